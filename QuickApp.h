@@ -8,6 +8,12 @@ void QuickAppLoop(std::function<void()> loopProcedure);
 #endif//QUICKAPP_INCLUDE_GUARD
 
 #ifdef QUICKAPP_IMPLEMENTATION
+//NOTE(Torin) Define QUICKAPP_PROFILE_SCOPE(name) before including this file
+//to time the ImGui render and the GL backend with your own profiler
+#ifndef QUICKAPP_PROFILE_SCOPE
+#define QUICKAPP_PROFILE_SCOPE(name)
+#endif//QUICKAPP_PROFILE_SCOPE
+
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_syswm.h>
 #include <SDL2/SDL_opengl.h>
@@ -45,6 +51,7 @@ static GLuint       g_FontTexture = 0;
 // - in your Render function, try translating your projection matrix by (0.5f,0.5f) or (0.375f,0.375f)
 void ImGui_ImplSdl_RenderDrawLists(ImDrawData* draw_data)
 {
+    QUICKAPP_PROFILE_SCOPE("GL Backend");
     // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer coordinates)
     ImGuiIO& io = ImGui::GetIO();
     int fb_width = (int)(io.DisplaySize.x * io.DisplayFramebufferScale.x);
@@ -339,7 +346,10 @@ void QuickAppLoop(std::function<void()> loopProc){
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     #ifdef QUICKAPP_IMGUI
-    ImGui::Render();
+    {
+      QUICKAPP_PROFILE_SCOPE("ImGui::Render");
+      ImGui::Render();
+    }
     #endif//QUICKAPP_IMGUI
     //SDL_RenderPresent(QuickAppInternal::renderer);
     SDL_GL_SwapWindow(QuickAppInternal::window);
@@ -0,0 +1,648 @@
+//NOTE(Torin) Autosave
+//Every record the editor applies, undoes or redoes is published to CommandJournal::outbox
+//(see commands.cpp). Once a frame UpdateAutosave hands the outbox to the writer thread, so
+//the UI thread only pays for the records made during that frame. The writer appends each
+//record to the journal file as an AutosaveEntry with a sequence number and a checksum and
+//fsyncs at most once every AUTOSAVE_SYNC_INTERVAL_MS.
+//The writer also applies the records to an AutosaveReplica of the design that only it
+//touches, which stands in for a copy-on-write snapshot of the editor: once the journal
+//exceeds AUTOSAVE_SNAPSHOT_BYTES the replica is written as a compacted snapshot (a temporary
+//file that is synced and renamed over the previous one) and the journal is truncated.
+//On startup the snapshot and then the journal entries past it are replayed through
+//ApplyCommandRecord, a torn or corrupt entry ends the replay and is cut off the journal.
+//Only the design is saved, simulation state and undo history are not. RAM / ROM contents
+//are saved as recorded by the commands, image loads and deleted nodes, words written by the
+//simulation since then are not.
+
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define AUTOSAVE_PATH "hwsim_autosave"
+#define AUTOSAVE_JOURNAL_MAGIC 0x4A535748   //"HWSJ"
+#define AUTOSAVE_SNAPSHOT_MAGIC 0x53535748  //"HWSS"
+#define AUTOSAVE_VERSION 3
+#define AUTOSAVE_SYNC_INTERVAL_MS 1000
+#define AUTOSAVE_SNAPSHOT_BYTES (16 * 1024 * 1024)
+#define AUTOSAVE_UNCONNECTED UINT32_MAX
+
+struct AutosaveFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t sequence;  //last journal entry included in a snapshot, unused by the journal
+};
+
+struct AutosaveEntry {
+  uint64_t sequence;  //consecutive in the journal, 0 in a snapshot
+  uint32_t checksum;  //FNV-1a of the size bytes that follow
+  uint32_t size;      //a PublishedRecord and its payload follow
+};
+
+struct ReplicaInput {
+  uint32_t source_id;  //AUTOSAVE_UNCONNECTED when the input is not driven
+  uint32_t source_output;
+};
+
+struct ReplicaNode {
+  NodeDescription description;
+  ReplicaInput *inputs;  //ReplicaInput[description.input_count], nullptr when not alive
+  DynamicArray<uint8_t> memory;  //description.memory_size bytes of serialized contents
+  bool is_alive;
+};
+
+struct AutosaveReplica {
+  DynamicArray<ReplicaNode> nodes;      //indexed by EditorNode::id
+  DynamicArray<uint8_t> definitions;    //the DEFINE_IC records in order, CommandHeader followed by payload
+  DynamicArray<uint32_t> definition_offsets;  //of the record of every IC in definitions
+  uint32_t alive_count;
+};
+
+struct AutosaveStatus {
+  uint64_t written_sequence;   //last entry written to the journal
+  uint64_t synced_sequence;    //last entry known to be on disk
+  uint64_t snapshot_sequence;  //last entry included in the snapshot
+  uint64_t journal_bytes;
+  uint32_t snapshot_count;
+  uint64_t recovered_entries;
+  bool was_journal_torn;
+  float recovery_milliseconds;
+  const char *error;  //nullptr while everything is written
+  int error_number;
+};
+
+struct Autosave {
+  char journal_path[256];
+  char snapshot_path[256];
+  char temporary_path[256];
+  int journal_fd;
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t condition;
+
+  //NOTE(Torin) Guarded by mutex
+  DynamicArray<uint8_t> pending;  //PublishedRecords handed over by UpdateAutosave
+  bool is_stopping;
+  AutosaveStatus status;
+
+  //NOTE(Torin) Owned by the writer thread once it is started
+  DynamicArray<uint8_t> writing;
+  DynamicArray<uint8_t> entries;
+  AutosaveReplica replica;
+  AutosaveStatus writer_status;
+  uint64_t next_sequence;
+  uint64_t last_sync_ticks;
+  bool is_dirty;
+};
+
+static uint32_t ChecksumFNV1a(const uint8_t *data, size_t size){
+  uint32_t hash = 2166136261u;
+  it(i, size){
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+static uint8_t *PushBytes(size_t size, DynamicArray<uint8_t> *buffer){
+  size_t required = buffer->count + size;
+  if(required > buffer->capacity){
+    size_t capacity = buffer->capacity * 2;
+    ArrayReserve(capacity > required ? capacity : required, *buffer);
+  }
+  uint8_t *result = buffer->data + buffer->count;
+  buffer->count = required;
+  return result;
+}
+
+//NOTE(Torin) Returns the payload to fill out, the checksum is computed by FinishAutosaveEntry
+static uint8_t *BeginAutosaveEntry(DynamicArray<uint8_t> *buffer, uint64_t sequence, bool is_undo, CommandType type, size_t size, size_t *entry_offset){
+  *entry_offset = buffer->count;
+  uint8_t *data = PushBytes(sizeof(AutosaveEntry) + sizeof(PublishedRecord) + size, buffer);
+  AutosaveEntry *entry = (AutosaveEntry *)data;
+  entry->sequence = sequence;
+  entry->size = sizeof(PublishedRecord) + size;
+  PublishedRecord *record = (PublishedRecord *)(entry + 1);
+  record->is_undo = is_undo ? 1 : 0;
+  record->header.type = type;
+  record->header.is_continuation = 0;
+  record->header.size = size;
+  return (uint8_t *)(record + 1);
+}
+
+static void FinishAutosaveEntry(DynamicArray<uint8_t> *buffer, size_t entry_offset){
+  AutosaveEntry *entry = (AutosaveEntry *)(buffer->data + entry_offset);
+  entry->checksum = ChecksumFNV1a((const uint8_t *)(entry + 1), entry->size);
+}
+
+static bool WriteAll(int fd, const uint8_t *data, size_t size){
+  while(size > 0){
+    ssize_t written = write(fd, data, size);
+    if(written < 0 && errno == EINTR) continue;
+    if(written <= 0) return false;
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+static bool ReadEntireFile(const char *path, DynamicArray<uint8_t> *data){
+  int fd = open(path, O_RDONLY);
+  if(fd < 0) return false;
+  data->count = 0;
+  while(true){
+    if(data->count == data->capacity) ArrayReserve(data->capacity * 2 + 64 * 1024, *data);
+    ssize_t bytes = read(fd, data->data + data->count, data->capacity - data->count);
+    if(bytes < 0 && errno == EINTR) continue;
+    if(bytes <= 0) break;
+    data->count += bytes;
+  }
+  close(fd);
+  return true;
+}
+
+//NOTE(Torin) A rename is only durable once the directory holding it is synced
+static void SyncParentDirectory(const char *path){
+  char directory[256];
+  const char *slash = strrchr(path, '/');
+  if(slash == nullptr){
+    strcpy(directory, ".");
+  } else {
+    size_t length = slash == path ? 1 : slash - path;
+    memcpy(directory, path, length);
+    directory[length] = 0;
+  }
+  int fd = open(directory, O_RDONLY);
+  if(fd < 0) return;
+  fsync(fd);
+  close(fd);
+}
+
+static ReplicaNode *GetReplicaNode(AutosaveReplica *replica, uint32_t id){
+  if(id >= replica->nodes.count){
+    size_t capacity = replica->nodes.capacity * 2;
+    if(id >= replica->nodes.capacity) ArrayReserve(capacity > id ? capacity : id + 1, replica->nodes);
+    for(size_t i = replica->nodes.count; i <= id; i++) replica->nodes.data[i] = ReplicaNode();
+    replica->nodes.count = id + 1;
+  }
+  return &replica->nodes[id];
+}
+
+static void ConnectReplica(AutosaveReplica *replica, const ConnectionDescription *connection, bool is_connected){
+  ReplicaNode *dest = GetReplicaNode(replica, connection->dest_id);
+  assert(dest->is_alive && connection->dest_input < dest->description.input_count);
+  ReplicaInput *input = &dest->inputs[connection->dest_input];
+  input->source_id = is_connected ? connection->source_id : AUTOSAVE_UNCONNECTED;
+  input->source_output = is_connected ? connection->source_output : 0;
+}
+
+static void SetReplicaMemory(ReplicaNode *node, const uint8_t *contents, uint32_t size){
+  ArrayReserve(size, node->memory);
+  if(size > 0) memcpy(node->memory.data, contents, size);
+  node->memory.count = size;
+  node->description.memory_size = size;
+}
+
+static void AddReplicaNodeSet(AutosaveReplica *replica, const uint8_t *payload){
+  const NodeSetCounts *counts = (const NodeSetCounts *)payload;
+  const NodeDescription *nodes = (const NodeDescription *)(counts + 1);
+  const ConnectionDescription *connections = (const ConnectionDescription *)(nodes + counts->node_count);
+  const uint8_t *contents = (const uint8_t *)(connections + counts->connection_count);
+  it(i, counts->node_count){
+    ReplicaNode *node = GetReplicaNode(replica, nodes[i].id);
+    assert(node->is_alive == false);
+    node->description = nodes[i];
+    node->is_alive = true;
+    node->inputs = (ReplicaInput *)malloc(nodes[i].input_count * sizeof(ReplicaInput) + 1);
+    it(n, nodes[i].input_count) node->inputs[n] = { AUTOSAVE_UNCONNECTED, 0 };
+    SetReplicaMemory(node, contents, nodes[i].memory_size);
+    contents += nodes[i].memory_size;
+    replica->alive_count++;
+  }
+  it(i, counts->connection_count) ConnectReplica(replica, &connections[i], true);
+}
+
+//NOTE(Torin) The set holds every connection touching its nodes, disconnecting them all
+//leaves no input outside of the set driven by a removed node
+static void RemoveReplicaNodeSet(AutosaveReplica *replica, const uint8_t *payload){
+  const NodeSetCounts *counts = (const NodeSetCounts *)payload;
+  const NodeDescription *nodes = (const NodeDescription *)(counts + 1);
+  const ConnectionDescription *connections = (const ConnectionDescription *)(nodes + counts->node_count);
+  it(i, counts->connection_count) ConnectReplica(replica, &connections[i], false);
+  it(i, counts->node_count){
+    ReplicaNode *node = GetReplicaNode(replica, nodes[i].id);
+    assert(node->is_alive);
+    free(node->inputs);
+    node->inputs = nullptr;
+    ArrayDestroy(node->memory);
+    node->memory = {};
+    node->is_alive = false;
+    replica->alive_count--;
+  }
+}
+
+static void ApplyReplicaRecord(AutosaveReplica *replica, const CommandHeader *header, bool is_undo){
+  const uint8_t *payload = (const uint8_t *)(header + 1);
+  switch(header->type){
+    case CommandType_CREATE_NODES:
+    case CommandType_DELETE_NODES:{
+      bool isCreate = (header->type == CommandType_CREATE_NODES) != is_undo;
+      if(isCreate) AddReplicaNodeSet(replica, payload);
+      else RemoveReplicaNodeSet(replica, payload);
+    }break;
+
+    case CommandType_CONNECT:
+    case CommandType_DISCONNECT:{
+      bool isConnect = (header->type == CommandType_CONNECT) != is_undo;
+      const ConnectionDescription *connections = (const ConnectionDescription *)payload;
+      size_t count = header->size / sizeof(ConnectionDescription);
+      it(i, count) ConnectReplica(replica, &connections[i], isConnect);
+    }break;
+
+    case CommandType_MOVE:{
+      const MoveCommand *move = (const MoveCommand *)payload;
+      const uint32_t *ids = (const uint32_t *)(move + 1);
+      float dx = is_undo ? -move->dx : move->dx;
+      float dy = is_undo ? -move->dy : move->dy;
+      it(i, move->node_count){
+        NodeDescription *description = &GetReplicaNode(replica, ids[i])->description;
+        description->x += dx;
+        description->y += dy;
+      }
+    }break;
+
+    case CommandType_SET_POSITIONS:{
+      const NodePosition *positions = (const NodePosition *)payload;
+      it(i, header->size / sizeof(NodePosition)){
+        NodeDescription *description = &GetReplicaNode(replica, positions[i].id)->description;
+        description->x = is_undo ? positions[i].old_x : positions[i].new_x;
+        description->y = is_undo ? positions[i].old_y : positions[i].new_y;
+      }
+    }break;
+
+    case CommandType_SET_PARAMETER:{
+      const ParameterCommand *change = (const ParameterCommand *)payload;
+      NodeDescription *description = &GetReplicaNode(replica, change->id)->description;
+      uint32_t value = is_undo ? change->old_value : change->new_value;
+      if(change->parameter == NodeParameter_DELAY) description->delay = value;
+      else description->parameter = value;
+    }break;
+
+    case CommandType_DEFINE_IC:{
+      if(is_undo || ((const DefineICCommand *)payload)->ic_index < replica->definition_offsets.count) break;
+      ArrayAdd((uint32_t)replica->definitions.count, replica->definition_offsets);
+      uint8_t *copy = PushBytes(sizeof(CommandHeader) + header->size, &replica->definitions);
+      memcpy(copy, header, sizeof(CommandHeader) + header->size);
+      ((CommandHeader *)copy)->is_continuation = 0;
+    }break;
+
+    case CommandType_RENAME_IC:{
+      const RenameICCommand *rename = (const RenameICCommand *)payload;
+      uint8_t *record = replica->definitions.data + replica->definition_offsets[rename->ic_index];
+      DefineICCommand *define = (DefineICCommand *)(record + sizeof(CommandHeader));
+      memcpy(define->name, is_undo ? rename->old_name : rename->new_name, IC_NAME_LENGTH);
+    }break;
+
+    //NOTE(Torin) Both patch the stored DEFINE_IC record, which always holds the layout
+    case CommandType_MOVE_IC_NODE:{
+      const MoveICNodeCommand *move = (const MoveICNodeCommand *)payload;
+      CommandHeader *define = (CommandHeader *)(replica->definitions.data + replica->definition_offsets[move->ic_index]);
+      uint8_t *definition = (uint8_t *)(define + 1) + sizeof(DefineICCommand);
+      float *position = GetSerializedICNodePosition(definition, define->size - sizeof(DefineICCommand), move->node_index);
+      position[0] += is_undo ? -move->dx : move->dx;
+      position[1] += is_undo ? -move->dy : move->dy;
+    }break;
+
+    case CommandType_SET_IC_NODE_TYPE:{
+      const ICNodeTypeCommand *change = (const ICNodeTypeCommand *)payload;
+      CommandHeader *define = (CommandHeader *)(replica->definitions.data + replica->definition_offsets[change->ic_index]);
+      uint8_t *definition = (uint8_t *)(define + 1) + sizeof(DefineICCommand);
+      *GetSerializedICNodeType(definition, change->node_index) = is_undo ? change->old_type : change->new_type;
+    }break;
+
+    case CommandType_SET_MEMORY:{
+      const MemoryCommand *change = (const MemoryCommand *)payload;
+      const uint8_t *contents = (const uint8_t *)(change + 1);
+      ReplicaNode *node = GetReplicaNode(replica, change->id);
+      if(is_undo) SetReplicaMemory(node, contents, change->old_size);
+      else SetReplicaMemory(node, contents + change->old_size, change->new_size);
+    }break;
+
+    default: assert(false);
+  }
+}
+
+static void DestroyReplica(AutosaveReplica *replica){
+  it(i, replica->nodes.count){
+    if(replica->nodes[i].is_alive == false) continue;
+    free(replica->nodes[i].inputs);
+    ArrayDestroy(replica->nodes[i].memory);
+  }
+  ArrayDestroy(replica->nodes);
+  ArrayDestroy(replica->definitions);
+  ArrayDestroy(replica->definition_offsets);
+  *replica = {};
+}
+
+static void SetAutosaveError(Autosave *autosave, const char *error){
+  autosave->writer_status.error = error;
+  autosave->writer_status.error_number = errno;
+}
+
+static void SyncAutosaveJournal(Autosave *autosave){
+  if(fdatasync(autosave->journal_fd) != 0) SetAutosaveError(autosave, "Failed to sync the journal");
+  else autosave->writer_status.synced_sequence = autosave->writer_status.written_sequence;
+  autosave->last_sync_ticks = ProfilerTimestamp();
+  autosave->is_dirty = false;
+}
+
+//NOTE(Torin) Written as the DEFINE_IC records followed by one CREATE_NODES record holding
+//every node and connection of the replica
+static void WriteAutosaveSnapshot(Autosave *autosave){
+  AutosaveReplica *replica = &autosave->replica;
+  DynamicArray<uint8_t> *buffer = &autosave->entries;
+  buffer->count = 0;
+  AutosaveFileHeader fileHeader = {};
+  fileHeader.magic = AUTOSAVE_SNAPSHOT_MAGIC;
+  fileHeader.version = AUTOSAVE_VERSION;
+  fileHeader.sequence = autosave->next_sequence - 1;
+  memcpy(PushBytes(sizeof(fileHeader), buffer), &fileHeader, sizeof(fileHeader));
+
+  size_t offset = 0, entryOffset = 0;
+  while(offset < replica->definitions.count){
+    const CommandHeader *header = (const CommandHeader *)(replica->definitions.data + offset);
+    uint8_t *payload = BeginAutosaveEntry(buffer, 0, false, CommandType_DEFINE_IC, header->size, &entryOffset);
+    memcpy(payload, header + 1, header->size);
+    FinishAutosaveEntry(buffer, entryOffset);
+    offset += sizeof(CommandHeader) + header->size;
+  }
+
+  size_t connectionCount = 0, memorySize = 0;
+  it(i, replica->nodes.count){
+    const ReplicaNode *node = &replica->nodes[i];
+    if(node->is_alive == false) continue;
+    memorySize += node->memory.count;
+    it(n, node->description.input_count) if(node->inputs[n].source_id != AUTOSAVE_UNCONNECTED) connectionCount++;
+  }
+  size_t size = sizeof(NodeSetCounts) + replica->alive_count * sizeof(NodeDescription) + connectionCount * sizeof(ConnectionDescription) + memorySize;
+  uint8_t *payload = BeginAutosaveEntry(buffer, 0, false, CommandType_CREATE_NODES, size, &entryOffset);
+  NodeSetCounts *counts = (NodeSetCounts *)payload;
+  counts->node_count = replica->alive_count;
+  counts->connection_count = connectionCount;
+  NodeDescription *description = (NodeDescription *)(counts + 1);
+  ConnectionDescription *connection = (ConnectionDescription *)(description + replica->alive_count);
+  uint8_t *contents = (uint8_t *)(connection + connectionCount);
+  it(i, replica->nodes.count){
+    const ReplicaNode *node = &replica->nodes[i];
+    if(node->is_alive == false) continue;
+    *description++ = node->description;
+    if(node->memory.count > 0) memcpy(contents, node->memory.data, node->memory.count);
+    contents += node->memory.count;
+    it(n, node->description.input_count){
+      const ReplicaInput *input = &node->inputs[n];
+      if(input->source_id == AUTOSAVE_UNCONNECTED) continue;
+      *connection++ = { input->source_id, input->source_output, (uint32_t)i, (uint32_t)n };
+    }
+  }
+  FinishAutosaveEntry(buffer, entryOffset);
+
+  int fd = open(autosave->temporary_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(fd < 0){
+    SetAutosaveError(autosave, "Failed to create the snapshot");
+    return;
+  }
+  bool isWritten = WriteAll(fd, buffer->data, buffer->count) && fsync(fd) == 0;
+  close(fd);
+  if(isWritten == false || rename(autosave->temporary_path, autosave->snapshot_path) != 0){
+    SetAutosaveError(autosave, "Failed to write the snapshot");
+    unlink(autosave->temporary_path);
+    return;
+  }
+  SyncParentDirectory(autosave->snapshot_path);
+
+  //NOTE(Torin) Entries left behind by a truncate that did not reach the disk are at or
+  //before the snapshot sequence and skipped by recovery
+  if(ftruncate(autosave->journal_fd, sizeof(AutosaveFileHeader)) != 0){
+    SetAutosaveError(autosave, "Failed to truncate the journal");
+    return;
+  }
+  autosave->writer_status.journal_bytes = sizeof(AutosaveFileHeader);
+  autosave->writer_status.snapshot_sequence = fileHeader.sequence;
+  autosave->writer_status.snapshot_count++;
+}
+
+static void WriteAutosaveRecords(Autosave *autosave, const uint8_t *records, size_t size){
+  DynamicArray<uint8_t> *buffer = &autosave->entries;
+  buffer->count = 0;
+  size_t offset = 0;
+  while(offset < size){
+    const PublishedRecord *record = (const PublishedRecord *)(records + offset);
+    size_t recordSize = sizeof(PublishedRecord) + record->header.size;
+    AutosaveEntry *entry = (AutosaveEntry *)PushBytes(sizeof(AutosaveEntry) + recordSize, buffer);
+    entry->sequence = autosave->next_sequence++;
+    entry->size = recordSize;
+    memcpy(entry + 1, record, recordSize);
+    entry->checksum = ChecksumFNV1a((const uint8_t *)record, recordSize);
+    ApplyReplicaRecord(&autosave->replica, &record->header, record->is_undo);
+    offset += recordSize;
+  }
+
+  AutosaveStatus *status = &autosave->writer_status;
+  if(WriteAll(autosave->journal_fd, buffer->data, buffer->count)){
+    status->journal_bytes += buffer->count;
+    status->written_sequence = autosave->next_sequence - 1;
+    autosave->is_dirty = true;
+  } else {
+    //NOTE(Torin) A partial write is cut off so later entries still follow a valid one,
+    //the records stay in the replica and reach the disk with the next snapshot
+    SetAutosaveError(autosave, "Failed to append to the journal");
+    if(ftruncate(autosave->journal_fd, status->journal_bytes) != 0) SetAutosaveError(autosave, "Failed to truncate the journal");
+  }
+}
+
+static void *RunAutosaveWriter(void *userdata){
+  Autosave *autosave = (Autosave *)userdata;
+  uint64_t syncTicks = (uint64_t)(AUTOSAVE_SYNC_INTERVAL_MS / ProfilerTicksToMilliseconds(1));
+  pthread_mutex_lock(&autosave->mutex);
+  while(true){
+    if(autosave->pending.count == 0 && autosave->is_stopping == false){
+      if(autosave->is_dirty){
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += AUTOSAVE_SYNC_INTERVAL_MS / 1000;
+        deadline.tv_nsec += (AUTOSAVE_SYNC_INTERVAL_MS % 1000) * 1000000;
+        if(deadline.tv_nsec >= 1000000000){
+          deadline.tv_sec++;
+          deadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&autosave->condition, &autosave->mutex, &deadline);
+      } else {
+        pthread_cond_wait(&autosave->condition, &autosave->mutex);
+      }
+    }
+    DynamicArray<uint8_t> records = autosave->pending;
+    autosave->pending = autosave->writing;
+    autosave->pending.count = 0;
+    autosave->writing = records;
+    bool isStopping = autosave->is_stopping;
+    pthread_mutex_unlock(&autosave->mutex);
+
+    if(autosave->writing.count > 0) WriteAutosaveRecords(autosave, autosave->writing.data, autosave->writing.count);
+    autosave->writing.count = 0;
+    bool isSyncDue = ProfilerTimestamp() - autosave->last_sync_ticks >= syncTicks;
+    if(autosave->writer_status.journal_bytes > AUTOSAVE_SNAPSHOT_BYTES ||
+      (isStopping && autosave->writer_status.journal_bytes > sizeof(AutosaveFileHeader))){
+      WriteAutosaveSnapshot(autosave);
+      if(autosave->is_dirty) SyncAutosaveJournal(autosave);
+    } else if(autosave->is_dirty && (isSyncDue || isStopping)){
+      SyncAutosaveJournal(autosave);
+    }
+
+    pthread_mutex_lock(&autosave->mutex);
+    autosave->status = autosave->writer_status;
+    if(isStopping && autosave->pending.count == 0) break;
+  }
+  pthread_mutex_unlock(&autosave->mutex);
+  return 0;
+}
+
+//NOTE(Torin) Returns the bytes of data holding valid entries, journal entries at or before
+//last_sequence were already replayed from the snapshot
+static size_t ReplayAutosaveEntries(Autosave *autosave, const uint8_t *data, size_t size, bool is_journal, uint64_t *last_sequence, Editor *editor){
+  size_t offset = sizeof(AutosaveFileHeader);
+  while(offset + sizeof(AutosaveEntry) <= size){
+    const AutosaveEntry *entry = (const AutosaveEntry *)(data + offset);
+    if(entry->size < sizeof(PublishedRecord) || entry->size > size - offset - sizeof(AutosaveEntry)) break;
+    const PublishedRecord *record = (const PublishedRecord *)(entry + 1);
+    if(record->header.size != entry->size - sizeof(PublishedRecord)) break;
+    if(ChecksumFNV1a((const uint8_t *)record, entry->size) != entry->checksum) break;
+    if(is_journal){
+      if(entry->sequence > *last_sequence + 1) break;
+      if(entry->sequence <= *last_sequence){
+        offset += sizeof(AutosaveEntry) + entry->size;
+        continue;
+      }
+      *last_sequence = entry->sequence;
+    }
+    ApplyCommandRecord(&record->header, record->is_undo, editor);
+    ApplyReplicaRecord(&autosave->replica, &record->header, record->is_undo);
+    autosave->writer_status.recovered_entries++;
+    offset += sizeof(AutosaveEntry) + entry->size;
+  }
+  return offset;
+}
+
+static void RecoverAutosave(Autosave *autosave, Editor *editor){
+  uint64_t beginTicks = ProfilerTimestamp();
+  DynamicArray<uint8_t> data = {};
+  uint64_t lastSequence = 0;
+  if(ReadEntireFile(autosave->snapshot_path, &data) && data.count >= sizeof(AutosaveFileHeader)){
+    const AutosaveFileHeader *header = (const AutosaveFileHeader *)data.data;
+    if(header->magic == AUTOSAVE_SNAPSHOT_MAGIC && header->version == AUTOSAVE_VERSION){
+      ReplayAutosaveEntries(autosave, data.data, data.count, false, &lastSequence, editor);
+      lastSequence = header->sequence;
+      autosave->writer_status.snapshot_sequence = lastSequence;
+    }
+  }
+
+  size_t journalBytes = 0;
+  if(ReadEntireFile(autosave->journal_path, &data) && data.count >= sizeof(AutosaveFileHeader)){
+    const AutosaveFileHeader *header = (const AutosaveFileHeader *)data.data;
+    if(header->magic == AUTOSAVE_JOURNAL_MAGIC && header->version == AUTOSAVE_VERSION){
+      journalBytes = ReplayAutosaveEntries(autosave, data.data, data.count, true, &lastSequence, editor);
+      autosave->writer_status.was_journal_torn = journalBytes < data.count;
+    }
+  }
+  ArrayDestroy(data);
+
+  autosave->next_sequence = lastSequence + 1;
+  autosave->writer_status.written_sequence = lastSequence;
+  autosave->writer_status.synced_sequence = lastSequence;
+  autosave->writer_status.journal_bytes = journalBytes;
+  autosave->writer_status.recovery_milliseconds = ProfilerTicksToMilliseconds(ProfilerTimestamp() - beginTicks);
+}
+
+//NOTE(Torin) Replays the design saved under path and starts saving every further edit,
+//path_prefix gets the .journal and .snapshot extensions
+Autosave *StartAutosave(const char *path_prefix, Editor *editor){
+  assert(editor->journal.is_publishing == false);
+  Autosave *autosave = (Autosave *)calloc(1, sizeof(Autosave));
+  snprintf(autosave->journal_path, sizeof(autosave->journal_path), "%s.journal", path_prefix);
+  snprintf(autosave->snapshot_path, sizeof(autosave->snapshot_path), "%s.snapshot", path_prefix);
+  snprintf(autosave->temporary_path, sizeof(autosave->temporary_path), "%s.snapshot.tmp", path_prefix);
+  RecoverAutosave(autosave, editor);
+
+  //NOTE(Torin) The torn tail of a journal is cut off so new entries follow the valid ones
+  autosave->journal_fd = open(autosave->journal_path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if(autosave->journal_fd < 0){
+    SetAutosaveError(autosave, "Failed to open the journal");
+  } else if(autosave->writer_status.journal_bytes == 0){
+    AutosaveFileHeader header = {};
+    header.magic = AUTOSAVE_JOURNAL_MAGIC;
+    header.version = AUTOSAVE_VERSION;
+    if(ftruncate(autosave->journal_fd, 0) != 0 ||
+      WriteAll(autosave->journal_fd, (const uint8_t *)&header, sizeof(header)) == false){
+      SetAutosaveError(autosave, "Failed to write the journal");
+    }
+    autosave->writer_status.journal_bytes = sizeof(header);
+  } else if(autosave->writer_status.was_journal_torn){
+    if(ftruncate(autosave->journal_fd, autosave->writer_status.journal_bytes) != 0){
+      SetAutosaveError(autosave, "Failed to truncate the journal");
+    }
+  }
+  autosave->status = autosave->writer_status;
+  autosave->last_sync_ticks = ProfilerTimestamp();
+
+  editor->journal.is_publishing = true;
+  editor->journal.published_count = editor->journal.applied_count;
+  pthread_mutex_init(&autosave->mutex, 0);
+  pthread_cond_init(&autosave->condition, 0);
+  pthread_create(&autosave->thread, 0, RunAutosaveWriter, autosave);
+  return autosave;
+}
+
+//NOTE(Torin) Called once a frame, hands the records published since the last call to the writer
+void UpdateAutosave(Autosave *autosave, Editor *editor){
+  DynamicArray<uint8_t>& outbox = editor->journal.outbox;
+  if(outbox.count == 0) return;
+  pthread_mutex_lock(&autosave->mutex);
+  if(autosave->pending.count == 0){
+    DynamicArray<uint8_t> swapped = autosave->pending;
+    autosave->pending = outbox;
+    outbox = swapped;
+  } else {
+    memcpy(PushBytes(outbox.count, &autosave->pending), outbox.data, outbox.count);
+  }
+  outbox.count = 0;
+  pthread_cond_signal(&autosave->condition);
+  pthread_mutex_unlock(&autosave->mutex);
+}
+
+AutosaveStatus GetAutosaveStatus(Autosave *autosave){
+  pthread_mutex_lock(&autosave->mutex);
+  AutosaveStatus result = autosave->status;
+  pthread_mutex_unlock(&autosave->mutex);
+  return result;
+}
+
+//NOTE(Torin) Writes everything still pending, compacts the journal into a snapshot and
+//stops publishing
+void StopAutosave(Autosave *autosave, Editor *editor){
+  EndMoveCommand(editor);
+  UpdateAutosave(autosave, editor);
+  pthread_mutex_lock(&autosave->mutex);
+  autosave->is_stopping = true;
+  pthread_cond_signal(&autosave->condition);
+  pthread_mutex_unlock(&autosave->mutex);
+  pthread_join(autosave->thread, 0);
+
+  editor->journal.is_publishing = false;
+  if(autosave->journal_fd >= 0) close(autosave->journal_fd);
+  pthread_mutex_destroy(&autosave->mutex);
+  pthread_cond_destroy(&autosave->condition);
+  DestroyReplica(&autosave->replica);
+  ArrayDestroy(autosave->pending);
+  ArrayDestroy(autosave->writing);
+  ArrayDestroy(autosave->entries);
+  free(autosave);
+}
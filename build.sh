@@ -1,2 +1,2 @@
 echo =========================================
-clang++ -std=c++14 -g -O0 main.cpp -lGL -lSDL2
\ No newline at end of file
+clang++ -std=c++14 -g -O0 main.cpp -lGL -lSDL2 -lpthread
\ No newline at end of file
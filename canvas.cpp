@@ -0,0 +1,84 @@
+//NOTE(Torin) Canvas camera
+//The design canvas and the IC view look at the world through a Camera, its position is
+//kept in doubles and positions are made relative to it before they are scaled, so panning
+//and zooming stay exact at any distance from the origin even though nodes store floats.
+//The mouse wheel zooms around the cursor, the middle button pans. The grid picks its
+//spacing from the zoom so it never draws more than a line every CANVAS_GRID_MIN_PIXELS.
+
+#define CANVAS_GRID_SIZE 16.0
+#define CANVAS_GRID_MIN_PIXELS 12.0
+#define CANVAS_GRID_MAJOR_EVERY 4
+#define CANVAS_ZOOM_MIN 0.01f
+#define CANVAS_ZOOM_MAX 8.0f
+#define CANVAS_ZOOM_STEP 1.15f
+//NOTE(Torin) Below this zoom nodes are drawn as boxes without their labels and widgets
+#define CANVAS_DETAIL_ZOOM 0.4f
+
+//NOTE(Torin) A zero camera starts at zoom 1 with the world origin at position in the canvas
+static void InitializeCamera(Camera *camera, ImVec2 position){
+  if(camera->zoom != 0.0f) return;
+  camera->zoom = 1.0f;
+  camera->x = -position.x;
+  camera->y = -position.y;
+}
+
+static inline
+ImVec2 WorldToScreen(ImVec2 p, const Camera *camera, ImVec2 canvasOrigin){
+  return ImVec2(canvasOrigin.x + (float)((p.x - camera->x) * camera->zoom),
+    canvasOrigin.y + (float)((p.y - camera->y) * camera->zoom));
+}
+
+static inline
+ImVec2 ScreenToWorld(ImVec2 p, const Camera *camera, ImVec2 canvasOrigin){
+  return ImVec2((float)(camera->x + (p.x - canvasOrigin.x) / camera->zoom),
+    (float)(camera->y + (p.y - canvasOrigin.y) / camera->zoom));
+}
+
+//NOTE(Torin) Whether the screen space box spanned by a and b overlaps the canvas, nodes and
+//connections outside of it are not drawn
+static inline
+bool IsOnCanvas(ImVec2 a, ImVec2 b, ImVec2 canvasOrigin, ImVec2 canvasSize){
+  return Max(a.x, b.x) >= canvasOrigin.x && Min(a.x, b.x) <= canvasOrigin.x + canvasSize.x &&
+    Max(a.y, b.y) >= canvasOrigin.y && Min(a.y, b.y) <= canvasOrigin.y + canvasSize.y;
+}
+
+//NOTE(Torin) Called with the canvas child window current
+static void UpdateCamera(Camera *camera, ImVec2 canvasOrigin){
+  ImGuiIO& io = ImGui::GetIO();
+  if(!ImGui::IsWindowHovered()) return;
+  if(io.MouseWheel != 0.0f){
+    //NOTE(Torin) The world point under the cursor stays under it
+    double worldX = camera->x + (io.MousePos.x - canvasOrigin.x) / camera->zoom;
+    double worldY = camera->y + (io.MousePos.y - canvasOrigin.y) / camera->zoom;
+    float zoom = camera->zoom * powf(CANVAS_ZOOM_STEP, io.MouseWheel);
+    camera->zoom = Min(Max(zoom, CANVAS_ZOOM_MIN), CANVAS_ZOOM_MAX);
+    camera->x = worldX - (io.MousePos.x - canvasOrigin.x) / camera->zoom;
+    camera->y = worldY - (io.MousePos.y - canvasOrigin.y) / camera->zoom;
+  }
+  if(!ImGui::IsAnyItemActive() && ImGui::IsMouseDragging(2, 0.0f)){
+    camera->x -= io.MouseDelta.x / camera->zoom;
+    camera->y -= io.MouseDelta.y / camera->zoom;
+  }
+}
+
+static void DrawCanvasGrid(ImDrawList *draw_list, const Camera *camera, ImVec2 canvasOrigin, ImVec2 canvasSize){
+  static const ImU32 GRID_COLOR = ImColor(200,200,200,25);
+  static const ImU32 GRID_MAJOR_COLOR = ImColor(200,200,200,50);
+  double spacing = CANVAS_GRID_SIZE;
+  while(spacing * camera->zoom < CANVAS_GRID_MIN_PIXELS) spacing *= CANVAS_GRID_MAJOR_EVERY;
+
+  int64_t first = (int64_t)floor(camera->x / spacing);
+  for(int64_t line = first; ; line++){
+    float x = (float)((line * spacing - camera->x) * camera->zoom);
+    if(x > canvasSize.x) break;
+    ImU32 color = line % CANVAS_GRID_MAJOR_EVERY == 0 ? GRID_MAJOR_COLOR : GRID_COLOR;
+    draw_list->AddLine(canvasOrigin + ImVec2(x, 0.0f), canvasOrigin + ImVec2(x, canvasSize.y), color);
+  }
+  first = (int64_t)floor(camera->y / spacing);
+  for(int64_t line = first; ; line++){
+    float y = (float)((line * spacing - camera->y) * camera->zoom);
+    if(y > canvasSize.y) break;
+    ImU32 color = line % CANVAS_GRID_MAJOR_EVERY == 0 ? GRID_MAJOR_COLOR : GRID_COLOR;
+    draw_list->AddLine(canvasOrigin + ImVec2(0.0f, y), canvasOrigin + ImVec2(canvasSize.x, y), color);
+  }
+}
@@ -0,0 +1,418 @@
+//NOTE(Torin) Copy / paste
+//A copied selection is a relocatable buffer: a ClipboardHeader followed by a ClipboardIC
+//for every IC the nodes instantiate, the NodeDescriptions of the nodes, whose ids are their
+//index in the buffer, the connections between them, the serialized definition and layout of
+//every ClipboardIC and the memory contents of the nodes with a memory_size. Connections to
+//nodes outside of the selection are not copied.
+//The same buffer goes to the system clipboard as text, CLIPBOARD_TEXT_PREFIX followed by the
+//buffer in base64. Pasting assigns the new nodes a contiguous range of ids, so remapping a
+//handle is an addition, and the journal records the paste as one CREATE_NODES command.
+//The type of a copied IC instance indexes the ClipboardICs instead of Editor::icdefs, pasting
+//uses the library entry with the same definition bytes and defines the IC from the buffer
+//when there is none.
+
+#define CLIPBOARD_MAGIC 0x43535748  //"HWSC"
+#define CLIPBOARD_VERSION 3
+#define CLIPBOARD_TEXT_PREFIX "hwsim-clipboard:"
+#define CLIPBOARD_DUPLICATE_OFFSET 32.0f
+
+struct ClipboardHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t node_count;
+  uint32_t connection_count;
+  uint32_t ic_count;
+  uint32_t reserved;         //keeps the ClipboardICs aligned
+  float origin_x, origin_y;  //center of the copied nodes
+};
+
+//NOTE(Torin) Like an ICLibraryEntry, hash and size are of the serialized definition which
+//is followed by layout_size bytes of its layout
+struct ClipboardIC {
+  uint64_t hash;
+  uint32_t size;
+  uint32_t layout_size;
+  uint32_t input_count;
+  uint32_t output_count;
+};
+
+static const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+//NOTE(Torin) Serializes the nodes into buffer, EditorNode::scratch_index holds the buffer
+//index of every copied node (UINT32_MAX otherwise)
+void SerializeNodes(const NodeIndex *indices, size_t count, Editor *editor, DynamicArray<uint8_t> *buffer){
+  it(i, editor->nodes.count) editor->nodes[i]->scratch_index = UINT32_MAX;
+  ImVec2 origin;
+  uint32_t *icSlot = (uint32_t *)malloc(sizeof(uint32_t) * (editor->icdefs.count + 1));
+  memset(icSlot, 0xFF, sizeof(uint32_t) * (editor->icdefs.count + 1));
+  DynamicArray<ClipboardIC> ics = {};
+  DynamicArray<uint8_t> definitions = {};
+  size_t memorySize = 0;
+  it(i, count){
+    EditorNode *node = GetNode(indices[i], editor);
+    node->scratch_index = i;
+    origin += node->position;
+    if(node->memory != nullptr) memorySize += GetMemoryContentsSize(node->memory);
+    if(node->type <= NodeType_COUNT) continue;
+    uint32_t ic_index = node->type - (NodeType_COUNT + 1);
+    if(icSlot[ic_index] != UINT32_MAX) continue;
+    const ICDefinition *icdef = editor->icdefs[ic_index];
+    size_t offset = definitions.count;
+    SerializeICDefinition(icdef, &definitions);
+    size_t size = definitions.count - offset;
+    SerializeICLayout(icdef, &definitions);
+    ClipboardIC ic = { HashFNV1a64(definitions.data + offset, size), (uint32_t)size, (uint32_t)(definitions.count - offset - size),
+      icdef->input_count, icdef->output_count };
+    icSlot[ic_index] = ics.count;
+    ArrayAdd(ic, ics);
+  }
+  if(count > 0) origin /= (float)count;
+
+  size_t connectionCount = 0;
+  it(i, count){
+    EditorNode *node = GetNode(indices[i], editor);
+    it(n, node->input_count){
+      const NodeConnection *input = &node->inputConnections[n];
+      if(IsValid(input->node_index) && input->node_index.node_ptr->scratch_index != UINT32_MAX) connectionCount++;
+    }
+  }
+
+  size_t size = sizeof(ClipboardHeader) + count * sizeof(NodeDescription) + connectionCount * sizeof(ConnectionDescription) +
+    ics.count * sizeof(ClipboardIC) + definitions.count + memorySize;
+  buffer->count = 0;
+  ArrayReserve(size, *buffer);
+  buffer->count = size;
+  ClipboardHeader *header = (ClipboardHeader *)buffer->data;
+  header->magic = CLIPBOARD_MAGIC;
+  header->version = CLIPBOARD_VERSION;
+  header->node_count = count;
+  header->connection_count = connectionCount;
+  header->ic_count = ics.count;
+  header->reserved = 0;
+  header->origin_x = origin.x;
+  header->origin_y = origin.y;
+
+  if(ics.count > 0) memcpy(header + 1, ics.data, ics.count * sizeof(ClipboardIC));
+  NodeDescription *nodes = (NodeDescription *)((ClipboardIC *)(header + 1) + ics.count);
+  ConnectionDescription *connection = (ConnectionDescription *)(nodes + count);
+  uint8_t *contents = buffer->data + size - memorySize;
+  if(definitions.count > 0) memcpy(contents - definitions.count, definitions.data, definitions.count);
+  it(i, count){
+    EditorNode *node = GetNode(indices[i], editor);
+    nodes[i] = DescribeNode(node);
+    nodes[i].id = i;
+    if(node->type > NodeType_COUNT) nodes[i].type = NodeType_COUNT + 1 + icSlot[node->type - (NodeType_COUNT + 1)];
+    if(node->memory != nullptr){
+      uint8_t *end = SerializeMemoryContents(node->memory, contents);
+      nodes[i].memory_size = end - contents;
+      contents = end;
+    }
+    it(n, node->input_count){
+      const NodeConnection *input = &node->inputConnections[n];
+      if(IsValid(input->node_index) == false) continue;
+      uint32_t source = input->node_index.node_ptr->scratch_index;
+      if(source == UINT32_MAX) continue;
+      *connection++ = { source, input->io_index, (uint32_t)i, (uint32_t)n };
+    }
+  }
+  free(icSlot);
+  ArrayDestroy(ics);
+  ArrayDestroy(definitions);
+}
+
+//NOTE(Torin) Built in nodes must have the ports and parameter CreateNode gives them, the
+//simulators index ports by node type without checking the counts
+static bool IsBuiltinNodeDescriptionValid(const NodeDescription *node){
+  uint32_t input_count = 0, output_count = 1;
+  switch(node->type){
+    case NodeType_INPUT:{
+      if(node->parameter > BUS_MAX_WIDTH) return false;
+    }break;
+    case NodeType_OUTPUT:{
+      if(node->parameter > BUS_MAX_WIDTH) return false;
+      input_count = 1;
+      output_count = 0;
+    }break;
+    case NodeType_DFF:{
+      input_count = 2;
+    }break;
+    case NodeType_REGISTER:{
+      //NOTE(Torin) A bit per output or a single bus output, see IsBusRegister
+      if(node->output_count < 1 || node->output_count > REGISTER_MAX_WIDTH) return false;
+      bool isBus = node->output_count == 1 && node->parameter >= 1 && node->parameter <= REGISTER_MAX_WIDTH;
+      if(node->parameter != node->output_count && !isBus) return false;
+      output_count = node->output_count;
+      input_count = output_count + 1;
+    }break;
+    case NodeType_CLOCK:{
+      if(node->parameter == 0) return false;
+    }break;
+    case NodeType_RAM:{
+      input_count = 4;
+    }break;
+    case NodeType_ROM:{
+      input_count = 1;
+    }break;
+    default:{
+      if(IsLogicGateType(node->type)){
+        const GateInfo *info = GetGateInfo(node->type);
+        if(node->input_count < info->min_inputs || node->input_count > info->max_inputs) return false;
+        input_count = node->input_count;
+      } else if(IsWordNodeType(node->type)){
+        if(node->parameter < 1 || node->parameter > BUS_MAX_WIDTH) return false;
+        GetWordNodeIOCount(node->type, node->parameter, &input_count, &output_count);
+      } else {
+        return false;
+      }
+    }break;
+  }
+  bool result = node->input_count == input_count && node->output_count == output_count;
+  return result;
+}
+
+//NOTE(Torin) The buffer may come from the system clipboard so everything is checked before
+//any node is created
+static bool IsClipboardBufferValid(const uint8_t *data, size_t size){
+  if(size < sizeof(ClipboardHeader)) return false;
+  const ClipboardHeader *header = (const ClipboardHeader *)data;
+  if(header->magic != CLIPBOARD_MAGIC || header->version != CLIPBOARD_VERSION) return false;
+  uint64_t expected = sizeof(ClipboardHeader) + (uint64_t)header->node_count * sizeof(NodeDescription) +
+    (uint64_t)header->connection_count * sizeof(ConnectionDescription) + (uint64_t)header->ic_count * sizeof(ClipboardIC);
+  if(expected > size) return false;
+
+  const ClipboardIC *ics = (const ClipboardIC *)(header + 1);
+  const NodeDescription *nodes = (const NodeDescription *)(ics + header->ic_count);
+  const ConnectionDescription *connections = (const ConnectionDescription *)(nodes + header->node_count);
+  //NOTE(Torin) Definitions are checked when they are pasted, the sizes keep the contents
+  //that follow them 4 byte aligned
+  it(i, header->ic_count){
+    if(ics[i].size % sizeof(uint32_t) != 0 || ics[i].layout_size % sizeof(uint32_t) != 0) return false;
+    expected += (uint64_t)ics[i].size + ics[i].layout_size;
+  }
+  it(i, header->node_count) expected += nodes[i].memory_size;
+  if(expected != size) return false;
+
+  const uint8_t *contents = data + size;
+  it(i, header->node_count) contents -= nodes[i].memory_size;
+  it(i, header->node_count){
+    const NodeDescription *node = &nodes[i];
+    if(node->id != i || node->type == NodeType_COUNT) return false;
+    if(node->type > NodeType_COUNT){
+      uint32_t slot = node->type - (NodeType_COUNT + 1);
+      if(slot >= header->ic_count) return false;
+      if(node->input_count != ics[slot].input_count || node->output_count != ics[slot].output_count) return false;
+    } else if(!IsBuiltinNodeDescriptionValid(node)){
+      return false;
+    }
+    if(node->input_count > 1024 || node->output_count > 1024) return false;
+    if(IsMemoryNodeType(node->type)){
+      if(node->memory_address_width < 1 || node->memory_address_width > MEMORY_MAX_ADDRESS_WIDTH) return false;
+      if(node->memory_data_width < 1 || node->memory_data_width > BUS_MAX_WIDTH) return false;
+      if(node->memory_size > 0 && !IsMemoryContentsValid(contents, node->memory_size, node->memory_address_width, node->memory_data_width)) return false;
+    } else if(node->memory_size > 0){
+      return false;
+    }
+    contents += node->memory_size;
+  }
+
+  it(i, header->connection_count){
+    const ConnectionDescription *connection = &connections[i];
+    if(connection->source_id >= header->node_count || connection->dest_id >= header->node_count) return false;
+    if(connection->source_output >= nodes[connection->source_id].output_count) return false;
+    if(connection->dest_input >= nodes[connection->dest_id].input_count) return false;
+  }
+  return true;
+}
+
+//NOTE(Torin) Creates the buffer's nodes centered on position and selects them, returns false
+//when the buffer is not a valid clipboard buffer or holds a definition that is not valid
+bool CommandPaste(const uint8_t *data, size_t size, ImVec2 position, Editor *editor){
+  PROFILE_SCOPE("CommandPaste");
+  if(!IsClipboardBufferValid(data, size)) return false;
+  const ClipboardHeader *header = (const ClipboardHeader *)data;
+  const ClipboardIC *ics = (const ClipboardIC *)(header + 1);
+  const NodeDescription *nodes = (const NodeDescription *)(ics + header->ic_count);
+  const ConnectionDescription *connections = (const ConnectionDescription *)(nodes + header->node_count);
+  const uint8_t *definition = (const uint8_t *)(connections + header->connection_count);
+  size_t memorySize = 0;
+  it(i, header->node_count) memorySize += nodes[i].memory_size;
+  const uint8_t *contents = data + size - memorySize;
+
+  //NOTE(Torin) An input can only be driven once, a buffer that drives one twice is rejected
+  //before anything is created
+  DynamicArray<uint32_t> inputBase = {};
+  ArrayReserve(header->node_count + 1, inputBase);
+  uint32_t inputTotal = 0;
+  it(i, header->node_count){
+    ArrayAdd(inputTotal, inputBase);
+    inputTotal += nodes[i].input_count;
+  }
+  uint8_t *isDriven = (uint8_t *)calloc(inputTotal + 1, 1);
+  bool isValid = true;
+  it(i, header->connection_count){
+    uint32_t slot = inputBase[connections[i].dest_id] + connections[i].dest_input;
+    if(isDriven[slot]) isValid = false;
+    isDriven[slot] = 1;
+  }
+  free(isDriven);
+  ArrayDestroy(inputBase);
+  if(!isValid) return false;
+
+  //NOTE(Torin) Definitions that are new to Editor::icdefs are recorded like
+  //CommandCreateLibraryIC does, a paste that fails afterwards leaves them defined
+  uint32_t *icIndices = (uint32_t *)malloc(sizeof(uint32_t) * (header->ic_count + 1));
+  bool isDefined = false;
+  it(i, header->ic_count){
+    size_t icCount = editor->icdefs.count;
+    uint32_t entry_index = FindLibraryEntry(definition, ics[i].size, ics[i].hash, false, editor);
+    if(entry_index != IC_LIBRARY_NONE){
+      icIndices[i] = LoadLibraryIC(entry_index, editor);
+    } else {
+      ICDefinition *icdef = DeserializeICDefinition(definition, ics[i].size + ics[i].layout_size);
+      if(icdef != nullptr && (icdef->input_count != ics[i].input_count || icdef->output_count != ics[i].output_count)){
+        free(icdef);
+        icdef = nullptr;
+      }
+      icIndices[i] = icdef == nullptr ? IC_LIBRARY_NONE : AddICDefinition(icdef, nullptr, editor);
+    }
+    definition += ics[i].size + ics[i].layout_size;
+    if(icIndices[i] == IC_LIBRARY_NONE){
+      isValid = false;
+      break;
+    }
+    if(editor->icdefs.count > icCount){
+      RecordDefineIC(icIndices[i], isDefined, editor);
+      isDefined = true;
+    }
+  }
+  if(!isValid){
+    if(isDefined) FinishCommand(editor);
+    free(icIndices);
+    return false;
+  }
+
+  uint32_t count = header->node_count;
+  uint32_t baseID = editor->nodeTable.count;
+  ArrayReserve(editor->nodes.count + count, editor->nodes);
+  ArrayReserve(editor->nodeTable.count + count, editor->nodeTable);
+  ArrayReserve(editor->selectedNodes.count + count, editor->selectedNodes);
+
+  size_t recordSize = sizeof(NodeSetCounts) + count * sizeof(NodeDescription) + header->connection_count * sizeof(ConnectionDescription) + memorySize;
+  uint8_t *payload = AppendCommandRecord(editor, CommandType_CREATE_NODES, recordSize, isDefined);
+  NodeSetCounts *counts = (NodeSetCounts *)payload;
+  counts->node_count = count;
+  counts->connection_count = header->connection_count;
+  NodeDescription *recordNodes = (NodeDescription *)(counts + 1);
+  ConnectionDescription *recordConnections = (ConnectionDescription *)(recordNodes + count);
+  if(memorySize > 0) memcpy(recordConnections + header->connection_count, contents, memorySize);
+
+  ClearSelection(editor);
+  ImVec2 offset = position - ImVec2(header->origin_x, header->origin_y);
+  it(i, count){
+    NodeDescription description = nodes[i];
+    description.id = NODE_ID_NEW;
+    description.x += offset.x;
+    description.y += offset.y;
+    if(description.type > NodeType_COUNT) description.type = NodeType_COUNT + 1 + icIndices[description.type - (NodeType_COUNT + 1)];
+    EditorNode *node = CreateNodeFromDescription(&description, editor);
+    assert(node->id == baseID + i);
+    if(description.memory_size > 0) LoadMemoryContents(node->memory, contents, description.memory_size);
+    contents += description.memory_size;
+    recordNodes[i] = DescribeNode(node);
+    recordNodes[i].memory_size = description.memory_size;
+    NodeIndex index = {};
+    index.node_index = node->id;
+    index.node_ptr = node;
+    SelectNode(index, editor);
+  }
+  it(i, header->connection_count){
+    ConnectionDescription connection = connections[i];
+    connection.source_id += baseID;
+    connection.dest_id += baseID;
+    recordConnections[i] = connection;
+    ConnectDescribed(&connection, editor);
+  }
+  FinishCommand(editor);
+  free(icIndices);
+  return true;
+}
+
+static void EncodeBase64(const uint8_t *data, size_t size, DynamicArray<char> *text){
+  ArrayReserve(text->count + ((size + 2) / 3) * 4 + 1, *text);
+  for(size_t i = 0; i < size; i += 3){
+    uint32_t bits = (uint32_t)data[i] << 16;
+    if(i + 1 < size) bits |= (uint32_t)data[i + 1] << 8;
+    if(i + 2 < size) bits |= data[i + 2];
+    ArrayAdd(BASE64_ALPHABET[(bits >> 18) & 63], *text);
+    ArrayAdd(BASE64_ALPHABET[(bits >> 12) & 63], *text);
+    ArrayAdd(i + 1 < size ? BASE64_ALPHABET[(bits >> 6) & 63] : '=', *text);
+    ArrayAdd(i + 2 < size ? BASE64_ALPHABET[bits & 63] : '=', *text);
+  }
+}
+
+static bool DecodeBase64(const char *text, DynamicArray<uint8_t> *data){
+  int8_t values[256];
+  memset(values, -1, sizeof(values));
+  it(i, 64) values[(uint8_t)BASE64_ALPHABET[i]] = i;
+
+  data->count = 0;
+  ArrayReserve((strlen(text) / 4) * 3, *data);
+  uint32_t bits = 0, bitCount = 0;
+  for(const char *c = text; *c != 0 && *c != '='; c++){
+    if(*c == '\n' || *c == '\r' || *c == ' ') continue;
+    int8_t value = values[(uint8_t)*c];
+    if(value < 0) return false;
+    bits = (bits << 6) | value;
+    bitCount += 6;
+    if(bitCount >= 8){
+      bitCount -= 8;
+      ArrayAdd((uint8_t)(bits >> bitCount), *data);
+      bits &= (1u << bitCount) - 1;
+    }
+  }
+  return true;
+}
+
+void CopySelection(Editor *editor){
+  SerializeNodes(editor->selectedNodes.data, editor->selectedNodes.count, editor, &editor->clipboard);
+  DynamicArray<char> text = {};
+  size_t prefixLength = strlen(CLIPBOARD_TEXT_PREFIX);
+  ArrayReserve(prefixLength, text);
+  memcpy(text.data, CLIPBOARD_TEXT_PREFIX, prefixLength);
+  text.count = prefixLength;
+  EncodeBase64(editor->clipboard.data, editor->clipboard.count, &text);
+  ArrayAdd('\0', text);
+  ImGui::SetClipboardText(text.data);
+  ArrayDestroy(text);
+}
+
+void CutSelection(Editor *editor){
+  CopySelection(editor);
+  CommandDeleteNodes(editor->selectedNodes.data, editor->selectedNodes.count, editor);
+}
+
+//NOTE(Torin) Prefers the system clipboard so selections can be moved between instances,
+//falls back to the last copy of this session
+bool PasteClipboard(ImVec2 position, Editor *editor){
+  const char *text = ImGui::GetClipboardText();
+  size_t prefixLength = strlen(CLIPBOARD_TEXT_PREFIX);
+  if(text != nullptr && strncmp(text, CLIPBOARD_TEXT_PREFIX, prefixLength) == 0){
+    DynamicArray<uint8_t> data = {};
+    bool result = DecodeBase64(text + prefixLength, &data) && CommandPaste(data.data, data.count, position, editor);
+    ArrayDestroy(data);
+    if(result) return true;
+  }
+  if(editor->clipboard.count == 0) return false;
+  return CommandPaste(editor->clipboard.data, editor->clipboard.count, position, editor);
+}
+
+//NOTE(Torin) Does not touch either clipboard
+void DuplicateSelection(Editor *editor){
+  if(editor->selectedNodes.count == 0) return;
+  DynamicArray<uint8_t> buffer = {};
+  SerializeNodes(editor->selectedNodes.data, editor->selectedNodes.count, editor, &buffer);
+  const ClipboardHeader *header = (const ClipboardHeader *)buffer.data;
+  ImVec2 position = ImVec2(header->origin_x, header->origin_y) + ImVec2(CLIPBOARD_DUPLICATE_OFFSET, CLIPBOARD_DUPLICATE_OFFSET);
+  CommandPaste(buffer.data, buffer.count, position, editor);
+  ArrayDestroy(buffer);
+}
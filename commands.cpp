@@ -0,0 +1,656 @@
+//NOTE(Torin) Undo / redo
+//Every edit of the design goes through one of the Command functions below, which applies
+//the edit and appends a record describing it to Editor::journal. Records reference nodes by
+//EditorNode::id and otherwise only hold plain values, so a record is the size of the change
+//and undoing or redoing it costs the same as making the edit. Deleted nodes are recorded
+//with NodeDescriptions and their connections instead of being kept alive.
+//A drag appends a single MOVE record whose delta grows while the mouse is held, the same
+//goes for MOVE_IC_NODE when a node is dragged inside an open IC (see ic_view.cpp). Once the
+//journal exceeds COMMAND_JOURNAL_MAX_BYTES the oldest commands are dropped.
+//Listeners that mirror the design (the autosave) read the records in the order they are
+//applied, undone and redone from CommandJournal::outbox, replaying them with
+//ApplyCommandRecord rebuilds the design.
+
+#define COMMAND_JOURNAL_MAX_BYTES (64 * 1024 * 1024)
+
+enum CommandType : uint16_t {
+  CommandType_CREATE_NODES,   //NodeSet
+  CommandType_DELETE_NODES,   //NodeSet
+  CommandType_CONNECT,        //ConnectionDescription[]
+  CommandType_DISCONNECT,     //ConnectionDescription[]
+  CommandType_MOVE,           //MoveCommand, ids
+  CommandType_SET_PARAMETER,  //ParameterCommand
+  CommandType_DEFINE_IC,      //DefineICCommand, serialized ICDefinition
+  CommandType_RENAME_IC,      //RenameICCommand
+  CommandType_MOVE_IC_NODE,   //MoveICNodeCommand
+  CommandType_SET_IC_NODE_TYPE,  //ICNodeTypeCommand
+  CommandType_SET_POSITIONS,  //NodePosition[]
+  CommandType_SET_MEMORY,     //MemoryCommand, old and new serialized contents
+};
+
+enum NodeParameter {
+  NodeParameter_DELAY,
+  NodeParameter_CLOCK_HALF_PERIOD,
+};
+
+struct CommandHeader {
+  uint16_t type;
+  uint16_t is_continuation;  //undone and redone together with the record before it
+  uint32_t size;             //payload bytes
+};
+
+struct ConnectionDescription {
+  uint32_t source_id;
+  uint32_t source_output;
+  uint32_t dest_id;
+  uint32_t dest_input;
+};
+
+//NOTE(Torin) NodeSet payload is the two counts followed by the NodeDescriptions, every
+//connection that touches one of the nodes and then the serialized memory contents of the
+//nodes with a memory_size, in the order of the descriptions
+struct NodeSetCounts {
+  uint32_t node_count;
+  uint32_t connection_count;
+};
+
+struct MoveCommand {
+  float dx, dy;
+  uint32_t node_count;  //followed by the ids
+};
+
+struct NodePosition {
+  uint32_t id;
+  float old_x, old_y;
+  float new_x, new_y;
+};
+
+struct PublishedRecord {
+  uint32_t is_undo;
+  CommandHeader header;  //followed by the payload
+};
+
+//NOTE(Torin) Definitions are never removed, undo keeps it and redo finds it already defined
+struct DefineICCommand {
+  uint32_t ic_index;
+  char name[IC_NAME_LENGTH];  //followed by the serialized ICDefinition
+};
+
+struct RenameICCommand {
+  uint32_t ic_index;
+  char old_name[IC_NAME_LENGTH];
+  char new_name[IC_NAME_LENGTH];
+};
+
+struct MoveICNodeCommand {
+  uint32_t ic_index;
+  uint32_t node_index;
+  float dx, dy;
+};
+
+//NOTE(Torin) Edits the definition, so every instance of the IC
+struct ICNodeTypeCommand {
+  uint32_t ic_index;
+  uint32_t node_index;
+  uint32_t old_type;
+  uint32_t new_type;
+};
+
+struct MemoryCommand {
+  uint32_t id;
+  uint32_t old_size;
+  uint32_t new_size;
+  uint32_t reserved;  //keeps the contents 8 byte aligned
+};
+
+struct ParameterCommand {
+  uint32_t id;
+  uint32_t parameter;
+  uint32_t old_value;
+  uint32_t new_value;
+};
+
+static inline
+const CommandHeader *GetCommandRecord(const CommandJournal *journal, uint32_t record){
+  return (const CommandHeader *)(journal->data.data + journal->record_offsets.data[record]);
+}
+
+//NOTE(Torin) Returns the payload to fill out, it is only valid until the next append
+static uint8_t *AppendCommandRecord(Editor *editor, CommandType type, size_t size, bool is_continuation){
+  CommandJournal *journal = &editor->journal;
+  //NOTE(Torin) A new edit discards everything that could still be redone
+  if(journal->applied_count < journal->record_offsets.count){
+    journal->data.count = journal->record_offsets[journal->applied_count];
+    journal->record_offsets.count = journal->applied_count;
+  }
+
+  size_t offset = journal->data.count;
+  size_t required = offset + sizeof(CommandHeader) + size;
+  if(required > journal->data.capacity){
+    size_t capacity = journal->data.capacity * 2;
+    ArrayReserve(capacity > required ? capacity : required, journal->data);
+  }
+  if(journal->record_offsets.count == journal->record_offsets.capacity){
+    ArrayReserve(journal->record_offsets.capacity * 2 + 64, journal->record_offsets);
+  }
+  journal->data.count = required;
+  ArrayAdd((uint32_t)offset, journal->record_offsets);
+
+  CommandHeader *header = (CommandHeader *)(journal->data.data + offset);
+  header->type = type;
+  header->is_continuation = is_continuation ? 1 : 0;
+  header->size = size;
+  journal->applied_count = journal->record_offsets.count;
+  journal->is_move_open = false;
+  journal->version++;
+  return (uint8_t *)(header + 1);
+}
+
+//NOTE(Torin) Drops whole commands from the front until the journal is at half of its budget,
+//the most recent command is always kept
+static void TrimCommandJournal(CommandJournal *journal){
+  if(journal->data.count <= COMMAND_JOURNAL_MAX_BYTES) return;
+  uint32_t recordCount = journal->record_offsets.count;
+  uint32_t lastCommand = recordCount - 1;
+  while(lastCommand > 0 && GetCommandRecord(journal, lastCommand)->is_continuation) lastCommand--;
+
+  uint32_t first = 1;
+  while(first < lastCommand){
+    bool isUnderBudget = journal->data.count - journal->record_offsets[first] <= COMMAND_JOURNAL_MAX_BYTES / 2;
+    if(isUnderBudget && !GetCommandRecord(journal, first)->is_continuation) break;
+    first++;
+  }
+  if(first > lastCommand) first = lastCommand;
+  if(first == 0) return;
+
+  uint32_t removedBytes = journal->record_offsets[first];
+  memmove(journal->data.data, journal->data.data + removedBytes, journal->data.count - removedBytes);
+  journal->data.count -= removedBytes;
+  for(uint32_t i = first; i < recordCount; i++){
+    journal->record_offsets[i - first] = journal->record_offsets[i] - removedBytes;
+  }
+  journal->record_offsets.count -= first;
+  journal->applied_count -= first;
+  journal->published_count = journal->published_count > first ? journal->published_count - first : 0;
+}
+
+static void PublishRecord(CommandJournal *journal, uint32_t record, bool is_undo){
+  if(!journal->is_publishing) return;
+  const CommandHeader *header = GetCommandRecord(journal, record);
+  size_t size = sizeof(PublishedRecord) + header->size;
+  size_t offset = journal->outbox.count;
+  if(offset + size > journal->outbox.capacity){
+    size_t capacity = journal->outbox.capacity * 2;
+    ArrayReserve(capacity > offset + size ? capacity : offset + size, journal->outbox);
+  }
+  journal->outbox.count += size;
+  PublishedRecord *published = (PublishedRecord *)(journal->outbox.data + offset);
+  published->is_undo = is_undo ? 1 : 0;
+  memcpy(&published->header, header, sizeof(CommandHeader) + header->size);
+}
+
+//NOTE(Torin) A MOVE that is still being dragged is published once it is closed
+static void PublishPendingRecords(CommandJournal *journal){
+  if(journal->is_move_open) return;
+  for(uint32_t i = journal->published_count; i < journal->applied_count; i++) PublishRecord(journal, i, false);
+  journal->published_count = journal->applied_count;
+}
+
+//NOTE(Torin) Called once a Command function has written all of its records
+static void FinishCommand(Editor *editor){
+  PublishPendingRecords(&editor->journal);
+  TrimCommandJournal(&editor->journal);
+}
+
+static void ConnectDescribed(const ConnectionDescription *connection, Editor *editor){
+  EditorNode *source = editor->nodeTable[connection->source_id];
+  EditorNode *dest = editor->nodeTable[connection->dest_id];
+  assert(source != nullptr && dest != nullptr);
+  ConnectNodes(source, connection->source_output, dest, connection->dest_input, editor);
+}
+
+static void DisconnectDescribed(const ConnectionDescription *connection, Editor *editor){
+  EditorNode *dest = editor->nodeTable[connection->dest_id];
+  assert(dest != nullptr);
+  assert(dest->inputConnections[connection->dest_input].node_index.node_ptr == editor->nodeTable[connection->source_id]);
+  DisconnectNodeInput(dest, connection->dest_input, editor);
+}
+
+static void CreateNodeSet(const uint8_t *payload, Editor *editor){
+  const NodeSetCounts *counts = (const NodeSetCounts *)payload;
+  const NodeDescription *nodes = (const NodeDescription *)(counts + 1);
+  const ConnectionDescription *connections = (const ConnectionDescription *)(nodes + counts->node_count);
+  const uint8_t *contents = (const uint8_t *)(connections + counts->connection_count);
+  ArrayReserve(editor->nodes.count + counts->node_count, editor->nodes);
+  it(i, counts->node_count){
+    EditorNode *node = CreateNodeFromDescription(&nodes[i], editor);
+    if(nodes[i].memory_size == 0) continue;
+    LoadMemoryContents(node->memory, contents, nodes[i].memory_size);
+    contents += nodes[i].memory_size;
+  }
+  it(i, counts->connection_count) ConnectDescribed(&connections[i], editor);
+}
+
+static void DeleteNodeSet(const uint8_t *payload, Editor *editor){
+  const NodeSetCounts *counts = (const NodeSetCounts *)payload;
+  const NodeDescription *nodes = (const NodeDescription *)(counts + 1);
+  DynamicArray<NodeIndex> indices = {};
+  ArrayReserve(counts->node_count, indices);
+  it(i, counts->node_count){
+    NodeIndex index = {};
+    index.node_index = nodes[i].id;
+    index.node_ptr = editor->nodeTable[nodes[i].id];
+    assert(index.node_ptr != nullptr);
+    ArrayAdd(index, indices);
+  }
+  DeleteNodes(indices.data, indices.count, editor);
+  ArrayDestroy(indices);
+}
+
+//NOTE(Torin) Records the nodes with every connection touching them, EditorNode::scratch_index
+//marks the members of the set
+static void RecordNodeSet(Editor *editor, CommandType type, const NodeIndex *indices, size_t count, bool is_continuation){
+  it(i, editor->nodes.count) editor->nodes[i]->scratch_index = 0;
+  it(i, count) GetNode(indices[i], editor)->scratch_index = 1;
+
+  size_t connectionCount = 0, memorySize = 0;
+  it(i, count){
+    EditorNode *node = GetNode(indices[i], editor);
+    if(node->memory != nullptr) memorySize += GetMemoryContentsSize(node->memory);
+    it(n, node->input_count) if(IsValid(node->inputConnections[n].node_index)) connectionCount++;
+    it(o, node->output_count){
+      DynamicArray<NodeConnection>& connections = node->output_connections[o];
+      it(c, connections.count) if(connections[c].node_index.node_ptr->scratch_index == 0) connectionCount++;
+    }
+  }
+
+  size_t size = sizeof(NodeSetCounts) + count * sizeof(NodeDescription) + connectionCount * sizeof(ConnectionDescription) + memorySize;
+  uint8_t *payload = AppendCommandRecord(editor, type, size, is_continuation);
+  NodeSetCounts *counts = (NodeSetCounts *)payload;
+  counts->node_count = count;
+  counts->connection_count = connectionCount;
+  NodeDescription *nodes = (NodeDescription *)(counts + 1);
+  ConnectionDescription *connection = (ConnectionDescription *)(nodes + count);
+  uint8_t *contents = (uint8_t *)(connection + connectionCount);
+  it(i, count){
+    EditorNode *node = GetNode(indices[i], editor);
+    nodes[i] = DescribeNode(node);
+    if(node->memory != nullptr){
+      uint8_t *end = SerializeMemoryContents(node->memory, contents);
+      nodes[i].memory_size = end - contents;
+      contents = end;
+    }
+    it(n, node->input_count){
+      const NodeConnection *input = &node->inputConnections[n];
+      if(IsValid(input->node_index) == false) continue;
+      *connection++ = { input->node_index.node_ptr->id, input->io_index, node->id, (uint32_t)n };
+    }
+    it(o, node->output_count){
+      DynamicArray<NodeConnection>& connections = node->output_connections[o];
+      it(c, connections.count){
+        EditorNode *dest = connections[c].node_index.node_ptr;
+        if(dest->scratch_index != 0) continue;
+        *connection++ = { node->id, (uint32_t)o, dest->id, connections[c].io_index };
+      }
+    }
+  }
+}
+
+static void SetNodeParameter(EditorNode *node, uint32_t parameter, uint32_t value, Editor *editor){
+  switch(parameter){
+    case NodeParameter_DELAY:{
+      node->delay = value;
+      editor->delayVersion++;
+    }break;
+    case NodeParameter_CLOCK_HALF_PERIOD:{
+      node->parameter = value;
+      InvalidateTopology(editor);
+    }break;
+    default: assert(false);
+  }
+}
+
+static uint32_t GetNodeParameter(const EditorNode *node, uint32_t parameter){
+  switch(parameter){
+    case NodeParameter_DELAY: return node->delay;
+    case NodeParameter_CLOCK_HALF_PERIOD: return node->parameter;
+  }
+  assert(false);
+  return 0;
+}
+
+static void DefineIC(const uint8_t *payload, size_t size, Editor *editor){
+  const DefineICCommand *define = (const DefineICCommand *)payload;
+  if(define->ic_index < editor->icdefs.count) return;
+  assert(define->ic_index == editor->icdefs.count);
+  ICDefinition *icdef = DeserializeICDefinition(payload + sizeof(DefineICCommand), size - sizeof(DefineICCommand));
+  assert(icdef != nullptr);
+  char name[IC_NAME_LENGTH];
+  memcpy(name, define->name, IC_NAME_LENGTH);
+  name[IC_NAME_LENGTH - 1] = 0;
+  RegisterICDefinition(icdef, name, false, editor);
+}
+
+static void RecordDefineIC(uint32_t ic_index, bool is_continuation, Editor *editor){
+  DynamicArray<uint8_t> definition = {};
+  SerializeICDefinition(editor->icdefs[ic_index], &definition);
+  SerializeICLayout(editor->icdefs[ic_index], &definition);
+  uint8_t *payload = AppendCommandRecord(editor, CommandType_DEFINE_IC, sizeof(DefineICCommand) + definition.count, is_continuation);
+  DefineICCommand *define = (DefineICCommand *)payload;
+  define->ic_index = ic_index;
+  memset(define->name, 0, IC_NAME_LENGTH);
+  strcpy(define->name, GetICName(ic_index, editor));
+  memcpy(define + 1, definition.data, definition.count);
+  ArrayDestroy(definition);
+}
+
+static void ApplyCommandRecord(const CommandHeader *header, bool is_undo, Editor *editor){
+  const uint8_t *payload = (const uint8_t *)(header + 1);
+  switch(header->type){
+    case CommandType_CREATE_NODES:
+    case CommandType_DELETE_NODES:{
+      if(is_undo == (header->type == CommandType_CREATE_NODES)) DeleteNodeSet(payload, editor);
+      else CreateNodeSet(payload, editor);
+    }break;
+
+    case CommandType_CONNECT:
+    case CommandType_DISCONNECT:{
+      const ConnectionDescription *connections = (const ConnectionDescription *)payload;
+      size_t count = header->size / sizeof(ConnectionDescription);
+      bool isConnect = is_undo == (header->type == CommandType_DISCONNECT);
+      it(i, count){
+        const ConnectionDescription *connection = &connections[is_undo ? count - 1 - i : i];
+        if(isConnect) ConnectDescribed(connection, editor);
+        else DisconnectDescribed(connection, editor);
+      }
+    }break;
+
+    case CommandType_MOVE:{
+      const MoveCommand *move = (const MoveCommand *)payload;
+      const uint32_t *ids = (const uint32_t *)(move + 1);
+      ImVec2 delta = is_undo ? ImVec2(-move->dx, -move->dy) : ImVec2(move->dx, move->dy);
+      it(i, move->node_count) editor->nodeTable[ids[i]]->position += delta;
+    }break;
+
+    case CommandType_SET_POSITIONS:{
+      const NodePosition *positions = (const NodePosition *)payload;
+      it(i, header->size / sizeof(NodePosition)){
+        const NodePosition *position = &positions[i];
+        editor->nodeTable[position->id]->position = is_undo ? ImVec2(position->old_x, position->old_y) : ImVec2(position->new_x, position->new_y);
+      }
+    }break;
+
+    case CommandType_SET_PARAMETER:{
+      const ParameterCommand *change = (const ParameterCommand *)payload;
+      SetNodeParameter(editor->nodeTable[change->id], change->parameter, is_undo ? change->old_value : change->new_value, editor);
+    }break;
+
+    case CommandType_DEFINE_IC:{
+      if(!is_undo) DefineIC(payload, header->size, editor);
+    }break;
+
+    case CommandType_RENAME_IC:{
+      const RenameICCommand *rename = (const RenameICCommand *)payload;
+      uint32_t entry_index = editor->library.entry_of_ic[rename->ic_index];
+      SetLibraryEntryName(&editor->library.entries[entry_index], is_undo ? rename->old_name : rename->new_name);
+    }break;
+
+    case CommandType_MOVE_IC_NODE:{
+      const MoveICNodeCommand *move = (const MoveICNodeCommand *)payload;
+      ICNode *icnode = &editor->icdefs[move->ic_index]->nodes[move->node_index];
+      icnode->x += is_undo ? -move->dx : move->dx;
+      icnode->y += is_undo ? -move->dy : move->dy;
+    }break;
+
+    case CommandType_SET_IC_NODE_TYPE:{
+      const ICNodeTypeCommand *change = (const ICNodeTypeCommand *)payload;
+      SetICNodeType(change->ic_index, change->node_index, is_undo ? change->old_type : change->new_type, editor);
+    }break;
+
+    case CommandType_SET_MEMORY:{
+      const MemoryCommand *change = (const MemoryCommand *)payload;
+      const uint8_t *contents = (const uint8_t *)(change + 1);
+      EditorNode *node = editor->nodeTable[change->id];
+      if(is_undo) LoadMemoryContents(node->memory, contents, change->old_size);
+      else LoadMemoryContents(node->memory, contents + change->old_size, change->new_size);
+    }break;
+
+    default: assert(false);
+  }
+}
+
+bool UndoCommand(Editor *editor){
+  CommandJournal *journal = &editor->journal;
+  journal->is_move_open = false;
+  PublishPendingRecords(journal);
+  if(journal->applied_count == 0) return false;
+  const CommandHeader *header = nullptr;
+  do {
+    journal->applied_count--;
+    header = GetCommandRecord(journal, journal->applied_count);
+    ApplyCommandRecord(header, true, editor);
+    PublishRecord(journal, journal->applied_count, true);
+  } while(header->is_continuation && journal->applied_count > 0);
+  journal->published_count = journal->applied_count;
+  journal->version++;
+  return true;
+}
+
+bool RedoCommand(Editor *editor){
+  CommandJournal *journal = &editor->journal;
+  journal->is_move_open = false;
+  PublishPendingRecords(journal);
+  if(journal->applied_count == journal->record_offsets.count) return false;
+  do {
+    ApplyCommandRecord(GetCommandRecord(journal, journal->applied_count), false, editor);
+    PublishRecord(journal, journal->applied_count, false);
+    journal->applied_count++;
+  } while(journal->applied_count < journal->record_offsets.count &&
+    GetCommandRecord(journal, journal->applied_count)->is_continuation);
+  journal->published_count = journal->applied_count;
+  journal->version++;
+  return true;
+}
+
+EditorNode *CommandCreateNode(uint32_t node_type, ImVec2 position, Editor *editor){
+  EditorNode *node = CreateNode(node_type, editor);
+  node->position = position;
+  uint8_t *payload = AppendCommandRecord(editor, CommandType_CREATE_NODES, sizeof(NodeSetCounts) + sizeof(NodeDescription), false);
+  NodeSetCounts *counts = (NodeSetCounts *)payload;
+  counts->node_count = 1;
+  counts->connection_count = 0;
+  *(NodeDescription *)(counts + 1) = DescribeNode(node);
+  FinishCommand(editor);
+  return node;
+}
+
+void CommandDeleteNodes(const NodeIndex *indices, size_t count, Editor *editor){
+  if(count == 0) return;
+  RecordNodeSet(editor, CommandType_DELETE_NODES, indices, count, false);
+  DeleteNodes(indices, count, editor);
+  FinishCommand(editor);
+}
+
+//NOTE(Torin) A connected input is disconnected first, both are undone together
+void CommandConnect(EditorNode *source, uint32_t output, EditorNode *dest, uint32_t input, Editor *editor){
+  bool isReplacing = false;
+  const NodeConnection *previous = &dest->inputConnections[input];
+  if(IsValid(previous->node_index)){
+    ConnectionDescription *removed = (ConnectionDescription *)AppendCommandRecord(editor, CommandType_DISCONNECT, sizeof(ConnectionDescription), false);
+    *removed = { previous->node_index.node_ptr->id, previous->io_index, dest->id, input };
+    DisconnectNodeInput(dest, input, editor);
+    isReplacing = true;
+  }
+  ConnectionDescription *added = (ConnectionDescription *)AppendCommandRecord(editor, CommandType_CONNECT, sizeof(ConnectionDescription), isReplacing);
+  *added = { source->id, output, dest->id, input };
+  ConnectNodes(source, output, dest, input, editor);
+  FinishCommand(editor);
+}
+
+void CommandDisconnectOutputs(EditorNode *node, Editor *editor){
+  size_t count = 0;
+  it(o, node->output_count) count += node->output_connections[o].count;
+  if(count == 0) return;
+  ConnectionDescription *connection = (ConnectionDescription *)AppendCommandRecord(editor, CommandType_DISCONNECT,
+    count * sizeof(ConnectionDescription), false);
+  it(o, node->output_count){
+    DynamicArray<NodeConnection>& connections = node->output_connections[o];
+    it(c, connections.count){
+      *connection++ = { node->id, (uint32_t)o, connections[c].node_index.node_ptr->id, connections[c].io_index };
+    }
+  }
+  RemoveNodeOutputConnections(node, editor);
+  FinishCommand(editor);
+}
+
+//NOTE(Torin) Consecutive calls extend the same record until EndMoveCommand
+void CommandMoveSelection(ImVec2 delta, Editor *editor){
+  CommandJournal *journal = &editor->journal;
+  MoveSelectedNodes(delta, editor);
+  if(journal->is_move_open){
+    MoveCommand *move = (MoveCommand *)(journal->data.data + journal->record_offsets[journal->applied_count - 1] + sizeof(CommandHeader));
+    move->dx += delta.x;
+    move->dy += delta.y;
+    return;
+  }
+
+  size_t count = editor->selectedNodes.count;
+  if(count == 0) return;
+  uint8_t *payload = AppendCommandRecord(editor, CommandType_MOVE, sizeof(MoveCommand) + count * sizeof(uint32_t), false);
+  MoveCommand *move = (MoveCommand *)payload;
+  move->dx = delta.x;
+  move->dy = delta.y;
+  move->node_count = count;
+  uint32_t *ids = (uint32_t *)(move + 1);
+  it(i, count) ids[i] = editor->selectedNodes[i].node_ptr->id;
+  journal->is_move_open = true;
+  FinishCommand(editor);
+}
+
+//NOTE(Torin) Like CommandMoveSelection for a node inside an IC
+void CommandMoveICNode(uint32_t ic_index, uint32_t node_index, ImVec2 delta, Editor *editor){
+  CommandJournal *journal = &editor->journal;
+  ICNode *icnode = &editor->icdefs[ic_index]->nodes[node_index];
+  icnode->x += delta.x;
+  icnode->y += delta.y;
+  if(journal->is_move_open){
+    const CommandHeader *header = GetCommandRecord(journal, journal->applied_count - 1);
+    MoveICNodeCommand *move = (MoveICNodeCommand *)(header + 1);
+    if(header->type == CommandType_MOVE_IC_NODE && move->ic_index == ic_index && move->node_index == node_index){
+      move->dx += delta.x;
+      move->dy += delta.y;
+      return;
+    }
+  }
+
+  MoveICNodeCommand *move = (MoveICNodeCommand *)AppendCommandRecord(editor, CommandType_MOVE_IC_NODE, sizeof(MoveICNodeCommand), false);
+  *move = { ic_index, node_index, delta.x, delta.y };
+  journal->is_move_open = true;
+  FinishCommand(editor);
+}
+
+static inline
+void EndMoveCommand(Editor *editor){
+  editor->journal.is_move_open = false;
+  PublishPendingRecords(&editor->journal);
+}
+
+//NOTE(Torin) Moves every node to its own new position, the old ones are read from the nodes
+void CommandSetNodePositions(const NodePosition *positions, size_t count, Editor *editor){
+  if(count == 0) return;
+  NodePosition *recorded = (NodePosition *)AppendCommandRecord(editor, CommandType_SET_POSITIONS, count * sizeof(NodePosition), false);
+  it(i, count){
+    EditorNode *node = editor->nodeTable[positions[i].id];
+    recorded[i] = positions[i];
+    recorded[i].old_x = node->position.x;
+    recorded[i].old_y = node->position.y;
+    node->position = ImVec2(positions[i].new_x, positions[i].new_y);
+  }
+  FinishCommand(editor);
+}
+
+//NOTE(Torin) Recorded with the contents before and after, false when the image could not be
+//loaded
+bool CommandLoadMemoryImage(EditorNode *node, const char *filename, Editor *editor){
+  size_t oldSize = GetMemoryContentsSize(node->memory);
+  uint8_t *old = (uint8_t *)malloc(oldSize);
+  SerializeMemoryContents(node->memory, old);
+  bool result = LoadMemoryImage(node->memory, filename);
+  if(result){
+    size_t newSize = GetMemoryContentsSize(node->memory);
+    uint8_t *payload = AppendCommandRecord(editor, CommandType_SET_MEMORY, sizeof(MemoryCommand) + oldSize + newSize, false);
+    MemoryCommand *change = (MemoryCommand *)payload;
+    *change = { node->id, (uint32_t)oldSize, (uint32_t)newSize, 0 };
+    memcpy(change + 1, old, oldSize);
+    SerializeMemoryContents(node->memory, payload + sizeof(MemoryCommand) + oldSize);
+    FinishCommand(editor);
+  }
+  free(old);
+  return result;
+}
+
+void CommandSetNodeParameter(EditorNode *node, NodeParameter parameter, uint32_t value, Editor *editor){
+  uint32_t old_value = GetNodeParameter(node, parameter);
+  if(old_value == value) return;
+  ParameterCommand *change = (ParameterCommand *)AppendCommandRecord(editor, CommandType_SET_PARAMETER, sizeof(ParameterCommand), false);
+  *change = { node->id, (uint32_t)parameter, old_value, value };
+  SetNodeParameter(node, parameter, value, editor);
+  FinishCommand(editor);
+}
+
+//NOTE(Torin) Recorded as deleting the packed nodes, defining the IC unless an identical one
+//exists and creating the instance, the ICDefinition itself is kept when the command is undone
+EditorNode *CommandCreateIC(const NodeIndex *indices, size_t count, Editor *editor){
+  RecordNodeSet(editor, CommandType_DELETE_NODES, indices, count, false);
+  size_t icCount = editor->icdefs.count;
+  EditorNode *node = CreateICFromNodes(indices, count, editor);
+  if(editor->icdefs.count > icCount) RecordDefineIC(icCount, true, editor);
+  uint8_t *payload = AppendCommandRecord(editor, CommandType_CREATE_NODES, sizeof(NodeSetCounts) + sizeof(NodeDescription), true);
+  NodeSetCounts *counts = (NodeSetCounts *)payload;
+  counts->node_count = 1;
+  counts->connection_count = 0;
+  *(NodeDescription *)(counts + 1) = DescribeNode(node);
+  FinishCommand(editor);
+  return node;
+}
+
+//NOTE(Torin) Loads the library entry on first use, the definition is recorded with the
+//instance so replaying the journal does not need the library file
+EditorNode *CommandCreateLibraryIC(uint32_t entry_index, ImVec2 position, Editor *editor){
+  size_t icCount = editor->icdefs.count;
+  uint32_t ic_index = LoadLibraryIC(entry_index, editor);
+  if(ic_index == IC_LIBRARY_NONE) return nullptr;
+  bool isDefined = editor->icdefs.count > icCount;
+  if(isDefined) RecordDefineIC(ic_index, false, editor);
+  EditorNode *node = CreateNode(NodeType_COUNT + 1 + ic_index, editor);
+  node->position = position;
+  uint8_t *payload = AppendCommandRecord(editor, CommandType_CREATE_NODES, sizeof(NodeSetCounts) + sizeof(NodeDescription), isDefined);
+  NodeSetCounts *counts = (NodeSetCounts *)payload;
+  counts->node_count = 1;
+  counts->connection_count = 0;
+  *(NodeDescription *)(counts + 1) = DescribeNode(node);
+  FinishCommand(editor);
+  return node;
+}
+
+void CommandSetICNodeType(uint32_t ic_index, uint32_t node_index, uint32_t type, Editor *editor){
+  uint32_t old_type = editor->icdefs[ic_index]->nodes[node_index].type;
+  if(old_type == type) return;
+  ICNodeTypeCommand *change = (ICNodeTypeCommand *)AppendCommandRecord(editor, CommandType_SET_IC_NODE_TYPE, sizeof(ICNodeTypeCommand), false);
+  *change = { ic_index, node_index, old_type, type };
+  SetICNodeType(ic_index, node_index, type, editor);
+  FinishCommand(editor);
+}
+
+void CommandRenameIC(uint32_t ic_index, const char *name, Editor *editor){
+  uint32_t entry_index = editor->library.entry_of_ic[ic_index];
+  ICLibraryEntry *entry = &editor->library.entries[entry_index];
+  if(strncmp(entry->name, name, IC_NAME_LENGTH - 1) == 0) return;
+  RenameICCommand *rename = (RenameICCommand *)AppendCommandRecord(editor, CommandType_RENAME_IC, sizeof(RenameICCommand), false);
+  *rename = {};
+  rename->ic_index = ic_index;
+  memcpy(rename->old_name, entry->name, IC_NAME_LENGTH);
+  strncpy(rename->new_name, name, IC_NAME_LENGTH - 1);
+  SetLibraryEntryName(entry, rename->new_name);
+  FinishCommand(editor);
+}
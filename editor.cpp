@@ -1,9 +1,133 @@
 struct Toolbar {
-  uint32_t nodeTypes[10];
-  uint32_t hotkey[10]; 
+  uint32_t nodeTypes[12];
+  uint32_t hotkey[12]; 
   size_t count;
 };
 
+enum SimulationMode {
+  SimulationMode_EVENT,
+  SimulationMode_NETLIST,
+  SimulationMode_TIMING,
+};
+
+struct Netlist;
+struct VectorRunner;
+struct FaultSimulation;
+struct EquivalenceCheck;
+struct Autosave;
+
+struct NodeWorklist {
+  EditorNode **nodes;
+  size_t capacity;
+  size_t head;
+  size_t count;
+};
+
+//NOTE(Torin) Strongly connected components of the node graph in topological order,
+//see schedule.cpp
+struct NodeComponent {
+  uint32_t first;  //index into NodeSchedule::order
+  uint32_t count;
+  bool is_cyclic;
+  bool is_oscillating;
+};
+
+struct NodeSchedule {
+  uint64_t topology_version;
+  bool is_valid;
+  DynamicArray<EditorNode *> order;
+  DynamicArray<NodeComponent> components;
+  uint32_t cyclic_count;
+  uint32_t oscillating_count;
+  uint32_t active_component;
+};
+
+//NOTE(Torin) Hierarchical timing wheel of the gate delay simulator, see timing.cpp
+#define TIMING_WHEEL_BITS 6
+#define TIMING_WHEEL_SLOTS (1 << TIMING_WHEEL_BITS)
+#define TIMING_WHEEL_LEVELS 4
+#define TIMING_WHEEL_OVERFLOW (TIMING_WHEEL_LEVELS * TIMING_WHEEL_SLOTS)
+#define TIMING_EVENT_NONE UINT32_MAX
+
+struct TimingEvent {
+  uint64_t time;
+  uint64_t value;
+  EditorNode *node;
+  uint32_t output_index;
+  NodeState state;
+  uint16_t list;   //wheel slot the event is linked into
+  uint32_t next;
+  uint32_t prev;
+};
+
+struct TimingWheel {
+  uint64_t now;
+  uint32_t heads[TIMING_WHEEL_OVERFLOW + 1];
+  uint64_t occupied[TIMING_WHEEL_LEVELS];
+  DynamicArray<TimingEvent> events;
+  uint32_t free_list;
+  uint32_t event_count;
+};
+
+struct TimingSimulation {
+  uint64_t topology_version;
+  bool is_valid;
+  uint64_t time;
+
+  TimingWheel wheel;
+  //NOTE(Torin) Indexed by EditorNode::timing_index
+  DynamicArray<uint32_t> output_base;
+  DynamicArray<uint8_t> is_dirty;
+  DynamicArray<EditorNode *> dirty;
+  //NOTE(Torin) Indexed by output_base + output index
+  DynamicArray<uint32_t> pending_event;     //last scheduled event that has not been applied
+  DynamicArray<NodeState> projected_state;  //value the output will have once all its events are applied
+  DynamicArray<uint64_t> projected_value;
+
+  uint64_t events_processed;
+  uint64_t last_step_events;
+  double last_step_milliseconds;
+};
+
+//NOTE(Torin) Static timing analysis results, see timing_analysis.cpp
+#define TIMING_ARRIVAL_NONE UINT32_MAX
+
+struct TimingPathNode {
+  EditorNode *node;
+  uint32_t input_index;   //input the path enters through, TIMING_ARRIVAL_NONE at the start point
+  uint32_t output_index;  //output the path leaves through, TIMING_ARRIVAL_NONE at the endpoint
+  uint32_t arrival;       //arrival time at output_index, or at the endpoint input
+};
+
+struct TimingPath {
+  uint32_t arrival;
+  uint32_t depth;
+  uint32_t first;  //index into TimingAnalysis::path_nodes
+  uint32_t count;
+};
+
+struct TimingAnalysis {
+  uint64_t topology_version;
+  uint64_t delay_version;
+  bool is_valid;
+
+  //NOTE(Torin) Indexed by output_base[EditorNode::analysis_index] + output index
+  DynamicArray<uint32_t> output_base;
+  DynamicArray<uint32_t> arrival;
+  DynamicArray<uint32_t> depth;
+  DynamicArray<uint32_t> critical_input;
+  //NOTE(Torin) Longest input to output delay and its depth of every ICDefinition,
+  //ic_offset[ic] indexes input_count * output_count entries
+  DynamicArray<uint32_t> ic_offset;
+  DynamicArray<uint32_t> ic_delay;
+  DynamicArray<uint32_t> ic_depth;
+
+  DynamicArray<TimingPath> paths;  //worst first
+  DynamicArray<TimingPathNode> path_nodes;
+  uint32_t endpoint_count;
+  uint32_t untimed_count;          //nodes on or behind a combinational loop
+};
+
 enum EditorMode {
   EditorMode_None,
   EditorMode_SelectBox,
@@ -11,13 +135,204 @@ enum EditorMode {
   EditorMode_PLACEMENT,
 };
 
+//NOTE(Torin) Append only log of the edits made to the design, see commands.cpp
+struct CommandJournal {
+  DynamicArray<uint8_t> data;              //CommandHeader followed by its payload, per record
+  DynamicArray<uint32_t> record_offsets;   //offset of every record in data
+  uint32_t applied_count;                  //records before this are applied, the rest can be redone
+  bool is_move_open;                       //the last record is a MOVE still being dragged
+  uint64_t version;                        //incremented whenever a record is applied, undone or redone
+
+  //NOTE(Torin) When is_publishing every record applied, undone or redone is also copied to
+  //outbox as a PublishedRecord for listeners such as the autosave, published_count records
+  //are already in the outbox
+  bool is_publishing;
+  uint32_t published_count;
+  DynamicArray<uint8_t> outbox;
+};
+
+#define IC_NAME_LENGTH 32
+#define IC_LIBRARY_NONE UINT32_MAX
+
+//NOTE(Torin) An IC known to the editor, made in this session or listed by an open library
+//file, see ic_library.cpp
+struct ICLibraryEntry {
+  char name[IC_NAME_LENGTH];
+  uint64_t hash;          //of the canonical serialized definition
+  uint32_t input_count;
+  uint32_t output_count;
+  uint32_t ic_index;      //into Editor::icdefs, IC_LIBRARY_NONE until first instantiated
+  uint32_t file_index;    //into ICLibrary::files, IC_LIBRARY_NONE when made in this session
+  uint64_t offset;        //of the serialized definition in the file
+  uint32_t size;          //of the serialized definition
+  uint32_t layout_size;   //of the layout that follows it
+};
+
+struct ICLibraryFile {
+  char path[256];
+  int fd;
+};
+
+struct ICLibrary {
+  DynamicArray<ICLibraryEntry> entries;
+  DynamicArray<uint32_t> entry_of_ic;  //indexed like Editor::icdefs
+  DynamicArray<uint32_t> hash_table;   //open addressing on the content hash, entry index + 1, 0 when empty
+  DynamicArray<ICLibraryFile> files;
+  const char *error;
+
+  //NOTE(Torin) Settings of the IC Library window
+  char path[256];
+  char filter[IC_NAME_LENGTH];
+};
+
+//NOTE(Torin) See canvas.cpp
+struct Camera {
+  double x, y;  //world position at the top left of the canvas
+  float zoom;   //pixels per world unit, 0 until the canvas is first drawn
+};
+
+//NOTE(Torin) Orthogonal wire routing, see router.cpp
+struct RouterCellRect {
+  int32_t min_x, min_y, max_x, max_y;  //inclusive
+};
+
+//NOTE(Torin) Cells a node left or entered this frame, routes passing next to vacated cells
+//may have a shorter path now, routes crossing entered ones are blocked
+struct RouterChange {
+  RouterCellRect cells;
+  bool is_vacated;
+};
+
+struct RouterNode {
+  RouterCellRect cells;  //marked in the obstacle map
+  bool is_placed;
+};
+
+#define ROUTER_CHUNK_BITS 4
+#define ROUTER_CHUNK_SIZE (1 << ROUTER_CHUNK_BITS)
+
+//NOTE(Torin) A square of cells, kept once any node covered part of it
+struct ObstacleChunk {
+  int32_t x, y;  //in chunks
+  uint32_t is_used;
+  uint16_t counts[ROUTER_CHUNK_SIZE * ROUTER_CHUNK_SIZE];  //nodes covering each cell
+};
+
+struct WireRoute {
+  uint32_t dest_id;
+  uint32_t input_index;
+  uint32_t source_id;
+  uint32_t output_index;
+  int32_t start_x, start_y, end_x, end_y;  //cells the route was searched between
+  RouterCellRect bounds;
+  bool is_dirty;          //crossed by a node that moved since it was routed
+  bool is_blocked;        //no path was found, the route is a plain three segment wire
+  DynamicArray<ImVec2> points;  //centers of the first, last and every turning cell
+};
+
+struct RouterSearchNode {
+  int32_t x, y;
+  float cost;
+  uint32_t parent;  //UINT32_MAX for the start
+  uint32_t slot;    //in WireRouter::search_table
+  uint8_t direction;
+  bool is_closed;
+};
+
+struct RouterHeapItem {
+  float estimate;
+  float cost;
+  uint32_t node;
+};
+
+struct WireRouter {
+  DynamicArray<RouterNode> nodes;        //indexed by EditorNode::id
+  DynamicArray<ObstacleChunk> chunks;    //open addressing on the chunk
+  size_t chunk_count;
+  const ObstacleChunk *cached_chunk;     //last chunk looked up, nullptr when there is none
+  int32_t cached_x, cached_y;
+  bool is_cache_valid;
+  DynamicArray<WireRoute> routes;
+  DynamicArray<uint32_t> route_table;    //open addressing on the input slot, route index + 1, 0 when empty
+  DynamicArray<RouterChange> changed;
+  int64_t frame_budget;                  //search steps left this frame
+
+  DynamicArray<RouterSearchNode> search_nodes;
+  DynamicArray<uint32_t> search_table;   //search node index + 1, cleared after every search
+  DynamicArray<RouterHeapItem> search_heap;
+};
+
+//NOTE(Torin) The IC instance opened in the canvas, see ic_view.cpp
+struct ICView {
+  bool is_open;
+  uint32_t instance_id;  //EditorNode::id of the instance
+  uint32_t ic_index;
+  Camera camera;
+  uint32_t menu_node;    //ICNode the gate menu was opened on
+
+  //NOTE(Torin) Evaluated for inputs with the definition at topology_version
+  DynamicArray<NodeState> values;  //output of every ICNode
+  DynamicArray<NodeState> inputs;
+  uint64_t topology_version;
+  bool is_oscillating;
+};
+
 struct Editor {
   DynamicArray<EditorNode *> inputs;
+  DynamicArray<EditorNode *> sequentialNodes;  //DFF, REGISTER and CLOCK nodes
   DynamicArray<EditorNode *> nodes;
+  DynamicArray<EditorNode *> nodeTable;  //indexed by EditorNode::id, nullptr once deleted
   DynamicArray<NodeIndex> selectedNodes;
   DynamicArray<ICDefinition *> icdefs;
+  ICLibrary library;
+
+  SimulationStats stats;
+  NodeWorklist worklist;
+  NodeSchedule schedule;
+  int loopIterationLimit;  //evaluations per node of a feedback loop before it is reported as oscillating
+  SimulationMode simulationMode;
+  TimingSimulation timing;
+  int timingTickLength;    //time units per clock tick / SimulationStep in timing mode
+  bool timingInertial;     //pulses shorter than a gate delay are swallowed instead of propagated
+  TimingAnalysis timingAnalysis;
+  int timingPathCount;     //critical paths reported by the static timing analysis
+  int selectedTimingPath;  //highlighted in the editor, -1 for none
+  bool useCompiledICs;
+  bool optimizeNetlist;
+  bool foldStableInputs;
 
-  ImVec2 viewPosition;
+  //NOTE(Torin) Incremented on every structural change, derived data such as the
+  //flattened netlist is rebuilt when it no longer matches
+  uint64_t topologyVersion;
+  uint64_t delayVersion;  //incremented when the delay of a node changes
+  Netlist *netlist;
+  VectorRunner *vectors;  //created the first time the test vector window is opened
+  FaultSimulation *faults;
+  EquivalenceCheck *equivalence;
+  CommandJournal journal;
+  DynamicArray<uint8_t> clipboard;  //last copied selection, see clipboard.cpp
+  Autosave *autosave;
+  ICView icView;
+
+  //NOTE(Torin) Sequential nodes latch on rising clock edges once per tick, CLOCK nodes
+  //derive their output from clockTick which advances every step while the clock runs
+  uint64_t clockTick;
+  bool clockRunning;
+  int registerWidth;
+  int clockHalfPeriod;
+  int gateInputCount;
+  int busWidth;
+  int portWidth;       //width of new INPUT and OUTPUT nodes
+  bool busRegisters;   //new REGISTER nodes have a single bus D input
+  int memoryAddressWidth;
+  int memoryDataWidth;
+  int cycleRunCount;
+  uint64_t lastRunCycles;
+  double lastRunMilliseconds;
+
+  Camera camera;
+  bool useWireRouting;
+  WireRouter router;
 
   Toolbar toolbar;
   EditorMode mode;
@@ -26,6 +341,11 @@ struct Editor {
   ImVec2 selectBoxOrigin;
 };
 
+static inline
+void InvalidateTopology(Editor *editor){
+  editor->topologyVersion++;
+}
+
 void DrawToolbarVerticaly(Toolbar *t, Editor *e){
   const uint8_t *keystate = SDL_GetKeyboardState(NULL);
 
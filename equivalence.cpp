@@ -0,0 +1,301 @@
+//NOTE(Torin) Combinational equivalence checking of two IC definitions
+//Both definitions are flattened into one netlist sharing the input nets (a miter), the
+//outputs are then compared in three stages:
+//  1. random vectors on 64 bit lanes find most differences in microseconds
+//  2. with few inputs every vector is simulated, which is a proof
+//  3. otherwise the miter is Tseitin encoded and the embedded SAT solver decides whether
+//     any input makes an output pair differ, a model is a distinguishing vector
+//Nets fed by an undriven gate input are NONE for every input vector, those are found by
+//the simulation and compared structurally (NONE equals NONE) instead of being encoded
+
+#define EQUIVALENCE_RANDOM_BLOCKS 256
+#define EQUIVALENCE_EXHAUSTIVE_INPUTS 20
+#define EQUIVALENCE_CONFLICT_LIMIT 2000000
+
+enum EquivalenceStatus {
+  EquivalenceStatus_EQUIVALENT,
+  EquivalenceStatus_DIFFERENT,
+  EquivalenceStatus_UNKNOWN,   //SAT conflict limit reached
+  EquivalenceStatus_ERROR,
+};
+
+enum EquivalenceMethod {
+  EquivalenceMethod_RANDOM,
+  EquivalenceMethod_EXHAUSTIVE,
+  EquivalenceMethod_SAT,
+};
+
+static const char *EquivalenceMethodName[] = {
+  "random simulation",
+  "exhaustive simulation",
+  "SAT",
+};
+
+struct EquivalenceCheck {
+  //NOTE(Torin) Settings of the Simulation window, indices into Editor::icdefs
+  int ic_a;
+  int ic_b;
+
+  EquivalenceStatus status;
+  EquivalenceMethod method;
+  DynamicArray<uint8_t> counterexample;  //one entry per input when DIFFERENT
+  uint32_t output_index;                 //first output that differs
+  NodeState output_a;
+  NodeState output_b;
+  uint32_t sat_variables;
+  uint32_t sat_clauses;
+  uint64_t sat_conflicts;
+  double milliseconds;
+  const char *error;
+};
+
+//NOTE(Torin) The ICNodes of icdef become gates after the shared input nets, returns the
+//net of the first ICNode
+static uint32_t AddMiterIC(Netlist *netlist, const ICDefinition *icdef){
+  uint32_t base = netlist->gates.count;
+  it(i, icdef->node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    if(icnode->type == NodeType_INPUT){
+      uint32_t gate = AddNetlistGate(netlist, NetType_BUF, 1);
+      GetFanins(netlist, gate)[0] = netlist->inputs[i];
+    } else if(icnode->type == NodeType_OUTPUT){
+      AddNetlistGate(netlist, NetType_BUF, 1);
+    } else {
+      AddNetlistGate(netlist, GetNetTypeForNode(icnode->type), icnode->input_count);
+    }
+  }
+  it(i, icdef->node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    uint32_t connection_count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+    it(n, connection_count){
+      const ICNodeConnection *connection = &icnode->output_connections[n];
+      GetFanins(netlist, base + connection->node_index)[connection->io_index] = base + i;
+    }
+  }
+  return base;
+}
+
+static inline
+NodeState GetLaneState(const uint64_t *values, const uint64_t *known, uint32_t net, uint32_t lane){
+  if(!((known[net] >> lane) & 1)) return NodeState_NONE;
+  return ((values[net] >> lane) & 1) ? NodeState_HIGH : NodeState_LOW;
+}
+
+//NOTE(Torin) Records the first lane of the block in which an output pair differs
+static bool FindMiterDifference(EquivalenceCheck *check, const Netlist *netlist, const uint64_t *values,
+  const uint64_t *known, const uint32_t *outputs_a, const uint32_t *outputs_b, uint32_t output_count, uint64_t lane_mask){
+  uint64_t firstLane = 0;
+  uint32_t firstOutput = 0;
+  it(o, output_count){
+    uint32_t a = outputs_a[o], b = outputs_b[o];
+    uint64_t difference = (((values[a] ^ values[b]) & known[a] & known[b]) | (known[a] ^ known[b])) & lane_mask;
+    if(difference == 0) continue;
+    uint64_t lowest = difference & (~difference + 1);
+    if(firstLane == 0 || lowest < firstLane){
+      firstLane = lowest;
+      firstOutput = o;
+    }
+  }
+  if(firstLane == 0) return false;
+
+  uint32_t lane = __builtin_ctzll(firstLane);
+  check->status = EquivalenceStatus_DIFFERENT;
+  check->output_index = firstOutput;
+  check->output_a = GetLaneState(values, known, outputs_a[firstOutput], lane);
+  check->output_b = GetLaneState(values, known, outputs_b[firstOutput], lane);
+  check->counterexample.count = 0;
+  it(i, netlist->inputs.count) ArrayAdd((uint8_t)((values[netlist->inputs.data[i]] >> lane) & 1), check->counterexample);
+  return true;
+}
+
+//NOTE(Torin) Literal of every known net, inverted gates are the negation of the
+//non inverted function so every gate costs one variable plus its XOR chain
+static bool EncodeMiter(SatSolver *solver, const Netlist *netlist, const uint64_t *known,
+  const uint32_t *outputs_a, const uint32_t *outputs_b, uint32_t output_count, uint32_t *literals){
+  uint32_t constant = AddSatVariable(solver);
+  uint32_t trueLiteral = SatLiteral(constant, false);
+  AddSatClause(solver, &trueLiteral, 1);
+  literals[NET_CONST0] = trueLiteral ^ 1;
+  literals[NET_CONST1] = trueLiteral;
+  //NOTE(Torin) NONE nets only feed other NONE nets, they read as the constant 0 so no
+  //literal is left undefined
+  literals[NET_UNDRIVEN] = literals[NET_CONST0];
+  it(i, netlist->inputs.count) literals[netlist->inputs.data[i]] = SatLiteral(AddSatVariable(solver), false);
+
+  DynamicArray<uint32_t> clause = {};
+  const uint32_t *fanins = netlist->fanins.data;
+  it(i, netlist->order.count){
+    uint32_t g = netlist->order.data[i];
+    if(known[g] == 0){
+      literals[g] = literals[NET_UNDRIVEN];
+      continue;
+    }
+    const NetlistGate *gate = &netlist->gates.data[g];
+    const uint32_t *gateFanins = fanins + gate->fanin_offset;
+    switch(gate->type){
+      case NetType_BUF: literals[g] = literals[gateFanins[0]]; break;
+      case NetType_NOT: literals[g] = literals[gateFanins[0]] ^ 1; break;
+      case NetType_AND:
+      case NetType_NAND:
+      case NetType_OR:
+      case NetType_NOR:{
+        //NOTE(Torin) OR is an AND of the negated fanins, negated
+        uint32_t invert = (gate->type == NetType_OR || gate->type == NetType_NOR) ? 1 : 0;
+        uint32_t result = SatLiteral(AddSatVariable(solver), false);
+        clause.count = 0;
+        ArrayAdd(result, clause);
+        it(n, gate->fanin_count){
+          uint32_t fanin = literals[gateFanins[n]] ^ invert;
+          uint32_t binary[2] = { result ^ 1, fanin };
+          AddSatClause(solver, binary, 2);
+          ArrayAdd(fanin ^ 1, clause);
+        }
+        AddSatClause(solver, clause.data, clause.count);
+        literals[g] = result ^ invert;
+        if(gate->type == NetType_NAND || gate->type == NetType_NOR) literals[g] ^= 1;
+      }break;
+      case NetType_XOR:
+      case NetType_XNOR:{
+        uint32_t result = literals[gateFanins[0]];
+        for(uint32_t n = 1; n < gate->fanin_count; n++){
+          uint32_t a = result, b = literals[gateFanins[n]];
+          result = SatLiteral(AddSatVariable(solver), false);
+          uint32_t clauses[4][3] = {
+            { result ^ 1, a, b }, { result ^ 1, a ^ 1, b ^ 1 },
+            { result, a ^ 1, b }, { result, a, b ^ 1 },
+          };
+          it(c, 4) AddSatClause(solver, clauses[c], 3);
+        }
+        literals[g] = gate->type == NetType_XNOR ? result ^ 1 : result;
+      }break;
+      default: assert(false);
+    }
+  }
+
+  //NOTE(Torin) At least one output pair differs, pairs that are NONE on both sides or
+  //share a literal never do and are left out
+  clause.count = 0;
+  it(o, output_count){
+    if(known[outputs_a[o]] == 0 && known[outputs_b[o]] == 0) continue;
+    uint32_t a = literals[outputs_a[o]], b = literals[outputs_b[o]];
+    if(a == b) continue;
+    uint32_t difference = SatLiteral(AddSatVariable(solver), false);
+    uint32_t clauses[4][3] = {
+      { difference ^ 1, a, b }, { difference ^ 1, a ^ 1, b ^ 1 },
+      { difference, a ^ 1, b }, { difference, a, b ^ 1 },
+    };
+    it(c, 4) AddSatClause(solver, clauses[c], 3);
+    ArrayAdd(difference, clause);
+  }
+  bool result = AddSatClause(solver, clause.data, clause.count);
+  ArrayDestroy(clause);
+  return result;
+}
+
+bool CheckEquivalence(EquivalenceCheck *check, const ICDefinition *a, const ICDefinition *b){
+  PROFILE_SCOPE("CheckEquivalence");
+  uint64_t beginTicks = ProfilerTimestamp();
+  check->status = EquivalenceStatus_ERROR;
+  check->method = EquivalenceMethod_RANDOM;
+  check->error = nullptr;
+  check->counterexample.count = 0;
+  check->sat_variables = check->sat_clauses = 0;
+  check->sat_conflicts = 0;
+  if(a->input_count != b->input_count || a->output_count != b->output_count){
+    check->error = "the definitions have different numbers of inputs or outputs";
+    return false;
+  }
+
+  Netlist netlist = {};
+  AddNetlistGate(&netlist, NetType_UNDRIVEN, 0);
+  AddNetlistGate(&netlist, NetType_CONST0, 0);
+  AddNetlistGate(&netlist, NetType_CONST1, 0);
+  it(i, a->input_count) ArrayAdd(AddNetlistGate(&netlist, NetType_INPUT, 0), netlist.inputs);
+  uint32_t baseA = AddMiterIC(&netlist, a);
+  uint32_t baseB = AddMiterIC(&netlist, b);
+  if(!LevelizeNetlist(&netlist)){
+    check->error = "an IC definition contains a loop";
+    DestroyNetlist(&netlist);
+    return false;
+  }
+
+  uint32_t output_count = a->output_count;
+  uint32_t gate_count = netlist.gates.count;
+  uint32_t *outputsA = (uint32_t *)malloc(sizeof(uint32_t) * (output_count + 1));
+  uint32_t *outputsB = (uint32_t *)malloc(sizeof(uint32_t) * (output_count + 1));
+  it(o, output_count){
+    outputsA[o] = baseA + a->input_count + o;
+    outputsB[o] = baseB + b->input_count + o;
+  }
+  uint64_t *values = (uint64_t *)malloc(sizeof(uint64_t) * gate_count);
+  uint64_t *known = (uint64_t *)malloc(sizeof(uint64_t) * gate_count);
+  SetLaneState(values, known, NET_UNDRIVEN, NodeState_NONE);
+  SetLaneState(values, known, NET_CONST0, NodeState_LOW);
+  SetLaneState(values, known, NET_CONST1, NodeState_HIGH);
+  it(i, netlist.inputs.count) known[netlist.inputs[i]] = ~0ULL;
+
+  bool isExhaustive = a->input_count <= EQUIVALENCE_EXHAUSTIVE_INPUTS;
+  uint64_t blockCount = EQUIVALENCE_RANDOM_BLOCKS;
+  if(isExhaustive){
+    uint64_t vectorCount = 1ULL << a->input_count;
+    blockCount = (vectorCount + VECTOR_LANES - 1) / VECTOR_LANES;
+    check->method = EquivalenceMethod_EXHAUSTIVE;
+  }
+
+  bool isDifferent = false;
+  uint64_t randomState = 0x9E3779B97F4A7C15ULL;
+  for(uint64_t block = 0; block < blockCount && !isDifferent; block++){
+    uint64_t laneMask = ~0ULL;
+    it(i, netlist.inputs.count){
+      uint32_t net = netlist.inputs[i];
+      if(isExhaustive){
+        values[net] = i < 6 ? EXHAUSTIVE_LANE_PATTERN[i] : ((((block * VECTOR_LANES) >> i) & 1) ? ~0ULL : 0);
+      } else {
+        values[net] = NextVectorRandom(&randomState);
+      }
+    }
+    if(isExhaustive && a->input_count < 6) laneMask = (1ULL << (1ULL << a->input_count)) - 1;
+    EvaluateNetlistLanes(&netlist, values, known);
+    isDifferent = FindMiterDifference(check, &netlist, values, known, outputsA, outputsB, output_count, laneMask);
+  }
+
+  if(!isDifferent && isExhaustive){
+    check->status = EquivalenceStatus_EQUIVALENT;
+  } else if(!isDifferent){
+    //NOTE(Torin) known is the same in every lane of the last block, NONE nets are structural
+    check->method = EquivalenceMethod_SAT;
+    SatSolver solver = {};
+    uint32_t *literals = (uint32_t *)malloc(sizeof(uint32_t) * gate_count);
+    EncodeMiter(&solver, &netlist, known, outputsA, outputsB, output_count, literals);
+    SatResult result = SolveSat(&solver, EQUIVALENCE_CONFLICT_LIMIT);
+    check->sat_variables = solver.var_count;
+    check->sat_conflicts = solver.conflicts;
+    check->sat_clauses = 0;
+    for(uint32_t offset = 0; offset < solver.arena.count; offset += solver.arena[offset] + 1) check->sat_clauses++;
+
+    if(result == SatResult_UNSATISFIABLE){
+      check->status = EquivalenceStatus_EQUIVALENT;
+    } else if(result == SatResult_UNKNOWN){
+      check->status = EquivalenceStatus_UNKNOWN;
+    } else {
+      //NOTE(Torin) The model is replayed on lane 0 so the reported outputs are simulated
+      it(i, netlist.inputs.count){
+        uint32_t net = netlist.inputs[i];
+        values[net] = GetSatModelValue(&solver, SatVar(literals[net])) ? 1 : 0;
+      }
+      EvaluateNetlistLanes(&netlist, values, known);
+      bool isConfirmed = FindMiterDifference(check, &netlist, values, known, outputsA, outputsB, output_count, 1);
+      assert(isConfirmed);
+    }
+    free(literals);
+    DestroySatSolver(&solver);
+  }
+
+  free(values);
+  free(known);
+  free(outputsA);
+  free(outputsB);
+  DestroyNetlist(&netlist);
+  check->milliseconds = ProfilerTicksToMilliseconds(ProfilerTimestamp() - beginTicks);
+  return true;
+}
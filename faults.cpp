@@ -0,0 +1,331 @@
+//NOTE(Torin) Stuck-at fault simulation
+//Every net of the flattened netlist (inputs, register outputs and gate outputs) gets a
+//stuck-at-0 and a stuck-at-1 fault. The vectors of a VectorRunner are applied in blocks
+//of 64 with one vector per bit lane: the good machine is evaluated once per block, then
+//each remaining fault forces its net and only the fanout cone of that net is re-evaluated
+//in levelized order until the difference dies out or reaches an observed net. A fault is
+//dropped with the first vector that detects it. Observed nets are the OUTPUT nodes and the
+//D inputs of registers (every register treated as scannable). The fault list is spread
+//over worker threads which each evaluate the good machine for themselves, so they share
+//nothing but the read only netlist
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define FAULT_MAX_THREADS 64
+#define FAULT_UNDETECTED UINT64_MAX
+
+//NOTE(Torin) A net without a path to an observed net can never detect a fault, those
+//faults are not simulated and their cones are not propagated into
+#define FAULT_NET_OBSERVED 0x1
+#define FAULT_NET_OBSERVABLE 0x2
+
+//NOTE(Torin) net indexes the netlist of the run that built the fault list, the runner
+//rebuilds its netlist on every run so the type is kept for the list of undetected faults
+struct Fault {
+  uint32_t net;
+  NetType net_type;
+  uint8_t stuck_value;
+  uint64_t detected_vector;  //FAULT_UNDETECTED until a vector detects the fault
+};
+
+struct FaultSimulation {
+  int thread_count;   //0 uses every core
+  DynamicArray<Fault> faults;
+  uint64_t detected_count;
+  uint64_t vector_count;
+  uint32_t threads_used;
+  double milliseconds;
+  const char *error;
+};
+
+struct FaultWorker {
+  const VectorRunner *runner;
+  const Editor *editor;
+  const uint32_t *fanout_offset;
+  const uint32_t *fanouts;
+  const uint32_t *position;     //levelized order position of every gate
+  const uint8_t *net_flags;
+  Fault *faults;
+  uint32_t fault_count;
+  uint32_t first_fault;
+  uint32_t fault_stride;
+
+  uint64_t *good_values;
+  uint64_t *good_known;
+  uint64_t *values;
+  uint64_t *known;
+  uint32_t *heap;
+  uint8_t *is_queued;
+  uint32_t *touched;
+  uint32_t heap_count;
+  pthread_t thread;
+  bool has_thread;
+};
+
+static inline
+void PushFaultGate(FaultWorker *worker, uint32_t gate){
+  if(worker->is_queued[gate] || !(worker->net_flags[gate] & FAULT_NET_OBSERVABLE)) return;
+  worker->is_queued[gate] = 1;
+  const uint32_t *position = worker->position;
+  uint32_t index = worker->heap_count++;
+  while(index > 0){
+    uint32_t parent = (index - 1) / 2;
+    if(position[worker->heap[parent]] <= position[gate]) break;
+    worker->heap[index] = worker->heap[parent];
+    index = parent;
+  }
+  worker->heap[index] = gate;
+}
+
+static inline
+uint32_t PopFaultGate(FaultWorker *worker){
+  const uint32_t *position = worker->position;
+  uint32_t result = worker->heap[0];
+  uint32_t last = worker->heap[--worker->heap_count];
+  uint32_t index = 0;
+  for(;;){
+    uint32_t child = index * 2 + 1;
+    if(child >= worker->heap_count) break;
+    if(child + 1 < worker->heap_count && position[worker->heap[child + 1]] < position[worker->heap[child]]) child++;
+    if(position[last] <= position[worker->heap[child]]) break;
+    worker->heap[index] = worker->heap[child];
+    index = child;
+  }
+  worker->heap[index] = last;
+  worker->is_queued[result] = 0;
+  return result;
+}
+
+//NOTE(Torin) Lanes of the current block in which the fault reaches an observed net, at
+//least the first one of them. values / known hold the good machine again when this returns
+static uint64_t SimulateFault(FaultWorker *worker, const Fault *fault, uint64_t lane_mask){
+  const Netlist *netlist = &worker->runner->netlist;
+  const uint64_t *goodValues = worker->good_values;
+  const uint64_t *goodKnown = worker->good_known;
+  uint64_t *values = worker->values;
+  uint64_t *known = worker->known;
+  uint32_t net = fault->net;
+  uint64_t stuck = fault->stuck_value ? ~0ULL : 0;
+  uint64_t activated = ((goodValues[net] ^ stuck) | ~goodKnown[net]) & lane_mask;
+  if(activated == 0) return 0;
+  //NOTE(Torin) No earlier lane can detect the fault once the first activated lane did,
+  //so the first detecting vector is exact without propagating the whole cone
+  uint64_t firstLane = activated & (~activated + 1);
+
+  uint32_t touchedCount = 0;
+  values[net] = stuck;
+  known[net] = ~0ULL;
+  worker->touched[touchedCount++] = net;
+  uint64_t detected = 0;
+  if(worker->net_flags[net] & FAULT_NET_OBSERVED) detected |= goodKnown[net] & (stuck ^ goodValues[net]);
+  for(uint32_t n = worker->fanout_offset[net]; n < worker->fanout_offset[net + 1]; n++)
+    PushFaultGate(worker, worker->fanouts[n]);
+
+  const uint32_t *fanins = netlist->fanins.data;
+  while(worker->heap_count > 0 && (detected & firstLane) == 0){
+    uint32_t g = PopFaultGate(worker);
+    const NetlistGate *gate = &netlist->gates.data[g];
+    uint64_t value, isKnown;
+    EvaluateLaneGate(gate, fanins + gate->fanin_offset, values, known, &value, &isKnown);
+    if(value == values[g] && isKnown == known[g]) continue;
+    values[g] = value;
+    known[g] = isKnown;
+    worker->touched[touchedCount++] = g;
+    if(worker->net_flags[g] & FAULT_NET_OBSERVED) detected |= goodKnown[g] & isKnown & (value ^ goodValues[g]);
+    for(uint32_t n = worker->fanout_offset[g]; n < worker->fanout_offset[g + 1]; n++)
+      PushFaultGate(worker, worker->fanouts[n]);
+  }
+
+  while(worker->heap_count > 0) PopFaultGate(worker);
+  it(i, touchedCount){
+    uint32_t touched = worker->touched[i];
+    values[touched] = goodValues[touched];
+    known[touched] = goodKnown[touched];
+  }
+  return detected & lane_mask;
+}
+
+static void *RunFaultWorker(void *data){
+  FaultWorker *worker = (FaultWorker *)data;
+  const VectorRunner *runner = worker->runner;
+  uint32_t gate_count = runner->netlist.gates.count;
+  size_t laneBytes = sizeof(uint64_t) * gate_count;
+  worker->good_values = (uint64_t *)malloc(laneBytes);
+  worker->good_known = (uint64_t *)malloc(laneBytes);
+  worker->values = (uint64_t *)malloc(laneBytes);
+  worker->known = (uint64_t *)malloc(laneBytes);
+  worker->heap = (uint32_t *)malloc(sizeof(uint32_t) * gate_count);
+  worker->touched = (uint32_t *)malloc(sizeof(uint32_t) * gate_count);
+  worker->is_queued = (uint8_t *)calloc(gate_count, 1);
+  worker->heap_count = 0;
+
+  //NOTE(Torin) Indices of the faults of this worker that are still undetected
+  DynamicArray<uint32_t> remaining = {};
+  for(uint32_t i = worker->first_fault; i < worker->fault_count; i += worker->fault_stride){
+    if(worker->net_flags[worker->faults[i].net] & FAULT_NET_OBSERVABLE) ArrayAdd(i, remaining);
+  }
+
+  uint64_t randomState = runner->seed | 1;
+  SetVectorLaneSources(runner, worker->editor, worker->good_values, worker->good_known);
+  for(uint64_t first = 0; first < runner->vector_count && remaining.count > 0; first += VECTOR_LANES){
+    uint32_t laneCount = GetVectorLaneCount(runner, first);
+    uint64_t laneMask = laneCount == VECTOR_LANES ? ~0ULL : (1ULL << laneCount) - 1;
+    SetVectorLaneInputs(runner, first, laneCount, worker->good_values, worker->good_known, &randomState);
+    EvaluateNetlistLanes(&runner->netlist, worker->good_values, worker->good_known);
+    memcpy(worker->values, worker->good_values, laneBytes);
+    memcpy(worker->known, worker->good_known, laneBytes);
+
+    size_t i = 0;
+    while(i < remaining.count){
+      Fault *fault = &worker->faults[remaining.data[i]];
+      uint64_t detected = SimulateFault(worker, fault, laneMask);
+      if(detected == 0){
+        i++;
+        continue;
+      }
+      fault->detected_vector = first + __builtin_ctzll(detected);
+      ArrayRemoveAtIndexUnordered(i, remaining);
+    }
+  }
+
+  ArrayDestroy(remaining);
+  free(worker->good_values);
+  free(worker->good_known);
+  free(worker->values);
+  free(worker->known);
+  free(worker->heap);
+  free(worker->touched);
+  free(worker->is_queued);
+  return 0;
+}
+
+//NOTE(Torin) Uses the stimulus of the runner, the design must be bit parallel since the
+//cone evaluation works on 64 lanes
+bool RunFaultSimulation(FaultSimulation *simulation, VectorRunner *runner, Editor *editor){
+  PROFILE_SCOPE("RunFaultSimulation");
+  uint64_t beginTicks = ProfilerTimestamp();
+  simulation->error = nullptr;
+  simulation->faults.count = 0;
+  simulation->detected_count = 0;
+  simulation->vector_count = 0;
+  if(!PrepareVectors(runner, editor)){
+    simulation->error = runner->error;
+    return false;
+  }
+  if(!runner->is_bit_parallel){
+    simulation->error = "word and memory nodes are not supported by the fault simulator";
+    return false;
+  }
+  simulation->vector_count = runner->vector_count;
+
+  const Netlist *netlist = &runner->netlist;
+  uint32_t gate_count = netlist->gates.count;
+  uint32_t *position = (uint32_t *)calloc(gate_count, sizeof(uint32_t));
+  uint32_t *fanoutOffset = (uint32_t *)calloc(gate_count + 1, sizeof(uint32_t));
+  uint8_t *netFlags = (uint8_t *)calloc(gate_count, 1);
+  it(i, netlist->order.count) position[netlist->order.data[i]] = i;
+  it(g, gate_count){
+    const NetlistGate *gate = &netlist->gates.data[g];
+    it(n, GetDependencyCount(gate)) fanoutOffset[netlist->fanins.data[gate->fanin_offset + n] + 1]++;
+  }
+  it(g, gate_count) fanoutOffset[g + 1] += fanoutOffset[g];
+  uint32_t *fanouts = (uint32_t *)malloc(sizeof(uint32_t) * (fanoutOffset[gate_count] + 1));
+  uint32_t *cursor = (uint32_t *)malloc(sizeof(uint32_t) * (gate_count + 1));
+  memcpy(cursor, fanoutOffset, sizeof(uint32_t) * (gate_count + 1));
+  it(g, gate_count){
+    const NetlistGate *gate = &netlist->gates.data[g];
+    it(n, GetDependencyCount(gate)) fanouts[cursor[netlist->fanins.data[gate->fanin_offset + n]]++] = g;
+  }
+  free(cursor);
+
+  it(i, runner->output_nets.count){
+    uint32_t net = runner->output_nets.data[i];
+    if(net != NET_INVALID) netFlags[net] = FAULT_NET_OBSERVED | FAULT_NET_OBSERVABLE;
+  }
+  it(i, netlist->registers.count){
+    const NetlistRegister *reg = &netlist->registers.data[i];
+    if(reg->net == NET_INVALID) continue;
+    netFlags[netlist->fanins.data[netlist->gates.data[reg->net].fanin_offset]] = FAULT_NET_OBSERVED | FAULT_NET_OBSERVABLE;
+  }
+  //NOTE(Torin) Reverse levelized order sees every fanout of a gate before the gate,
+  //sources are not in the order and are resolved afterwards
+  for(size_t i = netlist->order.count; i > 0; i--){
+    uint32_t g = netlist->order.data[i - 1];
+    for(uint32_t n = fanoutOffset[g]; n < fanoutOffset[g + 1] && !(netFlags[g] & FAULT_NET_OBSERVABLE); n++)
+      netFlags[g] |= netFlags[fanouts[n]] & FAULT_NET_OBSERVABLE;
+  }
+  it(g, gate_count){
+    if(!IsNetSource(netlist->gates.data[g].type)) continue;
+    for(uint32_t n = fanoutOffset[g]; n < fanoutOffset[g + 1] && !(netFlags[g] & FAULT_NET_OBSERVABLE); n++)
+      netFlags[g] |= netFlags[fanouts[n]] & FAULT_NET_OBSERVABLE;
+  }
+
+  //NOTE(Torin) Sources first then the gates in levelized order
+  Fault fault = {};
+  fault.detected_vector = FAULT_UNDETECTED;
+  it(g, gate_count){
+    NetType type = netlist->gates.data[g].type;
+    if(type != NetType_INPUT && type != NetType_DFF) continue;
+    fault.net = g;
+    fault.net_type = type;
+    fault.stuck_value = 0;
+    ArrayAdd(fault, simulation->faults);
+    fault.stuck_value = 1;
+    ArrayAdd(fault, simulation->faults);
+  }
+  it(i, netlist->order.count){
+    fault.net = netlist->order.data[i];
+    fault.net_type = netlist->gates.data[fault.net].type;
+    fault.stuck_value = 0;
+    ArrayAdd(fault, simulation->faults);
+    fault.stuck_value = 1;
+    ArrayAdd(fault, simulation->faults);
+  }
+
+  //NOTE(Torin) Faults are dealt out round robin so every worker gets a share of the
+  //large cones close to the inputs
+  uint32_t threadCount = simulation->thread_count > 0 ? (uint32_t)simulation->thread_count : (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+  threadCount = Min(Max(threadCount, 1), FAULT_MAX_THREADS);
+  if(threadCount > simulation->faults.count) threadCount = Max(simulation->faults.count, 1);
+  FaultWorker workers[FAULT_MAX_THREADS] = {};
+  it(t, threadCount){
+    FaultWorker *worker = &workers[t];
+    worker->runner = runner;
+    worker->editor = editor;
+    worker->fanout_offset = fanoutOffset;
+    worker->fanouts = fanouts;
+    worker->position = position;
+    worker->net_flags = netFlags;
+    worker->faults = simulation->faults.data;
+    worker->fault_count = simulation->faults.count;
+    worker->first_fault = t;
+    worker->fault_stride = threadCount;
+    if(t > 0) worker->has_thread = pthread_create(&worker->thread, 0, RunFaultWorker, worker) == 0;
+  }
+  //NOTE(Torin) A worker whose thread could not be created runs on the calling thread
+  simulation->threads_used = 1;
+  it(t, threadCount){
+    if(!workers[t].has_thread) RunFaultWorker(&workers[t]);
+  }
+  it(t, threadCount){
+    if(!workers[t].has_thread) continue;
+    pthread_join(workers[t].thread, 0);
+    simulation->threads_used++;
+  }
+
+  it(i, simulation->faults.count){
+    if(simulation->faults[i].detected_vector != FAULT_UNDETECTED) simulation->detected_count++;
+  }
+
+  free(position);
+  free(fanoutOffset);
+  free(fanouts);
+  free(netFlags);
+  simulation->milliseconds = ProfilerTicksToMilliseconds(ProfilerTimestamp() - beginTicks);
+  return true;
+}
+
+void DestroyFaultSimulation(FaultSimulation *simulation){
+  ArrayDestroy(simulation->faults);
+}
@@ -0,0 +1,83 @@
+//NOTE(Torin) Logic gate library
+//Every single bit gate is one of three symmetric functions of its inputs (all HIGH, any
+//HIGH, odd number HIGH) optionally inverted, so a gate with any number of inputs only
+//depends on how many of them are HIGH. That count is reduced to a 3 bit class
+//(all HIGH, any HIGH, odd) which indexes an 8 entry truth table generated at compile
+//time from the function, evaluation is a count and a table lookup for every gate type
+
+#define GATE_MAX_INPUTS 16
+
+enum GateFunction : uint8_t {
+  GateFunction_ALL,
+  GateFunction_ANY,
+  GateFunction_PARITY,
+};
+
+struct GateInfo {
+  GateFunction function;
+  uint8_t invert;
+  uint8_t min_inputs;
+  uint8_t max_inputs;
+  uint8_t truth;        //bit GetGateTruthIndex() is the output
+  uint8_t delay;        //default propagation delay in time units
+};
+
+static constexpr
+uint8_t GetGateTruthTable(GateFunction function, bool invert){
+  return (uint8_t)((function == GateFunction_ALL ? 0xF0 : function == GateFunction_ANY ? 0xCC : 0xAA) ^ (invert ? 0xFF : 0x00));
+}
+
+#define GATE_INFO(function, invert, min_inputs, max_inputs, delay) \
+  { function, invert, min_inputs, max_inputs, GetGateTruthTable(function, invert), delay }
+
+//NOTE(Torin) Indexed by type - NodeType_AND, delays are relative to an inverter
+static const GateInfo GATE_INFO_TABLE[] = {
+  GATE_INFO(GateFunction_ALL,    0, 2, GATE_MAX_INPUTS, 3), //AND
+  GATE_INFO(GateFunction_ANY,    0, 2, GATE_MAX_INPUTS, 3), //OR
+  GATE_INFO(GateFunction_PARITY, 0, 2, GATE_MAX_INPUTS, 4), //XOR
+  GATE_INFO(GateFunction_ALL,    1, 1, 1,               1), //NOT
+  GATE_INFO(GateFunction_ALL,    1, 2, GATE_MAX_INPUTS, 2), //NAND
+  GATE_INFO(GateFunction_ANY,    1, 2, GATE_MAX_INPUTS, 2), //NOR
+  GATE_INFO(GateFunction_PARITY, 1, 2, GATE_MAX_INPUTS, 4), //XNOR
+  GATE_INFO(GateFunction_ALL,    0, 1, 1,               1), //BUF
+};
+
+static_assert(sizeof(GATE_INFO_TABLE) / sizeof(GATE_INFO_TABLE[0]) == NodeType_BUF - NodeType_AND + 1,
+  "GATE_INFO_TABLE must have an entry for every gate type");
+
+static inline
+bool IsLogicGateType(uint32_t type){
+  bool result = type >= NodeType_AND && type <= NodeType_BUF;
+  return result;
+}
+
+static inline
+const GateInfo *GetGateInfo(uint32_t type){
+  assert(IsLogicGateType(type));
+  return &GATE_INFO_TABLE[type - NodeType_AND];
+}
+
+static inline
+uint32_t GetGateInputCount(uint32_t type, int requested){
+  const GateInfo *info = GetGateInfo(type);
+  uint32_t result = Min(Max(requested, (int)info->min_inputs), (int)info->max_inputs);
+  return result;
+}
+
+static inline
+uint32_t GetGateTruthIndex(uint32_t high_count, uint32_t input_count){
+  uint32_t result = ((high_count == input_count) << 2) | ((high_count != 0) << 1) | (high_count & 1);
+  return result;
+}
+
+//NOTE(Torin) NONE on any input leaves the output NONE
+static inline
+NodeState EvaluateGate(uint8_t truth, const NodeState *inputs, size_t input_count){
+  uint32_t highCount = 0;
+  for(size_t i = 0; i < input_count; i++){
+    if(inputs[i] == NodeState_NONE) return NodeState_NONE;
+    highCount += inputs[i];
+  }
+  NodeState result = (NodeState)((truth >> GetGateTruthIndex(highCount, input_count)) & 1);
+  return result;
+}
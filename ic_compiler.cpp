@@ -0,0 +1,288 @@
+//NOTE(Torin) Compiles an ICDefinition into straight-line code
+//The ICNode graph is levelized once into a list of GateInstructions operating on
+//uint64_t slots (one slot per ICNode), which is then emitted as x86-64 machine code.
+//A gate with more than two inputs accumulates into its own slot, inverted gates end
+//with a NOT.
+//Every bit of a slot is an independent lane so one call evaluates 64 input vectors,
+//scalar simulation uses all-ones for HIGH and reads back bit 0.
+//Only ICs whose internal inputs are all driven and that contain no feedback are compiled,
+//anything else keeps using the interpreter in SimulateIC
+
+#include <sys/mman.h>
+
+enum GateOp : uint32_t {
+  GateOp_COPY,
+  GateOp_AND,
+  GateOp_OR,
+  GateOp_XOR,
+  GateOp_NOT,   //dest = ~a
+};
+
+struct GateInstruction {
+  GateOp op;
+  uint32_t dest;
+  uint32_t a;
+  uint32_t b;
+};
+
+typedef void (*ICProgramProc)(uint64_t *slots);
+
+//NOTE(Torin) Slot layout matches the ICNode layout of the definition
+//slots [0, input_count) are the inputs and [input_count, input_count + output_count) the outputs
+struct ICProgram {
+  uint32_t input_count;
+  uint32_t output_count;
+  uint32_t slot_count;
+  uint32_t instruction_count;
+  GateInstruction *instructions;
+  uint64_t *slots;
+
+  ICProgramProc proc;
+  void *code;
+  size_t code_size;
+};
+
+static inline
+GateOp GetGateOp(GateFunction function){
+  switch(function){
+    case GateFunction_ALL:    return GateOp_AND;
+    case GateFunction_ANY:    return GateOp_OR;
+    case GateFunction_PARITY: return GateOp_XOR;
+  }
+  assert(false);
+  return GateOp_COPY;
+}
+
+#if defined(__x86_64__)
+struct CodeBuffer {
+  uint8_t *base;
+  size_t used;
+  size_t size;
+};
+
+static inline
+void EmitByte(CodeBuffer *buffer, uint8_t value){
+  assert(buffer->used < buffer->size);
+  buffer->base[buffer->used++] = value;
+}
+
+//NOTE(Torin) Emits REX.W <opcode> with a [rdi + disp32] memory operand and rax as the register operand
+static inline
+void EmitRaxRdiOp(CodeBuffer *buffer, uint8_t opcode, uint32_t slot){
+  uint32_t displacement = slot * sizeof(uint64_t);
+  EmitByte(buffer, 0x48);
+  EmitByte(buffer, opcode);
+  EmitByte(buffer, 0x87);
+  EmitByte(buffer, (uint8_t)(displacement >> 0));
+  EmitByte(buffer, (uint8_t)(displacement >> 8));
+  EmitByte(buffer, (uint8_t)(displacement >> 16));
+  EmitByte(buffer, (uint8_t)(displacement >> 24));
+}
+
+static bool JITCompileICProgram(ICProgram *program){
+  static const uint8_t MOV_RAX_MEM = 0x8B;
+  static const uint8_t MOV_MEM_RAX = 0x89;
+  static const uint8_t AND_RAX_MEM = 0x23;
+  static const uint8_t OR_RAX_MEM  = 0x0B;
+  static const uint8_t XOR_RAX_MEM = 0x33;
+  static const uint8_t NOT_RAX[] = { 0x48, 0xF7, 0xD0 };
+  static const size_t MAX_INSTRUCTION_SIZE = 7 * 3;
+
+  size_t page_size = 4096;
+  size_t required = (program->instruction_count * MAX_INSTRUCTION_SIZE) + 1;
+  required = (required + page_size - 1) & ~(page_size - 1);
+  void *memory = mmap(0, required, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(memory == MAP_FAILED) return false;
+
+  CodeBuffer buffer = {};
+  buffer.base = (uint8_t *)memory;
+  buffer.size = required;
+
+  //NOTE(Torin) rax caches the last stored slot so chains of gates feeding each other
+  //skip the reload
+  uint32_t raxSlot = UINT32_MAX;
+  for(uint32_t i = 0; i < program->instruction_count; i++){
+    const GateInstruction *instruction = &program->instructions[i];
+    if(raxSlot != instruction->a) EmitRaxRdiOp(&buffer, MOV_RAX_MEM, instruction->a);
+    switch(instruction->op){
+      case GateOp_COPY: break;
+      case GateOp_AND: EmitRaxRdiOp(&buffer, AND_RAX_MEM, instruction->b); break;
+      case GateOp_OR:  EmitRaxRdiOp(&buffer, OR_RAX_MEM, instruction->b); break;
+      case GateOp_XOR: EmitRaxRdiOp(&buffer, XOR_RAX_MEM, instruction->b); break;
+      case GateOp_NOT: for(uint8_t byte : NOT_RAX) EmitByte(&buffer, byte); break;
+    }
+    EmitRaxRdiOp(&buffer, MOV_MEM_RAX, instruction->dest);
+    raxSlot = instruction->dest;
+  }
+  EmitByte(&buffer, 0xC3); //ret
+
+  if(mprotect(memory, required, PROT_READ | PROT_EXEC) != 0){
+    munmap(memory, required);
+    return false;
+  }
+
+  program->code = memory;
+  program->code_size = required;
+  program->proc = (ICProgramProc)memory;
+  return true;
+}
+#else
+static bool JITCompileICProgram(ICProgram *program){
+  return false;
+}
+#endif
+
+//NOTE(Torin) Portable path used when no native code could be emitted
+static inline
+void InterpretICProgram(const ICProgram *program, uint64_t *slots){
+  for(uint32_t i = 0; i < program->instruction_count; i++){
+    const GateInstruction *instruction = &program->instructions[i];
+    uint64_t a = slots[instruction->a];
+    uint64_t b = slots[instruction->b];
+    uint64_t result = 0;
+    switch(instruction->op){
+      case GateOp_COPY: result = a; break;
+      case GateOp_AND: result = a & b; break;
+      case GateOp_OR:  result = a | b; break;
+      case GateOp_XOR: result = a ^ b; break;
+      case GateOp_NOT: result = ~a; break;
+    }
+    slots[instruction->dest] = result;
+  }
+}
+
+static inline
+void RunICProgram(const ICProgram *program, uint64_t *slots){
+  if(program->proc != nullptr) program->proc(slots);
+  else InterpretICProgram(program, slots);
+}
+
+ICProgram *CompileICDefinition(const ICDefinition *icdef){
+  uint32_t node_count = icdef->node_count;
+  uint32_t driver_count = 0;
+  for(uint32_t i = 0; i < node_count; i++) driver_count += icdef->nodes[i].input_count;
+
+  //NOTE(Torin) ICNodes only store their output connections so the drivers of every
+  //input are recovered first, inputOffset[i] indexes node i's entries in drivers
+  uint32_t *inputOffset = (uint32_t *)malloc(sizeof(uint32_t) * (node_count + 1));
+  uint32_t *drivers = (uint32_t *)malloc(sizeof(uint32_t) * (driver_count + 1));
+  uint32_t *pending = (uint32_t *)calloc(node_count, sizeof(uint32_t));
+  uint32_t *order = (uint32_t *)malloc(sizeof(uint32_t) * node_count);
+
+  inputOffset[0] = 0;
+  for(uint32_t i = 0; i < node_count; i++)
+    inputOffset[i + 1] = inputOffset[i] + icdef->nodes[i].input_count;
+  for(uint32_t i = 0; i < driver_count; i++) drivers[i] = UINT32_MAX;
+
+  bool compilable = true;
+  for(uint32_t i = 0; i < node_count && compilable; i++){
+    const ICNode *node = &icdef->nodes[i];
+    if(node->type != NodeType_INPUT && node->type != NodeType_OUTPUT && !IsLogicGateType(node->type)){
+      compilable = false;
+      break;
+    }
+
+    uint32_t connection_count = node->output_count > 0 ? node->connection_count_per_output[0] : 0;
+    for(uint32_t n = 0; n < connection_count; n++){
+      const ICNodeConnection *connection = &node->output_connections[n];
+      uint32_t *driver = &drivers[inputOffset[connection->node_index] + connection->io_index];
+      if(*driver != UINT32_MAX) compilable = false;
+      *driver = i;
+      pending[connection->node_index]++;
+    }
+  }
+
+  for(uint32_t i = 0; i < driver_count; i++)
+    if(drivers[i] == UINT32_MAX) compilable = false;
+
+  //NOTE(Torin) Kahn's algorithm, if a node is never released the IC contains a loop
+  uint32_t orderCount = 0;
+  if(compilable){
+    for(uint32_t i = 0; i < node_count; i++)
+      if(pending[i] == 0) order[orderCount++] = i;
+    for(uint32_t i = 0; i < orderCount; i++){
+      const ICNode *node = &icdef->nodes[order[i]];
+      uint32_t connection_count = node->output_count > 0 ? node->connection_count_per_output[0] : 0;
+      for(uint32_t n = 0; n < connection_count; n++){
+        uint32_t target = node->output_connections[n].node_index;
+        if(--pending[target] == 0) order[orderCount++] = target;
+      }
+    }
+    if(orderCount != node_count) compilable = false;
+  }
+
+  ICProgram *program = nullptr;
+  if(compilable){
+    //NOTE(Torin) At most one instruction per input plus the final NOT of every node
+    uint32_t instruction_capacity = driver_count + node_count;
+    size_t required_memory = sizeof(ICProgram);
+    required_memory += sizeof(GateInstruction) * instruction_capacity;
+    required_memory += sizeof(uint64_t) * node_count;
+    program = (ICProgram *)calloc(required_memory, 1);
+    program->input_count = icdef->input_count;
+    program->output_count = icdef->output_count;
+    program->slot_count = node_count;
+    program->instructions = (GateInstruction *)(program + 1);
+    program->slots = (uint64_t *)(program->instructions + instruction_capacity);
+
+    for(uint32_t i = 0; i < orderCount; i++){
+      uint32_t index = order[i];
+      const ICNode *node = &icdef->nodes[index];
+      if(node->type == NodeType_INPUT) continue;
+
+      const uint32_t *nodeDrivers = &drivers[inputOffset[index]];
+      GateInstruction *instruction = &program->instructions[program->instruction_count++];
+      instruction->op = GateOp_COPY;
+      instruction->dest = index;
+      instruction->a = nodeDrivers[0];
+      instruction->b = instruction->a;
+      if(node->type == NodeType_OUTPUT) continue;
+
+      const GateInfo *info = GetGateInfo(node->type);
+      GateOp op = GetGateOp(info->function);
+      if(node->input_count > 1){
+        instruction->op = op;
+        instruction->b = nodeDrivers[1];
+      }
+      for(uint32_t n = 2; n < node->input_count; n++){
+        instruction = &program->instructions[program->instruction_count++];
+        *instruction = { op, index, index, nodeDrivers[n] };
+      }
+      if(info->invert){
+        instruction = &program->instructions[program->instruction_count++];
+        *instruction = { GateOp_NOT, index, index, index };
+      }
+    }
+    assert(program->instruction_count <= instruction_capacity);
+
+    JITCompileICProgram(program);
+  }
+
+  free(inputOffset);
+  free(drivers);
+  free(pending);
+  free(order);
+  return program;
+}
+
+void DestroyICProgram(ICProgram *program){
+  if(program == nullptr) return;
+  if(program->code != nullptr) munmap(program->code, program->code_size);
+  free(program);
+}
+
+static inline
+void SimulateCompiledIC(ICDefinition *icdef, NodeState *inputs, NodeState *outputs){
+  PROFILE_SCOPE("SimulateCompiledIC");
+  uint64_t beginTicks = ProfilerTimestamp();
+
+  ICProgram *program = icdef->program;
+  for(uint32_t i = 0; i < program->input_count; i++)
+    program->slots[i] = (inputs[i] == NodeState_HIGH) ? ~0ULL : 0;
+  RunICProgram(program, program->slots);
+  for(uint32_t i = 0; i < program->output_count; i++)
+    outputs[i] = (NodeState)(program->slots[program->input_count + i] & 1);
+
+  icdef->eval_count++;
+  icdef->eval_ticks += ProfilerTimestamp() - beginTicks;
+}
@@ -0,0 +1,693 @@
+//NOTE(Torin) IC library
+//Every ICDefinition in Editor::icdefs has an ICLibraryEntry in Editor::library holding its
+//name and the FNV-1a hash of its serialized form. CanonicalizeICDefinition puts the logic
+//nodes of a new definition in an order that does not depend on how they were selected and
+//AddICDefinition hands back the existing definition when a structurally identical one is
+//known, so instances of equal ICs share one ICDefinition and one compiled program.
+//A library file is the serialized definitions followed by an index of ICLibraryFileEntry.
+//Opening one only reads the header and the index, a definition is read, checked against
+//its hash and compiled the first time it is instantiated. Entries are found by content hash
+//through ICLibrary::hash_table, so a large shared library costs memory only for the index
+//and for the ICs that are used.
+//The positions of the nodes inside an IC are serialized after the definition as its layout,
+//hashes and comparisons only cover the definition so moving nodes does not change identity.
+
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+
+#define IC_LIBRARY_MAGIC 0x4C435748  //"HWCL"
+#define IC_LIBRARY_VERSION 2
+#define IC_CANONICAL_ROUNDS 8
+
+struct ICLibraryFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+  uint64_t index_offset;  //ICLibraryFileEntry[entry_count]
+};
+
+struct ICLibraryFileEntry {
+  char name[IC_NAME_LENGTH];
+  uint64_t hash;
+  uint64_t offset;
+  uint32_t size;
+  uint32_t input_count;
+  uint32_t output_count;
+  uint32_t layout_size;  //follows the size bytes of the definition
+};
+
+static uint64_t HashFNV1a64(const uint8_t *data, size_t size){
+  uint64_t hash = 14695981039346656037ull;
+  it(i, size){
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+static inline
+uint64_t MixHash(uint64_t hash, uint64_t value){
+  hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+  hash *= 0xFF51AFD7ED558CCDull;
+  return hash ^ (hash >> 32);
+}
+
+//NOTE(Torin) input_count, output_count, node_count and connection_count, then the type, input
+//count, output count and per output connection counts of every node, then all connections
+void SerializeICDefinition(const ICDefinition *icdef, DynamicArray<uint8_t> *buffer){
+  size_t words = 4;
+  size_t connectionCount = 0;
+  it(i, icdef->node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    words += 3 + icnode->output_count;
+    it(n, icnode->output_count) connectionCount += icnode->connection_count_per_output[n];
+  }
+  words += connectionCount * 2;
+
+  size_t offset = buffer->count;
+  ArrayReserve(offset + words * sizeof(uint32_t), *buffer);
+  buffer->count = offset + words * sizeof(uint32_t);
+  uint32_t *word = (uint32_t *)(buffer->data + offset);
+  *word++ = icdef->input_count;
+  *word++ = icdef->output_count;
+  *word++ = icdef->node_count;
+  *word++ = connectionCount;
+  it(i, icdef->node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    *word++ = icnode->type;
+    *word++ = icnode->input_count;
+    *word++ = icnode->output_count;
+    it(n, icnode->output_count) *word++ = icnode->connection_count_per_output[n];
+  }
+  it(i, icdef->node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    size_t count = 0;
+    it(n, icnode->output_count) count += icnode->connection_count_per_output[n];
+    it(c, count){
+      *word++ = icnode->output_connections[c].node_index;
+      *word++ = icnode->output_connections[c].io_index;
+    }
+  }
+}
+
+//NOTE(Torin) The x and y of every node
+void SerializeICLayout(const ICDefinition *icdef, DynamicArray<uint8_t> *buffer){
+  size_t offset = buffer->count;
+  ArrayReserve(offset + icdef->node_count * 2 * sizeof(float), *buffer);
+  buffer->count = offset + icdef->node_count * 2 * sizeof(float);
+  float *position = (float *)(buffer->data + offset);
+  it(i, icdef->node_count){
+    *position++ = icdef->nodes[i].x;
+    *position++ = icdef->nodes[i].y;
+  }
+}
+
+//NOTE(Torin) Locate the type and the position of a node in the bytes written by
+//SerializeICDefinition and SerializeICLayout, stored definitions are patched through them
+static uint32_t *GetSerializedICNodeType(uint8_t *data, uint32_t node_index){
+  uint32_t *word = (uint32_t *)data + 4;
+  it(i, node_index) word += 3 + word[2];
+  return word;
+}
+
+static float *GetSerializedICNodePosition(uint8_t *data, size_t size, uint32_t node_index){
+  uint32_t node_count = ((const uint32_t *)data)[2];
+  float *layout = (float *)(data + size) - node_count * 2;
+  return layout + node_index * 2;
+}
+
+//NOTE(Torin) Layout of a definition that has none, inputs in the first column, every other
+//node one column right of its deepest driver and the outputs in the last column. Nodes in a
+//loop are placed after the drivers outside of it
+static void ArrangeICNodes(ICDefinition *icdef){
+  uint32_t node_count = icdef->node_count;
+  uint32_t *column = (uint32_t *)calloc(node_count * 4 + 2, sizeof(uint32_t));
+  uint32_t *rowCount = column + node_count;
+  uint32_t *pending = rowCount + node_count + 2;
+  uint32_t *order = pending + node_count;
+  it(i, node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    size_t count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+    it(c, count) pending[icnode->output_connections[c].node_index]++;
+  }
+  uint32_t orderCount = 0;
+  it(i, node_count) if(pending[i] == 0) order[orderCount++] = i;
+  uint32_t lastColumn = 1;
+  for(uint32_t n = 0; n < orderCount; n++){
+    const ICNode *icnode = &icdef->nodes[order[n]];
+    size_t count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+    it(c, count){
+      uint32_t target = icnode->output_connections[c].node_index;
+      column[target] = Max(column[target], column[order[n]] + 1);
+      lastColumn = Max(lastColumn, column[target] + 1);
+      if(--pending[target] == 0) order[orderCount++] = target;
+    }
+  }
+
+  float height = 0.0f;
+  it(i, node_count){
+    if(i >= icdef->input_count && i < icdef->input_count + icdef->output_count) column[i] = lastColumn;
+    icdef->nodes[i].x = column[i] * 96.0f;
+    icdef->nodes[i].y = rowCount[column[i]]++ * 80.0f;
+    height = Max(height, icdef->nodes[i].y);
+  }
+  it(i, node_count){
+    icdef->nodes[i].x -= lastColumn * 48.0f;
+    icdef->nodes[i].y -= height * 0.5f;
+  }
+  free(column);
+}
+
+//NOTE(Torin) The data may come from a file so it is validated, returns nullptr when it does
+//not describe a definition Create IC could have made. The layout may follow the definition,
+//without it the nodes are arranged by ArrangeICNodes. The result is a single allocation laid out like
+//the ones CreateICFromNodes makes and is not compiled
+ICDefinition *DeserializeICDefinition(const uint8_t *data, size_t size){
+  if(size % sizeof(uint32_t) != 0 || size < 4 * sizeof(uint32_t)) return nullptr;
+  const uint32_t *words = (const uint32_t *)data;
+  size_t wordCount = size / sizeof(uint32_t);
+  uint32_t input_count = words[0], output_count = words[1], node_count = words[2], connection_count = words[3];
+  if(node_count < (uint64_t)input_count + output_count) return nullptr;
+
+  size_t required_memory = sizeof(ICDefinition) + (uint64_t)node_count * sizeof(ICNode);
+  size_t cursor = 4;
+  uint64_t countedConnections = 0;
+  it(i, node_count){
+    if(cursor + 3 > wordCount) return nullptr;
+    uint32_t type = words[cursor], nodeInputs = words[cursor + 1], nodeOutputs = words[cursor + 2];
+    bool isPort = i < (uint64_t)input_count + output_count;
+    if(isPort && type != (i < input_count ? NodeType_INPUT : NodeType_OUTPUT)) return nullptr;
+    if(!isPort && (type >= NodeType_COUNT || type == NodeType_INPUT || type == NodeType_OUTPUT ||
+      IsSequentialNodeType(type) || IsWordNodeType(type) || IsMemoryNodeType(type))) return nullptr;
+    if(nodeOutputs > 1 || nodeInputs > 1024 || cursor + 3 + nodeOutputs > wordCount) return nullptr;
+    required_memory += nodeInputs * sizeof(NodeState) + nodeOutputs * sizeof(uint32_t);
+    it(n, nodeOutputs) countedConnections += words[cursor + 3 + n];
+    cursor += 3 + nodeOutputs;
+  }
+  if(countedConnections != connection_count) return nullptr;
+  uint64_t definitionWords = cursor + (uint64_t)connection_count * 2;
+  bool hasLayout = definitionWords + (uint64_t)node_count * 2 == wordCount;
+  if(definitionWords != wordCount && hasLayout == false) return nullptr;
+  const float *layout = (const float *)(words + definitionWords);
+  const uint32_t *connection = words + cursor;
+  for(uint32_t c = 0; c < connection_count; c++){
+    if(connection[c * 2] >= node_count) return nullptr;
+  }
+  required_memory += (uint64_t)connection_count * sizeof(ICNodeConnection);
+
+  ICDefinition *icdef = (ICDefinition *)calloc(required_memory, 1);
+  icdef->input_count = input_count;
+  icdef->output_count = output_count;
+  icdef->node_count = node_count;
+  MStack mstack = {};
+  mstack.base = (uintptr_t)(icdef + 1);
+  mstack.size = required_memory - sizeof(ICDefinition);
+  icdef->nodes = MStackPushArray(ICNode, node_count, &mstack);
+
+  cursor = 4;
+  it(i, node_count){
+    ICNode *icnode = &icdef->nodes[i];
+    icnode->type = words[cursor];
+    icnode->input_count = words[cursor + 1];
+    icnode->output_count = words[cursor + 2];
+    if(hasLayout && isfinite(layout[i * 2]) && isfinite(layout[i * 2 + 1])){
+      icnode->x = layout[i * 2];
+      icnode->y = layout[i * 2 + 1];
+    }
+    if(icnode->input_count > 0) icnode->input_state = MStackPushArray(NodeState, icnode->input_count, &mstack);
+    if(icnode->output_count > 0){
+      icnode->connection_count_per_output = MStackPushArray(uint32_t, icnode->output_count, &mstack);
+      size_t count = 0;
+      it(n, icnode->output_count){
+        icnode->connection_count_per_output[n] = words[cursor + 3 + n];
+        count += icnode->connection_count_per_output[n];
+      }
+      icnode->output_connections = MStackPushArray(ICNodeConnection, count, &mstack);
+      it(c, count){
+        icnode->output_connections[c].node_index = *connection++;
+        icnode->output_connections[c].io_index = *connection++;
+      }
+    }
+    cursor += 3 + icnode->output_count;
+  }
+  if(hasLayout == false) ArrangeICNodes(icdef);
+
+  bool isValid = true;
+  it(i, node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    size_t count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+    it(c, count){
+      const ICNodeConnection *target = &icnode->output_connections[c];
+      if(target->io_index >= icdef->nodes[target->node_index].input_count) isValid = false;
+    }
+  }
+  if(!isValid){
+    free(icdef);
+    return nullptr;
+  }
+  return icdef;
+}
+
+//NOTE(Torin) Orders the logic nodes by a label refined from their type and the labels of
+//their drivers and loads (ports keep their place, they are the interface of the IC), ties
+//keep the order of the selection. Connections of every output are sorted by target.
+//Definitions built from the same circuit then serialize to the same bytes however the
+//nodes were selected
+struct CanonicalLabel {
+  uint64_t label;
+  uint32_t index;
+};
+
+static int CompareCanonicalLabels(const void *a, const void *b){
+  const CanonicalLabel *x = (const CanonicalLabel *)a, *y = (const CanonicalLabel *)b;
+  if(x->label != y->label) return x->label < y->label ? -1 : 1;
+  return x->index < y->index ? -1 : (x->index > y->index);
+}
+
+static int CompareICNodeConnections(const void *a, const void *b){
+  const ICNodeConnection *x = (const ICNodeConnection *)a, *y = (const ICNodeConnection *)b;
+  if(x->node_index != y->node_index) return x->node_index < y->node_index ? -1 : 1;
+  return x->io_index < y->io_index ? -1 : (x->io_index > y->io_index);
+}
+
+void CanonicalizeICDefinition(ICDefinition *icdef){
+  uint32_t node_count = icdef->node_count;
+  uint32_t portCount = icdef->input_count + icdef->output_count;
+  if(node_count == portCount) return;
+  uint32_t logicCount = node_count - portCount;
+  uint32_t driverCount = 0;
+  it(i, node_count) driverCount += icdef->nodes[i].input_count;
+
+  uint64_t *labels = (uint64_t *)malloc(sizeof(uint64_t) * node_count * 2);
+  uint64_t *nextLabels = labels + node_count;
+  CanonicalLabel *sorted = (CanonicalLabel *)malloc(sizeof(CanonicalLabel) * logicCount);
+  uint32_t *inputOffset = (uint32_t *)malloc(sizeof(uint32_t) * (node_count * 2 + 1 + driverCount));
+  uint32_t *drivers = inputOffset + node_count + 1;
+  uint32_t *newIndex = drivers + driverCount;
+
+  inputOffset[0] = 0;
+  it(i, node_count) inputOffset[i + 1] = inputOffset[i] + icdef->nodes[i].input_count;
+  it(i, driverCount) drivers[i] = UINT32_MAX;
+  it(i, node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    size_t count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+    it(c, count){
+      const ICNodeConnection *target = &icnode->output_connections[c];
+      drivers[inputOffset[target->node_index] + target->io_index] = i;
+    }
+  }
+
+  it(i, node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    labels[i] = i < portCount ? MixHash(1, i) : MixHash(MixHash(MixHash(2, icnode->type), icnode->input_count), icnode->output_count);
+  }
+
+  //NOTE(Torin) Sorts the logic nodes by label and returns how many distinct labels they have
+  auto SortLabels = [&]() -> uint32_t {
+    it(i, logicCount) sorted[i] = { labels[portCount + i], (uint32_t)(portCount + i) };
+    qsort(sorted, logicCount, sizeof(CanonicalLabel), CompareCanonicalLabels);
+    uint32_t distinct = 1;
+    for(uint32_t i = 1; i < logicCount; i++) if(sorted[i].label != sorted[i - 1].label) distinct++;
+    return distinct;
+  };
+
+  uint32_t distinctCount = SortLabels();
+  for(uint32_t round = 0; round < IC_CANONICAL_ROUNDS && distinctCount < logicCount; round++){
+    for(uint32_t i = portCount; i < node_count; i++){
+      const ICNode *icnode = &icdef->nodes[i];
+      uint64_t label = labels[i];
+      for(uint32_t n = inputOffset[i]; n < inputOffset[i + 1]; n++){
+        label = MixHash(label, drivers[n] == UINT32_MAX ? 0 : labels[drivers[n]]);
+      }
+      //NOTE(Torin) Loads are summed since their order is not canonical yet
+      uint64_t loads = 0;
+      size_t count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+      it(c, count){
+        const ICNodeConnection *target = &icnode->output_connections[c];
+        loads += MixHash(labels[target->node_index], target->io_index);
+      }
+      nextLabels[i] = MixHash(label, loads);
+    }
+    memcpy(labels + portCount, nextLabels + portCount, sizeof(uint64_t) * logicCount);
+    uint32_t refinedCount = SortLabels();
+    if(refinedCount == distinctCount) break;
+    distinctCount = refinedCount;
+  }
+
+  //NOTE(Torin) The ICNodes only move within the definition's allocation so the arrays they
+  //point to stay valid
+  ICNode *nodes = (ICNode *)malloc(sizeof(ICNode) * logicCount);
+  it(i, portCount) newIndex[i] = i;
+  it(i, logicCount){
+    nodes[i] = icdef->nodes[sorted[i].index];
+    newIndex[sorted[i].index] = portCount + i;
+  }
+  memcpy(icdef->nodes + portCount, nodes, sizeof(ICNode) * logicCount);
+  free(nodes);
+
+  it(i, node_count){
+    ICNode *icnode = &icdef->nodes[i];
+    size_t count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+    it(c, count) icnode->output_connections[c].node_index = newIndex[icnode->output_connections[c].node_index];
+    qsort(icnode->output_connections, count, sizeof(ICNodeConnection), CompareICNodeConnections);
+  }
+  free(labels);
+  free(sorted);
+  free(inputOffset);
+}
+
+static void SetLibraryEntryName(ICLibraryEntry *entry, const char *name){
+  strncpy(entry->name, name, IC_NAME_LENGTH - 1);
+  entry->name[IC_NAME_LENGTH - 1] = 0;
+}
+
+static void RebuildLibraryHashTable(ICLibrary *library, size_t size){
+  DynamicArray<uint32_t>& table = library->hash_table;
+  ArrayReserve(size, table);
+  table.count = size;
+  memset(table.data, 0, sizeof(uint32_t) * size);
+  it(i, library->entries.count){
+    size_t slot = library->entries[i].hash & (size - 1);
+    while(table[slot] != 0) slot = (slot + 1) & (size - 1);
+    table[slot] = i + 1;
+  }
+}
+
+static void InsertLibraryHash(ICLibrary *library, uint32_t entry_index){
+  DynamicArray<uint32_t>& table = library->hash_table;
+  if(library->entries.count * 2 > table.count){
+    size_t size = table.count > 0 ? table.count * 2 : 64;
+    while(size < library->entries.count * 2) size *= 2;
+    RebuildLibraryHashTable(library, size);
+    return;
+  }
+  size_t slot = library->entries[entry_index].hash & (table.count - 1);
+  while(table[slot] != 0) slot = (slot + 1) & (table.count - 1);
+  table[slot] = entry_index + 1;
+}
+
+static uint32_t AddLibraryEntry(ICLibrary *library, const ICLibraryEntry *entry){
+  uint32_t entry_index = library->entries.count;
+  if(library->entries.count == library->entries.capacity){
+    ArrayReserve(library->entries.capacity * 2 + 16, library->entries);
+  }
+  ArrayAdd(*entry, library->entries);
+  InsertLibraryHash(library, entry_index);
+  return entry_index;
+}
+
+//NOTE(Torin) The serialized definition of the entry followed by its layout, from
+//Editor::icdefs once it is loaded
+static bool ReadLibraryEntry(const ICLibraryEntry *entry, const Editor *editor, DynamicArray<uint8_t> *bytes){
+  bytes->count = 0;
+  if(entry->ic_index != IC_LIBRARY_NONE){
+    SerializeICDefinition(editor->icdefs.data[entry->ic_index], bytes);
+    SerializeICLayout(editor->icdefs.data[entry->ic_index], bytes);
+    return true;
+  }
+  if(entry->file_index == IC_LIBRARY_NONE) return false;
+  const ICLibraryFile *file = &editor->library.files.data[entry->file_index];
+  size_t size = (size_t)entry->size + entry->layout_size;
+  ArrayReserve(size, *bytes);
+  size_t offset = 0;
+  while(offset < size){
+    ssize_t count = pread(file->fd, bytes->data + offset, size - offset, entry->offset + offset);
+    if(count < 0 && errno == EINTR) continue;
+    if(count <= 0) return false;
+    offset += count;
+  }
+  bytes->count = size;
+  return true;
+}
+
+//NOTE(Torin) Finds an entry with the same serialized definition, the bytes of every entry
+//with a matching hash are compared so a collision never shares a definition
+static uint32_t FindLibraryEntry(const uint8_t *data, size_t size, uint64_t hash, bool is_unloaded_only, const Editor *editor){
+  const ICLibrary *library = &editor->library;
+  if(library->hash_table.count == 0) return IC_LIBRARY_NONE;
+  uint32_t result = IC_LIBRARY_NONE;
+  DynamicArray<uint8_t> bytes = {};
+  size_t mask = library->hash_table.count - 1;
+  for(size_t slot = hash & mask; library->hash_table.data[slot] != 0; slot = (slot + 1) & mask){
+    uint32_t entry_index = library->hash_table.data[slot] - 1;
+    const ICLibraryEntry *entry = &library->entries.data[entry_index];
+    if(entry->hash != hash || entry->size != size) continue;
+    if(is_unloaded_only && entry->ic_index != IC_LIBRARY_NONE) continue;
+    if(ReadLibraryEntry(entry, editor, &bytes) && memcmp(bytes.data, data, size) == 0){
+      result = entry_index;
+      break;
+    }
+  }
+  ArrayDestroy(bytes);
+  return result;
+}
+
+//NOTE(Torin) Whether FindLibraryEntry could match without reading the bytes of any entry,
+//a match here still has to be confirmed by comparing the bytes
+static uint32_t FindLibraryEntryByHash(uint64_t hash, uint32_t size, const Editor *editor){
+  const ICLibrary *library = &editor->library;
+  if(library->hash_table.count == 0) return IC_LIBRARY_NONE;
+  size_t mask = library->hash_table.count - 1;
+  for(size_t slot = hash & mask; library->hash_table.data[slot] != 0; slot = (slot + 1) & mask){
+    uint32_t entry_index = library->hash_table.data[slot] - 1;
+    const ICLibraryEntry *entry = &library->entries.data[entry_index];
+    if(entry->hash == hash && entry->size == size) return entry_index;
+  }
+  return IC_LIBRARY_NONE;
+}
+
+static uint32_t AppendICDefinition(ICDefinition *icdef, uint32_t entry_index, Editor *editor){
+  ICLibrary *library = &editor->library;
+  uint32_t ic_index = editor->icdefs.count;
+  ArrayAdd(icdef, editor->icdefs);
+  //NOTE(Torin) Definitions added to Editor::icdefs directly have no entry
+  while(library->entry_of_ic.count < ic_index) ArrayAdd((uint32_t)IC_LIBRARY_NONE, library->entry_of_ic);
+  ArrayAdd(entry_index, library->entry_of_ic);
+  library->entries[entry_index].ic_index = ic_index;
+  if(icdef->program == nullptr) icdef->program = CompileICDefinition(icdef);
+  return ic_index;
+}
+
+//NOTE(Torin) With is_shared an identical known definition is used instead of icdef, which
+//is freed. Otherwise icdef is always appended, replaying a journal relies on the indices
+static uint32_t RegisterICDefinition(ICDefinition *icdef, const char *name, bool is_shared, Editor *editor){
+  ICLibrary *library = &editor->library;
+  DynamicArray<uint8_t> bytes = {};
+  SerializeICDefinition(icdef, &bytes);
+  uint64_t hash = HashFNV1a64(bytes.data, bytes.count);
+  uint32_t entry_index = FindLibraryEntry(bytes.data, bytes.count, hash, !is_shared, editor);
+  if(entry_index == IC_LIBRARY_NONE){
+    ICLibraryEntry entry = {};
+    if(name != nullptr) SetLibraryEntryName(&entry, name);
+    else snprintf(entry.name, IC_NAME_LENGTH, "IC %u", library->entries.count);
+    entry.hash = hash;
+    entry.input_count = icdef->input_count;
+    entry.output_count = icdef->output_count;
+    entry.ic_index = IC_LIBRARY_NONE;
+    entry.file_index = IC_LIBRARY_NONE;
+    entry.size = bytes.count;
+    entry.layout_size = icdef->node_count * 2 * sizeof(float);
+    entry_index = AddLibraryEntry(library, &entry);
+  }
+  ArrayDestroy(bytes);
+
+  uint32_t ic_index = library->entries[entry_index].ic_index;
+  if(ic_index != IC_LIBRARY_NONE){
+    free(icdef);
+    return ic_index;
+  }
+  return AppendICDefinition(icdef, entry_index, editor);
+}
+
+//NOTE(Torin) Takes ownership of a canonical icdef and returns its index in Editor::icdefs,
+//an identical definition that is already known is returned instead, a nullptr name
+//gives the IC a numbered one
+uint32_t AddICDefinition(ICDefinition *icdef, const char *name, Editor *editor){
+  return RegisterICDefinition(icdef, name, true, editor);
+}
+
+//NOTE(Torin) Returns the Editor::icdefs index of the entry, reading, checking and compiling
+//its definition the first time, IC_LIBRARY_NONE when the file no longer holds it
+uint32_t LoadLibraryIC(uint32_t entry_index, Editor *editor){
+  ICLibrary *library = &editor->library;
+  ICLibraryEntry *entry = &library->entries[entry_index];
+  if(entry->ic_index != IC_LIBRARY_NONE) return entry->ic_index;
+  PROFILE_SCOPE("LoadLibraryIC");
+  DynamicArray<uint8_t> bytes = {};
+  ICDefinition *icdef = nullptr;
+  if(ReadLibraryEntry(entry, editor, &bytes) && HashFNV1a64(bytes.data, entry->size) == entry->hash){
+    icdef = DeserializeICDefinition(bytes.data, bytes.count);
+  }
+  ArrayDestroy(bytes);
+  if(icdef == nullptr || icdef->input_count != entry->input_count || icdef->output_count != entry->output_count){
+    free(icdef);
+    library->error = "IC definition in the library file is damaged";
+    return IC_LIBRARY_NONE;
+  }
+  return AppendICDefinition(icdef, entry_index, editor);
+}
+
+//NOTE(Torin) Changes the gate of an ICNode, which changes it in every instance. The program
+//is recompiled and the entry rehashed, the definition is not canonicalized again so node
+//indices recorded in the journal stay valid
+void SetICNodeType(uint32_t ic_index, uint32_t node_index, uint32_t type, Editor *editor){
+  ICDefinition *icdef = editor->icdefs[ic_index];
+  ICNode *icnode = &icdef->nodes[node_index];
+  assert(IsLogicGateType(icnode->type) && IsLogicGateType(type));
+  assert(icnode->input_count >= GetGateInfo(type)->min_inputs && icnode->input_count <= GetGateInfo(type)->max_inputs);
+  icnode->type = type;
+  DestroyICProgram(icdef->program);
+  icdef->program = CompileICDefinition(icdef);
+  InvalidateTopology(editor);
+
+  ICLibrary *library = &editor->library;
+  if(ic_index >= library->entry_of_ic.count || library->entry_of_ic[ic_index] == IC_LIBRARY_NONE) return;
+  DynamicArray<uint8_t> bytes = {};
+  SerializeICDefinition(icdef, &bytes);
+  library->entries[library->entry_of_ic[ic_index]].hash = HashFNV1a64(bytes.data, bytes.count);
+  ArrayDestroy(bytes);
+  RebuildLibraryHashTable(library, library->hash_table.count);
+}
+
+const char *GetICName(uint32_t ic_index, const Editor *editor){
+  const ICLibrary *library = &editor->library;
+  if(ic_index >= library->entry_of_ic.count || library->entry_of_ic.data[ic_index] == IC_LIBRARY_NONE) return "IC";
+  return library->entries.data[library->entry_of_ic.data[ic_index]].name;
+}
+
+//NOTE(Torin) Reads the header and the index only, entries of ICs that are already known are
+//left out. Only an entry whose hash and size match a known one has its definition read to
+//compare the bytes
+bool OpenICLibrary(const char *path, Editor *editor){
+  PROFILE_SCOPE("OpenICLibrary");
+  ICLibrary *library = &editor->library;
+  it(i, library->files.count){
+    if(strcmp(library->files[i].path, path) == 0) return true;
+  }
+  if(strlen(path) >= sizeof(ICLibraryFile::path)){
+    library->error = "Library path is too long";
+    return false;
+  }
+  int fd = open(path, O_RDONLY);
+  if(fd < 0){
+    library->error = "Failed to open the library file";
+    return false;
+  }
+
+  ICLibraryFileHeader header = {};
+  off_t fileSize = lseek(fd, 0, SEEK_END);
+  bool isValid = pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+    header.magic == IC_LIBRARY_MAGIC && header.version == IC_LIBRARY_VERSION &&
+    header.index_offset + (uint64_t)header.entry_count * sizeof(ICLibraryFileEntry) == (uint64_t)fileSize;
+  ICLibraryFileEntry *index = nullptr;
+  if(isValid){
+    size_t indexSize = header.entry_count * sizeof(ICLibraryFileEntry);
+    index = (ICLibraryFileEntry *)malloc(indexSize + 1);
+    isValid = pread(fd, index, indexSize, header.index_offset) == (ssize_t)indexSize;
+  }
+  it(i, isValid ? header.entry_count : 0){
+    if(index[i].offset < sizeof(header) || index[i].offset + index[i].size + index[i].layout_size > header.index_offset) isValid = false;
+  }
+  if(isValid == false){
+    free(index);
+    close(fd);
+    library->error = "Not a valid library file";
+    return false;
+  }
+
+  ICLibraryFile file = {};
+  strcpy(file.path, path);
+  file.fd = fd;
+  uint32_t file_index = library->files.count;
+  ArrayAdd(file, library->files);
+  ArrayReserve(library->entries.count + header.entry_count, library->entries);
+  DynamicArray<uint8_t> bytes = {};
+  it(i, header.entry_count){
+    const ICLibraryFileEntry *source = &index[i];
+    if(FindLibraryEntryByHash(source->hash, source->size, editor) != IC_LIBRARY_NONE){
+      ICLibraryEntry candidate = {};
+      candidate.ic_index = IC_LIBRARY_NONE;
+      candidate.file_index = file_index;
+      candidate.offset = source->offset;
+      candidate.size = source->size;
+      if(ReadLibraryEntry(&candidate, editor, &bytes) &&
+        FindLibraryEntry(bytes.data, source->size, source->hash, false, editor) != IC_LIBRARY_NONE) continue;
+    }
+    ICLibraryEntry entry = {};
+    memcpy(entry.name, source->name, IC_NAME_LENGTH);
+    entry.name[IC_NAME_LENGTH - 1] = 0;
+    entry.hash = source->hash;
+    entry.input_count = source->input_count;
+    entry.output_count = source->output_count;
+    entry.ic_index = IC_LIBRARY_NONE;
+    entry.file_index = file_index;
+    entry.offset = source->offset;
+    entry.size = source->size;
+    entry.layout_size = source->layout_size;
+    AddLibraryEntry(library, &entry);
+  }
+  ArrayDestroy(bytes);
+  free(index);
+  library->error = nullptr;
+  return true;
+}
+
+//NOTE(Torin) Writes every known IC, written to a temporary file that is renamed over path
+bool SaveICLibrary(const char *path, Editor *editor){
+  PROFILE_SCOPE("SaveICLibrary");
+  ICLibrary *library = &editor->library;
+  char temporaryPath[sizeof(ICLibraryFile::path) + 8];
+  snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path);
+  FILE *file = fopen(temporaryPath, "wb");
+  if(file == nullptr){
+    library->error = "Failed to create the library file";
+    return false;
+  }
+
+  ICLibraryFileHeader header = {};
+  header.magic = IC_LIBRARY_MAGIC;
+  header.version = IC_LIBRARY_VERSION;
+  fwrite(&header, sizeof(header), 1, file);
+  DynamicArray<ICLibraryFileEntry> index = {};
+  ArrayReserve(library->entries.count, index);
+  DynamicArray<uint8_t> bytes = {};
+  uint64_t offset = sizeof(header);
+  bool isWritten = true;
+  it(i, library->entries.count){
+    const ICLibraryEntry *entry = &library->entries[i];
+    if(ReadLibraryEntry(entry, editor, &bytes) == false){
+      isWritten = false;
+      break;
+    }
+    ICLibraryFileEntry fileEntry = {};
+    memcpy(fileEntry.name, entry->name, IC_NAME_LENGTH);
+    fileEntry.hash = entry->hash;
+    fileEntry.offset = offset;
+    fileEntry.size = entry->size;
+    fileEntry.layout_size = bytes.count - entry->size;
+    fileEntry.input_count = entry->input_count;
+    fileEntry.output_count = entry->output_count;
+    ArrayAdd(fileEntry, index);
+    fwrite(bytes.data, 1, bytes.count, file);
+    offset += bytes.count;
+  }
+  header.entry_count = index.count;
+  header.index_offset = offset;
+  fwrite(index.data, sizeof(ICLibraryFileEntry), index.count, file);
+  fseek(file, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, file);
+  isWritten = isWritten && fflush(file) == 0 && ferror(file) == 0 && fsync(fileno(file)) == 0;
+  fclose(file);
+  ArrayDestroy(bytes);
+  ArrayDestroy(index);
+
+  if(isWritten == false || rename(temporaryPath, path) != 0){
+    unlink(temporaryPath);
+    library->error = "Failed to write the library file";
+    return false;
+  }
+  library->error = nullptr;
+  return true;
+}
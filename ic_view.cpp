@@ -0,0 +1,232 @@
+//NOTE(Torin) IC view
+//Opening an IC instance replaces the design in the canvas with the ICNodes of its definition,
+//drawn at the positions stored in the definition with the signals of that instance. Only
+//the open instance is evaluated here, by EvaluateICInternals from the signals driving its
+//inputs and only when they or the topology changed, the simulation itself keeps running
+//every instance through the compiled program. Dragging a node and changing a gate edit the
+//definition through the command journal, so they apply to every instance and can be undone,
+//a gate change recompiles the program of the definition (see SetICNodeType).
+
+#define IC_VIEW_NODE_SIZE 64.0f
+
+//NOTE(Torin) Writes the output of every ICNode for the inputs, like SimulateIC but with its
+//own worklist and input state so the state shared by the instances is left alone. As in
+//SimulateIC nothing is evaluated while an input is NONE, every value is NONE then.
+//Returns false when a loop did not settle within iteration_limit evaluations per node
+bool EvaluateICInternals(const ICDefinition *icdef, const NodeState *inputs, NodeState *values, uint32_t iteration_limit){
+  uint32_t node_count = icdef->node_count;
+  it(i, node_count) values[i] = NodeState_NONE;
+  it(i, icdef->input_count)
+    if(inputs[i] == NodeState_NONE) return true;
+  uint32_t slotCount = 0;
+  it(i, node_count) slotCount += icdef->nodes[i].input_count;
+  uint32_t *inputOffset = (uint32_t *)malloc(sizeof(uint32_t) * (node_count * 2 + 1));
+  uint32_t *worklist = inputOffset + node_count + 1;
+  NodeState *slots = (NodeState *)malloc(slotCount + node_count + 1);
+  uint8_t *is_queued = (uint8_t *)(slots + slotCount);
+  inputOffset[0] = 0;
+  it(i, node_count) inputOffset[i + 1] = inputOffset[i] + icdef->nodes[i].input_count;
+  memset(slots, NodeState_NONE, slotCount);
+  memset(is_queued, 0, node_count);
+
+  uint32_t queueHead = 0, queueTail = 0;
+  auto Transmit = [&](uint32_t index, NodeState state){
+    const ICNode *icnode = &icdef->nodes[index];
+    values[index] = state;
+    size_t count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+    it(c, count){
+      const ICNodeConnection *connection = &icnode->output_connections[c];
+      NodeState *slot = &slots[inputOffset[connection->node_index] + connection->io_index];
+      if(*slot == state) continue;
+      *slot = state;
+      if(is_queued[connection->node_index]) continue;
+      is_queued[connection->node_index] = 1;
+      worklist[queueTail++ % node_count] = connection->node_index;
+    }
+  };
+
+  it(i, icdef->input_count) Transmit(i, inputs[i]);
+  uint64_t budget = (uint64_t)node_count * iteration_limit;
+  uint64_t evaluations = 0;
+  bool isSettled = true;
+  while(queueHead != queueTail){
+    uint32_t index = worklist[queueHead++ % node_count];
+    is_queued[index] = 0;
+    if(evaluations++ == budget) isSettled = false;
+    if(isSettled == false) continue;
+    const ICNode *icnode = &icdef->nodes[index];
+    uint8_t state = 0;
+    if(GetNodeOutputState(icnode->type, &slots[inputOffset[index]], icnode->input_count, &state) && state != values[index]){
+      Transmit(index, (NodeState)state);
+    }
+  }
+
+  free(inputOffset);
+  free(slots);
+  return isSettled;
+}
+
+void OpenICView(EditorNode *instance, Editor *editor){
+  assert(instance->type > NodeType_COUNT);
+  ICView *view = &editor->icView;
+  EndMoveCommand(editor);
+  view->is_open = true;
+  view->instance_id = instance->id;
+  view->ic_index = instance->type - NodeType_COUNT - 1;
+  view->camera = {};
+  view->topology_version = editor->topologyVersion - 1;
+}
+
+void CloseICView(Editor *editor){
+  EndMoveCommand(editor);
+  editor->icView.is_open = false;
+  ArrayDestroy(editor->icView.values);
+  ArrayDestroy(editor->icView.inputs);
+}
+
+//NOTE(Torin) The instance reads its inputs from the outputs driving it, which every
+//simulation mode keeps up to date
+static void UpdateICViewValues(const EditorNode *instance, Editor *editor){
+  ICView *view = &editor->icView;
+  const ICDefinition *icdef = editor->icdefs[view->ic_index];
+  bool isOutOfDate = view->topology_version != editor->topologyVersion || view->values.count != icdef->node_count;
+  ArrayReserve(icdef->input_count, view->inputs);
+  view->inputs.count = icdef->input_count;
+  it(i, icdef->input_count){
+    const NodeConnection *connection = &instance->inputConnections[i];
+    NodeState state = NodeState_NONE;
+    if(IsValid(connection->node_index)) state = GetNode(connection->node_index, editor)->output_state[connection->io_index];
+    if(view->inputs[i] != state) isOutOfDate = true;
+    view->inputs[i] = state;
+  }
+  if(isOutOfDate == false) return;
+
+  ArrayReserve(icdef->node_count, view->values);
+  view->values.count = icdef->node_count;
+  view->is_oscillating = !EvaluateICInternals(icdef, view->inputs.data, view->values.data, Max(editor->loopIterationLimit, 1));
+  view->topology_version = editor->topologyVersion;
+}
+
+//NOTE(Torin) Drawn into the canvas child window of DrawEditor in place of the design
+void DrawICView(Editor *editor, ImDrawList *draw_list){
+  static const float NODE_SLOT_RADIUS = 6.0f;
+  static const ImColor CONNECTION_DEFAULT_COLOR = ImColor(150,50,50);
+  static const ImColor CONNECTION_ACTIVE_COLOR = ImColor(220, 220, 110);
+  static const ImColor NODE_BACKGROUND_COLOR = ImColor(60,60,60);
+  static const ImColor NODE_PORT_BACKGROUND_COLOR = ImColor(60,60,90);
+  static const ImColor NODE_OUTLINE_COLOR = ImColor(100,100,100);
+  static const ImColor SLOT_COLOR = ImColor(150,150,150,150);
+
+  ICView *view = &editor->icView;
+  EditorNode *instance = view->instance_id < editor->nodeTable.count ? editor->nodeTable[view->instance_id] : nullptr;
+  const SDL_Scancode esc_scancode = SDL_GetScancodeFromKey(SDLK_ESCAPE);
+  if(instance == nullptr || instance->type != NodeType_COUNT + 1 + view->ic_index || SDL_GetKeyboardState(0)[esc_scancode]){
+    CloseICView(editor);
+    return;
+  }
+  ICDefinition *icdef = editor->icdefs[view->ic_index];
+  UpdateICViewValues(instance, editor);
+
+  ImVec2 canvasOrigin = ImGui::GetCursorScreenPos();
+  ImVec2 canvasSize = ImGui::GetWindowSize();
+  Camera *camera = &view->camera;
+  InitializeCamera(camera, canvasSize * 0.5f);
+  const float zoom = camera->zoom;
+  DrawCanvasGrid(draw_list, camera, canvasOrigin, canvasSize);
+
+  auto GetInputSlotPos = [&](const ICNode *icnode, uint32_t slot) -> ImVec2 {
+    ImVec2 p = ImVec2(icnode->x, icnode->y + IC_VIEW_NODE_SIZE * (slot + 1) / (icnode->input_count + 1));
+    return WorldToScreen(p, camera, canvasOrigin);
+  };
+  auto GetOutputSlotPos = [&](const ICNode *icnode) -> ImVec2 {
+    ImVec2 p = ImVec2(icnode->x + IC_VIEW_NODE_SIZE, icnode->y + IC_VIEW_NODE_SIZE * 0.5f);
+    return WorldToScreen(p, camera, canvasOrigin);
+  };
+
+  draw_list->ChannelsSplit(2);
+  draw_list->ChannelsSetCurrent(0);
+  it(i, icdef->node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    size_t count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+    ImVec2 p1 = GetOutputSlotPos(icnode);
+    ImColor color = view->values[i] == NodeState_HIGH ? CONNECTION_ACTIVE_COLOR : CONNECTION_DEFAULT_COLOR;
+    it(c, count){
+      const ICNodeConnection *connection = &icnode->output_connections[c];
+      ImVec2 p2 = GetInputSlotPos(&icdef->nodes[connection->node_index], connection->io_index);
+      ImVec2 tangent = ImVec2(50.0f * zoom, 0.0f);
+      if(!IsOnCanvas(ImMin(p1, p2) - tangent, ImMax(p1, p2) + tangent, canvasOrigin, canvasSize)) continue;
+      draw_list->AddBezierCurve(p1, p1+tangent, p2-tangent, p2, color, Max(3.0f * Min(zoom, 1.0f), 1.0f));
+    }
+  }
+
+  it(i, icdef->node_count){
+    const ICNode *icnode = &icdef->nodes[i];
+    ImVec2 node_rect_min = WorldToScreen(ImVec2(icnode->x, icnode->y), camera, canvasOrigin);
+    ImVec2 node_rect_max = node_rect_min + ImVec2(IC_VIEW_NODE_SIZE, IC_VIEW_NODE_SIZE) * zoom;
+    if(!IsOnCanvas(node_rect_min - ImVec2(NODE_SLOT_RADIUS, 0), node_rect_max + ImVec2(NODE_SLOT_RADIUS, 0), canvasOrigin, canvasSize)) continue;
+
+    ImGui::PushID(i);
+    draw_list->ChannelsSetCurrent(1);
+    if(zoom >= CANVAS_DETAIL_ZOOM){
+      ImGui::SetWindowFontScale(zoom);
+      ImGui::SetCursorScreenPos(node_rect_min + ImVec2(8, 16) * zoom);
+      const char *value = view->values[i] == NodeState_NONE ? "-" : (view->values[i] == NodeState_HIGH ? "1" : "0");
+      if(icnode->type == NodeType_INPUT) ImGui::Text("in %u\n%s", (uint32_t)i, value);
+      else if(icnode->type == NodeType_OUTPUT) ImGui::Text("out %u\n%s", (uint32_t)(i - icdef->input_count), value);
+      else ImGui::Text("%s\n%s", NodeName[icnode->type], value);
+      ImGui::SetWindowFontScale(1.0f);
+    }
+
+    ImGui::SetCursorScreenPos(node_rect_min);
+    ImGui::InvisibleButton("icnode", ImVec2(IC_VIEW_NODE_SIZE, IC_VIEW_NODE_SIZE) * zoom);
+    if(ImGui::IsItemActive() && ImGui::IsMouseDragging(0)){
+      CommandMoveICNode(view->ic_index, i, ImGui::GetIO().MouseDelta / zoom, editor);
+    }
+    if(ImGui::IsItemHovered() && ImGui::IsMouseClicked(1) && IsLogicGateType(icnode->type)){
+      view->menu_node = i;
+      ImGui::OpenPopup("ic_node_menu");
+    }
+    ImGui::PopID();
+
+    draw_list->ChannelsSetCurrent(0);
+    bool isPort = icnode->type == NodeType_INPUT || icnode->type == NodeType_OUTPUT;
+    draw_list->AddRectFilled(node_rect_min, node_rect_max, isPort ? NODE_PORT_BACKGROUND_COLOR : NODE_BACKGROUND_COLOR, 4.0f);
+    draw_list->AddRect(node_rect_min, node_rect_max, NODE_OUTLINE_COLOR, 4.0f);
+    float slotRadius = Max(NODE_SLOT_RADIUS * zoom, 2.0f);
+    it(n, icnode->input_count) draw_list->AddCircleFilled(GetInputSlotPos(icnode, n), slotRadius, SLOT_COLOR);
+    if(icnode->output_count > 0) draw_list->AddCircleFilled(GetOutputSlotPos(icnode), slotRadius, SLOT_COLOR);
+  }
+  draw_list->ChannelsMerge();
+
+  //NOTE(Torin) A gate can become any gate that takes the same number of inputs
+  ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(8,8));
+  if(ImGui::BeginPopup("ic_node_menu")){
+    const ICNode *icnode = &icdef->nodes[view->menu_node];
+    for(uint32_t type = NodeType_AND; type <= NodeType_BUF; type++){
+      const GateInfo *info = GetGateInfo(type);
+      if(icnode->input_count < info->min_inputs || icnode->input_count > info->max_inputs) continue;
+      if(ImGui::MenuItem(NodeName[type], NULL, icnode->type == type)){
+        CommandSetICNodeType(view->ic_index, view->menu_node, type, editor);
+      }
+    }
+    ImGui::EndPopup();
+  }
+  ImGui::PopStyleVar();
+
+  ImGui::SetCursorScreenPos(canvasOrigin + ImVec2(8, 8));
+  if(ImGui::Button("Back")){
+    CloseICView(editor);
+    return;
+  }
+  ImGui::SameLine();
+  ImGui::Text("%s, instance %u: %u nodes%s", GetICName(view->ic_index, editor), view->instance_id,
+    icdef->node_count, view->is_oscillating ? ", oscillating" : "");
+
+  ImGuiIO& io = ImGui::GetIO();
+  if(!ImGui::IsMouseDown(0)) EndMoveCommand(editor);
+  if(io.KeyCtrl && !io.WantTextInput){
+    if(ImGui::IsKeyPressed(SDLK_z) && !io.KeyShift) UndoCommand(editor);
+    else if(ImGui::IsKeyPressed(SDLK_y) || (ImGui::IsKeyPressed(SDLK_z) && io.KeyShift)) RedoCommand(editor);
+  }
+  UpdateCamera(camera, canvasOrigin);
+}
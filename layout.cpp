@@ -0,0 +1,222 @@
+//NOTE(Torin) Automatic layered layout
+//Sugiyama style: every node gets the layer of its longest path from a source, the nodes of
+//each layer are ordered by alternating barycenter sweeps to reduce crossings and then given
+//coordinates, the y of a node is pulled toward its drivers without overlapping the node
+//above it. Edges spanning several layers are not split into dummy nodes, a barycenter
+//takes the neighbors in any layer instead, so apart from sorting the layers every pass is
+//linear in the nodes and connections and designs with hundreds of thousands of nodes lay
+//out in well under a second. As in the schedule connections into DFF and REGISTER nodes
+//are not edges, and a combinational loop is broken where Kahn's algorithm stalls.
+//The result is recorded as one SET_POSITIONS command.
+
+#define LAYOUT_SWEEPS 4  //pairs of a down and an up sweep
+#define LAYOUT_LAYER_GAP 96.0f
+#define LAYOUT_NODE_GAP 16.0f
+//NOTE(Torin) Positions are multiples of the grid, with node sizes being multiples as well the
+//gaps between nodes line up with the cells of the wire router and stay free for wires
+#define LAYOUT_GRID_SIZE 16.0f
+
+struct LayoutKey {
+  float key;
+  uint32_t node;
+  uint32_t previous;  //index in the layer before the sort, breaks ties
+};
+
+static int CompareLayoutKeys(const void *a, const void *b){
+  const LayoutKey *x = (const LayoutKey *)a, *y = (const LayoutKey *)b;
+  if(x->key != y->key) return x->key < y->key ? -1 : 1;
+  return x->previous < y->previous ? -1 : (x->previous > y->previous);
+}
+
+//NOTE(Torin) Writes the top left of every node, origin is the top left of the layout.
+//EditorNode::scratch_index is the index of a laid out node and UINT32_MAX for the others
+void ComputeLayeredLayout(EditorNode **nodes, uint32_t count, ImVec2 origin, ImVec2 *positions, Editor *editor){
+  PROFILE_SCOPE("ComputeLayeredLayout");
+  if(count == 0) return;
+  it(i, editor->nodes.count) editor->nodes[i]->scratch_index = UINT32_MAX;
+  it(i, count) nodes[i]->scratch_index = i;
+
+  //NOTE(Torin) Successors and predecessors of every node as offsets into one edge array
+  uint32_t *succOffset = (uint32_t *)calloc(count * 2 + 2, sizeof(uint32_t));
+  uint32_t *predOffset = succOffset + count + 1;
+  size_t edgeCount = 0;
+  it(i, count){
+    EditorNode *node = nodes[i];
+    it(o, node->output_count){
+      DynamicArray<NodeConnection>& connections = node->output_connections[o];
+      it(c, connections.count){
+        EditorNode *dest = connections[c].node_index.node_ptr;
+        if(dest->scratch_index == UINT32_MAX || dest == node || !IsScheduleEdge(dest, connections[c].io_index)) continue;
+        succOffset[i + 1]++;
+        predOffset[dest->scratch_index + 1]++;
+        edgeCount++;
+      }
+    }
+  }
+  it(i, count){
+    succOffset[i + 1] += succOffset[i];
+    predOffset[i + 1] += predOffset[i];
+  }
+  uint32_t *succ = (uint32_t *)malloc(sizeof(uint32_t) * (edgeCount * 2 + 1));
+  uint32_t *pred = succ + edgeCount;
+  uint32_t *cursor = (uint32_t *)malloc(sizeof(uint32_t) * (count * 6 + 1));
+  uint32_t *layer = cursor + count;
+  uint32_t *queue = layer + count;
+  uint32_t *pending = queue + count;
+  uint32_t *layerOffset = pending + count;  //count + 1 is enough, layers never outnumber nodes
+  uint32_t *layerNodes = layerOffset + count + 1;
+  uint8_t *is_queued = (uint8_t *)calloc(count, 1);
+  memcpy(cursor, predOffset, sizeof(uint32_t) * count);
+  it(i, count){
+    EditorNode *node = nodes[i];
+    uint32_t next = succOffset[i];
+    it(o, node->output_count){
+      DynamicArray<NodeConnection>& connections = node->output_connections[o];
+      it(c, connections.count){
+        EditorNode *dest = connections[c].node_index.node_ptr;
+        if(dest->scratch_index == UINT32_MAX || dest == node || !IsScheduleEdge(dest, connections[c].io_index)) continue;
+        succ[next++] = dest->scratch_index;
+        pred[cursor[dest->scratch_index]++] = i;
+      }
+    }
+  }
+
+  //NOTE(Torin) Longest path layering, when the queue runs dry the remaining nodes are in or
+  //behind a loop and the first of them is released. Edges into a node that is already queued
+  //are back edges, so a node is only raised before it is queued and layers stay below count
+  uint32_t queueCount = 0, released = 0;
+  it(i, count){
+    layer[i] = 0;
+    pending[i] = predOffset[i + 1] - predOffset[i];
+    if(pending[i] == 0){
+      queue[queueCount++] = i;
+      is_queued[i] = 1;
+    }
+  }
+  uint32_t layerCount = 1;
+  for(uint32_t head = 0; head < count; head++){
+    if(head == queueCount){
+      while(is_queued[released]) released++;
+      queue[queueCount++] = released;
+      is_queued[released] = 1;
+    }
+    uint32_t v = queue[head];
+    for(uint32_t e = succOffset[v]; e < succOffset[v + 1]; e++){
+      uint32_t s = succ[e];
+      if(is_queued[s]) continue;
+      layer[s] = Max(layer[s], layer[v] + 1);
+      layerCount = Max(layerCount, layer[s] + 1);
+      if(--pending[s] == 0 && !is_queued[s]){
+        queue[queueCount++] = s;
+        is_queued[s] = 1;
+      }
+    }
+  }
+  assert(layerCount <= count);
+  it(i, count) if(nodes[i]->type == NodeType_OUTPUT) layer[i] = layerCount - 1;
+
+  //NOTE(Torin) Layers in queue order, which keeps connected nodes close to start with
+  memset(layerOffset, 0, sizeof(uint32_t) * (layerCount + 1));
+  it(i, count) layerOffset[layer[i] + 1]++;
+  it(l, layerCount) layerOffset[l + 1] += layerOffset[l];
+  memcpy(cursor, layerOffset, sizeof(uint32_t) * layerCount);
+  it(i, count){
+    uint32_t v = queue[i];
+    layerNodes[cursor[layer[v]]++] = v;
+  }
+
+  //NOTE(Torin) rank is the position of a node within its layer scaled to [0, 1) so layers
+  //of different sizes can be compared
+  float *rank = (float *)malloc(sizeof(float) * count);
+  LayoutKey *keys = (LayoutKey *)malloc(sizeof(LayoutKey) * count);
+  auto RankLayer = [&](uint32_t l){
+    uint32_t size = layerOffset[l + 1] - layerOffset[l];
+    for(uint32_t i = layerOffset[l]; i < layerOffset[l + 1]; i++) rank[layerNodes[i]] = (i - layerOffset[l] + 0.5f) / size;
+  };
+  it(l, layerCount) RankLayer(l);
+
+  for(uint32_t sweep = 0; sweep < LAYOUT_SWEEPS * 2; sweep++){
+    bool isDown = (sweep & 1) == 0;
+    const uint32_t *neighborOffset = isDown ? predOffset : succOffset;
+    const uint32_t *neighbors = isDown ? pred : succ;
+    for(uint32_t n = 0; n < layerCount; n++){
+      uint32_t l = isDown ? n : layerCount - 1 - n;
+      uint32_t first = layerOffset[l], size = layerOffset[l + 1] - first;
+      it(i, size){
+        uint32_t v = layerNodes[first + i];
+        float sum = 0.0f;
+        uint32_t neighborCount = neighborOffset[v + 1] - neighborOffset[v];
+        for(uint32_t e = neighborOffset[v]; e < neighborOffset[v + 1]; e++) sum += rank[neighbors[e]];
+        keys[i] = { neighborCount > 0 ? sum / neighborCount : rank[v], v, (uint32_t)i };
+      }
+      qsort(keys, size, sizeof(LayoutKey), CompareLayoutKeys);
+      it(i, size) layerNodes[first + i] = keys[i].node;
+      RankLayer(l);
+    }
+  }
+
+  //NOTE(Torin) Coordinates, layers are as wide as their widest node
+  origin.x = floorf(origin.x / LAYOUT_GRID_SIZE) * LAYOUT_GRID_SIZE;
+  origin.y = floorf(origin.y / LAYOUT_GRID_SIZE) * LAYOUT_GRID_SIZE;
+  float x = origin.x;
+  it(l, layerCount){
+    float width = 0.0f;
+    float top = origin.y;
+    for(uint32_t i = layerOffset[l]; i < layerOffset[l + 1]; i++){
+      uint32_t v = layerNodes[i];
+      EditorNode *node = nodes[v];
+      float sum = 0.0f;
+      uint32_t placedCount = 0;
+      for(uint32_t e = predOffset[v]; e < predOffset[v + 1]; e++){
+        if(layer[pred[e]] >= l) continue;
+        sum += positions[pred[e]].y + nodes[pred[e]]->size.y * 0.5f;
+        placedCount++;
+      }
+      float y = top;
+      if(placedCount > 0) y = Max(top, sum / placedCount - node->size.y * 0.5f);
+      y = ceilf(y / LAYOUT_GRID_SIZE) * LAYOUT_GRID_SIZE;
+      positions[v] = ImVec2(x, y);
+      top = y + node->size.y + LAYOUT_NODE_GAP;
+      width = Max(width, node->size.x);
+    }
+    x += ceilf(width / LAYOUT_GRID_SIZE) * LAYOUT_GRID_SIZE + LAYOUT_LAYER_GAP;
+  }
+
+  free(succOffset);
+  free(succ);
+  free(cursor);
+  free(is_queued);
+  free(rank);
+  free(keys);
+}
+
+//NOTE(Torin) Lays out the nodes starting at the top left corner of their current bounds
+void CommandArrangeNodes(const NodeIndex *indices, size_t count, Editor *editor){
+  if(count == 0) return;
+  PROFILE_SCOPE("CommandArrangeNodes");
+  EditorNode **nodes = (EditorNode **)malloc(sizeof(EditorNode *) * count);
+  ImVec2 *positions = (ImVec2 *)malloc(sizeof(ImVec2) * count);
+  NodePosition *moves = (NodePosition *)malloc(sizeof(NodePosition) * count);
+  ImVec2 origin = GetNode(indices[0], editor)->position;
+  it(i, count){
+    nodes[i] = GetNode(indices[i], editor);
+    origin.x = Min(origin.x, nodes[i]->position.x);
+    origin.y = Min(origin.y, nodes[i]->position.y);
+  }
+  ComputeLayeredLayout(nodes, count, origin, positions, editor);
+  it(i, count) moves[i] = { nodes[i]->id, 0.0f, 0.0f, positions[i].x, positions[i].y };
+  CommandSetNodePositions(moves, count, editor);
+  free(nodes);
+  free(positions);
+  free(moves);
+}
+
+void CommandArrangeAllNodes(Editor *editor){
+  NodeIndex *indices = (NodeIndex *)malloc(sizeof(NodeIndex) * (editor->nodes.count + 1));
+  it(i, editor->nodes.count){
+    indices[i].node_index = i;
+    indices[i].node_ptr = editor->nodes[i];
+  }
+  CommandArrangeNodes(indices, editor->nodes.count, editor);
+  free(indices);
+}
@@ -1,3 +1,6 @@
+#include "profiler.cpp"
+
+#define QUICKAPP_PROFILE_SCOPE(name) PROFILE_SCOPE(name)
 #define QUICKAPP_IMPLEMENTATION
 #define QUICKAPP_IMGUI
 #define QUICKAPP_RENDER
@@ -14,8 +17,29 @@ enum NodeType {
   NodeType_AND,
   NodeType_OR,
   NodeType_XOR,
+  NodeType_NOT,
+  NodeType_NAND,
+  NodeType_NOR,
+  NodeType_XNOR,
+  NodeType_BUF,
   NodeType_INPUT,
   NodeType_OUTPUT,
+  NodeType_DFF,
+  NodeType_REGISTER,
+  NodeType_CLOCK,
+  NodeType_WORD_AND,
+  NodeType_WORD_OR,
+  NodeType_WORD_XOR,
+  NodeType_WORD_ADD,
+  NodeType_WORD_SUB,
+  NodeType_WORD_COMPARE,
+  NodeType_WORD_SHL,
+  NodeType_WORD_SHR,
+  NodeType_WORD_MUX,
+  NodeType_WORD_SPLIT,
+  NodeType_WORD_MERGE,
+  NodeType_RAM,
+  NodeType_ROM,
   NodeType_COUNT,
 };
 
@@ -24,10 +48,33 @@ static const char *NodeName[] = {
   "AND",
   "OR",
   "XOR",
+  "NOT",
+  "NAND",
+  "NOR",
+  "XNOR",
+  "BUF",
   "INPUT",
   "OUTPUT",
+  "DFF",
+  "REGISTER",
+  "CLOCK",
+  "WAND",
+  "WOR",
+  "WXOR",
+  "ADD",
+  "SUB",
+  "CMP",
+  "SHL",
+  "SHR",
+  "MUX",
+  "SPLIT",
+  "MERGE",
+  "RAM",
+  "ROM",
 };
 
+#define REGISTER_MAX_WIDTH 64
+
 enum NodeState : uint8_t {
   NodeState_LOW,
   NodeState_HIGH,
@@ -35,6 +82,7 @@ enum NodeState : uint8_t {
 };
 
 struct EditorNode;
+struct MemoryStorage;
 
 struct NodeIndex {
   uint32_t node_index;
@@ -54,6 +102,13 @@ struct Node {
   NodeConnection *inputConnections;     
 };
 
+struct NetActivity {
+  uint64_t toggle_count;
+  uint64_t transition_count;  //every change including glitches, only counted by the timing simulator
+  uint64_t settled_value;
+  NodeState settled_state;
+};
+
 struct EditorNode {
   uint32_t type;
   size_t input_count;
@@ -62,12 +117,63 @@ struct EditorNode {
   
   NodeConnection *inputConnections;                 //NodeConnection[input_count]
   DynamicArray<NodeConnection> *output_connections; //DynamicArray<NodeConnection>[output_count]
+  NodeState *output_state;                          //NodeState[output_count]
+  NetActivity *output_activity;                     //NetActivity[output_count]
+  uint64_t *input_value;                            //uint64_t[input_count] bus value of each input
+  uint64_t *output_value;                           //uint64_t[output_count]
  
   ImVec2 position;
   ImVec2 size;
   NodeState signal_state;
+  uint8_t is_queued;
+  uint8_t is_selected;  //membership in Editor::selectedNodes
+
+  //NOTE(Torin) REGISTER, INPUT and OUTPUT bit count, word node bus width or CLOCK half
+  //period in ticks
+  uint32_t parameter;
+  uint64_t bus_value;  //value driven by a bus INPUT, signal_state is HIGH when any bit is set
+  //NOTE(Torin) Clock input of a DFF / REGISTER / RAM at its last latch, used to detect rising edges
+  NodeState clock_state;
+  MemoryStorage *memory;  //RAM and ROM contents
+
+  uint32_t step_evaluations;
+  uint64_t total_evaluations;
+
+  //NOTE(Torin) Handle into Editor::nodeTable, stays the same when a node is deleted and
+  //restored by undo so recorded commands never hold pointers
+  uint32_t id;
+  //NOTE(Torin) Dense index assigned by passes that need to remap editor->nodes
+  uint32_t scratch_index;
+  //NOTE(Torin) Component of the node in Editor::schedule
+  uint32_t scc_index;
+  //NOTE(Torin) Propagation delay in time units of the timing simulator, 0 uses the
+  //default delay of the node type
+  uint32_t delay;
+  uint32_t timing_index;
+  //NOTE(Torin) Slot of the node in Editor::timingAnalysis
+  uint32_t analysis_index;
+  //NOTE(Torin) Input the highlighted critical path enters this node through
+  uint32_t path_input;
+};
+
+//NOTE(Torin) Everything needed to recreate a node apart from its connections and its
+//simulation state (signal states, register contents). The RAM / ROM contents are kept
+//out of line, a NodeSet (see commands.cpp) stores memory_size bytes of them for the node
+struct NodeDescription {
+  uint32_t id;  //NODE_ID_NEW allocates the next id
+  uint32_t type;
+  uint32_t input_count;
+  uint32_t output_count;
+  uint32_t parameter;
+  uint32_t delay;
+  float x, y;
+  uint32_t memory_address_width;
+  uint32_t memory_data_width;
+  uint32_t memory_size;  //of the serialized contents, 0 for empty storage
 };
 
+static const uint32_t NODE_ID_NEW = UINT32_MAX;
+
 struct ICNodeConnection {
   uint32_t node_index;
   uint32_t io_index;
@@ -77,20 +183,59 @@ struct ICNode {
   uint32_t type;
   uint32_t input_count;
   uint32_t output_count;
+  float x, y;  //relative to the center of the IC, where the IC view draws the node
 
   NodeState *input_state;
   uint32_t *connection_count_per_output;
   ICNodeConnection *output_connections;
 };
 
+struct ICProgram;
+
 struct ICDefinition {
   uint32_t input_count;
   uint32_t output_count;
   uint32_t node_count;
   ICNode *nodes; 
+  ICProgram *program;
+
+  uint32_t *worklist;  //uint32_t[node_count]
+  uint8_t *is_queued;  //uint8_t[node_count]
+
+  uint64_t eval_count;
+  uint64_t eval_ticks;
+  uint64_t node_evaluations;
+  bool is_oscillating;
+};
+
+#define SIMULATION_STATS_HISTORY 128
+
+struct SimulationStats {
+  uint64_t step_count;
+
+  //NOTE(Torin) Counters for the step currently being simulated
+  uint32_t evaluations;
+  uint32_t redundant_evaluations;
+  uint32_t ic_evaluations;
+  uint32_t toggles;
+  uint32_t transitions;  //timing simulation only, includes glitches
+
+  uint64_t total_evaluations;
+  uint64_t total_redundant_evaluations;
+  uint64_t total_ic_evaluations;
+  uint64_t total_toggles;
+  uint64_t total_transitions;
+
+  float evaluation_history[SIMULATION_STATS_HISTORY];
+  float redundant_history[SIMULATION_STATS_HISTORY];
+  float toggle_history[SIMULATION_STATS_HISTORY];
 };
 
 #include "editor.cpp"
+#include "gates.cpp"
+#include "ic_compiler.cpp"
+#include "memory.cpp"
+#include "word.cpp"
 
 
 EditorNode *AllocateNode(uint32_t input_count, uint32_t output_count) {
@@ -101,6 +246,11 @@ EditorNode *AllocateNode(uint32_t input_count, uint32_t output_count) {
   required_memory += sizeof(NodeConnection) * input_count;
   required_memory = (required_memory + 0x3) & ~0x3;
   required_memory += sizeof(DynamicArray<NodeConnection>) * output_count;
+  required_memory += sizeof(NodeState) * output_count;
+  required_memory = (required_memory + 0x7) & ~0x7;
+  required_memory += sizeof(NetActivity) * output_count;
+  required_memory += sizeof(uint64_t) * input_count;
+  required_memory += sizeof(uint64_t) * output_count;
 
   EditorNode *node = (EditorNode *)malloc(required_memory);
   memset(node, 0, required_memory);
@@ -116,14 +266,83 @@ EditorNode *AllocateNode(uint32_t input_count, uint32_t output_count) {
   current += sizeof(NodeConnection) * input_count;
   current = (current + 0x3) & ~0x3;
   node->output_connections = (DynamicArray<NodeConnection> *)current;
+  current += sizeof(DynamicArray<NodeConnection>) * output_count;
+  node->output_state = (NodeState *)current;
+  current += sizeof(NodeState) * output_count;
+  current = (current + 0x7) & ~0x7;
+  node->output_activity = (NetActivity *)current;
+  current += sizeof(NetActivity) * output_count;
+  node->input_value = (uint64_t *)current;
+  current += sizeof(uint64_t) * input_count;
+  node->output_value = (uint64_t *)current;
 
-  //TODO(Torin) Proper node sizing
+  //NOTE(Torin) Tall enough to keep the slots of nodes with many inputs or outputs apart
   uint32_t largestIOCount = Max(input_count, output_count);
-  node->size = ImVec2(64, 64);
+  node->size = ImVec2(64, Max(64.0f, 16.0f * (largestIOCount + 1)));
 
   return node;
 }
 
+static inline
+bool IsSequentialNodeType(uint32_t type){
+  bool result = type == NodeType_DFF || type == NodeType_REGISTER || type == NodeType_CLOCK || type == NodeType_RAM;
+  return result;
+}
+
+#include "ic_library.cpp"
+
+EditorNode *CreateNodeFromDescription(const NodeDescription *description, Editor *editor){
+  auto node = AllocateNode(description->input_count, description->output_count);
+  node->type = description->type;
+  node->parameter = description->parameter;
+  node->delay = description->delay;
+  node->position = ImVec2(description->x, description->y);
+  node->id = description->id;
+  if(node->id == NODE_ID_NEW){
+    node->id = editor->nodeTable.count;
+    ArrayAdd(node, editor->nodeTable);
+  } else {
+    //NOTE(Torin) Ids past the table come from replaying a saved journal
+    size_t capacity = editor->nodeTable.capacity * 2;
+    if(editor->nodeTable.capacity <= node->id) ArrayReserve(capacity > node->id ? capacity : node->id + 1, editor->nodeTable);
+    while(editor->nodeTable.count <= node->id) ArrayAdd((EditorNode *)nullptr, editor->nodeTable);
+    assert(editor->nodeTable[node->id] == nullptr);
+    editor->nodeTable[node->id] = node;
+  }
+
+  ArrayAdd(node, editor->nodes);
+  InvalidateTopology(editor);
+  if(node->type == NodeType_INPUT){
+    ArrayAdd(node, editor->inputs);
+  }
+  if(IsMemoryNodeType(node->type)){
+    node->memory = CreateMemoryStorage(description->memory_address_width, description->memory_data_width);
+  }
+  if(IsSequentialNodeType(node->type)){
+    ArrayAdd(node, editor->sequentialNodes);
+    node->clock_state = NodeState_NONE;
+  }
+  return node;
+}
+
+static inline
+NodeDescription DescribeNode(const EditorNode *node){
+  NodeDescription result = {};
+  result.id = node->id;
+  result.type = node->type;
+  result.input_count = node->input_count;
+  result.output_count = node->output_count;
+  result.parameter = node->parameter;
+  result.delay = node->delay;
+  result.x = node->position.x;
+  result.y = node->position.y;
+  if(node->memory != nullptr){
+    result.memory_address_width = node->memory->address_width;
+    result.memory_data_width = node->memory->data_width;
+  }
+  return result;
+}
+
 EditorNode *CreateNode(uint32_t node_type, Editor *editor){
   uint32_t input_count = 0, output_count = 0;
   switch(node_type){
@@ -133,28 +352,60 @@ EditorNode *CreateNode(uint32_t node_type, Editor *editor){
     case NodeType_OUTPUT:{
       input_count = 1;
     }break;
+    case NodeType_DFF:{
+      input_count = 2;
+      output_count = 1;
+    }break;
+    case NodeType_REGISTER:{
+      //NOTE(Torin) D inputs for every bit or a single bus D input followed by the clock input
+      output_count = editor->busRegisters ? 1 : Min(Max(editor->registerWidth, 1), REGISTER_MAX_WIDTH);
+      input_count = output_count + 1;
+    }break;
+    case NodeType_CLOCK:{
+      output_count = 1;
+    }break;
+    case NodeType_RAM:{
+      //NOTE(Torin) address, data, write enable, clock
+      input_count = 4;
+      output_count = 1;
+    }break;
+    case NodeType_ROM:{
+      input_count = 1;
+      output_count = 1;
+    }break;
 
     default:{
-      if(node_type > NodeType_COUNT){
+      if(IsWordNodeType(node_type)){
+        GetWordNodeIOCount(node_type, Min(Max(editor->busWidth, 1), BUS_MAX_WIDTH), &input_count, &output_count);
+      } else if(node_type > NodeType_COUNT){
         uint32_t ic_index = node_type - (NodeType_COUNT + 1);
         ICDefinition *ic = editor->icdefs[ic_index];
         input_count = ic->input_count;
         output_count = ic->output_count;
       } else {
-        input_count = 2;
+        input_count = GetGateInputCount(node_type, editor->gateInputCount);
         output_count = 1;
       }
     }break;
 
   }
 
-  auto node = AllocateNode(input_count, output_count);
-  node->type = node_type;
-  ArrayAdd(node, editor->nodes);
-  if(node->type == NodeType_INPUT){
-    ArrayAdd(node, editor->inputs);
+  NodeDescription description = {};
+  description.id = NODE_ID_NEW;
+  description.type = node_type;
+  description.input_count = input_count;
+  description.output_count = output_count;
+  if(IsWordNodeType(node_type)){
+    description.parameter = Min(Max(editor->busWidth, 1), BUS_MAX_WIDTH);
   }
-  return node;
+  if(IsMemoryNodeType(node_type)){
+    description.memory_address_width = Min(Max(editor->memoryAddressWidth, 1), MEMORY_MAX_ADDRESS_WIDTH);
+    description.memory_data_width = Min(Max(editor->memoryDataWidth, 1), BUS_MAX_WIDTH);
+  }
+  if(node_type == NodeType_REGISTER) description.parameter = Min(Max(editor->registerWidth, 1), REGISTER_MAX_WIDTH);
+  if(node_type == NodeType_INPUT || node_type == NodeType_OUTPUT) description.parameter = Min(Max(editor->portWidth, 1), BUS_MAX_WIDTH);
+  if(node_type == NodeType_CLOCK) description.parameter = Max(editor->clockHalfPeriod, 1);
+  return CreateNodeFromDescription(&description, editor);
 }
 
 
@@ -226,53 +477,224 @@ EditorNode *GetNode(NodeIndex index, Editor *editor){
   return index.node_ptr;
 }
 
+//NOTE(Torin) Editor::selectedNodes lists the selection, EditorNode::is_selected answers
+//membership in O(1)
 static inline
-void DeleteNode(NodeIndex index, Editor *editor){
-  EditorNode *node = index.node_ptr;
-
-  for(size_t i = 0; i < node->input_count; i++){
-    NodeConnection *connection = &node->inputConnections[i];
-    if(IsValid(connection->node_index) == false) continue;
-    EditorNode *inputSource = GetNode(connection->node_index, editor);
-    bool wasConnectionRemoved = false;
-
-    DynamicArray<NodeConnection> &sourceConnections = inputSource->output_connections[connection->io_index];
-    for(size_t n = 0; n < sourceConnections.count; n++){
-      const NodeConnection *sourceConnection = &sourceConnections[n];
-      if((sourceConnection->node_index == index) && sourceConnection->io_index == i){
-        ArrayRemoveAtIndexUnordered(n, sourceConnections);
-        wasConnectionRemoved = true;              
+void ClearSelection(Editor *editor){
+  it(i, editor->selectedNodes.count) editor->selectedNodes[i].node_ptr->is_selected = 0;
+  editor->selectedNodes.count = 0;
+}
+
+static inline
+void SelectNode(NodeIndex index, Editor *editor){
+  EditorNode *node = GetNode(index, editor);
+  if(node->is_selected) return;
+  node->is_selected = 1;
+  ArrayAdd(index, editor->selectedNodes);
+}
+
+static inline
+void MoveSelectedNodes(ImVec2 delta, Editor *editor){
+  it(i, editor->selectedNodes.count) editor->selectedNodes[i].node_ptr->position += delta;
+}
+
+//NOTE(Torin) Deletes a batch of nodes in time linear in the nodes and their connections,
+//EditorNode::scratch_index marks the deleted nodes (1) and the surviving sources whose
+//output connections were already filtered (2)
+void DeleteNodes(const NodeIndex *indices, size_t count, Editor *editor){
+  if(count == 0) return;
+  it(i, editor->nodes.count) editor->nodes[i]->scratch_index = 0;
+  it(i, count) GetNode(indices[i], editor)->scratch_index = 1;
+
+  it(i, count){
+    EditorNode *node = GetNode(indices[i], editor);
+    it(n, node->input_count){
+      NodeConnection *connection = &node->inputConnections[n];
+      if(IsValid(connection->node_index) == false) continue;
+      EditorNode *source = GetNode(connection->node_index, editor);
+      if(source->scratch_index != 0) continue;
+      source->scratch_index = 2;
+      it(outputIndex, source->output_count){
+        DynamicArray<NodeConnection>& connections = source->output_connections[outputIndex];
+        size_t keptCount = 0;
+        it(c, connections.count){
+          if(connections[c].node_index.node_ptr->scratch_index == 1) continue;
+          connections.data[keptCount++] = connections[c];
+        }
+        connections.count = keptCount;
       }
     }
-    assert(wasConnectionRemoved && "inputConnection did not match any outputConnection");
-  }
 
-  for(size_t outputIndex = 0; outputIndex < node->output_count; outputIndex++){
-    DynamicArray<NodeConnection>& connections = node->output_connections[outputIndex];
-    for(size_t i = 0; i < connections.count; i++){
-      NodeConnection *connection = &connections[i];
-      EditorNode *connectionDest = GetNode(connection->node_index, editor);
-      connectionDest->inputConnections[connection->io_index].node_index = InvalidNodeIndex();
+    it(outputIndex, node->output_count){
+      DynamicArray<NodeConnection>& connections = node->output_connections[outputIndex];
+      it(c, connections.count){
+        EditorNode *dest = GetNode(connections[c].node_index, editor);
+        if(dest->scratch_index != 1) dest->inputConnections[connections[c].io_index].node_index = InvalidNodeIndex();
+      }
     }
   }
 
-  for(size_t i = 0; i < node->output_count; i++){
-    ArrayDestroy(node->output_connections[i]);
+  //NOTE(Torin) indices may be the selection itself so it is not read past this point,
+  //the deleted nodes are freed while compacting editor->nodes
+  size_t keptSelectionCount = 0;
+  it(i, editor->selectedNodes.count){
+    if(editor->selectedNodes[i].node_ptr->scratch_index == 1) continue;
+    editor->selectedNodes.data[keptSelectionCount++] = editor->selectedNodes[i];
+  }
+  editor->selectedNodes.count = keptSelectionCount;
+
+  DynamicArray<EditorNode *>& nodeTable = editor->nodeTable;
+  auto RemoveMarkedNodes = [&nodeTable](DynamicArray<EditorNode *>& nodes, bool freeNodes){
+    size_t keptCount = 0;
+    it(i, nodes.count){
+      EditorNode *node = nodes[i];
+      if(node->scratch_index != 1){
+        nodes.data[keptCount++] = node;
+      } else if(freeNodes){
+        nodeTable[node->id] = nullptr;
+        it(outputIndex, node->output_count) ArrayDestroy(node->output_connections[outputIndex]);
+        DestroyMemoryStorage(node->memory);
+        free(node);
+      }
+    }
+    nodes.count = keptCount;
+  };
+  RemoveMarkedNodes(editor->inputs, false);
+  RemoveMarkedNodes(editor->sequentialNodes, false);
+  RemoveMarkedNodes(editor->nodes, true);
+  InvalidateTopology(editor);
+}
+
+//NOTE(Torin) Packs the nodes into a new ICDefinition and replaces them with an instance of it,
+//ICNodes are ordered inputs, outputs then logic and EditorNode::scratch_index holds the ICNode
+//index of every packed node (UINT32_MAX otherwise) so connections are remapped in O(1),
+//connections leaving the packed nodes are dropped. An identical IC that already exists is
+//instanced instead of adding a definition
+EditorNode *CreateICFromNodes(const NodeIndex *indices, size_t count, Editor *editor){
+  PROFILE_SCOPE("CreateICFromNodes");
+  DynamicArray<EditorNode *> icNodes = {};
+  ArrayReserve(count, icNodes);
+  ImVec2 averagePosition;
+  uint32_t inputCount = 0, outputCount = 0;
+  it(i, editor->nodes.count) editor->nodes[i]->scratch_index = UINT32_MAX;
+  it(pass, 3){
+    it(i, count){
+      EditorNode *node = GetNode(indices[i], editor);
+      size_t nodePass = node->type == NodeType_INPUT ? 0 : (node->type == NodeType_OUTPUT ? 1 : 2);
+      if(nodePass != pass) continue;
+      node->scratch_index = icNodes.count;
+      ArrayAdd(node, icNodes);
+      averagePosition += node->position;
+      if(pass == 0) inputCount++;
+      if(pass == 1) outputCount++;
+    }
+  }
+  averagePosition /= (float)count;
+
+  //NOTE(Torin) Only connections between packed nodes are stored
+  size_t required_memory = sizeof(ICDefinition);
+  it(i, icNodes.count){
+    EditorNode *node = icNodes[i];
+    required_memory += sizeof(ICNode);
+    required_memory += node->input_count * sizeof(NodeState);
+    required_memory += node->output_count * sizeof(uint32_t);
+    it(n, node->output_count){
+      DynamicArray<NodeConnection>& connections = node->output_connections[n];
+      it(c, connections.count){
+        if(connections[c].node_index.node_ptr->scratch_index != UINT32_MAX) required_memory += sizeof(ICNodeConnection);
+      }
+    }
   }
 
-  ArrayRemoveValueUnordered(node, editor->nodes);
-  if(node->type == NodeType_INPUT){
-    ArrayRemoveValueUnordered(node, editor->inputs);
+  ICDefinition *icdef = (ICDefinition *)calloc(required_memory, 1);
+  icdef->input_count = inputCount;
+  icdef->output_count = outputCount;
+  icdef->node_count = icNodes.count;
+
+  MStack mstack = {};
+  mstack.base = (uintptr_t)(icdef + 1);
+  mstack.size = required_memory - sizeof(ICDefinition);
+  icdef->nodes = MStackPushArray(ICNode, icdef->node_count, &mstack);
+
+  it(i, icNodes.count){
+    EditorNode *ed_node = icNodes[i];
+    ICNode *ic_node = &icdef->nodes[i];
+    ic_node->type = ed_node->type;
+    ic_node->input_count = ed_node->input_count;
+    ic_node->output_count = ed_node->output_count;
+    ic_node->x = ed_node->position.x - averagePosition.x;
+    ic_node->y = ed_node->position.y - averagePosition.y;
+    if(ic_node->input_count > 0){
+      ic_node->input_state = MStackPushArray(NodeState, ic_node->input_count, &mstack);
+    }
+    if(ic_node->output_count == 0) continue;
+
+    ic_node->connection_count_per_output = MStackPushArray(uint32_t, ic_node->output_count, &mstack);
+    size_t totalConnectionCount = 0;
+    it(n, ic_node->output_count){
+      DynamicArray<NodeConnection>& connections = ed_node->output_connections[n];
+      uint32_t internalCount = 0;
+      it(c, connections.count){
+        if(connections[c].node_index.node_ptr->scratch_index != UINT32_MAX) internalCount++;
+      }
+      ic_node->connection_count_per_output[n] = internalCount;
+      totalConnectionCount += internalCount;
+    }
+    ic_node->output_connections = MStackPushArray(ICNodeConnection, totalConnectionCount, &mstack);
+
+    size_t currentConnectionIndex = 0;
+    it(n, ic_node->output_count){
+      DynamicArray<NodeConnection>& connections = ed_node->output_connections[n];
+      it(c, connections.count){
+        uint32_t connectedNodeIndex = connections[c].node_index.node_ptr->scratch_index;
+        if(connectedNodeIndex == UINT32_MAX) continue;
+        ICNodeConnection icConnection = {};
+        icConnection.node_index = connectedNodeIndex;
+        icConnection.io_index = connections[c].io_index;
+        ic_node->output_connections[currentConnectionIndex++] = icConnection;
+      }
+    }
   }
 
-  free(node);
+  CanonicalizeICDefinition(icdef);
+  uint32_t ic_index = AddICDefinition(icdef, nullptr, editor);
+  DeleteNodes(indices, count, editor);
+  ArrayDestroy(icNodes);
 
+  uint32_t node_type = NodeType_COUNT + 1 + ic_index;
+  EditorNode *node = CreateNode(node_type, editor);
+  node->position = averagePosition;
+  return node;
+}
 
-  //NodeBlock *block = editor->nodeBlocks[index.block_index];
-  //block->isOccupied[index.node_index] = 0;
-  //ArrayDestroy(block->nodes[index.node_index].outputConnections);
-  //memset(&block->nodes[index.node_index], 0, sizeof(EditorNode));
-  //block->currentOccupiedCount -= 1;
+void ConnectNodes(EditorNode *source, uint32_t output, EditorNode *dest, uint32_t input, Editor *editor){
+  assert(IsValid(dest->inputConnections[input].node_index) == false);
+  NodeConnection outputToInput = {};
+  outputToInput.node_index.node_index = dest->id;
+  outputToInput.node_index.node_ptr = dest;
+  outputToInput.io_index = input;
+  ArrayAdd(outputToInput, source->output_connections[output]);
+
+  NodeConnection inputToOutput = {};
+  inputToOutput.node_index.node_index = source->id;
+  inputToOutput.node_index.node_ptr = source;
+  inputToOutput.io_index = output;
+  dest->inputConnections[input] = inputToOutput;
+  InvalidateTopology(editor);
+}
+
+void DisconnectNodeInput(EditorNode *dest, uint32_t input, Editor *editor){
+  NodeConnection *connection = &dest->inputConnections[input];
+  if(IsValid(connection->node_index) == false) return;
+  DynamicArray<NodeConnection>& sourceConnections = GetNode(connection->node_index, editor)->output_connections[connection->io_index];
+  it(i, sourceConnections.count){
+    if(sourceConnections[i].node_index.node_ptr == dest && sourceConnections[i].io_index == input){
+      ArrayRemoveAtIndexUnordered(i, sourceConnections);
+      break;
+    }
+  }
+  connection->node_index = InvalidNodeIndex();
+  InvalidateTopology(editor);
 }
 
 void RemoveNodeOutputConnections(EditorNode *node, Editor *editor){
@@ -283,26 +705,75 @@ void RemoveNodeOutputConnections(EditorNode *node, Editor *editor){
       auto dest = GetNode(connection->node_index, editor);
       dest->inputConnections[connection->io_index].node_index = InvalidNodeIndex();
     }
+    node->output_connections[outputIndex].count = 0;
   }
+  InvalidateTopology(editor);
 }
 
-static inline void SimulateNode(EditorNode *node, Editor *editor);
+//NOTE(Torin) Propagation uses an explicit FIFO worklist instead of recursing into
+//connected nodes so arbitrarily deep designs cannot overflow the stack, a node is only
+//queued once at a time which bounds the worklist by the node count
+//Nodes outside of the feedback loop currently being iterated are only flagged, they
+//are evaluated when RunNodeSchedule reaches their component
+static inline
+void EnqueueNode(EditorNode *node, Editor *editor){
+  if(node->is_queued) return;
+  node->is_queued = 1;
+  if(node->scc_index != editor->schedule.active_component) return;
+  NodeWorklist *worklist = &editor->worklist;
+  assert(worklist->count < worklist->capacity);
+  worklist->nodes[(worklist->head + worklist->count) % worklist->capacity] = node;
+  worklist->count++;
+}
 
 static inline
-void TransmitOutputAndSimulateConnectedNodes(EditorNode *node, uint32_t output_index, uint8_t outputState, Editor *editor){
-  assert(outputState != NodeState_NONE);
+EditorNode *DequeueNode(Editor *editor){
+  NodeWorklist *worklist = &editor->worklist;
+  assert(worklist->count > 0);
+  EditorNode *node = worklist->nodes[worklist->head];
+  worklist->head = (worklist->head + 1) % worklist->capacity;
+  worklist->count--;
+  node->is_queued = 0;
+  return node;
+}
+
+static inline
+void ReserveWorklist(Editor *editor){
+  NodeWorklist *worklist = &editor->worklist;
+  assert(worklist->count == 0);
+  if(worklist->capacity >= editor->nodes.count && worklist->capacity > 0) return;
+  worklist->capacity = editor->nodes.count + 64;
+  worklist->nodes = (EditorNode **)realloc(worklist->nodes, sizeof(EditorNode *) * worklist->capacity);
+  worklist->head = 0;
+}
+
+//NOTE(Torin) Single bit outputs transmit their NodeState as the value
+static inline
+void TransmitWordAndQueueConnectedNodes(EditorNode *node, uint32_t output_index, uint64_t value, Editor *editor){
   assert(output_index < node->output_count);
-  node->signal_state = (NodeState)outputState;
+  NodeState outputState = value ? NodeState_HIGH : NodeState_LOW;
+  node->signal_state = outputState;
+  node->output_state[output_index] = outputState;
+  node->output_value[output_index] = value;
 
   DynamicArray<NodeConnection>& outputConnections = node->output_connections[output_index];
   it(i, outputConnections.count){
     NodeConnection *connection = &outputConnections[i];
     auto connectedNode = GetNode(connection->node_index, editor);
-    connectedNode->input_state[connection->io_index] = (NodeState)outputState;
-    SimulateNode(connectedNode, editor);
+    if(connectedNode->input_state[connection->io_index] == outputState &&
+      connectedNode->input_value[connection->io_index] == value) continue;
+    connectedNode->input_state[connection->io_index] = outputState;
+    connectedNode->input_value[connection->io_index] = value;
+    EnqueueNode(connectedNode, editor);
   }
 }
 
+static inline
+void TransmitOutputAndQueueConnectedNodes(EditorNode *node, uint32_t output_index, uint8_t outputState, Editor *editor){
+  assert(outputState != NodeState_NONE);
+  TransmitWordAndQueueConnectedNodes(node, output_index, outputState, editor);
+}
+
 static inline
 uint64_t GetNodeOutputState(const uint32_t type, const NodeState *inputState, const size_t inputCount, uint8_t *outputState){
   switch(type){
@@ -318,47 +789,48 @@ uint64_t GetNodeOutputState(const uint32_t type, const NodeState *inputState, co
       *outputState = (inputState[0] == NodeState_NONE) ? NodeState_LOW : inputState[0];
     }break;
 
-    case NodeType_AND:{
-      if(inputState[0] == NodeState_NONE) return 0;
-      if(inputState[1] == NodeState_NONE) return 0;
-      *outputState = inputState[0] & inputState[1];
-    }break;
-
-    case NodeType_OR:{
-      if(inputState[0] == NodeState_NONE) return 0;
-      if(inputState[1] == NodeState_NONE) return 0;
-      *outputState = inputState[0] | inputState[1];
-    }break;
-
-    case NodeType_XOR:{
-      if(inputState[0] == NodeState_NONE) return 0;
-      if(inputState[1] == NodeState_NONE) return 0;
-      *outputState = inputState[0] ^ inputState[1];
-    }break;
-
     default:{
-      assert(false);
+      NodeState result = EvaluateGate(GetGateInfo(type)->truth, inputState, inputCount);
+      if(result == NodeState_NONE) return 0;
+      *outputState = result;
     };
   }
 
   return 1;
 }
 
-static inline void SimulateICNode(ICNode *node, ICDefinition *icdef);
+static inline
+NodeState GetClockState(uint32_t half_period, uint64_t tick){
+  NodeState result = ((tick / half_period) & 1) ? NodeState_HIGH : NodeState_LOW;
+  return result;
+}
 
+//NOTE(Torin) IC internals use the same worklist scheme as editor nodes with a FIFO
+//of ICNode indices owned by the definition, the internal state persists between
+//instances evaluated in the same step so only nodes whose inputs differ are requeued
+static inline
+void AllocateICWorklist(ICDefinition *icdef){
+  icdef->worklist = (uint32_t *)malloc(sizeof(uint32_t) * icdef->node_count);
+  icdef->is_queued = (uint8_t *)calloc(icdef->node_count, 1);
+}
 
 static inline
-void TransmitICNodeOutputAndSimulateConnectedNodes(ICNode *node, size_t outputSlot, uint8_t signal, ICDefinition *icdef){
+void TransmitICNodeOutputAndQueueConnectedNodes(ICNode *node, size_t outputSlot, uint8_t signal, ICDefinition *icdef, uint32_t *queueTail){
   for(size_t n = 0; n < node->connection_count_per_output[outputSlot]; n++){
     ICNodeConnection *connection = &node->output_connections[n]; 
     ICNode *connectedNode = &icdef->nodes[connection->node_index];
+    if(connectedNode->input_state[connection->io_index] == signal) continue;
     connectedNode->input_state[connection->io_index] = (NodeState)signal;
-    SimulateICNode(connectedNode, icdef);
+    if(icdef->is_queued[connection->node_index]) continue;
+    icdef->is_queued[connection->node_index] = 1;
+    icdef->worklist[*queueTail % icdef->node_count] = connection->node_index;
+    *queueTail += 1;
   }
 }
 
 static inline
-void SimulateICNode(ICNode *node, ICDefinition *icdef){
+void SimulateICNode(ICNode *node, ICDefinition *icdef, uint32_t *queueTail){
+  icdef->node_evaluations++;
   switch(node->type){
 
     case NodeType_OUTPUT:{
@@ -374,49 +846,114 @@ void SimulateICNode(ICNode *node, ICDefinition *icdef){
       uint8_t outputState = 0;
       if(GetNodeOutputState(node->type, node->input_state, node->input_count, &outputState)){
         assert(node->output_count == 1);
-
-        for(size_t n = 0; n < node->connection_count_per_output[0]; n++){
-          ICNodeConnection *connection = &node->output_connections[n]; 
-          ICNode *connectedNode = &icdef->nodes[connection->node_index];
-          connectedNode->input_state[connection->io_index] = (NodeState)outputState;
-          SimulateICNode(connectedNode, icdef);
-        }
+        TransmitICNodeOutputAndQueueConnectedNodes(node, 0, outputState, icdef, queueTail);
       }
     } break;
   }
 }
 
+//NOTE(Torin) An IC containing a feedback loop gives up after iteration_limit
+//evaluations per ICNode and flags the definition as oscillating
 static inline
-void SimulateIC(ICDefinition *icdef, NodeState *inputs, NodeState *outputs){
+void SimulateIC(ICDefinition *icdef, NodeState *inputs, NodeState *outputs, uint32_t iteration_limit){
+  PROFILE_SCOPE("SimulateIC");
   for(size_t i = 0; i < icdef->input_count; i++)
     if(inputs[i] == NodeState_NONE) return;
 
+  uint64_t beginTicks = ProfilerTimestamp();
+
+  if(icdef->worklist == nullptr) AllocateICWorklist(icdef);
+
   //TODO(Torin) This should just emit outputs! 
   //NOTE(Torin) The first (input_count) nodes are inputs 
+  uint32_t queueHead = 0, queueTail = 0;
   for(size_t i = 0; i < icdef->input_count; i++){
     ICNode *node = &icdef->nodes[i];
     assert(node->type == NodeType_INPUT);
-    TransmitICNodeOutputAndSimulateConnectedNodes(node, 0, inputs[i], icdef);
+    TransmitICNodeOutputAndQueueConnectedNodes(node, 0, inputs[i], icdef, &queueTail);
+  }
+
+  uint64_t budget = (uint64_t)icdef->node_count * iteration_limit;
+  uint64_t evaluations = 0;
+  icdef->is_oscillating = false;
+  while(queueHead != queueTail){
+    uint32_t index = icdef->worklist[queueHead % icdef->node_count];
+    queueHead++;
+    icdef->is_queued[index] = 0;
+    if(evaluations++ == budget){
+      icdef->is_oscillating = true;
+      continue;
+    }
+    SimulateICNode(&icdef->nodes[index], icdef, &queueTail);
   }
 
   for(size_t i = 0; i < icdef->output_count; i++){
     const ICNode *ic_outputs = icdef->nodes + icdef->input_count;
     outputs[i] = ic_outputs[i].input_state[0];
   }
+
+  icdef->eval_count++;
+  icdef->eval_ticks += ProfilerTimestamp() - beginTicks;
 }
 
 static inline
 void SimulateNode(EditorNode *node, Editor *editor){
+  PROFILE_SCOPE("SimulateNode");
+  node->step_evaluations++;
+  node->total_evaluations++;
+  editor->stats.evaluations++;
+  if(node->step_evaluations > 1) editor->stats.redundant_evaluations++;
+
   switch(node->type){
     
     case NodeType_INPUT: {
-      TransmitOutputAndSimulateConnectedNodes(node, 0, node->signal_state, editor); 
+      if(GetPortWidth(node, false, 0) > 1) TransmitWordAndQueueConnectedNodes(node, 0, node->bus_value, editor);
+      else TransmitOutputAndQueueConnectedNodes(node, 0, node->signal_state, editor);
     }break;
 
     case NodeType_OUTPUT:{
       node->signal_state = (node->input_state[0] == NodeState_NONE) ? NodeState_LOW : node->input_state[0];
     }break;
 
+    //NOTE(Torin) Sequential outputs only change in LatchSequentialNodes at the end of a step
+    case NodeType_DFF:
+    case NodeType_REGISTER:{
+      for(size_t i = 0; i < node->output_count; i++){
+        TransmitWordAndQueueConnectedNodes(node, i, GetOutputWord(node, i), editor);
+      }
+    }break;
+
+    case NodeType_CLOCK:{
+      TransmitOutputAndQueueConnectedNodes(node, 0, GetClockState(node->parameter, editor->clockTick), editor);
+    }break;
+
+    //NOTE(Torin) Reads are combinational, RAM writes happen in LatchSequentialNodes
+    case NodeType_RAM:
+    case NodeType_ROM:{
+      if(node->input_state[0] == NodeState_NONE) return;
+      TransmitWordAndQueueConnectedNodes(node, 0, ReadMemoryWord(node->memory, node->input_value[0]), editor);
+    }break;
+
+    case NodeType_WORD_AND:
+    case NodeType_WORD_OR:
+    case NodeType_WORD_XOR:
+    case NodeType_WORD_ADD:
+    case NodeType_WORD_SUB:
+    case NodeType_WORD_COMPARE:
+    case NodeType_WORD_SHL:
+    case NodeType_WORD_SHR:
+    case NodeType_WORD_MUX:
+    case NodeType_WORD_SPLIT:
+    case NodeType_WORD_MERGE:{
+      for(size_t i = 0; i < node->input_count; i++)
+        if(node->input_state[i] == NodeState_NONE) return;
+      for(size_t i = 0; i < node->output_count; i++){
+        uint32_t parameter = 0;
+        WordOp op = GetWordOutputOp(node->type, i, node->parameter, &parameter);
+        uint64_t value = EvaluateWordOp(op, parameter, node->input_value, node->input_count);
+        TransmitWordAndQueueConnectedNodes(node, i, value, editor);
+      }
+    }break;
 
     default:{
 
@@ -430,16 +967,21 @@ void SimulateNode(EditorNode *node, Editor *editor){
         assert(node->input_count == ic->input_count);
         assert(node->output_count > 0);
         NodeState outputs[node->output_count];
-        SimulateIC(ic, node->input_state, outputs);
+        editor->stats.ic_evaluations++;
+        if(editor->useCompiledICs && ic->program != nullptr){
+          SimulateCompiledIC(ic, node->input_state, outputs);
+        } else {
+          SimulateIC(ic, node->input_state, outputs, Max(editor->loopIterationLimit, 1));
+        }
         for(size_t i = 0; i < node->output_count; i++){
-          TransmitOutputAndSimulateConnectedNodes(node, i, outputs[i], editor);
+          TransmitOutputAndQueueConnectedNodes(node, i, outputs[i], editor);
         }
 
 
       } else {
         uint8_t output_state;
         if(GetNodeOutputState(node->type, node->input_state, node->input_count, &output_state)){
-          TransmitOutputAndSimulateConnectedNodes(node, 0, output_state, editor);
+          TransmitOutputAndQueueConnectedNodes(node, 0, output_state, editor);
         }
       }
     }break;
@@ -503,11 +1045,45 @@ void iterate_nodes(Editor *editor, std::function<void(EditorNode*, NodeIndex)> p
 //TODO(Torin) Why should this care about an editor ptr
 //Just directly pass the node block array it signals intent better
 
+#include "sim_stats.cpp"
+#include "schedule.cpp"
+#include "netlist.cpp"
+#include "netlist_optimizer.cpp"
+
+//NOTE(Torin) Rebuilds the flattened netlist when the topology changed or when an
+//input that the optimizer folded to a constant was toggled
+//returns false if the design cannot be levelized
+static bool UpdateNetlist(Editor *editor){
+  if(editor->netlist == nullptr){
+    editor->netlist = (Netlist *)calloc(1, sizeof(Netlist));
+    editor->netlist->topology_version = editor->topologyVersion - 1;
+  }
 
-static inline
-void SimulationStep(Editor *editor){
-  iterate_nodes(editor, [](EditorNode *node){
-    memset(node->input_state, NodeState_NONE, node->input_count * sizeof(NodeState));
+  Netlist *netlist = editor->netlist;
+  bool isOutOfDate = netlist->topology_version != editor->topologyVersion;
+  it(i, netlist->folded_inputs.count){
+    FoldedInput *folded = &netlist->folded_inputs[i];
+    if(folded->node->signal_state != folded->state) isOutOfDate = true;
+  }
+
+  if(isOutOfDate){
+    BuildNetlist(netlist, editor);
+    if(LevelizeNetlist(netlist) && editor->optimizeNetlist){
+      NetlistOptimizerSettings settings = {};
+      settings.fold_stable_inputs = editor->foldStableInputs;
+      OptimizeNetlist(netlist, &settings);
+    }
+  }
+  return netlist->is_levelized;
+}
+
+
+static void SimulateEventDriven(Editor *editor){
+  UpdateNodeSchedule(editor);
+  editor->schedule.active_component = UINT32_MAX;
+  iterate_nodes(editor, [editor](EditorNode *node){
+    ResetNodeInputs(node, &editor->schedule);
+    node->step_evaluations = 0;
   });
 
   for(size_t ic_index = 0; ic_index < editor->icdefs.count; ic_index++){
@@ -521,20 +1097,356 @@ void SimulationStep(Editor *editor){
   }
   
 
+  ReserveWorklist(editor);
   for(size_t i = 0; i < editor->inputs.count; i++){
     EditorNode *node = editor->inputs[i];
-    SimulateNode(node, editor);
+    EnqueueNode(node, editor);
+  }
+  for(size_t i = 0; i < editor->sequentialNodes.count; i++){
+    EditorNode *node = editor->sequentialNodes[i];
+    EnqueueNode(node, editor);
+  }
+
+  RunNodeSchedule(editor);
+}
+
+#include "sequential.cpp"
+#include "timing.cpp"
+#include "timing_analysis.cpp"
+#include "vectors.cpp"
+#include "faults.cpp"
+#include "sat.cpp"
+#include "equivalence.cpp"
+#include "commands.cpp"
+#include "clipboard.cpp"
+#include "autosave.cpp"
+#include "layout.cpp"
+#include "canvas.cpp"
+#include "router.cpp"
+#include "ic_view.cpp"
+
+//NOTE(Torin) The runner and the fault simulation are created again the next time the
+//Test vectors panel is drawn
+static void DestroyTestVectors(Editor *editor){
+  if(editor->vectors != nullptr){
+    DestroyVectorRunner(editor->vectors);
+    free(editor->vectors);
+    editor->vectors = nullptr;
+  }
+  if(editor->faults != nullptr){
+    DestroyFaultSimulation(editor->faults);
+    free(editor->faults);
+    editor->faults = nullptr;
   }
 }
 
+static inline
+void SimulationStep(Editor *editor){
+  PROFILE_SCOPE("SimulationStep");
+  BeginSimulationStats(&editor->stats);
+
+  if(editor->simulationMode != SimulationMode_TIMING) editor->timing.is_valid = false;
+  if(editor->simulationMode == SimulationMode_TIMING){
+    SimulateTiming(editor);
+  } else if(editor->simulationMode == SimulationMode_NETLIST && UpdateNetlist(editor)){
+    Netlist *netlist = editor->netlist;
+    LoadNetlistRegisters(netlist);
+    EvaluateNetlist(netlist, editor->clockTick);
+    WriteBackNetlist(netlist);
+    LatchNetlistRegisters(netlist);
+    StoreNetlistRegisters(netlist);
+    editor->stats.evaluations += netlist->order.count;
+  } else {
+    SimulateEventDriven(editor);
+    LatchSequentialNodes(editor);
+  }
+
+  EndSimulationStats(editor);
+  if(editor->clockRunning) editor->clockTick++;
+}
+
 static inline
 void DrawNodeDebugInfo(EditorNode *node){
   }
 
+void DrawSimulationSettings(Editor *editor){
+  ImGui::Begin("Simulation");
+  int mode = editor->simulationMode;
+  if(ImGui::Combo("Mode", &mode, "Event driven\0Netlist\0Timing\0")){
+    editor->simulationMode = (SimulationMode)mode;
+  }
+  ImGui::Checkbox("Compiled ICs", &editor->useCompiledICs);
+  if(ImGui::Checkbox("Optimize netlist", &editor->optimizeNetlist)) InvalidateTopology(editor);
+  if(ImGui::Checkbox("Fold stable inputs", &editor->foldStableInputs)) InvalidateTopology(editor);
+
+  if(editor->simulationMode == SimulationMode_TIMING){
+    const TimingSimulation *timing = &editor->timing;
+    ImGui::InputInt("Tick length", &editor->timingTickLength);
+    editor->timingTickLength = Max(editor->timingTickLength, 1);
+    ImGui::Checkbox("Inertial delay", &editor->timingInertial);
+    ImGui::Text("time: %llu, %u events pending", (unsigned long long)timing->time, timing->wheel.event_count);
+    if(timing->last_step_milliseconds > 0.0){
+      double eventsPerSecond = (double)timing->last_step_events / (timing->last_step_milliseconds / 1000.0);
+      ImGui::Text("%llu events last step, %.0f events/sec", (unsigned long long)timing->last_step_events, eventsPerSecond);
+    }
+  }
+
+  if(editor->simulationMode == SimulationMode_NETLIST && editor->netlist != nullptr){
+    Netlist *netlist = editor->netlist;
+    if(!netlist->is_levelized){
+      ImGui::Text("Design contains a combinational loop, using event driven simulation");
+    } else {
+      const NetlistOptimizationStats *optimization = &netlist->optimization;
+      ImGui::Text("%zu gates evaluated per step", netlist->order.count);
+      if(editor->optimizeNetlist){
+        ImGui::Text("%u gates before optimization", optimization->gates_before);
+        ImGui::Text("folded %u, merged %u, buffers %u, dead %u", optimization->folded,
+          optimization->merged, optimization->buffers, optimization->removed);
+        ImGui::Text("%zu inputs folded to constants", netlist->folded_inputs.count);
+      }
+    }
+  }
+
+  size_t compiledCount = 0;
+  it(i, editor->icdefs.count){
+    if(editor->icdefs[i]->program != nullptr) compiledCount++;
+  }
+  ImGui::Text("%zu / %zu IC definitions compiled", compiledCount, editor->icdefs.count);
+
+  const NodeSchedule *schedule = &editor->schedule;
+  ImGui::InputInt("Loop iteration limit", &editor->loopIterationLimit);
+  editor->loopIterationLimit = Max(editor->loopIterationLimit, 1);
+  ImGui::Text("%u feedback loops, %u oscillating", schedule->cyclic_count, schedule->oscillating_count);
+  it(i, editor->icdefs.count){
+    if(editor->icdefs[i]->is_oscillating) ImGui::Text("%s (IC %zu) contains an oscillating loop", GetICName(i, editor), i);
+  }
+
+  if(ImGui::CollapsingHeader("Clock")){
+    ImGui::Text("tick: %llu", (unsigned long long)editor->clockTick);
+    ImGui::Checkbox("Run clock", &editor->clockRunning);
+    ImGui::InputInt("Cycles", &editor->cycleRunCount);
+    editor->cycleRunCount = Max(editor->cycleRunCount, 1);
+    if(GetClockCycleTicks(editor) == 0){
+      ImGui::Text("Add a CLOCK node to run cycles");
+    } else {
+      if(ImGui::Button("Step cycle")) RunClockCycles(editor, 1);
+      ImGui::SameLine();
+      if(ImGui::Button("Run cycles")) RunClockCycles(editor, editor->cycleRunCount);
+    }
+    if(editor->lastRunCycles > 0 && editor->lastRunMilliseconds > 0.0){
+      double cyclesPerSecond = (double)editor->lastRunCycles / (editor->lastRunMilliseconds / 1000.0);
+      ImGui::Text("%llu cycles in %.3f ms, %.0f cycles/sec", (unsigned long long)editor->lastRunCycles,
+        editor->lastRunMilliseconds, cyclesPerSecond);
+    }
+  }
+
+  //NOTE(Torin) Redone before anything reads the paths, they point at nodes that may have
+  //been deleted since the last analysis
+  UpdateTimingAnalysis(editor);
+  if(ImGui::CollapsingHeader("Static timing")){
+    TimingAnalysis *analysis = &editor->timingAnalysis;
+    ImGui::InputInt("Paths", &editor->timingPathCount);
+    editor->timingPathCount = Min(Max(editor->timingPathCount, 1), 64);
+    if(ImGui::Button("Analyze")){
+      AnalyzeTiming(editor, editor->timingPathCount);
+      SelectTimingPath(editor, analysis->paths.count > 0 ? 0 : -1);
+    }
+    if(analysis->is_valid){
+      ImGui::SameLine();
+      if(ImGui::Button("Clear highlight")) SelectTimingPath(editor, -1);
+      //NOTE(Torin) Register endpoints must settle within one period of a default clock
+      uint32_t period = 2 * Max(editor->clockHalfPeriod, 1) * Max(editor->timingTickLength, 1);
+      ImGui::Text("%u endpoints, %u untimed nodes, clock period %u", analysis->endpoint_count,
+        analysis->untimed_count, period);
+      it(i, analysis->paths.count){
+        const TimingPath *path = &analysis->paths[i];
+        const TimingPathNode *endpoint = &analysis->path_nodes[path->first + path->count - 1];
+        const TimingPathNode *start = &analysis->path_nodes[path->first];
+        const char *startName = start->node->type < NodeType_COUNT ? NodeName[start->node->type] : "IC";
+        char label[128];
+        if(endpoint->node->type == NodeType_OUTPUT){
+          snprintf(label, sizeof(label), "%zu: arrival %u, depth %u, %s -> output##path%zu", i, path->arrival,
+            path->depth, startName, i);
+        } else {
+          snprintf(label, sizeof(label), "%zu: arrival %u, depth %u, slack %d, %s -> %s.%u##path%zu", i, path->arrival,
+            path->depth, (int)period - (int)path->arrival, startName,
+            NodeName[endpoint->node->type], endpoint->input_index, i);
+        }
+        if(ImGui::Selectable(label, editor->selectedTimingPath == (int)i)) SelectTimingPath(editor, i);
+      }
+      if(ImGui::TreeNode("Outputs")){
+        it(i, editor->nodes.count){
+          EditorNode *node = editor->nodes[i];
+          if(node->type != NodeType_OUTPUT) continue;
+          uint32_t arrival = 0, depth = 0;
+          if(GetInputArrival(analysis, node, 0, &arrival, &depth)){
+            ImGui::Text("output %zu: arrival %u, depth %u", i, arrival, depth);
+          } else {
+            ImGui::Text("output %zu: untimed", i);
+          }
+        }
+        ImGui::TreePop();
+      }
+    }
+  }
+
+  if(ImGui::CollapsingHeader("Test vectors")){
+    if(editor->vectors != nullptr && ImGui::Button("Reset vectors")) DestroyTestVectors(editor);
+    if(editor->vectors == nullptr) editor->vectors = CreateVectorRunner(editor);
+    VectorRunner *runner = editor->vectors;
+    ImGui::Combo("Stimulus", &runner->source, "Exhaustive\0Random\0File\0");
+    if(runner->source == VectorSource_RANDOM){
+      ImGui::InputInt("Vectors", &runner->random_count);
+      runner->random_count = Max(runner->random_count, 1);
+    }
+    ImGui::Combo("Check", &runner->check, "None\0Expected outputs in file\0Event driven simulator\0");
+    if(runner->source == VectorSource_FILE || runner->check == VectorCheck_FILE){
+      ImGui::InputText("Vector file", runner->path, sizeof(runner->path));
+      ImGui::SameLine();
+      if(ImGui::Button("Load") && !LoadVectorFile(&runner->file, runner->path)) runner->file.inputs.count = 0;
+      ImGui::Text("%zu vectors, %u inputs, %u outputs", runner->file.inputs.count, runner->file.input_count, runner->file.output_count);
+    }
+    if(ImGui::Button("Run vectors")) RunVectors(runner, editor);
+    if(runner->error != nullptr){
+      ImGui::Text("error: %s", runner->error);
+    } else if(runner->vector_count > 0){
+      ImGui::Text("%llu vectors in %.3f ms (%s), %llu mismatches", (unsigned long long)runner->vector_count,
+        runner->milliseconds, runner->is_bit_parallel ? "64 lanes" : "scalar", (unsigned long long)runner->mismatch_count);
+      it(i, runner->mismatches.count){
+        const VectorMismatch *mismatch = &runner->mismatches[i];
+        char inputs[VECTOR_MAX_PORTS + 1], expected[VECTOR_MAX_PORTS + 1], actual[VECTOR_MAX_PORTS + 1];
+        FormatVectorBits(inputs, mismatch->inputs, 0, ~0ULL, runner->input_count);
+        FormatVectorBits(expected, mismatch->expected, 0, mismatch->care, runner->output_count);
+        FormatVectorBits(actual, mismatch->actual, mismatch->unknown, ~0ULL, runner->output_count);
+        ImGui::Text("#%llu %s expected %s got %s", (unsigned long long)mismatch->vector, inputs, expected, actual);
+      }
+    }
+
+    if(editor->faults == nullptr) editor->faults = (FaultSimulation *)calloc(1, sizeof(FaultSimulation));
+    FaultSimulation *faults = editor->faults;
+    ImGui::InputInt("Fault threads (0 = all cores)", &faults->thread_count);
+    faults->thread_count = Min(Max(faults->thread_count, 0), FAULT_MAX_THREADS);
+    if(ImGui::Button("Fault coverage")) RunFaultSimulation(faults, runner, editor);
+    if(faults->error != nullptr){
+      ImGui::Text("error: %s", faults->error);
+    } else if(faults->faults.count > 0){
+      double coverage = 100.0 * (double)faults->detected_count / (double)faults->faults.count;
+      ImGui::Text("%llu / %zu stuck-at faults detected (%.2f%%) by %llu vectors", (unsigned long long)faults->detected_count,
+        faults->faults.count, coverage, (unsigned long long)faults->vector_count);
+      ImGui::Text("%.3f ms on %u threads", faults->milliseconds, faults->threads_used);
+      if(ImGui::TreeNode("Undetected faults")){
+        size_t listed = 0;
+        for(size_t i = 0; i < faults->faults.count && listed < 64; i++){
+          const Fault *fault = &faults->faults[i];
+          if(fault->detected_vector != FAULT_UNDETECTED) continue;
+          ImGui::Text("net %u (%s) stuck at %u", fault->net, NetTypeName[fault->net_type], fault->stuck_value);
+          listed++;
+        }
+        ImGui::TreePop();
+      }
+    }
+  }
+
+  if(ImGui::CollapsingHeader("Equivalence")){
+    if(editor->equivalence == nullptr) editor->equivalence = (EquivalenceCheck *)calloc(1, sizeof(EquivalenceCheck));
+    EquivalenceCheck *check = editor->equivalence;
+    int lastIC = Max((int)editor->icdefs.count - 1, 0);
+    ImGui::InputInt("IC A", &check->ic_a);
+    ImGui::InputInt("IC B", &check->ic_b);
+    check->ic_a = Min(Max(check->ic_a, 0), lastIC);
+    check->ic_b = Min(Max(check->ic_b, 0), lastIC);
+    if(editor->icdefs.count > 0) ImGui::Text("%s against %s", GetICName(check->ic_a, editor), GetICName(check->ic_b, editor));
+    if(editor->icdefs.count > 0 && ImGui::Button("Check equivalence")){
+      CheckEquivalence(check, editor->icdefs[check->ic_a], editor->icdefs[check->ic_b]);
+    }
+    if(check->error != nullptr){
+      ImGui::Text("error: %s", check->error);
+    } else if(check->milliseconds > 0.0){
+      static const char *StatusName[] = { "equivalent", "different", "unknown, conflict limit reached" };
+      ImGui::Text("%s by %s in %.3f ms", StatusName[check->status], EquivalenceMethodName[check->method], check->milliseconds);
+      if(check->method == EquivalenceMethod_SAT){
+        ImGui::Text("%u variables, %u clauses, %llu conflicts", check->sat_variables, check->sat_clauses,
+          (unsigned long long)check->sat_conflicts);
+      }
+      if(check->status == EquivalenceStatus_DIFFERENT){
+        ImGui::Text("output %u: A = %c, B = %c", check->output_index,
+          "01x"[check->output_a], "01x"[check->output_b]);
+        ImGui::TextWrapped("inputs (input 0 first):");
+        char bits[129];
+        size_t count = 0;
+        it(i, check->counterexample.count){
+          bits[count++] = check->counterexample[i] ? '1' : '0';
+          if(count == sizeof(bits) - 1 || i == check->counterexample.count - 1){
+            bits[count] = 0;
+            ImGui::TextUnformatted(bits);
+            count = 0;
+          }
+        }
+      }
+    }
+  }
+
+  if(ImGui::CollapsingHeader("History")){
+    const CommandJournal *journal = &editor->journal;
+    ImGui::Text("%u / %zu records applied, %zu bytes", journal->applied_count, journal->record_offsets.count, journal->data.count);
+    ImGui::Text("Ctrl+Z undo, Ctrl+Y or Ctrl+Shift+Z redo");
+  }
+
+  if(ImGui::CollapsingHeader("IC Library")){
+    ICLibrary *library = &editor->library;
+    if(library->path[0] == 0) strcpy(library->path, "ics.hwlib");
+    ImGui::InputText("Library file", library->path, sizeof(library->path));
+    if(ImGui::Button("Open")) OpenICLibrary(library->path, editor);
+    ImGui::SameLine();
+    if(ImGui::Button("Save")) SaveICLibrary(library->path, editor);
+    if(library->error != nullptr) ImGui::Text("error: %s", library->error);
+    ImGui::Text("%zu ICs known, %zu loaded, %zu library files open", library->entries.count, editor->icdefs.count, library->files.count);
+    it(i, editor->icdefs.count){
+      if(i >= library->entry_of_ic.count || library->entry_of_ic[i] == IC_LIBRARY_NONE) continue;
+      const ICLibraryEntry *entry = &library->entries[library->entry_of_ic[i]];
+      char name[IC_NAME_LENGTH];
+      memcpy(name, entry->name, IC_NAME_LENGTH);
+      ImGui::PushID(i);
+      if(ImGui::InputText("##name", name, sizeof(name), ImGuiInputTextFlags_EnterReturnsTrue)) CommandRenameIC(i, name, editor);
+      ImGui::SameLine();
+      ImGui::Text("%u in, %u out, %u nodes", entry->input_count, entry->output_count, editor->icdefs[i]->node_count);
+      ImGui::PopID();
+    }
+  }
+
+  if(editor->autosave != nullptr && ImGui::CollapsingHeader("Autosave")){
+    AutosaveStatus status = GetAutosaveStatus(editor->autosave);
+    ImGui::Text("Journal: %llu bytes, written through entry %llu", (unsigned long long)status.journal_bytes, (unsigned long long)status.written_sequence);
+    ImGui::Text("Synced through entry %llu", (unsigned long long)status.synced_sequence);
+    ImGui::Text("Snapshot: through entry %llu, %u written", (unsigned long long)status.snapshot_sequence, status.snapshot_count);
+    ImGui::Text("Recovered %llu entries in %.2f ms%s", (unsigned long long)status.recovered_entries,
+      status.recovery_milliseconds, status.was_journal_torn ? ", torn journal tail dropped" : "");
+    if(status.error != nullptr) ImGui::Text("error: %s (%s)", status.error, strerror(status.error_number));
+  }
+
+  if(ImGui::CollapsingHeader("New nodes")){
+    ImGui::InputInt("Register width", &editor->registerWidth);
+    editor->registerWidth = Min(Max(editor->registerWidth, 1), REGISTER_MAX_WIDTH);
+    ImGui::Checkbox("Register as bus", &editor->busRegisters);
+    ImGui::InputInt("Input / output width", &editor->portWidth);
+    editor->portWidth = Min(Max(editor->portWidth, 1), BUS_MAX_WIDTH);
+    ImGui::InputInt("Clock half period", &editor->clockHalfPeriod);
+    editor->clockHalfPeriod = Max(editor->clockHalfPeriod, 1);
+    ImGui::InputInt("Gate inputs", &editor->gateInputCount);
+    editor->gateInputCount = Min(Max(editor->gateInputCount, 2), GATE_MAX_INPUTS);
+    ImGui::InputInt("Bus width", &editor->busWidth);
+    editor->busWidth = Min(Max(editor->busWidth, 1), BUS_MAX_WIDTH);
+    ImGui::InputInt("Memory address width", &editor->memoryAddressWidth);
+    editor->memoryAddressWidth = Min(Max(editor->memoryAddressWidth, 1), MEMORY_MAX_ADDRESS_WIDTH);
+    ImGui::InputInt("Memory data width", &editor->memoryDataWidth);
+    editor->memoryDataWidth = Min(Max(editor->memoryDataWidth, 1), BUS_MAX_WIDTH);
+  }
+  ImGui::End();
+}
+
 
 void DrawEditor(Editor *editor){
-  static const ImU32 GRID_COLOR = ImColor(200,200,200,40);
-  static const float GRID_SIZE = 16.0f;
+  PROFILE_SCOPE("DrawEditor");
   static const float NODE_SLOT_RADIUS = 6.0f;
   static const ImVec2 NODE_WINDOW_PADDING(8.0f, 8.0f);
 
@@ -544,8 +1456,8 @@ void DrawEditor(Editor *editor){
   static const ImColor NODE_BACKGROUND_SELECTED_COLOR = ImColor(90,90,90);
   static const ImColor NODE_BACKGROUND_DEFAULT_COLOR = ImColor(60,60,60);
   static const ImColor NODE_OUTLINE_COLOR = ImColor(100,100,100);
-
-  static ImVec2 scrolling = ImVec2(0.0f, 0.0f);
+  static const ImColor NODE_OSCILLATING_OUTLINE_COLOR = ImColor(220,60,60);
+  static const ImColor CRITICAL_PATH_COLOR = ImColor(240,150,40);
 
   ImGuiWindowFlags flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | 
     ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse;
@@ -586,22 +1498,32 @@ void DrawEditor(Editor *editor){
   ImGui::BeginChild("scrolling_region", ImVec2(0,0), true, ImGuiWindowFlags_NoScrollbar|ImGuiWindowFlags_NoMove);
   ImGui::PushItemWidth(120.0f);
 
-  ImVec2 canvasOrigin = ImGui::GetCursorScreenPos();
-  ImVec2 offset = ImGui::GetCursorScreenPos() - scrolling;
-  ImVec2 canvasMouseCoords = ImGui::GetMousePos() - canvasOrigin;
+  if(editor->icView.is_open){
+    DrawICView(editor, ImGui::GetWindowDrawList());
+    ImGui::PopItemWidth();
+    ImGui::EndChild();
+    ImGui::PopStyleColor();
+    ImGui::PopStyleVar(2);
+    ImGui::EndGroup();
+    ImGui::End();
+    return;
+  }
 
-  ImVec2 editorSpaceMousePos = (ImGui::GetMousePos() - canvasOrigin) + scrolling;
+  ImVec2 canvasOrigin = ImGui::GetCursorScreenPos();
+  ImVec2 canvasSize = ImGui::GetWindowSize();
+  Camera *camera = &editor->camera;
+  InitializeCamera(camera, ImVec2(0.0f, 0.0f));
+  const float zoom = camera->zoom;
+  const bool isDetailed = zoom >= CANVAS_DETAIL_ZOOM;
+  ImVec2 editorSpaceMousePos = ScreenToWorld(ImGui::GetMousePos(), camera, canvasOrigin);
 
   ImDrawList* draw_list = ImGui::GetWindowDrawList();
   draw_list->ChannelsSplit(2);
 
   //@Draw @Grid
-  ImVec2 win_pos = ImGui::GetCursorScreenPos();
-  ImVec2 canvas_sz = ImGui::GetWindowSize();
-  for(float x = fmodf(offset.x,GRID_SIZE); x < canvas_sz.x; x += GRID_SIZE)
-    draw_list->AddLine(ImVec2(x,0.0f)+win_pos, ImVec2(x,canvas_sz.y)+win_pos, GRID_COLOR);
-  for(float y = fmodf(offset.y,GRID_SIZE); y < canvas_sz.y; y += GRID_SIZE)
-    draw_list->AddLine(ImVec2(0.0f,y)+win_pos, ImVec2(canvas_sz.x,y)+win_pos, GRID_COLOR);
+  DrawCanvasGrid(draw_list, camera, canvasOrigin, canvasSize);
+
+  auto ToScreen = [&](ImVec2 p) -> ImVec2 { return WorldToScreen(p, camera, canvasOrigin); };
 
   // Display links
   draw_list->ChannelsSetCurrent(0); // Background
@@ -617,15 +1539,30 @@ void DrawEditor(Editor *editor){
     return result;
   };
 
+  if(editor->useWireRouting) UpdateWireRouter(editor);
   iterate_nodes(editor, [&](EditorNode *a, NodeIndex index){
     it(outputIndex, a->output_count){
       auto outputConnections = a->output_connections[outputIndex];
       it(n, outputConnections.count){
-        ImVec2 p1 = offset + GetNodeOutputSlotPos(a, outputIndex);
+        ImVec2 w1 = GetNodeOutputSlotPos(a, outputIndex);
+        ImVec2 p1 = ToScreen(w1);
         EditorNode *b = GetNode(outputConnections[n].node_index, editor);
-        ImVec2 p2 = offset + GetNodeInputSlotPos(b, outputConnections[n].io_index);
+        ImVec2 w2 = GetNodeInputSlotPos(b, outputConnections[n].io_index);
+        ImVec2 p2 = ToScreen(w2);
+        ImVec2 tangent = ImVec2(50.0f * zoom, 0.0f);
+        if(!IsOnCanvas(ImMin(p1, p2) - tangent, ImMax(p1, p2) + tangent, canvasOrigin, canvasSize)) continue;
         auto color = a->signal_state ? CONNECTION_ACTIVE_COLOR : CONNECTION_DEFAULT_COLOR;
-        draw_list->AddBezierCurve(p1, p1+ImVec2(+50,0), p2+ImVec2(-50,0), p2, color, 3.0f);
+        float thickness = GetPortWidth(a, false, outputIndex) > 1 ? 5.0f : 3.0f;
+        if(b->path_input == outputConnections[n].io_index + 1){
+          color = CRITICAL_PATH_COLOR;
+          thickness += 2.0f;
+        }
+        thickness = Max(thickness * Min(zoom, 1.0f), 1.0f);
+        //NOTE(Torin) Wires keep the curve until the router got to them
+        WireRoute *route = nullptr;
+        if(editor->useWireRouting) route = GetWireRoute(a, outputIndex, b, outputConnections[n].io_index, editor);
+        if(route != nullptr) DrawWireRoute(draw_list, route, w1, w2, camera, canvasOrigin, color, thickness);
+        else draw_list->AddBezierCurve(p1, p1+tangent, p2-tangent, p2, color, thickness);
       }
     }
   });
@@ -635,57 +1572,87 @@ void DrawEditor(Editor *editor){
   
 
   iterate_nodes(editor, [&](EditorNode *node, NodeIndex index){
-    ImVec2 node_rect_min = offset + node->position;
-    ImVec2 node_rect_max = node_rect_min + node->size;
+    ImVec2 node_rect_min = ToScreen(node->position);
+    ImVec2 node_rect_max = node_rect_min + node->size * zoom;
+    if(!IsOnCanvas(node_rect_min, node_rect_max, canvasOrigin, canvasSize)) return;
 
     ImGui::PushID(index.node_index);
     draw_list->ChannelsSetCurrent(1); // Foreground
-    ImGui::BeginGroup();
-    ImGui::SetCursorScreenPos(node_rect_min + ImVec2(24, 24));
-    switch(node->type){
-      case NodeType_INPUT:{
-        ImGui::SetCursorScreenPos(node_rect_min + ImVec2(4, 4));
-        const char *text = node->signal_state ? "1" : "0";
-        auto color = node->signal_state ? CONNECTION_ACTIVE_COLOR : CONNECTION_DEFAULT_COLOR;
-        //ImGui::PushStyleColor(ImGuiCol_Button, color);
-
-        if(ImGui::Button(text, ImVec2(32, 32))){
-          if(node->signal_state == NodeState_LOW){
-            node->signal_state = NodeState_HIGH;
-          } else if (node->signal_state == NodeState_HIGH){
-            node->signal_state = NodeState_LOW;
-          } else {
-            assert(false);
+    //NOTE(Torin) Zoomed out nodes are only boxes
+    if(isDetailed){
+      ImGui::SetWindowFontScale(zoom);
+      ImGui::BeginGroup();
+      ImGui::SetCursorScreenPos(node_rect_min + ImVec2(24, 24) * zoom);
+      switch(node->type){
+        case NodeType_INPUT:{
+          ImGui::SetCursorScreenPos(node_rect_min + ImVec2(4, 4) * zoom);
+          //NOTE(Torin) ImGui only writes the buffer back when enter is pressed
+          if(GetPortWidth(node, false, 0) > 1){
+            char text[20];
+            snprintf(text, sizeof(text), "%llx", (unsigned long long)node->bus_value);
+            ImGui::PushItemWidth(56 * zoom);
+            if(ImGui::InputText("##value", text, sizeof(text), ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue)){
+              node->bus_value = strtoull(text, nullptr, 16) & WordMask(GetPortWidth(node, false, 0));
+              node->signal_state = node->bus_value ? NodeState_HIGH : NodeState_LOW;
+            }
+            ImGui::PopItemWidth();
+            break;
           }
-        }
-        //ImGui::PopStyleColor();
-      }break;
-
-      case NodeType_OUTPUT:{
-        const char *text = node->signal_state ? "1" : "0";
-        ImGui::Text(text);
-      }break;
+          const char *text = node->signal_state ? "1" : "0";
+          auto color = node->signal_state ? CONNECTION_ACTIVE_COLOR : CONNECTION_DEFAULT_COLOR;
+          //ImGui::PushStyleColor(ImGuiCol_Button, color);
+
+          if(ImGui::Button(text, ImVec2(32, 32) * zoom)){
+            if(node->signal_state == NodeState_LOW){
+              node->signal_state = NodeState_HIGH;
+            } else if (node->signal_state == NodeState_HIGH){
+              node->signal_state = NodeState_LOW;
+            } else {
+              assert(false);
+            }
+          }
+          //ImGui::PopStyleColor();
+        }break;
 
-      default:{
-        ImGui::Text(NodeName[node->type]);
-      } break;
+        case NodeType_OUTPUT:{
+          if(GetPortWidth(node, true, 0) > 1){
+            ImGui::Text("%llx", (unsigned long long)node->input_value[0]);
+            break;
+          }
+          const char *text = node->signal_state ? "1" : "0";
+          ImGui::Text(text);
+        }break;
+
+        default:{
+          if(IsWordNodeType(node->type) && GetPortWidth(node, false, 0) > 1){
+            ImGui::SetCursorScreenPos(node_rect_min + ImVec2(8, 16) * zoom);
+            ImGui::Text("%s\n%llx", NodeName[node->type], (unsigned long long)node->output_value[0]);
+          } else {
+            ImGui::Text(NodeName[node->type]);
+          }
+        } break;
+      }
+      ImGui::EndGroup();
+      ImGui::SetWindowFontScale(1.0f);
     }
-    ImGui::EndGroup();
 
     // Display node box
     ImGui::SetCursorScreenPos(node_rect_min);
 
-    ImGui::InvisibleButton("node", node->size);
+    ImGui::InvisibleButton("node", node->size * zoom);
     ImGui::PopID();
     
     if(ImGui::IsItemHovered()){
       node_hovered = index;
-      if(ImGui::IsMouseClicked(1)) {
+      if(ImGui::IsMouseDoubleClicked(0) && node->type > NodeType_COUNT) {
+        OpenICView(node, editor);
+        dragNodeIndex = InvalidNodeIndex();
+      } else if(ImGui::IsMouseClicked(1)) {
         open_context_menu = 1;
       } else if (ImGui::IsMouseClicked(0) && editor->mode != EditorMode_SelectBox){
-        if(!ArrayContains(node_hovered, editor->selectedNodes)){
-          editor->selectedNodes.count = 0;
-          ArrayAdd(node_hovered, editor->selectedNodes);
+        if(!node->is_selected){
+          ClearSelection(editor);
+          SelectNode(node_hovered, editor);
         }
       }
     }
@@ -693,28 +1660,34 @@ void DrawEditor(Editor *editor){
     bool node_moving_active = ImGui::IsItemActive();
 
     if(node_moving_active && ImGui::IsMouseDragging(0)){
-      for(size_t i = 0; i < editor->selectedNodes.count; i++){
-        EditorNode *selectedNode = GetNode(editor->selectedNodes[i], editor);
-        selectedNode->position += ImGui::GetIO().MouseDelta;
-      }
+      CommandMoveSelection(ImGui::GetIO().MouseDelta / zoom, editor);
     }
 
     ImColor nodeColor = NODE_BACKGROUND_DEFAULT_COLOR;
-    if(ArrayContains(index, editor->selectedNodes)){
+    if(node->is_selected){
       nodeColor = NODE_BACKGROUND_SELECTED_COLOR;
     }
 
+    ImColor outlineColor = NODE_OUTLINE_COLOR;
+    if(IsNodeOscillating(node, editor)){
+      outlineColor = NODE_OSCILLATING_OUTLINE_COLOR;
+    } else if(node->path_input != 0){
+      outlineColor = CRITICAL_PATH_COLOR;
+    }
+
     draw_list->ChannelsSetCurrent(0); // Background
     draw_list->AddRectFilled(node_rect_min, node_rect_max, nodeColor, 4.0f); 
-    draw_list->AddRect(node_rect_min, node_rect_max, NODE_OUTLINE_COLOR, 4.0f);
+    draw_list->AddRect(node_rect_min, node_rect_max, outlineColor, 4.0f);
   });
   draw_list->ChannelsMerge();
 
   //Draw and Update Node IO slots
+  const float slotRadius = Max(NODE_SLOT_RADIUS * zoom, 2.0f);
   iterate_nodes(editor, [&](EditorNode *node, NodeIndex index){
-    ImVec2 node_rect_min = offset + node->position - ImVec2(12,12);
+    ImVec2 node_rect_min = ToScreen(node->position) - ImVec2(12,12);
+    ImVec2 size = node->size * zoom + ImVec2(32, 32);
+    if(!IsOnCanvas(node_rect_min, node_rect_min + size, canvasOrigin, canvasSize)) return;
     ImGui::SetCursorScreenPos(node_rect_min);
-    ImVec2 size = ImVec2(node->size.x + 32, node->size.x + 32);
     ImGui::PushID(index.node_index);
     ImGui::InvisibleButton("##node", size);
     ImGui::PopID();
@@ -728,10 +1701,9 @@ void DrawEditor(Editor *editor){
       size_t total_slot_count = node->input_count + node->output_count;
       for(size_t slot_index = 0; slot_index < total_slot_count; slot_index++){
         bool is_input_slot = slot_index < node->input_count;
-        const float NODE_SLOT_RADIUS_SQUARED = NODE_SLOT_RADIUS*NODE_SLOT_RADIUS;
+        const float NODE_SLOT_RADIUS_SQUARED = slotRadius*slotRadius;
         ImVec2 deltaSlot = is_input_slot ? GetNodeInputSlotPos(node, slot_index) : GetNodeOutputSlotPos(node, slot_index - node->input_count);
-        deltaSlot -= scrolling;
-        deltaSlot -= canvasMouseCoords; 
+        deltaSlot = ToScreen(deltaSlot) - ImGui::GetMousePos();
         deltaSlot.x = abs(deltaSlot.x);
         deltaSlot.y = abs(deltaSlot.y);
 
@@ -752,17 +1724,17 @@ void DrawEditor(Editor *editor){
     static const ImColor hover_color   = ImColor(220, 150, 150, 150);
     for(int slot_idx = 0; slot_idx < node->input_count; slot_idx++) {
       const ImColor color = ((hovered_slot_index == slot_idx) && (hovered_slot_is_input == true)) ? hover_color : default_color;
-      draw_list->AddCircleFilled(offset + GetNodeInputSlotPos(node, slot_idx), NODE_SLOT_RADIUS, color);
+      draw_list->AddCircleFilled(ToScreen(GetNodeInputSlotPos(node, slot_idx)), slotRadius, color);
     }
 
     for(int slot_idx = 0; slot_idx < node->output_count; slot_idx++){
       const ImColor color = ((hovered_slot_index == slot_idx) && (hovered_slot_is_input == false)) ? hover_color : default_color;
-      draw_list->AddCircleFilled(offset + GetNodeOutputSlotPos(node, slot_idx), NODE_SLOT_RADIUS, color);
+      draw_list->AddCircleFilled(ToScreen(GetNodeOutputSlotPos(node, slot_idx)), slotRadius, color);
     }
       
     if(hovered_slot_index != -1){
       if(ImGui::IsMouseDoubleClicked(0)){
-        RemoveNodeOutputConnections(GetNode(dragNodeIndex, editor), editor);
+        if(IsValid(dragNodeIndex)) CommandDisconnectOutputs(GetNode(dragNodeIndex, editor), editor);
       } else if(ImGui::IsMouseClicked(0)){
         if(!IsValid(dragNodeIndex) && !hovered_slot_is_input){
           dragNodeIndex = index;
@@ -771,21 +1743,12 @@ void DrawEditor(Editor *editor){
           EditorNode *sourceNode = GetNode(dragNodeIndex, editor);
           EditorNode *destNode = node;
 
-          if(!IsValid(destNode->inputConnections[hovered_slot_index].node_index)){
+          bool widthsMatch = GetPortWidth(sourceNode, false, dragSlotIndex) == GetPortWidth(destNode, true, hovered_slot_index);
+          if(!IsValid(destNode->inputConnections[hovered_slot_index].node_index) && widthsMatch){
             //TODO(Torin) Insure that an output connection cannot have two connections to the same input
             //It appears that this is currently imposible already **BUT** only because single input sources
             //are allowed
-
-            NodeConnection outputToInput = {};
-            outputToInput.node_index = index;
-            outputToInput.io_index = hovered_slot_index;
-            auto &outputConnections = sourceNode->output_connections[dragSlotIndex];
-            ArrayAdd(outputToInput, outputConnections);
-
-            NodeConnection inputToOutput;
-            inputToOutput.node_index = dragNodeIndex;
-            inputToOutput.io_index = dragSlotIndex;
-            destNode->inputConnections[hovered_slot_index] = inputToOutput;
+            CommandConnect(sourceNode, dragSlotIndex, destNode, hovered_slot_index, editor);
             dragNodeIndex = InvalidNodeIndex();
             dragSlotIndex = 0;
           }
@@ -798,7 +1761,7 @@ void DrawEditor(Editor *editor){
   if(IsValid(dragNodeIndex)){
     EditorNode *sourceNode = GetNode(dragNodeIndex, editor);
     ImVec2 p1 = ImGui::GetMousePos();
-    ImVec2 p2 = offset + GetNodeOutputSlotPos(sourceNode, dragSlotIndex);
+    ImVec2 p2 = ToScreen(GetNodeOutputSlotPos(sourceNode, dragSlotIndex));
     draw_list->AddBezierCurve(p1, p1+ImVec2(+50,0), p2+ImVec2(-50,0), p2, ImColor(200,200,100), 3.0f);
   }
 
@@ -821,11 +1784,29 @@ void DrawEditor(Editor *editor){
     editor->mode = EditorMode_None;
   }
 
+  //NOTE(Torin) Ctrl+Z undoes, Ctrl+Y or Ctrl+Shift+Z redoes, Ctrl+C / X / V / D copy, cut,
+  //paste and duplicate, the node handles held across frames may point at nodes the command deleted
+  ImGuiIO& io = ImGui::GetIO();
+  if(!ImGui::IsMouseDown(0)) EndMoveCommand(editor);
+  if(io.KeyCtrl && !io.WantTextInput){
+    bool isUndo = ImGui::IsKeyPressed(SDLK_z) && !io.KeyShift;
+    bool isRedo = ImGui::IsKeyPressed(SDLK_y) || (ImGui::IsKeyPressed(SDLK_z) && io.KeyShift);
+    bool isCut = ImGui::IsKeyPressed(SDLK_x, false) && editor->selectedNodes.count > 0;
+    if(ImGui::IsKeyPressed(SDLK_c, false) && editor->selectedNodes.count > 0) CopySelection(editor);
+    if(ImGui::IsKeyPressed(SDLK_v, false)) PasteClipboard(editorSpaceMousePos, editor);
+    if(ImGui::IsKeyPressed(SDLK_d, false)) DuplicateSelection(editor);
+    if(isCut) CutSelection(editor);
+    if(isCut || (isUndo && UndoCommand(editor)) || (isRedo && RedoCommand(editor))){
+      dragNodeIndex = InvalidNodeIndex();
+      node_hovered = InvalidNodeIndex();
+    }
+  }
+
   switch(editor->mode){
     case EditorMode_None:{
       if(ImGui::IsMouseDragging(0)){
         if(node_hovered != InvalidNodeIndex()) break;
-        editor->selectBoxOrigin = ImGui::GetMousePos();
+        editor->selectBoxOrigin = editorSpaceMousePos;
         editor->mode = EditorMode_SelectBox;
       }
 
@@ -836,15 +1817,14 @@ void DrawEditor(Editor *editor){
     case EditorMode_PLACEMENT:{
       if(node_hovered == InvalidNodeIndex()){
         const ImColor color = ImColor(100, 100, 100, 100);
-        draw_list->AddRectFilled(ImGui::GetMousePos(), ImGui::GetMousePos() + ImVec2(64, 64), color);
+        draw_list->AddRectFilled(ImGui::GetMousePos(), ImGui::GetMousePos() + ImVec2(64, 64) * zoom, color);
 
         //TODO(Torin) Hack to fix bullshit SDL / ImGui bug
         //where rarely it registers multiple mouse down events when only one happens
         static float creationCooldown = 0.0f;
         if(creationCooldown > 0.0f) creationCooldown -= ImGui::GetIO().DeltaTime;
         if(ImGui::IsMouseClicked(0) && ImGui::IsMouseDown(0) && creationCooldown <= 0.0f){
-          auto node = CreateNode(editor->placementNodeType, editor);
-          node->position = canvasMouseCoords; 
+          CommandCreateNode(editor->placementNodeType, editorSpaceMousePos, editor);
           creationCooldown += 0.1f;
         }
       }
@@ -854,7 +1834,7 @@ void DrawEditor(Editor *editor){
 
     case EditorMode_SelectBox:{
       if(ImGui::IsMouseDragging(0) == 0){
-        editor->selectedNodes.count = 0;
+        ClearSelection(editor);
         auto end = editorSpaceMousePos; 
         Rectangle selectBoxBounds;
         selectBoxBounds.minX = Min(editor->selectBoxOrigin.x, end.x);
@@ -864,7 +1844,7 @@ void DrawEditor(Editor *editor){
         iterate_nodes(editor, [&](EditorNode *node, NodeIndex index){
           Rectangle nodeRect = {node->position.x, node->position.y, node->position.x + node->size.x, node->position.y + node->size.y};
           if(Intersects(selectBoxBounds, nodeRect)){
-            ArrayAdd(index, editor->selectedNodes);
+            SelectNode(index, editor);
           }
         });
 
@@ -875,173 +1855,83 @@ void DrawEditor(Editor *editor){
 
   if(editor->mode == EditorMode_SelectBox){
     ImColor color = ImColor(100, 100, 100, 100);
-    draw_list->AddRectFilled(editor->selectBoxOrigin, ImGui::GetMousePos(), color);
+    draw_list->AddRectFilled(ToScreen(editor->selectBoxOrigin), ImGui::GetMousePos(), color);
   }
 
   // Draw context menu
   ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(8,8));
   if(ImGui::BeginPopup("context_menu")){
-    ImVec2 scene_pos = ImGui::GetMousePosOnOpeningCurrentPopup() - offset;
+    ImVec2 scene_pos = ScreenToWorld(ImGui::GetMousePosOnOpeningCurrentPopup(), camera, canvasOrigin);
     if(IsValid(node_hovered)){
 
-      if(ImGui::MenuItem("Delete")){
-        if(ArrayContains(node_hovered, editor->selectedNodes)){
-          for(size_t i = 0; i < editor->selectedNodes.count; i++)
-            DeleteNode(editor->selectedNodes[i], editor);
-          editor->selectedNodes.count = 0;
+      bool hasSelection = editor->selectedNodes.count > 0;
+      if(ImGui::MenuItem("Copy", "Ctrl+C", false, hasSelection)) CopySelection(editor);
+      if(ImGui::MenuItem("Duplicate", "Ctrl+D", false, hasSelection)) DuplicateSelection(editor);
+      if(ImGui::MenuItem("Cut", "Ctrl+X", false, hasSelection)){
+        CutSelection(editor);
+        node_hovered = InvalidNodeIndex();
+        dragNodeIndex = InvalidNodeIndex();
+      }
+      if(IsValid(node_hovered) && ImGui::MenuItem("Delete")){
+        if(GetNode(node_hovered, editor)->is_selected){
+          CommandDeleteNodes(editor->selectedNodes.data, editor->selectedNodes.count, editor);
         } else {
-          DeleteNode(node_hovered, editor);
+          CommandDeleteNodes(&node_hovered, 1, editor);
         }
       }
 
       
-      if(ImGui::MenuItem("Create IC")){
-        DynamicArray<EditorNode *> inputs;
-        DynamicArray<EditorNode *> outputs;
-        DynamicArray<EditorNode *> logic;
-
-
-        ImVec2 averagePosition; 
-        it(i, editor->selectedNodes.count){
-          EditorNode *node = GetNode(editor->selectedNodes[i], editor);
-          if(node->type == NodeType_INPUT) {
-            ArrayAdd(node, inputs);
-          } else if (node->type == NodeType_OUTPUT){
-            ArrayAdd(node, outputs);
-          } else {
-            ArrayAdd(node, logic);
-          }
-          averagePosition += node->position;
-        }
-        averagePosition /= (float)editor->selectedNodes.count;
-
-        size_t required_memory = sizeof(ICDefinition);
-        for(size_t i = 0; i < editor->selectedNodes.count; i++){
-          EditorNode *node = GetNode(editor->selectedNodes[i], editor);
-          required_memory += sizeof(ICNode);
-          required_memory += node->input_count * sizeof(NodeState);
-          required_memory += node->output_count * sizeof(uint32_t);
-          for(size_t n = 0; n < node->output_count; n++){
-            required_memory += node->output_connections[n].count * sizeof(ICNodeConnection);
-          } 
-        }
-
-        ICDefinition *icdef = (ICDefinition *)calloc(required_memory, 1);
-        ArrayAdd(icdef, editor->icdefs);
-        icdef->input_count = inputs.count;
-        icdef->output_count = outputs.count;
-        icdef->node_count = editor->selectedNodes.count;
-
-        MStack mstack = {};
-        mstack.base = (uintptr_t)(icdef + 1);
-        mstack.size = required_memory - sizeof(ICDefinition);
-        icdef->nodes = MStackPushArray(ICNode, icdef->node_count, &mstack); 
-        
-        auto InitICNode = [](ICNode *ic_node, EditorNode *ed_node, MStack *mstack){
-          ic_node->type = ed_node->type;
-          ic_node->input_count = ed_node->input_count; 
-          ic_node->output_count = ed_node->output_count;
-          
-          if(ic_node->input_count > 0) {
-            ic_node->input_state = MStackPushArray(NodeState, ic_node->input_count, mstack);
-          }          
-
-          if(ic_node->output_count > 0){
-            ic_node->connection_count_per_output = MStackPushArray(uint32_t, ic_node->output_count, mstack);
-            size_t totalConnectionCount = 0;
-            for(size_t n = 0; n < ic_node->output_count; n++){
-              DynamicArray<NodeConnection>& connections = ed_node->output_connections[n];
-              ic_node->connection_count_per_output[n] = connections.count;
-              totalConnectionCount += connections.count;
-            }
-            
-            ic_node->output_connections = MStackPushArray(ICNodeConnection, totalConnectionCount, mstack);
-          }
-        };
-        
-        //TODO(Torin) @UNSAFE This stack allocation could potentialy be enormous
-        //NOTE(Torin) The following loops build a lookuptable to map a pointer to an EditorNode
-        //To the index of the new coresponding ICNode
-        EditorNode *icToEdMap[editor->selectedNodes.count];
-        size_t currentICNodeIndex = 0;
-        for(size_t i = 0; i < inputs.count; i++){
-          EditorNode *ed_node = inputs[i];
-          ICNode *ic_node = &icdef->nodes[currentICNodeIndex];
-          InitICNode(ic_node, ed_node, &mstack);
-          icToEdMap[currentICNodeIndex] = ed_node;
-          currentICNodeIndex++;
-        }
-
-        for(size_t i = 0; i < outputs.count; i++){
-          EditorNode *ed_node = outputs[i];
-          ICNode *ic_node = &icdef->nodes[currentICNodeIndex];
-          InitICNode(ic_node, ed_node, &mstack);
-          icToEdMap[currentICNodeIndex] = ed_node;
-          currentICNodeIndex++;
-        }
-
-        //TODO(Torin) Sort by distance to inputs?
-        for(size_t i = 0; i < logic.count; i++){
-          EditorNode *ed_node = logic[i];
-          ICNode *ic_node = &icdef->nodes[currentICNodeIndex];
-          InitICNode(ic_node, ed_node, &mstack);
-          icToEdMap[currentICNodeIndex] = ed_node;
-          currentICNodeIndex++;
-        }
-
-        //NOTE(Torin) Fills out the connections between the nodes now that there locations
-        //are known via the previous step
-        for(size_t i = 0; i < icdef->node_count; i++){
-          ICNode *icnode = &icdef->nodes[i];
-          EditorNode *ednode = icToEdMap[i];
-          size_t currentConnectionIndex = 0;
-
-          for(size_t n = 0; n < icnode->output_count; n++){
-            DynamicArray<NodeConnection>& connections = ednode->output_connections[n]; 
-            for(size_t j = 0; j < connections.count; j++){
-              NodeConnection *edConnection = &connections[j];
-              ICNodeConnection icConnection = {};
-              icConnection.io_index = edConnection->io_index;
-
-              EditorNode *connectedNodePtr = edConnection->node_index.node_ptr;
-              size_t connectedNodeIndex = 0;
-              if(!LinearSearch<EditorNode *>(connectedNodePtr, icToEdMap, icdef->node_count, &connectedNodeIndex)){
-                assert(false);
-              }
-              icConnection.node_index = connectedNodeIndex;
-              icnode->output_connections[currentConnectionIndex++] = icConnection;
-            }
-          }
-        }
-
-        for(size_t i = 0; i < editor->selectedNodes.count; i++){
-          DeleteNode(editor->selectedNodes[i], editor);
-        }
-
-        uint32_t node_type = NodeType_COUNT + 1 + (editor->icdefs.count - 1);
-        auto node = CreateNode(node_type, editor);
-        node->position = averagePosition;
+      //NOTE(Torin) ICs are purely combinational single bit logic, sequential nodes, word nodes,
+      //bus ports, memories and nested ICs cannot be packed
+      bool canCreateIC = editor->selectedNodes.count > 0;
+      it(i, editor->selectedNodes.count){
+        EditorNode *node = GetNode(editor->selectedNodes[i], editor);
+        if(IsSequentialNodeType(node->type) || IsWordNodeType(node->type) || IsMemoryNodeType(node->type) ||
+          node->type > NodeType_COUNT) canCreateIC = false;
+        bool isPort = node->type == NodeType_INPUT || node->type == NodeType_OUTPUT;
+        if(isPort && GetPortWidth(node, node->type == NodeType_OUTPUT, 0) > 1) canCreateIC = false;
+      }
 
-        ArrayDestroy(inputs);
-        ArrayDestroy(outputs);
-        ArrayDestroy(logic);
+      if(ImGui::MenuItem("Create IC", NULL, false, canCreateIC)){
+        CommandCreateIC(editor->selectedNodes.data, editor->selectedNodes.count, editor);
+      }
+      if(ImGui::MenuItem("Arrange", NULL, false, hasSelection)){
+        CommandArrangeNodes(editor->selectedNodes.data, editor->selectedNodes.count, editor);
+      }
+      if(IsValid(node_hovered) && GetNode(node_hovered, editor)->type > NodeType_COUNT && ImGui::MenuItem("Open IC")){
+        OpenICView(GetNode(node_hovered, editor), editor);
+        node_hovered = InvalidNodeIndex();
+        dragNodeIndex = InvalidNodeIndex();
       }
     }
     else {
 
+      if(ImGui::MenuItem("Paste", "Ctrl+V")) PasteClipboard(scene_pos, editor);
+      if(ImGui::MenuItem("Arrange All", NULL, false, editor->nodes.count > 0)) CommandArrangeAllNodes(editor);
+      if(ImGui::MenuItem("Route Wires", NULL, &editor->useWireRouting) && !editor->useWireRouting) ResetWireRouter(&editor->router);
+      ImGui::Separator();
+
       for(size_t i = 0; i < NodeType_COUNT; i++){
         if(ImGui::MenuItem(NodeName[i])) {
-          auto node = CreateNode((NodeType)i, editor);
-          node->position = canvasMouseCoords;
+          CommandCreateNode((NodeType)i, scene_pos, editor);
         }
       }
 
       ImGui::Separator();
 
-      it(i, editor->icdefs.count){
-        if(ImGui::MenuItem("IC XXX")){
-          auto node = CreateNode(i + NodeType_COUNT + 1, editor);
+      ICLibrary *library = &editor->library;
+      if(library->entries.count > 0 && ImGui::BeginMenu("ICs")){
+        ImGui::InputText("Filter", library->filter, sizeof(library->filter));
+        it(i, library->entries.count){
+          const ICLibraryEntry *entry = &library->entries[i];
+          if(library->filter[0] != 0 && strstr(entry->name, library->filter) == nullptr) continue;
+          char ports[32];
+          snprintf(ports, sizeof(ports), "%u in, %u out", entry->input_count, entry->output_count);
+          ImGui::PushID(i);
+          if(ImGui::MenuItem(entry->name, ports)) CommandCreateLibraryIC(i, scene_pos, editor);
+          ImGui::PopID();
         }
+        ImGui::EndMenu();
       }
 
 
@@ -1052,9 +1942,8 @@ void DrawEditor(Editor *editor){
   }
   ImGui::PopStyleVar();
 
-  // Scrolling
-  if (ImGui::IsWindowHovered() && !ImGui::IsAnyItemActive() && ImGui::IsMouseDragging(2, 0.0f))
-      scrolling = scrolling - ImGui::GetIO().MouseDelta;
+  // Scrolling and zoom
+  UpdateCamera(camera, canvasOrigin);
 
   ImGui::PopItemWidth();
   ImGui::EndChild();
@@ -1073,6 +1962,32 @@ void DrawEditor(Editor *editor){
       ImGui::Text("type: %s", NodeName[node->type]);
       ImGui::Text("input_count: %zu", node->input_count);
       ImGui::Text("output_count: %zu", node->output_count);
+      if(node->type != NodeType_INPUT && node->type != NodeType_OUTPUT && node->type != NodeType_CLOCK){
+        int delay = node->delay;
+        if(ImGui::InputInt("delay (0 = default)", &delay)) CommandSetNodeParameter(node, NodeParameter_DELAY, Max(delay, 0), editor);
+        ImGui::SameLine();
+        ImGui::Text("%u", GetNodeDelay(node));
+      }
+      it(n, node->output_count){
+        const NetActivity *activity = &node->output_activity[n];
+        if(activity->transition_count > activity->toggle_count)
+          ImGui::Text("output %zu: %llu glitch transitions", n, (unsigned long long)(activity->transition_count - activity->toggle_count));
+      }
+      if(node->type == NodeType_CLOCK){
+        int halfPeriod = node->parameter;
+        if(ImGui::InputInt("half period", &halfPeriod)){
+          CommandSetNodeParameter(node, NodeParameter_CLOCK_HALF_PERIOD, Max(halfPeriod, 1), editor);
+        }
+      }
+      if(IsMemoryNodeType(node->type)){
+        static char imagePath[MEMORY_IMAGE_PATH_LENGTH];
+        MemoryStorage *memory = node->memory;
+        ImGui::Text("%u x %u bits, %llu pages allocated", 1u << Min(memory->address_width, 31),
+          memory->data_width, (unsigned long long)memory->allocated_pages);
+        if(memory->image != nullptr) ImGui::Text("image: %s, %zu bytes", memory->image_path, memory->image_size);
+        ImGui::InputText("image", imagePath, sizeof(imagePath));
+        if(ImGui::Button("Load image")) CommandLoadMemoryImage(node, imagePath, editor);
+      }
       if(ImGui::CollapsingHeader("InputConnections")){
       }
       ImGui::TreePop();
@@ -1082,8 +1997,15 @@ void DrawEditor(Editor *editor){
   ImGui::End();
 }
 
-int main(){
+#include "self_check.cpp"
+
+int main(int argc, char **argv){
+  if(argc > 1 && strcmp(argv[1], "--self-check") == 0){
+    ProfilerInit();
+    return RunSelfChecks() == 0 ? 0 : 1;
+  }
   QuickAppStart("Hardware Simulator", 1280, 720);
+  ProfilerInit();
   Editor editor = {};
 
   editor.toolbar.hotkey[0] = SDL_SCANCODE_1;
@@ -1096,16 +2018,47 @@ int main(){
   editor.toolbar.hotkey[7] = SDL_SCANCODE_8;
   editor.toolbar.hotkey[8] = SDL_SCANCODE_9;
   editor.toolbar.hotkey[9] = SDL_SCANCODE_0;
-  editor.toolbar.count = 10;
+  editor.toolbar.hotkey[10] = SDL_SCANCODE_MINUS;
+  editor.toolbar.hotkey[11] = SDL_SCANCODE_EQUALS;
+  editor.toolbar.count = 12;
+  editor.useCompiledICs = true;
+  editor.optimizeNetlist = true;
+  editor.registerWidth = 4;
+  editor.clockHalfPeriod = 1;
+  editor.cycleRunCount = 1000;
+  editor.loopIterationLimit = 32;
+  editor.busWidth = 8;
+  editor.portWidth = 1;
+  editor.timingTickLength = 32;
+  editor.timingPathCount = 8;
+  editor.selectedTimingPath = -1;
+  editor.gateInputCount = 2;
+  editor.memoryAddressWidth = 16;
+  editor.memoryDataWidth = 8;
 
   editor.toolbar.nodeTypes[0] = NodeType_INPUT;
   editor.toolbar.nodeTypes[1] = NodeType_OUTPUT;
   editor.toolbar.nodeTypes[2] = NodeType_AND;
   editor.toolbar.nodeTypes[3] = NodeType_OR;
   editor.toolbar.nodeTypes[4] = NodeType_XOR;
+  editor.toolbar.nodeTypes[5] = NodeType_DFF;
+  editor.toolbar.nodeTypes[6] = NodeType_REGISTER;
+  editor.toolbar.nodeTypes[7] = NodeType_CLOCK;
+  editor.toolbar.nodeTypes[8] = NodeType_WORD_SPLIT;
+  editor.toolbar.nodeTypes[9] = NodeType_WORD_MERGE;
+  editor.toolbar.nodeTypes[10] = NodeType_NOT;
+  editor.toolbar.nodeTypes[11] = NodeType_NAND;
+  editor.autosave = StartAutosave(AUTOSAVE_PATH, &editor);
 
   QuickAppLoop([&]() {
+    ProfilerBeginFrame();
     SimulationStep(&editor);
     DrawEditor(&editor);
+    UpdateAutosave(editor.autosave, &editor);
+    DrawProfilerWindow();
+    DrawSimulationSettings(&editor);
+    DrawSimulationStatsWindow(&editor);
   });
+  StopAutosave(editor.autosave, &editor);
+  DestroyTestVectors(&editor);
 }
\ No newline at end of file
@@ -0,0 +1,317 @@
+//NOTE(Torin) RAM and ROM storage
+//The address space is split into 4KiB pages that are only allocated once they are
+//written, a two level table maps a page index to its memory so a 32 bit address space
+//costs a table of pointers plus the pages that were touched. An image file is mapped
+//with mmap and read in place, a page is copied out of the image the first time it is
+//written. Files ending in .hex are parsed as whitespace separated hex words with
+//@address directives ($readmemh style) and written into pages instead.
+//The contents are serialized (commands, clipboard, autosave) as the path of the mapped
+//image followed by the allocated pages, the image is mapped again instead of being copied
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define MEMORY_PAGE_SIZE 4096
+#define MEMORY_PAGES_PER_TABLE 1024
+#define MEMORY_MAX_ADDRESS_WIDTH 32
+#define MEMORY_IMAGE_PATH_LENGTH 256
+
+struct MemoryStorage {
+  uint32_t address_width;
+  uint32_t data_width;
+  uint32_t word_size;        //bytes per word, 1 2 4 or 8
+
+  uint8_t ***tables;         //tables[page / MEMORY_PAGES_PER_TABLE][page % MEMORY_PAGES_PER_TABLE]
+  uint64_t table_count;
+  uint64_t allocated_pages;
+
+  const uint8_t *image;
+  size_t image_size;
+  char image_path[MEMORY_IMAGE_PATH_LENGTH];  //empty when no image is mapped
+};
+
+//NOTE(Torin) Followed by the image path padded to 8 bytes and then page_count times the
+//uint64_t index of a page and its MEMORY_PAGE_SIZE bytes
+struct MemoryContentsHeader {
+  uint32_t path_length;
+  uint32_t page_count;
+};
+
+static inline
+bool IsMemoryNodeType(uint32_t type){
+  bool result = type == NodeType_RAM || type == NodeType_ROM;
+  return result;
+}
+
+//NOTE(Torin) RAM inputs are address, data, write enable and clock, ROM only has the address
+static inline
+uint32_t GetMemoryPortWidth(const EditorNode *node, bool is_input, size_t index){
+  const MemoryStorage *storage = node->memory;
+  if(!is_input) return storage->data_width;
+  switch(index){
+    case 0: return storage->address_width;
+    case 1: return storage->data_width;
+  }
+  return 1;
+}
+
+static inline
+uint32_t GetMemoryWordSize(uint32_t data_width){
+  uint32_t result = 1;
+  while(result * 8 < data_width) result <<= 1;
+  return result;
+}
+
+static inline
+uint64_t GetMemoryPageCount(uint32_t address_width, uint32_t data_width){
+  uint64_t byte_count = ((uint64_t)1 << address_width) * GetMemoryWordSize(data_width);
+  uint64_t result = (byte_count + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE;
+  return result;
+}
+
+MemoryStorage *CreateMemoryStorage(uint32_t address_width, uint32_t data_width){
+  MemoryStorage *storage = (MemoryStorage *)calloc(1, sizeof(MemoryStorage));
+  storage->address_width = address_width;
+  storage->data_width = data_width;
+  storage->word_size = GetMemoryWordSize(data_width);
+
+  uint64_t page_count = GetMemoryPageCount(address_width, data_width);
+  storage->table_count = (page_count + MEMORY_PAGES_PER_TABLE - 1) / MEMORY_PAGES_PER_TABLE;
+  storage->tables = (uint8_t ***)calloc(storage->table_count, sizeof(uint8_t **));
+  return storage;
+}
+
+static void UnmapMemoryImage(MemoryStorage *storage){
+  if(storage->image == nullptr) return;
+  munmap((void *)storage->image, storage->image_size);
+  storage->image = nullptr;
+  storage->image_size = 0;
+  storage->image_path[0] = 0;
+}
+
+static void FreeMemoryPages(MemoryStorage *storage){
+  for(uint64_t i = 0; i < storage->table_count; i++){
+    uint8_t **table = storage->tables[i];
+    if(table == nullptr) continue;
+    for(size_t n = 0; n < MEMORY_PAGES_PER_TABLE; n++) free(table[n]);
+    free(table);
+    storage->tables[i] = nullptr;
+  }
+  storage->allocated_pages = 0;
+}
+
+void DestroyMemoryStorage(MemoryStorage *storage){
+  if(storage == nullptr) return;
+  FreeMemoryPages(storage);
+  UnmapMemoryImage(storage);
+  free(storage->tables);
+  free(storage);
+}
+
+static inline
+uint64_t GetMemoryWordAddress(const MemoryStorage *storage, uint64_t address){
+  uint64_t result = (address & WordMask(storage->address_width)) * storage->word_size;
+  return result;
+}
+
+static inline
+uint8_t *GetMemoryPage(const MemoryStorage *storage, uint64_t page){
+  uint8_t **table = storage->tables[page / MEMORY_PAGES_PER_TABLE];
+  if(table == nullptr) return nullptr;
+  return table[page % MEMORY_PAGES_PER_TABLE];
+}
+
+static uint8_t *AllocateMemoryPage(MemoryStorage *storage, uint64_t page){
+  uint8_t **table = storage->tables[page / MEMORY_PAGES_PER_TABLE];
+  if(table == nullptr){
+    table = (uint8_t **)calloc(MEMORY_PAGES_PER_TABLE, sizeof(uint8_t *));
+    storage->tables[page / MEMORY_PAGES_PER_TABLE] = table;
+  }
+
+  uint8_t **entry = &table[page % MEMORY_PAGES_PER_TABLE];
+  if(*entry == nullptr){
+    *entry = (uint8_t *)calloc(MEMORY_PAGE_SIZE, 1);
+    uint64_t begin = page * MEMORY_PAGE_SIZE;
+    if(begin < storage->image_size){
+      size_t remaining = storage->image_size - begin;
+      size_t count = remaining < MEMORY_PAGE_SIZE ? remaining : MEMORY_PAGE_SIZE;
+      memcpy(*entry, storage->image + begin, count);
+    }
+    storage->allocated_pages++;
+  }
+  return *entry;
+}
+
+//NOTE(Torin) Words are little endian and never straddle a page since the word size
+//divides the page size
+uint64_t ReadMemoryWord(const MemoryStorage *storage, uint64_t address){
+  uint64_t byte = GetMemoryWordAddress(storage, address);
+  const uint8_t *source = nullptr;
+  size_t count = storage->word_size;
+  const uint8_t *page = GetMemoryPage(storage, byte / MEMORY_PAGE_SIZE);
+  if(page != nullptr){
+    source = page + (byte % MEMORY_PAGE_SIZE);
+  } else if(byte < storage->image_size){
+    source = storage->image + byte;
+    if(storage->image_size - byte < count) count = storage->image_size - byte;
+  }
+
+  uint64_t result = 0;
+  if(source != nullptr) memcpy(&result, source, count);
+  return result & WordMask(storage->data_width);
+}
+
+void WriteMemoryWord(MemoryStorage *storage, uint64_t address, uint64_t value){
+  uint64_t byte = GetMemoryWordAddress(storage, address);
+  uint8_t *page = AllocateMemoryPage(storage, byte / MEMORY_PAGE_SIZE);
+  value &= WordMask(storage->data_width);
+  memcpy(page + (byte % MEMORY_PAGE_SIZE), &value, storage->word_size);
+}
+
+static inline
+int GetHexDigit(uint8_t c){
+  if(c >= '0' && c <= '9') return c - '0';
+  if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static void ParseMemoryHex(MemoryStorage *storage, const uint8_t *text, size_t size){
+  uint64_t address = 0;
+  size_t i = 0;
+  while(i < size){
+    uint8_t c = text[i];
+    if(c == '/' && i + 1 < size && text[i + 1] == '/'){
+      while(i < size && text[i] != '\n') i++;
+      continue;
+    }
+
+    bool isAddress = c == '@';
+    if(isAddress) i++;
+    if(i >= size || GetHexDigit(text[i]) < 0){
+      i++;
+      continue;
+    }
+
+    uint64_t value = 0;
+    while(i < size && (GetHexDigit(text[i]) >= 0 || text[i] == '_')){
+      if(text[i] != '_') value = (value << 4) | GetHexDigit(text[i]);
+      i++;
+    }
+
+    if(isAddress){
+      address = value;
+    } else {
+      WriteMemoryWord(storage, address, value);
+      address++;
+    }
+  }
+}
+
+//NOTE(Torin) Replaces the contents of the memory with the file, returns false if it
+//could not be mapped
+bool LoadMemoryImage(MemoryStorage *storage, const char *filename){
+  size_t nameLength = strlen(filename);
+  if(nameLength >= MEMORY_IMAGE_PATH_LENGTH) return false;
+  int file = open(filename, O_RDONLY);
+  if(file < 0) return false;
+  struct stat info;
+  if(fstat(file, &info) != 0 || info.st_size == 0){
+    close(file);
+    return false;
+  }
+
+  size_t size = (size_t)info.st_size;
+  void *mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if(mapping == MAP_FAILED) return false;
+
+  FreeMemoryPages(storage);
+  UnmapMemoryImage(storage);
+
+  bool isHex = nameLength > 4 && strcmp(filename + nameLength - 4, ".hex") == 0;
+  if(isHex){
+    ParseMemoryHex(storage, (const uint8_t *)mapping, size);
+    munmap(mapping, size);
+  } else {
+    storage->image = (const uint8_t *)mapping;
+    storage->image_size = size;
+    memcpy(storage->image_path, filename, nameLength + 1);
+  }
+  return true;
+}
+
+static inline
+size_t GetMemoryContentsPathSize(uint32_t path_length){
+  size_t result = (path_length + 7) & ~(size_t)7;
+  return result;
+}
+
+//NOTE(Torin) Bytes written by SerializeMemoryContents, always a multiple of 8
+static inline
+size_t GetMemoryContentsSize(const MemoryStorage *storage){
+  size_t result = sizeof(MemoryContentsHeader) + GetMemoryContentsPathSize(strlen(storage->image_path)) +
+    storage->allocated_pages * (sizeof(uint64_t) + MEMORY_PAGE_SIZE);
+  return result;
+}
+
+//NOTE(Torin) Returns the end of the written contents
+uint8_t *SerializeMemoryContents(const MemoryStorage *storage, uint8_t *write){
+  MemoryContentsHeader header = {};
+  header.path_length = strlen(storage->image_path);
+  header.page_count = storage->allocated_pages;
+  size_t pathSize = GetMemoryContentsPathSize(header.path_length);
+  memcpy(write, &header, sizeof(header));
+  write += sizeof(header);
+  memset(write, 0, pathSize);
+  memcpy(write, storage->image_path, header.path_length);
+  write += pathSize;
+  for(uint64_t page = 0; page < storage->table_count * MEMORY_PAGES_PER_TABLE; page++){
+    const uint8_t *data = GetMemoryPage(storage, page);
+    if(data == nullptr) continue;
+    memcpy(write, &page, sizeof(uint64_t));
+    memcpy(write + sizeof(uint64_t), data, MEMORY_PAGE_SIZE);
+    write += sizeof(uint64_t) + MEMORY_PAGE_SIZE;
+  }
+  return write;
+}
+
+//NOTE(Torin) Contents may come from the system clipboard, they have to fit the storage
+bool IsMemoryContentsValid(const uint8_t *data, size_t size, uint32_t address_width, uint32_t data_width){
+  if(size < sizeof(MemoryContentsHeader)) return false;
+  const MemoryContentsHeader *header = (const MemoryContentsHeader *)data;
+  if(header->path_length >= MEMORY_IMAGE_PATH_LENGTH) return false;
+  size_t pathSize = GetMemoryContentsPathSize(header->path_length);
+  if(size != sizeof(MemoryContentsHeader) + pathSize + header->page_count * (uint64_t)(sizeof(uint64_t) + MEMORY_PAGE_SIZE)) return false;
+  const uint8_t *pages = data + sizeof(MemoryContentsHeader) + pathSize;
+  it(i, header->page_count){
+    uint64_t page = 0;
+    memcpy(&page, pages + i * (sizeof(uint64_t) + MEMORY_PAGE_SIZE), sizeof(uint64_t));
+    if(page >= GetMemoryPageCount(address_width, data_width)) return false;
+  }
+  return true;
+}
+
+//NOTE(Torin) Replaces the contents with serialized ones, an image that can no longer be
+//mapped leaves only the pages
+void LoadMemoryContents(MemoryStorage *storage, const uint8_t *data, size_t size){
+  assert(IsMemoryContentsValid(data, size, storage->address_width, storage->data_width));
+  const MemoryContentsHeader *header = (const MemoryContentsHeader *)data;
+  FreeMemoryPages(storage);
+  UnmapMemoryImage(storage);
+  const char *path = (const char *)(header + 1);
+  if(header->path_length > 0){
+    char filename[MEMORY_IMAGE_PATH_LENGTH];
+    memcpy(filename, path, header->path_length);
+    filename[header->path_length] = 0;
+    LoadMemoryImage(storage, filename);
+  }
+  const uint8_t *pages = (const uint8_t *)path + GetMemoryContentsPathSize(header->path_length);
+  it(i, header->page_count){
+    const uint8_t *record = pages + i * (sizeof(uint64_t) + MEMORY_PAGE_SIZE);
+    uint64_t page = 0;
+    memcpy(&page, record, sizeof(uint64_t));
+    memcpy(AllocateMemoryPage(storage, page), record + sizeof(uint64_t), MEMORY_PAGE_SIZE);
+  }
+}
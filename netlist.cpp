@@ -0,0 +1,614 @@
+//NOTE(Torin) Flattened netlist of the whole design
+//Every editor node and every ICNode of every IC instance becomes one or more gates that
+//each drive exactly one net, net and gate indices are the same thing. The netlist is
+//rebuilt whenever Editor::topologyVersion changes and evaluated in levelized order,
+//values use the same three states as the editor so a netlist step produces exactly the
+//signals SimulateNode would
+
+enum NetType : uint8_t {
+  NetType_UNDRIVEN,
+  NetType_CONST0,
+  NetType_CONST1,
+  NetType_INPUT,
+  NetType_CLOCK,
+  NetType_DFF,
+  NetType_BUF,
+  NetType_PORT,
+  NetType_AND,
+  NetType_OR,
+  NetType_XOR,
+  NetType_NOT,
+  NetType_NAND,
+  NetType_NOR,
+  NetType_XNOR,
+  NetType_WORD,
+  NetType_MEMORY,
+  NetType_COUNT,
+};
+
+static const char *NetTypeName[] = {
+  "UNDRIVEN",
+  "CONST0",
+  "CONST1",
+  "INPUT",
+  "CLOCK",
+  "DFF",
+  "BUF",
+  "PORT",
+  "AND",
+  "OR",
+  "XOR",
+  "NOT",
+  "NAND",
+  "NOR",
+  "XNOR",
+  "WORD",
+  "MEMORY",
+};
+
+//NOTE(Torin) These nets always exist at the start of a netlist
+static const uint32_t NET_UNDRIVEN = 0;
+static const uint32_t NET_CONST0 = 1;
+static const uint32_t NET_CONST1 = 2;
+static const uint32_t NET_INVALID = UINT32_MAX;
+
+//NOTE(Torin) PORT gates are the outputs of a flattened IC instance
+//fanin 0 is the internal driver and the remaining fanins are the instance inputs,
+//the port is NONE if any of them is NONE just like SimulateIC refusing to run
+//DFF gates have the fanins D and CLK but are sources for levelization, their value is
+//the NetlistRegister state which is only updated by LatchNetlistRegisters
+//WORD gates are one output of a word node, the bus value is kept in Netlist::words,
+//op is the WordOp and parameter its width or bit index
+//MEMORY gates are the read port of a RAM or ROM, parameter indexes Netlist::memories.
+//Only the address fanin is a dependency, the RAM write port (data, write enable, clock)
+//is sampled by LatchNetlistRegisters like the fanins of a DFF
+struct NetlistGate {
+  NetType type;
+  uint8_t op;
+  uint8_t width;       //bus width of a NetType_WORD gate
+  uint16_t parameter;
+  uint32_t fanin_offset;
+  uint32_t fanin_count;
+};
+
+//NOTE(Torin) Maps nets back onto the editor so the canvas shows netlist results
+//OUTPUT nodes have no outputs of their own and display the net driving their input
+static const uint32_t NETLIST_TAP_OUTPUT_NODE = UINT32_MAX;
+
+struct NetlistTap {
+  EditorNode *node;
+  uint32_t output_index;
+  uint32_t net;
+};
+
+//NOTE(Torin) One per DFF gate, a REGISTER node becomes one DFF gate per bit or a single
+//one holding the whole bus in word, the state is loaded from and stored back to the
+//editor node around every run
+struct NetlistRegister {
+  EditorNode *node;
+  uint32_t bit;
+  uint32_t net;
+  uint32_t width;
+  NodeState state;
+  NodeState clock_state;
+  uint64_t word;
+};
+
+struct NetlistMemory {
+  EditorNode *node;
+  MemoryStorage *storage;
+  uint32_t net;
+  NodeState clock_state;
+};
+
+struct NetlistClock {
+  uint32_t net;
+  uint32_t half_period;
+};
+
+struct FoldedInput {
+  EditorNode *node;
+  NodeState state;
+};
+
+struct NetlistOptimizationStats {
+  uint32_t gates_before;
+  uint32_t gates_after;
+  uint32_t folded;
+  uint32_t merged;
+  uint32_t buffers;
+  uint32_t removed;
+};
+
+struct Netlist {
+  uint64_t topology_version;
+  bool is_levelized;
+
+  DynamicArray<NetlistGate> gates;
+  DynamicArray<uint32_t> fanins;
+  DynamicArray<uint32_t> inputs;        //net of every entry in Editor::inputs
+  DynamicArray<EditorNode *> input_nodes;
+  DynamicArray<NetlistTap> taps;
+  DynamicArray<NetlistRegister> registers;
+  DynamicArray<NetlistClock> clocks;
+  DynamicArray<NetlistMemory> memories;
+  DynamicArray<uint32_t> order;         //levelized gate order, sources are not included
+  DynamicArray<FoldedInput> folded_inputs;
+
+  NodeState *values;
+  uint64_t *words;      //bus value of WORD nets
+  size_t value_capacity;
+
+  NetlistOptimizationStats optimization;
+};
+
+//NOTE(Torin) Sources are not part of the levelized order, their value is set before
+//the combinational gates are evaluated
+static inline
+bool IsNetSource(NetType type){
+  bool result = type <= NetType_DFF;
+  return result;
+}
+
+static inline
+uint32_t AddNetlistGate(Netlist *netlist, NetType type, uint32_t fanin_count){
+  NetlistGate gate = {};
+  gate.type = type;
+  gate.fanin_offset = netlist->fanins.count;
+  gate.fanin_count = fanin_count;
+  ArrayAdd(gate, netlist->gates);
+  for(uint32_t i = 0; i < fanin_count; i++) ArrayAdd(NET_UNDRIVEN, netlist->fanins);
+  return netlist->gates.count - 1;
+}
+
+static inline
+uint32_t *GetFanins(Netlist *netlist, uint32_t gate){
+  return &netlist->fanins.data[netlist->gates.data[gate].fanin_offset];
+}
+
+static inline
+NetType GetNetTypeForNode(uint32_t node_type){
+  switch(node_type){
+    case NodeType_AND:  return NetType_AND;
+    case NodeType_OR:   return NetType_OR;
+    case NodeType_XOR:  return NetType_XOR;
+    case NodeType_NOT:  return NetType_NOT;
+    case NodeType_NAND: return NetType_NAND;
+    case NodeType_NOR:  return NetType_NOR;
+    case NodeType_XNOR: return NetType_XNOR;
+    case NodeType_BUF:  return NetType_BUF;
+  }
+  assert(false);
+  return NetType_UNDRIVEN;
+}
+
+//NOTE(Torin) Truth table of the logic NetTypes, see GateInfo
+static const uint8_t NET_GATE_TRUTH[] = {
+  GetGateTruthTable(GateFunction_ALL, false),    //AND
+  GetGateTruthTable(GateFunction_ANY, false),    //OR
+  GetGateTruthTable(GateFunction_PARITY, false), //XOR
+  GetGateTruthTable(GateFunction_ALL, true),     //NOT
+  GetGateTruthTable(GateFunction_ALL, true),     //NAND
+  GetGateTruthTable(GateFunction_ANY, true),     //NOR
+  GetGateTruthTable(GateFunction_PARITY, true),  //XNOR
+};
+
+static_assert(sizeof(NET_GATE_TRUTH) == NetType_XNOR - NetType_AND + 1, "NET_GATE_TRUTH must cover every logic NetType");
+
+void ResetNetlist(Netlist *netlist){
+  netlist->gates.count = 0;
+  netlist->fanins.count = 0;
+  netlist->inputs.count = 0;
+  netlist->input_nodes.count = 0;
+  netlist->taps.count = 0;
+  netlist->registers.count = 0;
+  netlist->clocks.count = 0;
+  netlist->memories.count = 0;
+  netlist->order.count = 0;
+  netlist->folded_inputs.count = 0;
+  netlist->is_levelized = false;
+  memset(&netlist->optimization, 0, sizeof(netlist->optimization));
+}
+
+void DestroyNetlist(Netlist *netlist){
+  ArrayDestroy(netlist->gates);
+  ArrayDestroy(netlist->fanins);
+  ArrayDestroy(netlist->inputs);
+  ArrayDestroy(netlist->input_nodes);
+  ArrayDestroy(netlist->taps);
+  ArrayDestroy(netlist->registers);
+  ArrayDestroy(netlist->clocks);
+  ArrayDestroy(netlist->memories);
+  ArrayDestroy(netlist->order);
+  ArrayDestroy(netlist->folded_inputs);
+  free(netlist->values);
+  free(netlist->words);
+  netlist->values = 0;
+  netlist->words = 0;
+  netlist->value_capacity = 0;
+}
+
+//NOTE(Torin) Net driving input slot input_index of an editor node
+static inline
+uint32_t GetEditorInputNet(EditorNode *node, size_t input_index){
+  NodeConnection *connection = &node->inputConnections[input_index];
+  if(!IsValid(connection->node_index)) return NET_UNDRIVEN;
+  EditorNode *source = connection->node_index.node_ptr;
+  uint32_t result = source->scratch_index + connection->io_index;
+  return result;
+}
+
+static void FlattenIC(Netlist *netlist, EditorNode *node, ICDefinition *icdef){
+  //NOTE(Torin) node->scratch_index holds the instance's port nets, the internal
+  //ICNode nets follow directly after them
+  uint32_t internalBase = netlist->gates.count;
+  for(uint32_t i = 0; i < icdef->node_count; i++){
+    const ICNode *icnode = &icdef->nodes[i];
+    if(icnode->type == NodeType_INPUT){
+      uint32_t gate = AddNetlistGate(netlist, NetType_BUF, 1);
+      GetFanins(netlist, gate)[0] = GetEditorInputNet(node, i);
+    } else if(icnode->type == NodeType_OUTPUT){
+      AddNetlistGate(netlist, NetType_BUF, 1);
+    } else {
+      AddNetlistGate(netlist, GetNetTypeForNode(icnode->type), icnode->input_count);
+    }
+  }
+
+  for(uint32_t i = 0; i < icdef->node_count; i++){
+    const ICNode *icnode = &icdef->nodes[i];
+    uint32_t connection_count = icnode->output_count > 0 ? icnode->connection_count_per_output[0] : 0;
+    for(uint32_t n = 0; n < connection_count; n++){
+      const ICNodeConnection *connection = &icnode->output_connections[n];
+      GetFanins(netlist, internalBase + connection->node_index)[connection->io_index] = internalBase + i;
+    }
+  }
+
+  for(uint32_t i = 0; i < icdef->output_count; i++){
+    uint32_t port = node->scratch_index + i;
+    uint32_t *fanins = GetFanins(netlist, port);
+    fanins[0] = internalBase + icdef->input_count + i;
+    for(uint32_t n = 0; n < icdef->input_count; n++)
+      fanins[n + 1] = GetEditorInputNet(node, n);
+  }
+}
+
+void BuildNetlist(Netlist *netlist, Editor *editor){
+  PROFILE_SCOPE("BuildNetlist");
+  ResetNetlist(netlist);
+  netlist->topology_version = editor->topologyVersion;
+  ArrayReserve(editor->nodes.count + 3, netlist->gates);
+  ArrayReserve(editor->nodes.count * 2, netlist->fanins);
+  ArrayReserve(editor->nodes.count, netlist->taps);
+
+  AddNetlistGate(netlist, NetType_UNDRIVEN, 0);
+  AddNetlistGate(netlist, NetType_CONST0, 0);
+  AddNetlistGate(netlist, NetType_CONST1, 0);
+
+  //NOTE(Torin) First pass assigns every editor node output a net so connections
+  //can be resolved through EditorNode::scratch_index in the second pass
+  it(i, editor->nodes.count){
+    EditorNode *node = editor->nodes[i];
+    node->scratch_index = netlist->gates.count;
+    if(node->type == NodeType_INPUT){
+      AddNetlistGate(netlist, NetType_INPUT, 0);
+    } else if(node->type == NodeType_OUTPUT){
+      node->scratch_index = NET_INVALID;
+    } else if(node->type == NodeType_CLOCK){
+      NetlistClock clock = {};
+      clock.net = AddNetlistGate(netlist, NetType_CLOCK, 0);
+      clock.half_period = node->parameter;
+      ArrayAdd(clock, netlist->clocks);
+    } else if(node->type == NodeType_DFF || node->type == NodeType_REGISTER){
+      it(n, node->output_count){
+        NetlistRegister reg = {};
+        reg.node = node;
+        reg.bit = n;
+        reg.width = GetPortWidth(node, false, n);
+        reg.net = AddNetlistGate(netlist, NetType_DFF, 2);
+        ArrayAdd(reg, netlist->registers);
+      }
+    } else if(node->type > NodeType_COUNT){
+      ICDefinition *icdef = editor->icdefs[node->type - (NodeType_COUNT + 1)];
+      it(n, icdef->output_count) AddNetlistGate(netlist, NetType_PORT, 1 + icdef->input_count);
+    } else if(IsWordNodeType(node->type)){
+      it(n, node->output_count){
+        uint32_t parameter = 0;
+        uint32_t gate = AddNetlistGate(netlist, NetType_WORD, node->input_count);
+        netlist->gates[gate].op = GetWordOutputOp(node->type, n, node->parameter, &parameter);
+        netlist->gates[gate].width = node->parameter;
+        netlist->gates[gate].parameter = parameter;
+      }
+    } else if(IsMemoryNodeType(node->type)){
+      NetlistMemory memory = {};
+      memory.node = node;
+      memory.storage = node->memory;
+      memory.net = AddNetlistGate(netlist, NetType_MEMORY, node->input_count);
+      assert(netlist->memories.count <= UINT16_MAX);
+      netlist->gates[memory.net].parameter = netlist->memories.count;
+      ArrayAdd(memory, netlist->memories);
+    } else {
+      AddNetlistGate(netlist, GetNetTypeForNode(node->type), node->input_count);
+    }
+  }
+
+  it(i, editor->nodes.count){
+    EditorNode *node = editor->nodes[i];
+    NetlistTap tap = {};
+    tap.node = node;
+    if(node->type == NodeType_OUTPUT){
+      tap.output_index = NETLIST_TAP_OUTPUT_NODE;
+      tap.net = GetEditorInputNet(node, 0);
+      ArrayAdd(tap, netlist->taps);
+    } else if(node->type > NodeType_COUNT){
+      ICDefinition *icdef = editor->icdefs[node->type - (NodeType_COUNT + 1)];
+      FlattenIC(netlist, node, icdef);
+      it(n, node->output_count){
+        tap.output_index = n;
+        tap.net = node->scratch_index + n;
+        ArrayAdd(tap, netlist->taps);
+      }
+    } else {
+      if(node->type == NodeType_REGISTER){
+        uint32_t clockNet = GetEditorInputNet(node, node->output_count);
+        it(n, node->output_count){
+          uint32_t *fanins = GetFanins(netlist, node->scratch_index + n);
+          fanins[0] = GetEditorInputNet(node, n);
+          fanins[1] = clockNet;
+        }
+      } else if(IsWordNodeType(node->type)){
+        it(o, node->output_count){
+          uint32_t *fanins = GetFanins(netlist, node->scratch_index + o);
+          it(n, node->input_count) fanins[n] = GetEditorInputNet(node, n);
+        }
+      } else if(node->input_count > 0){
+        uint32_t *fanins = GetFanins(netlist, node->scratch_index);
+        it(n, node->input_count) fanins[n] = GetEditorInputNet(node, n);
+      }
+      it(n, node->output_count){
+        tap.output_index = n;
+        tap.net = node->scratch_index + n;
+        ArrayAdd(tap, netlist->taps);
+      }
+    }
+  }
+
+  it(i, editor->inputs.count){
+    ArrayAdd((uint32_t)editor->inputs[i]->scratch_index, netlist->inputs);
+    ArrayAdd(editor->inputs[i], netlist->input_nodes);
+  }
+}
+
+//NOTE(Torin) Kahn's algorithm over the gate fanins, a netlist containing a
+//combinational loop cannot be levelized and is left to the event driven simulator
+//fanins of DFF gates are not dependencies so feedback through a register is fine
+static inline
+uint32_t GetDependencyCount(const NetlistGate *gate){
+  if(IsNetSource(gate->type)) return 0;
+  if(gate->type == NetType_MEMORY) return 1;
+  return gate->fanin_count;
+}
+
+bool LevelizeNetlist(Netlist *netlist){
+  PROFILE_SCOPE("LevelizeNetlist");
+  uint32_t gate_count = netlist->gates.count;
+  uint32_t *pending = (uint32_t *)calloc(gate_count, sizeof(uint32_t));
+  uint32_t *fanoutOffset = (uint32_t *)calloc(gate_count + 1, sizeof(uint32_t));
+  uint32_t *fanouts = (uint32_t *)malloc(sizeof(uint32_t) * (netlist->fanins.count + 1));
+
+  it(g, gate_count){
+    const NetlistGate *gate = &netlist->gates.data[g];
+    pending[g] = GetDependencyCount(gate);
+    it(n, pending[g]) fanoutOffset[netlist->fanins.data[gate->fanin_offset + n] + 1]++;
+  }
+  it(g, gate_count) fanoutOffset[g + 1] += fanoutOffset[g];
+  uint32_t *cursor = (uint32_t *)malloc(sizeof(uint32_t) * (gate_count + 1));
+  memcpy(cursor, fanoutOffset, sizeof(uint32_t) * (gate_count + 1));
+  it(g, gate_count){
+    const NetlistGate *gate = &netlist->gates.data[g];
+    it(n, GetDependencyCount(gate)) fanouts[cursor[netlist->fanins.data[gate->fanin_offset + n]]++] = g;
+  }
+
+  uint32_t *queue = (uint32_t *)malloc(sizeof(uint32_t) * (gate_count + 1));
+  uint32_t queueCount = 0;
+  it(g, gate_count) if(pending[g] == 0) queue[queueCount++] = g;
+
+  netlist->order.count = 0;
+  for(uint32_t i = 0; i < queueCount; i++){
+    uint32_t g = queue[i];
+    if(!IsNetSource(netlist->gates.data[g].type)) ArrayAdd(g, netlist->order);
+    for(uint32_t n = fanoutOffset[g]; n < fanoutOffset[g + 1]; n++){
+      uint32_t target = fanouts[n];
+      if(--pending[target] == 0) queue[queueCount++] = target;
+    }
+  }
+
+  netlist->is_levelized = (queueCount == gate_count);
+  if(netlist->value_capacity < gate_count){
+    free(netlist->values);
+    free(netlist->words);
+    netlist->values = (NodeState *)malloc(sizeof(NodeState) * gate_count);
+    netlist->words = (uint64_t *)malloc(sizeof(uint64_t) * gate_count);
+    netlist->value_capacity = gate_count;
+  }
+
+  free(pending);
+  free(fanoutOffset);
+  free(fanouts);
+  free(cursor);
+  free(queue);
+  return netlist->is_levelized;
+}
+
+static inline
+NodeState EvaluateNetlistGate(const NetlistGate *gate, const uint32_t *fanins, const NodeState *values){
+  uint32_t highCount = 0;
+  for(uint32_t i = 0; i < gate->fanin_count; i++){
+    NodeState value = values[fanins[i]];
+    if(value == NodeState_NONE) return NodeState_NONE;
+    highCount += value;
+  }
+
+  if(gate->type == NetType_BUF || gate->type == NetType_PORT) return values[fanins[0]];
+  assert(gate->type >= NetType_AND && gate->type <= NetType_XNOR);
+  uint8_t truth = NET_GATE_TRUTH[gate->type - NetType_AND];
+  NodeState result = (NodeState)((truth >> GetGateTruthIndex(highCount, gate->fanin_count)) & 1);
+  return result;
+}
+
+//NOTE(Torin) Value of a net as a port of the given width, single bit nets have no word
+static inline
+uint64_t GetNetWord(const NodeState *values, const uint64_t *words, uint32_t net, uint32_t width){
+  uint64_t result = width > 1 ? words[net] : (values[net] == NodeState_HIGH);
+  return result;
+}
+
+//NOTE(Torin) Fanins are read with the width of their port (see GetPortWidth), the MUX
+//select and MERGE inputs are single bits and so is every input of a width 1 word node
+static inline
+NodeState EvaluateNetlistWordGate(const NetlistGate *gate, const uint32_t *fanins, const NodeState *values, const uint64_t *words, uint64_t *result){
+  uint64_t inputs[BUS_MAX_WIDTH];
+  assert(gate->fanin_count <= BUS_MAX_WIDTH);
+  for(uint32_t i = 0; i < gate->fanin_count; i++){
+    if(values[fanins[i]] == NodeState_NONE) return NodeState_NONE;
+    bool isBitInput = gate->op == WordOp_MERGE || (gate->op == WordOp_MUX && i == 0);
+    inputs[i] = GetNetWord(values, words, fanins[i], isBitInput ? 1 : gate->width);
+  }
+  *result = EvaluateWordOp((WordOp)gate->op, gate->parameter, inputs, gate->fanin_count);
+  return *result ? NodeState_HIGH : NodeState_LOW;
+}
+
+void EvaluateNetlist(Netlist *netlist, uint64_t clock_tick){
+  PROFILE_SCOPE("EvaluateNetlist");
+  assert(netlist->is_levelized);
+  NodeState *values = netlist->values;
+  values[NET_UNDRIVEN] = NodeState_NONE;
+  values[NET_CONST0] = NodeState_LOW;
+  values[NET_CONST1] = NodeState_HIGH;
+  uint64_t *words = netlist->words;
+  it(i, netlist->inputs.count){
+    uint32_t net = netlist->inputs[i];
+    values[net] = netlist->input_nodes[i]->signal_state;
+    words[net] = netlist->input_nodes[i]->bus_value;
+  }
+  it(i, netlist->clocks.count){
+    const NetlistClock *clock = &netlist->clocks.data[i];
+    values[clock->net] = GetClockState(clock->half_period, clock_tick);
+  }
+  it(i, netlist->registers.count){
+    const NetlistRegister *reg = &netlist->registers.data[i];
+    values[reg->net] = reg->state;
+    words[reg->net] = reg->word;
+  }
+
+  const uint32_t *fanins = netlist->fanins.data;
+  it(i, netlist->order.count){
+    uint32_t g = netlist->order.data[i];
+    const NetlistGate *gate = &netlist->gates.data[g];
+    if(gate->type == NetType_WORD){
+      values[g] = EvaluateNetlistWordGate(gate, fanins + gate->fanin_offset, values, words, &words[g]);
+    } else if(gate->type == NetType_MEMORY){
+      uint32_t address = fanins[gate->fanin_offset];
+      if(values[address] == NodeState_NONE){
+        values[g] = NodeState_NONE;
+        continue;
+      }
+      const MemoryStorage *storage = netlist->memories.data[gate->parameter].storage;
+      uint64_t word = ReadMemoryWord(storage, GetNetWord(values, words, address, storage->address_width));
+      words[g] = word;
+      values[g] = word ? NodeState_HIGH : NodeState_LOW;
+    } else {
+      values[g] = EvaluateNetlistGate(gate, fanins + gate->fanin_offset, values);
+    }
+  }
+}
+
+//NOTE(Torin) Copies net values back onto the editor nodes for display and for the
+//activity counters, nets removed by the optimizer read as NONE
+void WriteBackNetlist(Netlist *netlist){
+  it(i, netlist->taps.count){
+    NetlistTap *tap = &netlist->taps[i];
+    NodeState state = tap->net == NET_INVALID ? NodeState_NONE : netlist->values[tap->net];
+    if(tap->output_index == NETLIST_TAP_OUTPUT_NODE){
+      tap->node->signal_state = (state == NodeState_NONE) ? NodeState_LOW : state;
+      if(state != NodeState_NONE && GetPortWidth(tap->node, true, 0) > 1)
+        tap->node->input_value[0] = netlist->words[tap->net];
+    } else {
+      tap->node->output_state[tap->output_index] = state;
+      if(state != NodeState_NONE) tap->node->signal_state = state;
+      if(state != NodeState_NONE && GetPortWidth(tap->node, false, tap->output_index) > 1)
+        tap->node->output_value[tap->output_index] = netlist->words[tap->net];
+    }
+  }
+}
+
+void LoadNetlistRegisters(Netlist *netlist){
+  it(i, netlist->registers.count){
+    NetlistRegister *reg = &netlist->registers[i];
+    reg->state = reg->node->output_state[reg->bit];
+    reg->word = GetOutputWord(reg->node, reg->bit);
+    reg->clock_state = reg->node->clock_state;
+  }
+  it(i, netlist->memories.count){
+    NetlistMemory *memory = &netlist->memories[i];
+    memory->clock_state = memory->node->clock_state;
+  }
+}
+
+void StoreNetlistRegisters(Netlist *netlist){
+  it(i, netlist->registers.count){
+    NetlistRegister *reg = &netlist->registers[i];
+    reg->node->output_state[reg->bit] = reg->state;
+    reg->node->output_value[reg->bit] = reg->word;
+    reg->node->clock_state = reg->clock_state;
+  }
+  it(i, netlist->memories.count){
+    NetlistMemory *memory = &netlist->memories[i];
+    memory->node->clock_state = memory->clock_state;
+  }
+}
+
+//NOTE(Torin) Samples D on a LOW to HIGH transition of CLK using the values of the last
+//EvaluateNetlist, only NetlistRegister::state changes so every register sees the
+//pre-edge values of the others. A NONE data input keeps the previous state
+//RAM write ports are sampled the same way, the write is visible to the next evaluation
+void LatchNetlistRegisters(Netlist *netlist){
+  const NodeState *values = netlist->values;
+  const uint64_t *words = netlist->words;
+  it(i, netlist->registers.count){
+    NetlistRegister *reg = &netlist->registers[i];
+    const uint32_t *fanins = GetFanins(netlist, reg->net);
+    NodeState data = values[fanins[0]];
+    NodeState clock = values[fanins[1]];
+    if(reg->clock_state == NodeState_LOW && clock == NodeState_HIGH && data != NodeState_NONE){
+      reg->state = data;
+      reg->word = GetNetWord(values, words, fanins[0], reg->width);
+    }
+    reg->clock_state = clock;
+  }
+
+  it(i, netlist->memories.count){
+    NetlistMemory *memory = &netlist->memories[i];
+    if(memory->node->type != NodeType_RAM) continue;
+    const uint32_t *fanins = GetFanins(netlist, memory->net);
+    NodeState clock = values[fanins[3]];
+    bool isWrite = memory->clock_state == NodeState_LOW && clock == NodeState_HIGH && values[fanins[2]] == NodeState_HIGH;
+    if(isWrite && values[fanins[0]] != NodeState_NONE && values[fanins[1]] != NodeState_NONE){
+      MemoryStorage *storage = memory->storage;
+      WriteMemoryWord(storage, GetNetWord(values, words, fanins[0], storage->address_width),
+        GetNetWord(values, words, fanins[1], storage->data_width));
+    }
+    memory->clock_state = clock;
+  }
+}
+
+//NOTE(Torin) Cycle based simulation, the combinational logic between the register
+//boundaries is evaluated once per tick in levelized order followed by the latch
+void RunNetlistCycles(Netlist *netlist, uint64_t first_tick, uint64_t tick_count){
+  PROFILE_SCOPE("RunNetlistCycles");
+  LoadNetlistRegisters(netlist);
+  for(uint64_t i = 0; i < tick_count; i++){
+    EvaluateNetlist(netlist, first_tick + i);
+    LatchNetlistRegisters(netlist);
+  }
+  StoreNetlistRegisters(netlist);
+}
@@ -0,0 +1,305 @@
+//NOTE(Torin) Pre-simulation logic optimization on the flattened netlist
+//Gates are visited once in levelized order with their fanins already replaced by the
+//representative net of each driver, which allows three rewrites in a single pass:
+//  constant folding: NONE absorbs, AND/OR/XOR identities and their inverted forms,
+//                    duplicate fanins, stable inputs
+//  structural hashing: a gate identical to an earlier one (same type, same fanins) is merged
+//  buffer removal: BUF and fully driven PORT gates become their driver
+//Afterwards only gates reaching a displayed OUTPUT node or a register are kept and the
+//netlist is compacted, registers and RAMs themselves are always kept since they hold state
+
+struct NetlistOptimizerSettings {
+  //NOTE(Torin) Inputs that never toggled are folded to their current value,
+  //the netlist is rebuilt by SimulationStep as soon as one of them changes
+  bool fold_stable_inputs;
+};
+
+static inline
+uint32_t HashGate(const NetlistGate *gate, const uint32_t *fanins, uint32_t fanin_count){
+  uint32_t hash = 2166136261u ^ gate->type ^ (gate->op << 8) ^ (gate->parameter << 16);
+  for(uint32_t i = 0; i < fanin_count; i++) hash = (hash ^ fanins[i]) * 16777619u;
+  return hash;
+}
+
+static inline
+void SortFanins(uint32_t *fanins, uint32_t count){
+  for(uint32_t i = 1; i < count; i++){
+    uint32_t value = fanins[i];
+    uint32_t n = i;
+    while(n > 0 && fanins[n - 1] > value){
+      fanins[n] = fanins[n - 1];
+      n--;
+    }
+    fanins[n] = value;
+  }
+}
+
+static inline
+uint32_t InvertConstant(uint32_t net){
+  uint32_t result = (net == NET_CONST0) ? NET_CONST1 : NET_CONST0;
+  return result;
+}
+
+//NOTE(Torin) Rewrites the (representative) fanins of a gate in place, an inverted gate
+//reduced to a single fanin becomes a NOT
+//returns the net the gate collapses into or NET_INVALID if the gate remains
+static uint32_t SimplifyGate(NetType *type, uint32_t *fanins, uint32_t *fanin_count){
+  uint32_t count = *fanin_count;
+  for(uint32_t i = 0; i < count; i++)
+    if(fanins[i] == NET_UNDRIVEN) return NET_UNDRIVEN;
+
+  switch(*type){
+    case NetType_BUF:
+    case NetType_PORT: return fanins[0];
+
+    case NetType_NOT: {
+      if(fanins[0] == NET_CONST0 || fanins[0] == NET_CONST1) return InvertConstant(fanins[0]);
+    } break;
+
+    case NetType_AND:
+    case NetType_OR:
+    case NetType_NAND:
+    case NetType_NOR: {
+      bool isAnd = *type == NetType_AND || *type == NetType_NAND;
+      bool isInverted = *type == NetType_NAND || *type == NetType_NOR;
+      uint32_t identity = isAnd ? NET_CONST1 : NET_CONST0;
+      uint32_t absorbing = isAnd ? NET_CONST0 : NET_CONST1;
+      SortFanins(fanins, count);
+      uint32_t kept = 0;
+      for(uint32_t i = 0; i < count; i++){
+        if(fanins[i] == absorbing) return isInverted ? InvertConstant(absorbing) : absorbing;
+        if(fanins[i] == identity) continue;
+        if(kept > 0 && fanins[kept - 1] == fanins[i]) continue;
+        fanins[kept++] = fanins[i];
+      }
+      *fanin_count = kept;
+      if(kept == 0) return isInverted ? InvertConstant(identity) : identity;
+      if(kept == 1){
+        if(!isInverted) return fanins[0];
+        *type = NetType_NOT;
+      }
+    } break;
+
+    case NetType_XOR:
+    case NetType_XNOR: {
+      SortFanins(fanins, count);
+      uint32_t parity = (*type == NetType_XNOR);
+      uint32_t kept = 0;
+      for(uint32_t i = 0; i < count; i++){
+        if(fanins[i] == NET_CONST0) continue;
+        if(fanins[i] == NET_CONST1){ parity ^= 1; continue; }
+        if(kept > 0 && fanins[kept - 1] == fanins[i]){ kept--; continue; }
+        fanins[kept++] = fanins[i];
+      }
+      if(kept == 0) return parity ? NET_CONST1 : NET_CONST0;
+      if(kept == 1 && parity == 0) return fanins[0];
+      if(kept == 1) *type = NetType_NOT;
+      else *type = parity ? NetType_XNOR : NetType_XOR;
+      *fanin_count = kept;
+    } break;
+
+    //NOTE(Torin) Word gates are only merged by structural hashing
+    case NetType_WORD: break;
+
+    default: assert(false);
+  }
+  return NET_INVALID;
+}
+
+void OptimizeNetlist(Netlist *netlist, const NetlistOptimizerSettings *settings){
+  PROFILE_SCOPE("OptimizeNetlist");
+  assert(netlist->is_levelized);
+  uint32_t gate_count = netlist->gates.count;
+  NetlistOptimizationStats *stats = &netlist->optimization;
+  stats->gates_before = netlist->order.count;
+
+  uint32_t *representative = (uint32_t *)malloc(sizeof(uint32_t) * gate_count);
+  uint32_t *newFanins = (uint32_t *)malloc(sizeof(uint32_t) * (netlist->fanins.count + 1));
+  NetlistGate *newGates = (NetlistGate *)malloc(sizeof(NetlistGate) * gate_count);
+  memcpy(newGates, netlist->gates.data, sizeof(NetlistGate) * gate_count);
+  for(uint32_t i = 0; i < gate_count; i++) representative[i] = i;
+
+  if(settings->fold_stable_inputs){
+    it(i, netlist->inputs.count){
+      uint32_t net = netlist->inputs[i];
+      EditorNode *node = netlist->input_nodes[i];
+      //NOTE(Torin) A bus input feeds word gates which only read Netlist::words
+      if(node->output_activity[0].toggle_count != 0 || GetPortWidth(node, false, 0) > 1) continue;
+      representative[net] = (node->signal_state == NodeState_HIGH) ? NET_CONST1 : NET_CONST0;
+      FoldedInput folded = { node, node->signal_state };
+      ArrayAdd(folded, netlist->folded_inputs);
+    }
+  }
+
+  uint32_t hashCapacity = 16;
+  while(hashCapacity < gate_count * 2) hashCapacity <<= 1;
+  uint32_t *hashTable = (uint32_t *)malloc(sizeof(uint32_t) * hashCapacity);
+  memset(hashTable, 0xFF, sizeof(uint32_t) * hashCapacity);
+
+  it(i, netlist->order.count){
+    uint32_t g = netlist->order[i];
+    NetlistGate *gate = &newGates[g];
+    uint32_t *fanins = newFanins + gate->fanin_offset;
+    const uint32_t *oldFanins = netlist->fanins.data + gate->fanin_offset;
+    for(uint32_t n = 0; n < gate->fanin_count; n++) fanins[n] = representative[oldFanins[n]];
+
+    //NOTE(Torin) Memories hold state, two read ports with the same address are still
+    //different memories so they are neither folded nor merged
+    if(gate->type == NetType_MEMORY) continue;
+
+    uint32_t collapsed = SimplifyGate(&gate->type, fanins, &gate->fanin_count);
+    if(collapsed != NET_INVALID){
+      representative[g] = collapsed;
+      if(gate->type == NetType_BUF || gate->type == NetType_PORT) stats->buffers++;
+      else stats->folded++;
+      continue;
+    }
+
+    uint32_t slot = HashGate(gate, fanins, gate->fanin_count) & (hashCapacity - 1);
+    while(hashTable[slot] != UINT32_MAX){
+      const NetlistGate *other = &newGates[hashTable[slot]];
+      if(other->type == gate->type && other->fanin_count == gate->fanin_count &&
+        other->op == gate->op && other->parameter == gate->parameter &&
+        memcmp(newFanins + other->fanin_offset, fanins, sizeof(uint32_t) * gate->fanin_count) == 0){
+        break;
+      }
+      slot = (slot + 1) & (hashCapacity - 1);
+    }
+
+    if(hashTable[slot] != UINT32_MAX){
+      representative[g] = hashTable[slot];
+      stats->merged++;
+    } else {
+      hashTable[slot] = g;
+    }
+  }
+
+  //NOTE(Torin) DFF gates are sources and the RAM write port is not a dependency so these
+  //fanins can be driven by gates later in the order, they are remapped once every
+  //representative is known
+  it(i, netlist->registers.count){
+    const NetlistGate *gate = &newGates[netlist->registers[i].net];
+    for(uint32_t n = 0; n < gate->fanin_count; n++){
+      uint32_t index = gate->fanin_offset + n;
+      newFanins[index] = representative[netlist->fanins.data[index]];
+    }
+  }
+  it(i, netlist->memories.count){
+    const NetlistGate *gate = &newGates[netlist->memories[i].net];
+    for(uint32_t n = 1; n < gate->fanin_count; n++){
+      uint32_t index = gate->fanin_offset + n;
+      newFanins[index] = representative[netlist->fanins.data[index]];
+    }
+  }
+
+  //NOTE(Torin) Liveness, a gate is kept if it is in the fanin cone of an OUTPUT node or
+  //a register, registers feed back into their own cone so this is a worklist walk over
+  //the fanins instead of a single backwards pass over the order
+  uint8_t *live = (uint8_t *)calloc(gate_count, 1);
+  uint32_t *liveStack = (uint32_t *)malloc(sizeof(uint32_t) * gate_count);
+  uint32_t liveStackCount = 0;
+  live[NET_UNDRIVEN] = live[NET_CONST0] = live[NET_CONST1] = 1;
+  it(i, netlist->inputs.count) live[netlist->inputs[i]] = 1;
+  it(i, netlist->taps.count){
+    NetlistTap *tap = &netlist->taps[i];
+    if(tap->net == NET_INVALID) continue;
+    tap->net = representative[tap->net];
+    if(tap->output_index == NETLIST_TAP_OUTPUT_NODE && !live[tap->net]){
+      live[tap->net] = 1;
+      liveStack[liveStackCount++] = tap->net;
+    }
+  }
+  it(i, netlist->registers.count){
+    uint32_t net = netlist->registers[i].net;
+    if(live[net]) continue;
+    live[net] = 1;
+    liveStack[liveStackCount++] = net;
+  }
+  //NOTE(Torin) A RAM is written even when nothing reads it
+  it(i, netlist->memories.count){
+    const NetlistMemory *memory = &netlist->memories[i];
+    if(memory->node->type != NodeType_RAM || live[memory->net]) continue;
+    live[memory->net] = 1;
+    liveStack[liveStackCount++] = memory->net;
+  }
+
+  while(liveStackCount > 0){
+    const NetlistGate *gate = &newGates[liveStack[--liveStackCount]];
+    for(uint32_t n = 0; n < gate->fanin_count; n++){
+      uint32_t fanin = newFanins[gate->fanin_offset + n];
+      if(live[fanin]) continue;
+      live[fanin] = 1;
+      liveStack[liveStackCount++] = fanin;
+    }
+  }
+
+  //NOTE(Torin) Compaction, the surviving gates keep their relative position in the
+  //levelized order so the netlist does not need to be levelized again
+  uint32_t *newIndex = (uint32_t *)malloc(sizeof(uint32_t) * gate_count);
+  uint32_t keptCount = 0;
+  for(uint32_t g = 0; g < gate_count; g++){
+    bool isCanonical = IsNetSource(netlist->gates.data[g].type) ? true : representative[g] == g;
+    newIndex[g] = (live[g] && isCanonical) ? keptCount++ : NET_INVALID;
+  }
+
+  DynamicArray<NetlistGate> compactGates;
+  DynamicArray<uint32_t> compactFanins;
+  ArrayReserve(keptCount, compactGates);
+  ArrayReserve(netlist->fanins.count, compactFanins);
+  for(uint32_t g = 0; g < gate_count; g++){
+    if(newIndex[g] == NET_INVALID) continue;
+    NetlistGate gate = newGates[g];
+    const uint32_t *fanins = newFanins + gate.fanin_offset;
+    gate.fanin_offset = compactFanins.count;
+    for(uint32_t n = 0; n < gate.fanin_count; n++) ArrayAdd(newIndex[fanins[n]], compactFanins);
+    ArrayAdd(gate, compactGates);
+  }
+
+  uint32_t orderCount = 0;
+  it(i, netlist->order.count){
+    uint32_t g = netlist->order[i];
+    if(newIndex[g] != NET_INVALID) netlist->order[orderCount++] = newIndex[g];
+  }
+  netlist->order.count = orderCount;
+
+  it(i, netlist->inputs.count){
+    netlist->inputs[i] = newIndex[netlist->inputs[i]];
+  }
+  it(i, netlist->taps.count){
+    NetlistTap *tap = &netlist->taps[i];
+    if(tap->net == NET_INVALID) continue;
+    tap->net = newIndex[tap->net];
+  }
+  it(i, netlist->registers.count){
+    netlist->registers[i].net = newIndex[netlist->registers[i].net];
+  }
+  //NOTE(Torin) Not compacted since MEMORY gates index this array, a removed ROM keeps
+  //an entry with an invalid net
+  it(i, netlist->memories.count){
+    netlist->memories[i].net = newIndex[netlist->memories[i].net];
+  }
+
+  uint32_t clockCount = 0;
+  it(i, netlist->clocks.count){
+    NetlistClock clock = netlist->clocks[i];
+    if(newIndex[clock.net] == NET_INVALID) continue;
+    clock.net = newIndex[clock.net];
+    netlist->clocks[clockCount++] = clock;
+  }
+  netlist->clocks.count = clockCount;
+
+  ArrayDestroy(netlist->gates);
+  ArrayDestroy(netlist->fanins);
+  netlist->gates = compactGates;
+  netlist->fanins = compactFanins;
+  stats->gates_after = netlist->order.count;
+  stats->removed = stats->gates_before - stats->gates_after - stats->folded - stats->merged - stats->buffers;
+
+  free(representative);
+  free(newFanins);
+  free(newGates);
+  free(hashTable);
+  free(live);
+  free(liveStack);
+  free(newIndex);
+}
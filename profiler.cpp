@@ -0,0 +1,336 @@
+//NOTE(Torin) Lightweight scoped timing instrumentation
+//Each thread writes completed scopes into its own ring buffer using rdtsc timestamps so
+//recording never takes a lock. When the profiler is disabled a scope costs a single branch
+//and defining PROFILER_DISABLED compiles the instrumentation out entirely
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <x86intrin.h>
+#include "imgui.h"
+
+#define PROFILER_EVENT_CAPACITY (1 << 16)
+#define PROFILER_CAPTURE_CAPACITY 8192
+#define PROFILER_MAX_THREADS 64
+#define PROFILER_FRAME_HISTORY 128
+
+struct ProfilerEvent {
+  const char *name;
+  uint64_t begin;
+  uint64_t end;
+  uint32_t depth;
+};
+
+struct ProfilerThread {
+  uint32_t thread_id;
+  uint32_t depth;
+  std::atomic<bool> is_released;  //its thread exited, the next new thread takes over the buffer
+  std::atomic<uint64_t> write_index;
+  ProfilerEvent events[PROFILER_EVENT_CAPACITY];
+};
+
+struct Profiler {
+  bool enabled;
+  bool paused;
+
+  ProfilerThread *threads[PROFILER_MAX_THREADS];
+  std::atomic<uint32_t> thread_count;
+
+  uint64_t calibration_tsc;
+  std::chrono::steady_clock::time_point calibration_time;
+  double ticks_per_second;
+
+  uint64_t frame_begin;
+  float frame_ms[PROFILER_FRAME_HISTORY];
+  uint32_t frame_index;
+
+  //NOTE(Torin) Copy of the main threads scopes from the last completed frame
+  //this is what the timeline panel displays
+  ProfilerEvent captured[PROFILER_CAPTURE_CAPACITY];
+  uint32_t captured_count;
+  uint64_t captured_begin;
+  uint64_t captured_end;
+};
+
+static Profiler g_profiler;
+
+//NOTE(Torin) Releases the buffer of a thread when it exits, threads that come and go such
+//as the fault simulation workers keep reusing the same few buffers
+struct ProfilerThreadHandle {
+  ProfilerThread *thread;
+  ~ProfilerThreadHandle(){
+    if(thread != nullptr) thread->is_released.store(true, std::memory_order_release);
+  }
+};
+
+static thread_local ProfilerThreadHandle t_profilerThread;
+
+static inline
+uint64_t ProfilerTimestamp(){
+  return __rdtsc();
+}
+
+//NOTE(Torin) A reused buffer keeps the events of the thread that exited, they are simply
+//overwritten as the ring wraps
+static ProfilerThread *ProfilerGetThread(){
+  if(t_profilerThread.thread != nullptr) return t_profilerThread.thread;
+  ProfilerThread *thread = nullptr;
+  uint32_t threadCount = g_profiler.thread_count.load();
+  for(uint32_t i = 0; i < threadCount && thread == nullptr; i++){
+    ProfilerThread *released = g_profiler.threads[i];
+    bool isReleased = true;
+    if(released != nullptr && released->is_released.compare_exchange_strong(isReleased, false)) thread = released;
+  }
+  if(thread == nullptr){
+    uint32_t index = g_profiler.thread_count.fetch_add(1);
+    assert(index < PROFILER_MAX_THREADS);
+    thread = (ProfilerThread *)calloc(1, sizeof(ProfilerThread));
+    thread->thread_id = index;
+    g_profiler.threads[index] = thread;
+  }
+  thread->depth = 0;
+  t_profilerThread.thread = thread;
+  return thread;
+}
+
+struct ProfileScope {
+  const char *name;
+  uint64_t begin;
+  ProfilerThread *thread;
+
+  ProfileScope(const char *scopeName){
+    thread = nullptr;
+    if(!g_profiler.enabled) return;
+    thread = ProfilerGetThread();
+    name = scopeName;
+    thread->depth++;
+    begin = ProfilerTimestamp();
+  }
+
+  ~ProfileScope(){
+    if(thread == nullptr) return;
+    uint64_t end = ProfilerTimestamp();
+    thread->depth--;
+    uint64_t index = thread->write_index.load(std::memory_order_relaxed);
+    ProfilerEvent *event = &thread->events[index & (PROFILER_EVENT_CAPACITY - 1)];
+    event->name = name;
+    event->begin = begin;
+    event->end = end;
+    event->depth = thread->depth;
+    thread->write_index.store(index + 1, std::memory_order_release);
+  }
+};
+
+#ifndef PROFILER_DISABLED
+#define PROFILE_CONCAT_INTERNAL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INTERNAL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#endif
+
+void ProfilerInit(){
+  g_profiler.calibration_tsc = ProfilerTimestamp();
+  g_profiler.calibration_time = std::chrono::steady_clock::now();
+  g_profiler.ticks_per_second = 1.0e9;
+  g_profiler.frame_begin = g_profiler.calibration_tsc;
+  ProfilerGetThread();
+}
+
+static inline
+double ProfilerTicksToMilliseconds(uint64_t ticks){
+  double result = ((double)ticks / g_profiler.ticks_per_second) * 1000.0;
+  return result;
+}
+
+static void ProfilerCalibrate(uint64_t now){
+  auto elapsed = std::chrono::steady_clock::now() - g_profiler.calibration_time;
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  if(seconds > 0.01){
+    g_profiler.ticks_per_second = (double)(now - g_profiler.calibration_tsc) / seconds;
+  }
+}
+
+//NOTE(Torin) Called once at the start of every frame on the main thread
+//Closes the previous frame and captures its scopes for the timeline panel
+void ProfilerBeginFrame(){
+  uint64_t now = ProfilerTimestamp();
+  ProfilerCalibrate(now);
+
+  uint64_t previousBegin = g_profiler.frame_begin;
+  g_profiler.frame_begin = now;
+  g_profiler.frame_ms[g_profiler.frame_index % PROFILER_FRAME_HISTORY] = (float)ProfilerTicksToMilliseconds(now - previousBegin);
+  g_profiler.frame_index++;
+
+  if(g_profiler.paused || !g_profiler.enabled) return;
+
+  ProfilerThread *thread = ProfilerGetThread();
+  uint64_t writeIndex = thread->write_index.load(std::memory_order_acquire);
+  uint64_t available = writeIndex < PROFILER_EVENT_CAPACITY ? writeIndex : PROFILER_EVENT_CAPACITY;
+
+  //NOTE(Torin) Events are written when a scope closes so walking backwards
+  //visits them in order of decreasing end time
+  g_profiler.captured_count = 0;
+  for(uint64_t i = 0; i < available && g_profiler.captured_count < PROFILER_CAPTURE_CAPACITY; i++){
+    const ProfilerEvent *event = &thread->events[(writeIndex - 1 - i) & (PROFILER_EVENT_CAPACITY - 1)];
+    if(event->end <= previousBegin) break;
+    if(event->begin < previousBegin) continue;
+    g_profiler.captured[g_profiler.captured_count++] = *event;
+  }
+  g_profiler.captured_begin = previousBegin;
+  g_profiler.captured_end = now;
+}
+
+static void WriteJSONString(FILE *file, const char *text){
+  fputc('"', file);
+  for(const char *c = text; *c; c++){
+    if(*c == '"' || *c == '\\') fputc('\\', file);
+    fputc(*c, file);
+  }
+  fputc('"', file);
+}
+
+//NOTE(Torin) Writes every event still held in the ring buffers in the
+//Chrome trace event format (load with chrome://tracing or ui.perfetto.dev)
+bool ProfilerExportChromeTrace(const char *filename){
+  FILE *file = fopen(filename, "wb");
+  if(file == nullptr) return false;
+
+  ProfilerCalibrate(ProfilerTimestamp());
+  double ticksPerMicrosecond = g_profiler.ticks_per_second / 1.0e6;
+
+  fprintf(file, "{\"traceEvents\":[\n");
+  bool first = true;
+  uint32_t threadCount = g_profiler.thread_count.load();
+  for(uint32_t t = 0; t < threadCount; t++){
+    ProfilerThread *thread = g_profiler.threads[t];
+    if(thread == nullptr) continue;  //still being created
+    uint64_t writeIndex = thread->write_index.load(std::memory_order_acquire);
+    uint64_t begin = writeIndex > PROFILER_EVENT_CAPACITY ? writeIndex - PROFILER_EVENT_CAPACITY : 0;
+    for(uint64_t i = begin; i < writeIndex; i++){
+      const ProfilerEvent *event = &thread->events[i & (PROFILER_EVENT_CAPACITY - 1)];
+      double ts = (double)(event->begin - g_profiler.calibration_tsc) / ticksPerMicrosecond;
+      double dur = (double)(event->end - event->begin) / ticksPerMicrosecond;
+      if(!first) fprintf(file, ",\n");
+      fprintf(file, "{\"name\":");
+      WriteJSONString(file, event->name);
+      fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", thread->thread_id, ts, dur);
+      first = false;
+    }
+  }
+  fprintf(file, "\n]}\n");
+  fclose(file);
+  return true;
+}
+
+static ImU32 ProfilerColorForName(const char *name){
+  uint32_t hash = 2166136261u;
+  for(const char *c = name; *c; c++) hash = (hash ^ (uint8_t)*c) * 16777619u;
+  ImU32 result = ImColor((int)(80 + (hash & 0x7F)), (int)(80 + ((hash >> 8) & 0x7F)), (int)(80 + ((hash >> 16) & 0x7F)));
+  return result;
+}
+
+void DrawProfilerWindow(){
+  static const float ROW_HEIGHT = 18.0f;
+  static const uint32_t MAX_ROWS = 24;
+
+  ImGui::Begin("Profiler");
+  ImGui::Checkbox("Enabled", &g_profiler.enabled);
+  ImGui::SameLine();
+  ImGui::Checkbox("Pause", &g_profiler.paused);
+  ImGui::SameLine();
+  if(ImGui::Button("Export Chrome Trace")){
+    ProfilerExportChromeTrace("profile_trace.json");
+  }
+
+  float frameMs = g_profiler.frame_ms[(g_profiler.frame_index - 1) % PROFILER_FRAME_HISTORY];
+  ImGui::PlotLines("##frametimes", g_profiler.frame_ms, PROFILER_FRAME_HISTORY,
+    g_profiler.frame_index % PROFILER_FRAME_HISTORY, 0, 0.0f, 33.0f, ImVec2(0, 40));
+  ImGui::SameLine();
+  ImGui::Text("%.2f ms", frameMs);
+
+  if(g_profiler.captured_count == 0 || g_profiler.captured_end <= g_profiler.captured_begin){
+    ImGui::Text("No captured scopes");
+    ImGui::End();
+    return;
+  }
+
+  //@Timeline
+  uint32_t rowCount = 1;
+  for(uint32_t i = 0; i < g_profiler.captured_count; i++){
+    uint32_t depth = g_profiler.captured[i].depth;
+    if(depth + 1 > rowCount) rowCount = depth + 1;
+  }
+  if(rowCount > MAX_ROWS) rowCount = MAX_ROWS;
+
+  ImVec2 origin = ImGui::GetCursorScreenPos();
+  float width = ImGui::GetContentRegionAvailWidth();
+  float height = rowCount * ROW_HEIGHT;
+  ImDrawList *drawList = ImGui::GetWindowDrawList();
+  drawList->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), ImColor(30, 30, 30));
+
+  double frameTicks = (double)(g_profiler.captured_end - g_profiler.captured_begin);
+  ImVec2 mouse = ImGui::GetMousePos();
+  const ProfilerEvent *hovered = nullptr;
+  for(uint32_t i = 0; i < g_profiler.captured_count; i++){
+    const ProfilerEvent *event = &g_profiler.captured[i];
+    if(event->depth >= MAX_ROWS) continue;
+    float x0 = origin.x + (float)((event->begin - g_profiler.captured_begin) / frameTicks) * width;
+    float x1 = origin.x + (float)((event->end - g_profiler.captured_begin) / frameTicks) * width;
+    if(x1 - x0 < 1.0f) x1 = x0 + 1.0f;
+    float y0 = origin.y + event->depth * ROW_HEIGHT;
+    float y1 = y0 + ROW_HEIGHT - 1.0f;
+    drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), ProfilerColorForName(event->name));
+    if(x1 - x0 > 40.0f){
+      drawList->PushClipRect(ImVec2(x0, y0), ImVec2(x1, y1), true);
+      drawList->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), ImColor(255, 255, 255), event->name);
+      drawList->PopClipRect();
+    }
+    if(mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1) hovered = event;
+  }
+  ImGui::Dummy(ImVec2(width, height));
+  if(hovered != nullptr && ImGui::IsItemHovered()){
+    ImGui::SetTooltip("%s\n%.4f ms", hovered->name, ProfilerTicksToMilliseconds(hovered->end - hovered->begin));
+  }
+
+  //@Summary
+  //NOTE(Torin) Scope names are string literals so they are aggregated by pointer
+  static const uint32_t MAX_SUMMARY = 64;
+  const char *names[MAX_SUMMARY];
+  uint32_t calls[MAX_SUMMARY];
+  uint64_t ticks[MAX_SUMMARY];
+  uint32_t summaryCount = 0;
+  for(uint32_t i = 0; i < g_profiler.captured_count; i++){
+    const ProfilerEvent *event = &g_profiler.captured[i];
+    uint32_t n = 0;
+    while(n < summaryCount && names[n] != event->name) n++;
+    if(n == summaryCount){
+      if(summaryCount == MAX_SUMMARY) continue;
+      names[n] = event->name;
+      calls[n] = 0;
+      ticks[n] = 0;
+      summaryCount++;
+    }
+    calls[n]++;
+    ticks[n] += event->end - event->begin;
+  }
+
+  ImGui::Columns(3, "ProfilerSummary");
+  ImGui::Text("Scope"); ImGui::NextColumn();
+  ImGui::Text("Calls"); ImGui::NextColumn();
+  ImGui::Text("Total ms"); ImGui::NextColumn();
+  ImGui::Separator();
+  for(uint32_t i = 0; i < summaryCount; i++){
+    ImGui::Text("%s", names[i]); ImGui::NextColumn();
+    ImGui::Text("%u", calls[i]); ImGui::NextColumn();
+    ImGui::Text("%.4f", ProfilerTicksToMilliseconds(ticks[i])); ImGui::NextColumn();
+  }
+  ImGui::Columns(1);
+  ImGui::End();
+}
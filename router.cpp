@@ -0,0 +1,503 @@
+//NOTE(Torin) Orthogonal wire routing
+//When Editor::useWireRouting is set connections are drawn as horizontal and vertical
+//segments that go around nodes instead of as curves. Routes are searched with A* on a grid of
+//ROUTER_CELL_SIZE cells against an obstacle map holding how many nodes cover each cell.
+//The map is sparse, a hash of chunks of cells, so the canvas stays unbounded.
+//Every route is cached per input slot. UpdateWireRouter compares the cells of every node to
+//the ones it marked last frame, only nodes that moved are updated in the map and only routes
+//crossing their new cells or passing next to their old ones are marked dirty. Routes into or out of a moved node notice
+//that their end cells changed when they are next drawn. Searches per frame are limited by
+//ROUTER_FRAME_BUDGET, wires that could not be routed yet keep the curve for that frame, so
+//dragging in a large design stays interactive. Routes are not searched against each other,
+//wires may share cells. Routes of deleted connections stay cached until routing is turned off.
+
+#define ROUTER_CELL_SIZE 16.0f
+#define ROUTER_TURN_COST 3.0f
+//NOTE(Torin) Weighting the estimate makes the search head for the end instead of proving the
+//path is the shortest, routes come out a little longer but take far fewer steps
+#define ROUTER_ESTIMATE_WEIGHT 2.0f
+//NOTE(Torin) A search gives up after closing ROUTER_MAX_SEARCH cells or, for long wires,
+//ROUTER_SEARCH_PER_CELL times the distance between its ends
+#define ROUTER_MAX_SEARCH 4096
+#define ROUTER_SEARCH_PER_CELL 4
+#define ROUTER_FRAME_BUDGET 16384  //cells closed by all searches of a frame
+//NOTE(Torin) More nodes than this moving in a frame marks every route near them dirty
+//without testing the segments
+#define ROUTER_EXACT_CHANGES 64
+
+static const int32_t ROUTER_DX[4] = { 1, 0, -1, 0 };  //east, south, west, north
+static const int32_t ROUTER_DY[4] = { 0, 1, 0, -1 };
+
+static inline
+int32_t RouterCell(float v){
+  return (int32_t)floorf(v / ROUTER_CELL_SIZE);
+}
+
+static inline
+ImVec2 RouterCellCenter(int32_t x, int32_t y){
+  return ImVec2((x + 0.5f) * ROUTER_CELL_SIZE, (y + 0.5f) * ROUTER_CELL_SIZE);
+}
+
+static inline
+uint64_t RouterCellHash(int32_t x, int32_t y){
+  return MixHash(MixHash(0, (uint32_t)x), (uint32_t)y);
+}
+
+static inline
+bool IsOverlapping(const RouterCellRect& a, const RouterCellRect& b){
+  return a.min_x <= b.max_x && b.min_x <= a.max_x && a.min_y <= b.max_y && b.min_y <= a.max_y;
+}
+
+static RouterCellRect GetNodeCells(const EditorNode *node){
+  RouterCellRect result;
+  result.min_x = RouterCell(node->position.x);
+  result.min_y = RouterCell(node->position.y);
+  result.max_x = (int32_t)ceilf((node->position.x + node->size.x) / ROUTER_CELL_SIZE) - 1;
+  result.max_y = (int32_t)ceilf((node->position.y + node->size.y) / ROUTER_CELL_SIZE) - 1;
+  return result;
+}
+
+static ObstacleChunk *FindObstacleChunk(WireRouter *router, int32_t x, int32_t y){
+  DynamicArray<ObstacleChunk>& table = router->chunks;
+  if(table.count == 0) return nullptr;
+  size_t slot = RouterCellHash(x, y) & (table.count - 1);
+  while(table[slot].is_used){
+    if(table[slot].x == x && table[slot].y == y) return &table[slot];
+    slot = (slot + 1) & (table.count - 1);
+  }
+  return nullptr;
+}
+
+static void RebuildObstacleTable(WireRouter *router, size_t size){
+  DynamicArray<ObstacleChunk> old = router->chunks;
+  DynamicArray<ObstacleChunk> table;
+  ArrayReserve(size, table);
+  table.count = size;
+  memset(table.data, 0, sizeof(ObstacleChunk) * size);
+  it(i, old.count){
+    if(!old[i].is_used) continue;
+    size_t slot = RouterCellHash(old[i].x, old[i].y) & (size - 1);
+    while(table[slot].is_used) slot = (slot + 1) & (size - 1);
+    table[slot] = old[i];
+  }
+  ArrayDestroy(old);
+  router->chunks = table;
+  router->is_cache_valid = false;
+}
+
+static void MarkObstacleCells(WireRouter *router, const RouterCellRect& cells, int32_t delta){
+  for(int32_t y = cells.min_y; y <= cells.max_y; y++){
+    for(int32_t x = cells.min_x; x <= cells.max_x; x++){
+      int32_t chunk_x = x >> ROUTER_CHUNK_BITS, chunk_y = y >> ROUTER_CHUNK_BITS;
+      ObstacleChunk *chunk = FindObstacleChunk(router, chunk_x, chunk_y);
+      if(chunk == nullptr){
+        assert(delta > 0);
+        if((router->chunk_count + 1) * 2 > router->chunks.count){
+          RebuildObstacleTable(router, router->chunks.count > 0 ? router->chunks.count * 2 : 256);
+        }
+        DynamicArray<ObstacleChunk>& table = router->chunks;
+        size_t slot = RouterCellHash(chunk_x, chunk_y) & (table.count - 1);
+        while(table[slot].is_used) slot = (slot + 1) & (table.count - 1);
+        chunk = &table[slot];
+        chunk->x = chunk_x;
+        chunk->y = chunk_y;
+        chunk->is_used = 1;
+        router->chunk_count++;
+        router->is_cache_valid = false;
+      }
+      uint16_t *count = &chunk->counts[((y & (ROUTER_CHUNK_SIZE - 1)) << ROUTER_CHUNK_BITS) + (x & (ROUTER_CHUNK_SIZE - 1))];
+      assert(delta > 0 || *count > 0);
+      *count += delta;
+    }
+  }
+}
+
+//NOTE(Torin) Searches mostly step between cells of the same chunk, the last chunk is cached
+static inline
+bool IsCellBlocked(WireRouter *router, int32_t x, int32_t y){
+  int32_t chunk_x = x >> ROUTER_CHUNK_BITS, chunk_y = y >> ROUTER_CHUNK_BITS;
+  if(!router->is_cache_valid || router->cached_x != chunk_x || router->cached_y != chunk_y){
+    router->cached_chunk = FindObstacleChunk(router, chunk_x, chunk_y);
+    router->cached_x = chunk_x;
+    router->cached_y = chunk_y;
+    router->is_cache_valid = true;
+  }
+  const ObstacleChunk *chunk = router->cached_chunk;
+  return chunk != nullptr && chunk->counts[((y & (ROUTER_CHUNK_SIZE - 1)) << ROUTER_CHUNK_BITS) + (x & (ROUTER_CHUNK_SIZE - 1))] > 0;
+}
+
+static void RebuildRouteTable(WireRouter *router, size_t size){
+  DynamicArray<uint32_t>& table = router->route_table;
+  ArrayReserve(size, table);
+  table.count = size;
+  memset(table.data, 0, sizeof(uint32_t) * size);
+  it(i, router->routes.count){
+    size_t slot = MixHash(router->routes[i].dest_id, router->routes[i].input_index) & (size - 1);
+    while(table[slot] != 0) slot = (slot + 1) & (size - 1);
+    table[slot] = i + 1;
+  }
+}
+
+static WireRoute *FindOrAddRoute(WireRouter *router, uint32_t dest_id, uint32_t input_index){
+  DynamicArray<uint32_t>& table = router->route_table;
+  if(table.count > 0){
+    size_t slot = MixHash(dest_id, input_index) & (table.count - 1);
+    while(table[slot] != 0){
+      WireRoute *route = &router->routes[table[slot] - 1];
+      if(route->dest_id == dest_id && route->input_index == input_index) return route;
+      slot = (slot + 1) & (table.count - 1);
+    }
+  }
+
+  uint32_t route_index = router->routes.count;
+  if(router->routes.count == router->routes.capacity){
+    ArrayReserve(router->routes.capacity * 2 + 64, router->routes);
+  }
+  WireRoute *route = &router->routes.data[router->routes.count++];
+  *route = WireRoute();
+  route->dest_id = dest_id;
+  route->input_index = input_index;
+  route->source_id = UINT32_MAX;
+  if(router->routes.count * 2 > table.count){
+    size_t size = table.count > 0 ? table.count * 2 : 1024;
+    while(size < router->routes.count * 2) size *= 2;
+    RebuildRouteTable(router, size);
+  } else {
+    size_t slot = MixHash(dest_id, input_index) & (table.count - 1);
+    while(table[slot] != 0) slot = (slot + 1) & (table.count - 1);
+    table[slot] = route_index + 1;
+  }
+  return route;
+}
+
+static bool IsRouteCrossing(const WireRoute *route, const RouterCellRect& cells){
+  if(!IsOverlapping(route->bounds, cells)) return false;
+  if(route->points.count < 2) return true;
+  for(size_t i = 1; i < route->points.count; i++){
+    RouterCellRect segment;
+    int32_t ax = RouterCell(route->points.data[i - 1].x), ay = RouterCell(route->points.data[i - 1].y);
+    int32_t bx = RouterCell(route->points.data[i].x), by = RouterCell(route->points.data[i].y);
+    segment = { Min(ax, bx), Min(ay, by), Max(ax, bx), Max(ay, by) };
+    if(IsOverlapping(segment, cells)) return true;
+  }
+  return false;
+}
+
+//NOTE(Torin) Called once per frame before any route is requested
+void UpdateWireRouter(Editor *editor){
+  PROFILE_SCOPE("UpdateWireRouter");
+  WireRouter *router = &editor->router;
+  router->frame_budget = ROUTER_FRAME_BUDGET;
+  router->changed.count = 0;
+  if(router->nodes.count < editor->nodeTable.count){
+    ArrayReserve(editor->nodeTable.count * 2, router->nodes);
+    memset(router->nodes.data + router->nodes.count, 0, sizeof(RouterNode) * (editor->nodeTable.count - router->nodes.count));
+    router->nodes.count = editor->nodeTable.count;
+  }
+
+  auto AddChanged = [router](const RouterCellRect& cells, bool is_vacated){
+    if(router->changed.count == router->changed.capacity) ArrayReserve(router->changed.capacity * 2 + 64, router->changed);
+    router->changed.data[router->changed.count++] = { cells, is_vacated };
+  };
+  it(id, router->nodes.count){
+    RouterNode *routerNode = &router->nodes[id];
+    EditorNode *node = id < editor->nodeTable.count ? editor->nodeTable[id] : nullptr;
+    if(node == nullptr){
+      if(!routerNode->is_placed) continue;
+      MarkObstacleCells(router, routerNode->cells, -1);
+      AddChanged(routerNode->cells, true);
+      routerNode->is_placed = false;
+      continue;
+    }
+    RouterCellRect cells = GetNodeCells(node);
+    if(routerNode->is_placed && memcmp(&cells, &routerNode->cells, sizeof(cells)) == 0) continue;
+    if(routerNode->is_placed){
+      MarkObstacleCells(router, routerNode->cells, -1);
+      AddChanged(routerNode->cells, true);
+    }
+    MarkObstacleCells(router, cells, 1);
+    AddChanged(cells, false);
+    routerNode->cells = cells;
+    routerNode->is_placed = true;
+  }
+  if(router->changed.count == 0) return;
+
+  //NOTE(Torin) One cell larger to include routes passing next to a vacated node
+  RouterCellRect area = router->changed[0].cells;
+  it(i, router->changed.count){
+    const RouterCellRect& cells = router->changed[i].cells;
+    area.min_x = Min(area.min_x, cells.min_x);
+    area.min_y = Min(area.min_y, cells.min_y);
+    area.max_x = Max(area.max_x, cells.max_x);
+    area.max_y = Max(area.max_y, cells.max_y);
+  }
+  area = { area.min_x - 1, area.min_y - 1, area.max_x + 1, area.max_y + 1 };
+  bool isExact = router->changed.count <= ROUTER_EXACT_CHANGES;
+  it(i, router->routes.count){
+    WireRoute *route = &router->routes[i];
+    if(route->is_dirty || route->points.count == 0 || !IsOverlapping(route->bounds, area)) continue;
+    if(!isExact){
+      route->is_dirty = true;
+      continue;
+    }
+    it(c, router->changed.count){
+      const RouterChange *change = &router->changed[c];
+      const RouterCellRect& cells = change->cells;
+      bool isAffected;
+      if(!change->is_vacated) isAffected = IsRouteCrossing(route, cells);
+      else if(route->is_blocked) isAffected = IsOverlapping(route->bounds, cells);
+      else {
+        //NOTE(Torin) A route that went around the node passes next to it
+        RouterCellRect around = { cells.min_x - 1, cells.min_y - 1, cells.max_x + 1, cells.max_y + 1 };
+        isAffected = IsRouteCrossing(route, around);
+      }
+      if(isAffected){
+        route->is_dirty = true;
+        break;
+      }
+    }
+  }
+}
+
+//NOTE(Torin) Skips points that repeat the last one and merges straight runs so only the ends
+//and turns are kept
+static void AppendRoutePoint(DynamicArray<ImVec2>& points, ImVec2 p){
+  if(points.count > 0 && points[points.count - 1].x == p.x && points[points.count - 1].y == p.y) return;
+  if(points.count >= 2){
+    ImVec2 a = points[points.count - 2], b = points[points.count - 1];
+    if((a.x == b.x && b.x == p.x) || (a.y == b.y && b.y == p.y)){
+      points[points.count - 1] = p;
+      return;
+    }
+  }
+  if(points.count == points.capacity) ArrayReserve(points.capacity * 2 + 8, points);
+  points.data[points.count++] = p;
+}
+
+static uint32_t AddSearchNode(WireRouter *router, int32_t x, int32_t y, size_t slot){
+  if(router->search_nodes.count == router->search_nodes.capacity){
+    ArrayReserve(router->search_nodes.capacity * 2 + 1024, router->search_nodes);
+  }
+  uint32_t index = router->search_nodes.count++;
+  RouterSearchNode *node = &router->search_nodes[index];
+  node->x = x;
+  node->y = y;
+  node->slot = slot;
+  node->is_closed = false;
+  router->search_table[slot] = index + 1;
+  return index;
+}
+
+static void PushSearchHeap(WireRouter *router, RouterHeapItem item){
+  DynamicArray<RouterHeapItem>& heap = router->search_heap;
+  if(heap.count == heap.capacity) ArrayReserve(heap.capacity * 2 + 1024, heap);
+  size_t i = heap.count++;
+  //NOTE(Torin) Ties go to the item that got further, which keeps open areas from being flooded
+  while(i > 0){
+    size_t parent = (i - 1) / 2;
+    const RouterHeapItem& p = heap.data[parent];
+    if(p.estimate < item.estimate || (p.estimate == item.estimate && p.cost >= item.cost)) break;
+    heap.data[i] = p;
+    i = parent;
+  }
+  heap.data[i] = item;
+}
+
+static RouterHeapItem PopSearchHeap(WireRouter *router){
+  DynamicArray<RouterHeapItem>& heap = router->search_heap;
+  RouterHeapItem result = heap.data[0];
+  RouterHeapItem last = heap.data[--heap.count];
+  size_t i = 0;
+  for(;;){
+    size_t child = i * 2 + 1;
+    if(child >= heap.count) break;
+    const RouterHeapItem *c = &heap.data[child];
+    if(child + 1 < heap.count){
+      const RouterHeapItem *r = &heap.data[child + 1];
+      if(r->estimate < c->estimate || (r->estimate == c->estimate && r->cost > c->cost)){
+        child++;
+        c = r;
+      }
+    }
+    if(last.estimate < c->estimate || (last.estimate == c->estimate && last.cost >= c->cost)) break;
+    heap.data[i] = *c;
+    i = child;
+  }
+  if(heap.count > 0) heap.data[i] = last;
+  return result;
+}
+
+//NOTE(Torin) A* from the start to the end cell, the route leaves its start going east and
+//turning costs ROUTER_TURN_COST steps. The two end cells may be covered by nodes
+static bool SearchRoute(WireRouter *router, WireRoute *route){
+  int64_t distance = abs(route->end_x - route->start_x) + (int64_t)abs(route->end_y - route->start_y);
+  int64_t searchLimit = Max((int64_t)ROUTER_MAX_SEARCH, distance * ROUTER_SEARCH_PER_CELL);
+  //NOTE(Torin) A search discovers at most four cells per closed cell, twice that keeps the
+  //table sparse
+  if(router->search_table.count < (size_t)searchLimit * 8){
+    size_t size = router->search_table.count > 0 ? router->search_table.count : 1024;
+    while(size < (size_t)searchLimit * 8) size *= 2;
+    ArrayReserve(size, router->search_table);
+    router->search_table.count = size;
+    memset(router->search_table.data, 0, sizeof(uint32_t) * size);
+  }
+  DynamicArray<uint32_t>& table = router->search_table;
+  DynamicArray<RouterSearchNode>& nodes = router->search_nodes;
+  auto FindOrAddSearchNode = [router, &table](int32_t x, int32_t y, bool *isNew) -> uint32_t {
+    size_t slot = RouterCellHash(x, y) & (table.count - 1);
+    while(table.data[slot] != 0){
+      const RouterSearchNode *node = &router->search_nodes.data[table.data[slot] - 1];
+      if(node->x == x && node->y == y){
+        *isNew = false;
+        return table.data[slot] - 1;
+      }
+      slot = (slot + 1) & (table.count - 1);
+    }
+    *isNew = true;
+    return AddSearchNode(router, x, y, slot);
+  };
+  auto Estimate = [route](int32_t x, int32_t y) -> float {
+    float result = (float)(abs(route->end_x - x) + abs(route->end_y - y));
+    if(x != route->end_x && y != route->end_y) result += ROUTER_TURN_COST;
+    return result * ROUTER_ESTIMATE_WEIGHT;
+  };
+
+  nodes.count = 0;
+  router->search_heap.count = 0;
+  bool isNew;
+  uint32_t start = FindOrAddSearchNode(route->start_x, route->start_y, &isNew);
+  nodes[start].cost = 0.0f;
+  nodes[start].parent = UINT32_MAX;
+  nodes[start].direction = 0;
+  PushSearchHeap(router, { Estimate(route->start_x, route->start_y), 0.0f, start });
+
+  uint32_t end = UINT32_MAX;
+  int64_t closedCount = 0;
+  while(router->search_heap.count > 0 && closedCount < searchLimit){
+    RouterHeapItem item = PopSearchHeap(router);
+    RouterSearchNode current = nodes[item.node];
+    if(current.is_closed || item.cost > current.cost) continue;
+    nodes[item.node].is_closed = true;
+    closedCount++;
+    if(current.x == route->end_x && current.y == route->end_y){
+      end = item.node;
+      break;
+    }
+    it(direction, 4){
+      if(direction == ((current.direction + 2u) & 3u)) continue;
+      int32_t x = current.x + ROUTER_DX[direction], y = current.y + ROUTER_DY[direction];
+      bool isEnd = x == route->end_x && y == route->end_y;
+      if(!isEnd && IsCellBlocked(router, x, y)) continue;
+      float cost = current.cost + 1.0f;
+      if(direction != current.direction) cost += ROUTER_TURN_COST;
+      if(isEnd && direction != 0) cost += ROUTER_TURN_COST;
+      uint32_t next = FindOrAddSearchNode(x, y, &isNew);
+      RouterSearchNode *node = &nodes[next];
+      if(!isNew && (node->is_closed || node->cost <= cost)) continue;
+      node->cost = cost;
+      node->parent = item.node;
+      node->direction = (uint8_t)direction;
+      PushSearchHeap(router, { cost + Estimate(x, y), cost, next });
+    }
+  }
+  router->frame_budget -= closedCount;
+
+  route->points.count = 0;
+  if(end != UINT32_MAX){
+    //NOTE(Torin) Walked from the end, reversed below
+    uint32_t current = end;
+    while(current != UINT32_MAX){
+      AppendRoutePoint(route->points, RouterCellCenter(nodes[current].x, nodes[current].y));
+      current = nodes[current].parent;
+    }
+    it(i, route->points.count / 2){
+      ImVec2 p = route->points[i];
+      route->points[i] = route->points[route->points.count - 1 - i];
+      route->points[route->points.count - 1 - i] = p;
+    }
+  }
+  it(i, nodes.count) table.data[nodes[i].slot] = 0;
+  return end != UINT32_MAX;
+}
+
+//NOTE(Torin) Returns the route of the connection, searching it when it is missing or out of
+//date, or nullptr when this frame's budget is used up and the connection has to wait
+WireRoute *GetWireRoute(const EditorNode *source, uint32_t output_index, const EditorNode *dest, uint32_t input_index, Editor *editor){
+  WireRouter *router = &editor->router;
+  if(source->id >= router->nodes.count || dest->id >= router->nodes.count) return nullptr;
+  const RouterNode *from = &router->nodes[source->id];
+  const RouterNode *to = &router->nodes[dest->id];
+  if(!from->is_placed || !to->is_placed) return nullptr;
+  float startY = source->position.y + source->size.y * (output_index + 1) / (source->output_count + 1);
+  float endY = dest->position.y + dest->size.y * (input_index + 1) / (dest->input_count + 1);
+  int32_t start_x = from->cells.max_x + 1, start_y = RouterCell(startY);
+  int32_t end_x = to->cells.min_x - 1, end_y = RouterCell(endY);
+
+  WireRoute *route = FindOrAddRoute(router, dest->id, input_index);
+  if(!route->is_dirty && route->points.count > 0 && route->source_id == source->id && route->output_index == output_index &&
+    route->start_x == start_x && route->start_y == start_y && route->end_x == end_x && route->end_y == end_y) return route;
+  if(router->frame_budget <= 0) return nullptr;
+
+  route->source_id = source->id;
+  route->output_index = output_index;
+  route->start_x = start_x;
+  route->start_y = start_y;
+  route->end_x = end_x;
+  route->end_y = end_y;
+  route->is_dirty = false;
+  route->is_blocked = !SearchRoute(router, route);
+  if(route->is_blocked){
+    int32_t middle_x = start_x + (end_x - start_x) / 2;
+    AppendRoutePoint(route->points, RouterCellCenter(start_x, start_y));
+    AppendRoutePoint(route->points, RouterCellCenter(middle_x, start_y));
+    AppendRoutePoint(route->points, RouterCellCenter(middle_x, end_y));
+    AppendRoutePoint(route->points, RouterCellCenter(end_x, end_y));
+  }
+  route->bounds = { start_x, start_y, start_x, start_y };
+  it(i, route->points.count){
+    int32_t x = RouterCell(route->points[i].x), y = RouterCell(route->points[i].y);
+    route->bounds.min_x = Min(route->bounds.min_x, x);
+    route->bounds.min_y = Min(route->bounds.min_y, y);
+    route->bounds.max_x = Max(route->bounds.max_x, x);
+    route->bounds.max_y = Max(route->bounds.max_y, y);
+  }
+  return route;
+}
+
+//NOTE(Torin) p1 and p2 are the world positions of the two slots, the first and last run of the
+//route are moved onto them so nodes can move within a cell without rerouting
+void DrawWireRoute(ImDrawList *draw_list, const WireRoute *route, ImVec2 p1, ImVec2 p2, const Camera *camera, ImVec2 canvasOrigin, ImU32 color, float thickness){
+  const ImVec2 *points = route->points.data;
+  size_t count = route->points.count;
+  draw_list->PathLineTo(WorldToScreen(p1, camera, canvasOrigin));
+  if(count == 2 && points[0].y == points[1].y){
+    float middle = (points[0].x + points[1].x) * 0.5f;
+    draw_list->PathLineTo(WorldToScreen(ImVec2(middle, p1.y), camera, canvasOrigin));
+    draw_list->PathLineTo(WorldToScreen(ImVec2(middle, p2.y), camera, canvasOrigin));
+  } else if(count == 1){
+    draw_list->PathLineTo(WorldToScreen(ImVec2(points[0].x, p1.y), camera, canvasOrigin));
+    draw_list->PathLineTo(WorldToScreen(ImVec2(points[0].x, p2.y), camera, canvasOrigin));
+  } else {
+    it(i, count){
+      ImVec2 p = points[i];
+      if(i == 0 || (i == 1 && points[0].y == points[1].y)) p.y = p1.y;
+      if(i == count - 1 || (i == count - 2 && points[count - 1].y == points[count - 2].y)) p.y = p2.y;
+      draw_list->PathLineTo(WorldToScreen(p, camera, canvasOrigin));
+    }
+  }
+  draw_list->PathLineTo(WorldToScreen(p2, camera, canvasOrigin));
+  draw_list->PathStroke(color, false, thickness);
+}
+
+void ResetWireRouter(WireRouter *router){
+  it(i, router->routes.count) ArrayDestroy(router->routes[i].points);
+  ArrayDestroy(router->nodes);
+  ArrayDestroy(router->chunks);
+  ArrayDestroy(router->routes);
+  ArrayDestroy(router->route_table);
+  ArrayDestroy(router->changed);
+  ArrayDestroy(router->search_nodes);
+  ArrayDestroy(router->search_table);
+  ArrayDestroy(router->search_heap);
+  *router = {};
+}
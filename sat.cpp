@@ -0,0 +1,415 @@
+//NOTE(Torin) Embedded CDCL SAT solver
+//A small conflict driven clause learning solver in the style of MiniSat: two watched
+//literals for propagation, first UIP conflict analysis, VSIDS variable activity kept in a
+//binary heap, phase saving and Luby restarts. Learnt clauses are never deleted, a solve
+//is bounded by a conflict limit instead.
+//A literal is variable * 2 + negated, clauses live in one arena as [size, literals...]
+//and are referenced by their offset. The implied literal of a reason clause is always
+//its first literal
+
+#define SAT_NONE UINT32_MAX
+#define SAT_RESTART_BASE 100
+
+enum SatResult {
+  SatResult_SATISFIABLE,
+  SatResult_UNSATISFIABLE,
+  SatResult_UNKNOWN,  //conflict limit reached
+};
+
+enum SatValue : uint8_t {
+  SatValue_FALSE,
+  SatValue_TRUE,
+  SatValue_UNASSIGNED,
+};
+
+struct SatSolver {
+  uint32_t var_count;
+  DynamicArray<uint32_t> arena;
+  DynamicArray<DynamicArray<uint32_t>> watches;  //clauses watching a literal, indexed by literal
+  DynamicArray<uint8_t> assigns;
+  DynamicArray<uint8_t> phase;
+  DynamicArray<uint32_t> level;
+  DynamicArray<uint32_t> reason;
+  DynamicArray<double> activity;
+  DynamicArray<uint32_t> heap;
+  DynamicArray<uint32_t> heap_index;  //SAT_NONE when not in the heap
+  DynamicArray<uint8_t> seen;
+
+  DynamicArray<uint32_t> trail;
+  DynamicArray<uint32_t> trail_limits;  //trail size at the start of each decision level
+  uint32_t propagate_head;
+  double activity_increment;
+  bool is_unsatisfiable;
+
+  uint64_t conflicts;
+  uint64_t decisions;
+  uint64_t propagations;
+};
+
+//NOTE(Torin) ArrayAdd grows by a constant, the clause arena and watch lists grow
+//geometrically instead
+template<typename T>
+static inline
+void AddSatArray(const T& value, DynamicArray<T>& array){
+  if(array.count == array.capacity) ArrayReserve(array.capacity * 2 + 16, array);
+  ArrayAdd(value, array);
+}
+
+static inline uint32_t SatLiteral(uint32_t var, bool negated){ return var * 2 + (negated ? 1 : 0); }
+static inline uint32_t SatVar(uint32_t literal){ return literal >> 1; }
+
+static inline
+uint8_t GetSatLiteralValue(const SatSolver *solver, uint32_t literal){
+  uint8_t value = solver->assigns.data[SatVar(literal)];
+  if(value == SatValue_UNASSIGNED) return value;
+  return value ^ (literal & 1);
+}
+
+static inline
+uint32_t GetSatDecisionLevel(const SatSolver *solver){
+  return solver->trail_limits.count;
+}
+
+static inline
+bool IsSatHeapBefore(const SatSolver *solver, uint32_t a, uint32_t b){
+  return solver->activity.data[a] > solver->activity.data[b];
+}
+
+static void SiftSatHeapUp(SatSolver *solver, uint32_t index){
+  uint32_t var = solver->heap[index];
+  while(index > 0){
+    uint32_t parent = (index - 1) / 2;
+    if(!IsSatHeapBefore(solver, var, solver->heap[parent])) break;
+    solver->heap[index] = solver->heap[parent];
+    solver->heap_index[solver->heap[index]] = index;
+    index = parent;
+  }
+  solver->heap[index] = var;
+  solver->heap_index[var] = index;
+}
+
+static void SiftSatHeapDown(SatSolver *solver, uint32_t index){
+  uint32_t var = solver->heap[index];
+  uint32_t count = solver->heap.count;
+  for(;;){
+    uint32_t child = index * 2 + 1;
+    if(child >= count) break;
+    if(child + 1 < count && IsSatHeapBefore(solver, solver->heap[child + 1], solver->heap[child])) child++;
+    if(!IsSatHeapBefore(solver, solver->heap[child], var)) break;
+    solver->heap[index] = solver->heap[child];
+    solver->heap_index[solver->heap[index]] = index;
+    index = child;
+  }
+  solver->heap[index] = var;
+  solver->heap_index[var] = index;
+}
+
+static inline
+void InsertSatHeap(SatSolver *solver, uint32_t var){
+  if(solver->heap_index[var] != SAT_NONE) return;
+  AddSatArray(var, solver->heap);
+  SiftSatHeapUp(solver, solver->heap.count - 1);
+}
+
+static inline
+uint32_t PopSatHeap(SatSolver *solver){
+  uint32_t result = solver->heap[0];
+  solver->heap_index[result] = SAT_NONE;
+  uint32_t last = solver->heap[solver->heap.count - 1];
+  solver->heap.count--;
+  if(solver->heap.count > 0){
+    solver->heap[0] = last;
+    solver->heap_index[last] = 0;
+    SiftSatHeapDown(solver, 0);
+  }
+  return result;
+}
+
+uint32_t AddSatVariable(SatSolver *solver){
+  uint32_t var = solver->var_count++;
+  DynamicArray<uint32_t> empty = {};
+  AddSatArray(empty, solver->watches);
+  AddSatArray(empty, solver->watches);
+  AddSatArray((uint8_t)SatValue_UNASSIGNED, solver->assigns);
+  AddSatArray((uint8_t)0, solver->phase);
+  AddSatArray(0U, solver->level);
+  AddSatArray((uint32_t)SAT_NONE, solver->reason);
+  AddSatArray(0.0, solver->activity);
+  AddSatArray((uint32_t)SAT_NONE, solver->heap_index);
+  AddSatArray((uint8_t)0, solver->seen);
+  InsertSatHeap(solver, var);
+  return var;
+}
+
+static inline
+void EnqueueSatLiteral(SatSolver *solver, uint32_t literal, uint32_t reason){
+  uint32_t var = SatVar(literal);
+  assert(solver->assigns[var] == SatValue_UNASSIGNED);
+  solver->assigns[var] = (literal & 1) ? SatValue_FALSE : SatValue_TRUE;
+  solver->level[var] = GetSatDecisionLevel(solver);
+  solver->reason[var] = reason;
+  AddSatArray(literal, solver->trail);
+}
+
+static inline
+uint32_t *GetSatClause(SatSolver *solver, uint32_t clause, uint32_t *size){
+  *size = solver->arena.data[clause];
+  return &solver->arena.data[clause + 1];
+}
+
+static uint32_t StoreSatClause(SatSolver *solver, const uint32_t *literals, uint32_t count){
+  uint32_t clause = solver->arena.count;
+  AddSatArray(count, solver->arena);
+  it(i, count) AddSatArray(literals[i], solver->arena);
+  AddSatArray(clause, solver->watches[literals[0]]);
+  AddSatArray(clause, solver->watches[literals[1]]);
+  return clause;
+}
+
+//NOTE(Torin) Only valid before SolveSat or at decision level 0, returns false once the
+//clauses are known to be unsatisfiable
+bool AddSatClause(SatSolver *solver, const uint32_t *literals, uint32_t count){
+  assert(GetSatDecisionLevel(solver) == 0);
+  if(solver->is_unsatisfiable) return false;
+  uint32_t stackLiterals[16];
+  uint32_t *clause = count <= 16 ? stackLiterals : (uint32_t *)malloc(sizeof(uint32_t) * count);
+  uint32_t size = 0;
+  bool isSatisfied = false;
+  it(i, count){
+    uint32_t literal = literals[i];
+    uint8_t value = GetSatLiteralValue(solver, literal);
+    if(value == SatValue_TRUE) isSatisfied = true;
+    if(value == SatValue_FALSE) continue;
+    bool isDuplicate = false;
+    it(n, size){
+      if(clause[n] == literal) isDuplicate = true;
+      if(clause[n] == (literal ^ 1)) isSatisfied = true;
+    }
+    if(!isDuplicate) clause[size++] = literal;
+  }
+
+  if(!isSatisfied){
+    if(size == 0){
+      solver->is_unsatisfiable = true;
+    } else if(size == 1){
+      EnqueueSatLiteral(solver, clause[0], SAT_NONE);
+    } else {
+      StoreSatClause(solver, clause, size);
+    }
+  }
+  if(clause != stackLiterals) free(clause);
+  return !solver->is_unsatisfiable;
+}
+
+//NOTE(Torin) Returns the conflicting clause or SAT_NONE
+static uint32_t PropagateSat(SatSolver *solver){
+  while(solver->propagate_head < solver->trail.count){
+    uint32_t falseLiteral = solver->trail[solver->propagate_head++] ^ 1;
+    DynamicArray<uint32_t> &watchers = solver->watches[falseLiteral];
+    solver->propagations++;
+    size_t i = 0, j = 0;
+    while(i < watchers.count){
+      uint32_t clause = watchers.data[i++];
+      uint32_t size;
+      uint32_t *literals = GetSatClause(solver, clause, &size);
+      if(literals[0] == falseLiteral){
+        literals[0] = literals[1];
+        literals[1] = falseLiteral;
+      }
+      if(GetSatLiteralValue(solver, literals[0]) == SatValue_TRUE){
+        watchers.data[j++] = clause;
+        continue;
+      }
+
+      bool isMoved = false;
+      for(uint32_t k = 2; k < size; k++){
+        if(GetSatLiteralValue(solver, literals[k]) != SatValue_FALSE){
+          literals[1] = literals[k];
+          literals[k] = falseLiteral;
+          AddSatArray(clause, solver->watches[literals[1]]);
+          isMoved = true;
+          break;
+        }
+      }
+      if(isMoved) continue;
+
+      watchers.data[j++] = clause;
+      if(GetSatLiteralValue(solver, literals[0]) == SatValue_FALSE){
+        while(i < watchers.count) watchers.data[j++] = watchers.data[i++];
+        watchers.count = j;
+        solver->propagate_head = solver->trail.count;
+        return clause;
+      }
+      EnqueueSatLiteral(solver, literals[0], clause);
+    }
+    watchers.count = j;
+  }
+  return SAT_NONE;
+}
+
+static void BacktrackSat(SatSolver *solver, uint32_t target_level){
+  if(GetSatDecisionLevel(solver) <= target_level) return;
+  uint32_t end = solver->trail_limits[target_level];
+  for(size_t i = solver->trail.count; i > end; i--){
+    uint32_t var = SatVar(solver->trail[i - 1]);
+    solver->phase[var] = solver->assigns[var];
+    solver->assigns[var] = SatValue_UNASSIGNED;
+    solver->reason[var] = SAT_NONE;
+    InsertSatHeap(solver, var);
+  }
+  solver->trail.count = end;
+  solver->trail_limits.count = target_level;
+  solver->propagate_head = end;
+}
+
+static inline
+void BumpSatActivity(SatSolver *solver, uint32_t var){
+  solver->activity[var] += solver->activity_increment;
+  if(solver->activity[var] > 1e100){
+    it(i, solver->var_count) solver->activity[i] *= 1e-100;
+    solver->activity_increment *= 1e-100;
+  }
+  if(solver->heap_index[var] != SAT_NONE) SiftSatHeapUp(solver, solver->heap_index[var]);
+}
+
+//NOTE(Torin) First UIP, learnt[0] is the asserting literal and learnt[1] the literal with
+//the highest level below the conflict level
+static uint32_t AnalyzeSatConflict(SatSolver *solver, uint32_t conflict, DynamicArray<uint32_t> *learnt){
+  learnt->count = 0;
+  ArrayAdd(SAT_NONE, *learnt);
+  uint32_t currentLevel = GetSatDecisionLevel(solver);
+  uint32_t pathCount = 0;
+  uint32_t literal = SAT_NONE;
+  size_t index = solver->trail.count;
+  uint32_t clause = conflict;
+  do {
+    uint32_t size;
+    uint32_t *literals = GetSatClause(solver, clause, &size);
+    for(uint32_t i = (literal == SAT_NONE) ? 0 : 1; i < size; i++){
+      uint32_t var = SatVar(literals[i]);
+      if(solver->seen[var] || solver->level[var] == 0) continue;
+      solver->seen[var] = 1;
+      BumpSatActivity(solver, var);
+      if(solver->level[var] == currentLevel){
+        pathCount++;
+      } else {
+        ArrayAdd(literals[i], *learnt);
+      }
+    }
+    while(!solver->seen[SatVar(solver->trail[index - 1])]) index--;
+    literal = solver->trail[--index];
+    clause = solver->reason[SatVar(literal)];
+    solver->seen[SatVar(literal)] = 0;
+    pathCount--;
+  } while(pathCount > 0);
+  learnt->data[0] = literal ^ 1;
+
+  uint32_t backtrackLevel = 0;
+  for(size_t i = 1; i < learnt->count; i++){
+    uint32_t var = SatVar(learnt->data[i]);
+    solver->seen[var] = 0;
+    if(solver->level[var] > backtrackLevel){
+      backtrackLevel = solver->level[var];
+      uint32_t temp = learnt->data[1];
+      learnt->data[1] = learnt->data[i];
+      learnt->data[i] = temp;
+    }
+  }
+  return backtrackLevel;
+}
+
+static uint64_t GetLubySequence(uint64_t index){
+  uint64_t size = 1, sequence = 0;
+  while(size < index + 1){
+    sequence++;
+    size = 2 * size + 1;
+  }
+  while(size - 1 != index){
+    size = (size - 1) >> 1;
+    sequence--;
+    index = index % size;
+  }
+  return 1ULL << sequence;
+}
+
+SatResult SolveSat(SatSolver *solver, uint64_t conflict_limit){
+  if(solver->is_unsatisfiable) return SatResult_UNSATISFIABLE;
+  if(solver->activity_increment == 0.0) solver->activity_increment = 1.0;
+  if(PropagateSat(solver) != SAT_NONE){
+    solver->is_unsatisfiable = true;
+    return SatResult_UNSATISFIABLE;
+  }
+
+  DynamicArray<uint32_t> learnt = {};
+  SatResult result = SatResult_UNKNOWN;
+  uint64_t restartCount = 0;
+  uint64_t restartConflicts = 0;
+  uint64_t restartLimit = SAT_RESTART_BASE * GetLubySequence(restartCount);
+  for(;;){
+    uint32_t conflict = PropagateSat(solver);
+    if(conflict != SAT_NONE){
+      solver->conflicts++;
+      restartConflicts++;
+      if(GetSatDecisionLevel(solver) == 0){
+        solver->is_unsatisfiable = true;
+        result = SatResult_UNSATISFIABLE;
+        break;
+      }
+      uint32_t backtrackLevel = AnalyzeSatConflict(solver, conflict, &learnt);
+      BacktrackSat(solver, backtrackLevel);
+      if(learnt.count == 1){
+        EnqueueSatLiteral(solver, learnt[0], SAT_NONE);
+      } else {
+        uint32_t clause = StoreSatClause(solver, learnt.data, learnt.count);
+        EnqueueSatLiteral(solver, learnt[0], clause);
+      }
+      solver->activity_increment *= 1.0 / 0.95;
+      if(solver->conflicts >= conflict_limit) break;
+      if(restartConflicts >= restartLimit){
+        BacktrackSat(solver, 0);
+        restartCount++;
+        restartConflicts = 0;
+        restartLimit = SAT_RESTART_BASE * GetLubySequence(restartCount);
+      }
+      continue;
+    }
+
+    uint32_t var = SAT_NONE;
+    while(solver->heap.count > 0){
+      var = PopSatHeap(solver);
+      if(solver->assigns[var] == SatValue_UNASSIGNED) break;
+      var = SAT_NONE;
+    }
+    if(var == SAT_NONE){
+      result = SatResult_SATISFIABLE;
+      break;
+    }
+    solver->decisions++;
+    ArrayAdd((uint32_t)solver->trail.count, solver->trail_limits);
+    EnqueueSatLiteral(solver, SatLiteral(var, solver->phase[var] != SatValue_TRUE), SAT_NONE);
+  }
+  ArrayDestroy(learnt);
+  return result;
+}
+
+//NOTE(Torin) Value of a variable in the model of the last satisfiable SolveSat
+static inline
+bool GetSatModelValue(const SatSolver *solver, uint32_t var){
+  return solver->assigns.data[var] == SatValue_TRUE;
+}
+
+void DestroySatSolver(SatSolver *solver){
+  it(i, solver->watches.count) ArrayDestroy(solver->watches[i]);
+  ArrayDestroy(solver->watches);
+  ArrayDestroy(solver->arena);
+  ArrayDestroy(solver->assigns);
+  ArrayDestroy(solver->phase);
+  ArrayDestroy(solver->level);
+  ArrayDestroy(solver->reason);
+  ArrayDestroy(solver->activity);
+  ArrayDestroy(solver->heap);
+  ArrayDestroy(solver->heap_index);
+  ArrayDestroy(solver->seen);
+  ArrayDestroy(solver->trail);
+  ArrayDestroy(solver->trail_limits);
+}
@@ -0,0 +1,217 @@
+//NOTE(Torin) Evaluation schedule for the event driven simulator
+//Tarjan's algorithm splits the node graph into strongly connected components which are
+//emitted in topological order. A component with a single node and no self connection is
+//acyclic and evaluated at most once per step, a cyclic component (a feedback loop such as
+//a latch built from gates) is iterated to a fixed point with a bounded number of
+//evaluations and reported as oscillating if it does not settle.
+//Connections into DFF / REGISTER nodes are not edges, a register breaks the loop. Only
+//the address input of a RAM is an edge since its other inputs are sampled at the latch
+
+struct TarjanFrame {
+  uint32_t node;
+  uint32_t output_index;
+  uint32_t connection_index;
+};
+
+static inline
+bool IsScheduleEdge(const EditorNode *dest, uint32_t io_index){
+  if(dest->type == NodeType_DFF || dest->type == NodeType_REGISTER) return false;
+  if(dest->type == NodeType_RAM) return io_index == 0;
+  return true;
+}
+
+static inline
+bool HasSelfConnection(const EditorNode *node){
+  it(o, node->output_count){
+    const DynamicArray<NodeConnection> &connections = node->output_connections[o];
+    it(i, connections.count){
+      if(connections.data[i].node_index.node_ptr == node && IsScheduleEdge(node, connections.data[i].io_index)) return true;
+    }
+  }
+  return false;
+}
+
+void BuildNodeSchedule(NodeSchedule *schedule, Editor *editor){
+  PROFILE_SCOPE("BuildNodeSchedule");
+  uint32_t node_count = editor->nodes.count;
+  schedule->topology_version = editor->topologyVersion;
+  schedule->components.count = 0;
+  schedule->cyclic_count = 0;
+  schedule->oscillating_count = 0;
+  ArrayReserve(node_count, schedule->order);
+  schedule->order.count = node_count;
+  it(i, node_count) editor->nodes[i]->scratch_index = i;
+
+  static const uint32_t UNVISITED = UINT32_MAX;
+  uint32_t *index = (uint32_t *)malloc(sizeof(uint32_t) * (node_count + 1));
+  uint32_t *lowlink = (uint32_t *)malloc(sizeof(uint32_t) * (node_count + 1));
+  uint8_t *onStack = (uint8_t *)calloc(node_count + 1, 1);
+  uint32_t *stack = (uint32_t *)malloc(sizeof(uint32_t) * (node_count + 1));
+  TarjanFrame *frames = (TarjanFrame *)malloc(sizeof(TarjanFrame) * (node_count + 1));
+  it(i, node_count) index[i] = UNVISITED;
+
+  //NOTE(Torin) Iterative so deep chains cannot overflow the stack, components are
+  //completed sinks first so they are written to order from the back
+  uint32_t nextIndex = 0, stackCount = 0, orderEnd = node_count;
+  for(uint32_t root = 0; root < node_count; root++){
+    if(index[root] != UNVISITED) continue;
+    uint32_t frameCount = 0;
+    frames[frameCount++] = { root, 0, 0 };
+    index[root] = lowlink[root] = nextIndex++;
+    stack[stackCount++] = root;
+    onStack[root] = 1;
+
+    while(frameCount > 0){
+      TarjanFrame *frame = &frames[frameCount - 1];
+      uint32_t v = frame->node;
+      EditorNode *node = editor->nodes[v];
+
+      uint32_t w = UNVISITED;
+      while(frame->output_index < node->output_count){
+        DynamicArray<NodeConnection> &connections = node->output_connections[frame->output_index];
+        if(frame->connection_index < connections.count){
+          const NodeConnection *connection = &connections[frame->connection_index++];
+          EditorNode *dest = connection->node_index.node_ptr;
+          if(!IsScheduleEdge(dest, connection->io_index)) continue;
+          w = dest->scratch_index;
+          break;
+        }
+        frame->output_index++;
+        frame->connection_index = 0;
+      }
+
+      if(w != UNVISITED){
+        if(index[w] == UNVISITED){
+          index[w] = lowlink[w] = nextIndex++;
+          stack[stackCount++] = w;
+          onStack[w] = 1;
+          frames[frameCount++] = { w, 0, 0 };
+        } else if(onStack[w]){
+          lowlink[v] = Min(lowlink[v], index[w]);
+        }
+        continue;
+      }
+
+      if(lowlink[v] == index[v]){
+        NodeComponent component = {};
+        uint32_t member;
+        do {
+          member = stack[--stackCount];
+          onStack[member] = 0;
+          schedule->order[--orderEnd] = editor->nodes[member];
+          component.count++;
+        } while(member != v);
+        component.first = orderEnd;
+        component.is_cyclic = component.count > 1 || HasSelfConnection(node);
+        if(component.is_cyclic) schedule->cyclic_count++;
+        ArrayAdd(component, schedule->components);
+      }
+
+      frameCount--;
+      if(frameCount > 0){
+        uint32_t parent = frames[frameCount - 1].node;
+        lowlink[parent] = Min(lowlink[parent], lowlink[v]);
+      }
+    }
+  }
+  assert(orderEnd == 0);
+
+  //NOTE(Torin) Components were appended sinks first
+  size_t componentCount = schedule->components.count;
+  it(i, componentCount / 2){
+    NodeComponent temp = schedule->components[i];
+    schedule->components[i] = schedule->components[componentCount - 1 - i];
+    schedule->components[componentCount - 1 - i] = temp;
+  }
+  it(c, componentCount){
+    const NodeComponent *component = &schedule->components[c];
+    it(i, component->count) schedule->order[component->first + i]->scratch_index = c;
+  }
+  it(i, node_count) editor->nodes[i]->scc_index = editor->nodes[i]->scratch_index;
+
+  schedule->is_valid = true;
+  free(index);
+  free(lowlink);
+  free(onStack);
+  free(stack);
+  free(frames);
+}
+
+static inline
+void UpdateNodeSchedule(Editor *editor){
+  NodeSchedule *schedule = &editor->schedule;
+  if(!schedule->is_valid || schedule->topology_version != editor->topologyVersion)
+    BuildNodeSchedule(schedule, editor);
+}
+
+static inline
+bool IsNodeOscillating(const EditorNode *node, const Editor *editor){
+  const NodeSchedule *schedule = &editor->schedule;
+  if(!schedule->is_valid || schedule->topology_version != editor->topologyVersion) return false;
+  bool result = schedule->components.data[node->scc_index].is_oscillating;
+  return result;
+}
+
+//NOTE(Torin) Inputs driven from inside the same loop keep the value they settled to in
+//the previous step, this is the state a latch holds. Every other input starts as NONE
+static inline
+void ResetNodeInputs(EditorNode *node, const NodeSchedule *schedule){
+  const NodeComponent *component = &schedule->components.data[node->scc_index];
+  if(!component->is_cyclic){
+    memset(node->input_state, NodeState_NONE, node->input_count * sizeof(NodeState));
+    return;
+  }
+
+  it(i, node->input_count){
+    const EditorNode *driver = node->inputConnections[i].node_index.node_ptr;
+    if(driver == nullptr || driver->scc_index != node->scc_index)
+      node->input_state[i] = NodeState_NONE;
+  }
+}
+
+//NOTE(Torin) Every member of a loop is evaluated each step so the loop transmits its
+//held values, EnqueueNode feeds members whose inputs changed straight back in. A loop
+//that has not settled after loopIterationLimit evaluations per member keeps its last values
+static void SimulateCyclicComponent(uint32_t component_index, Editor *editor){
+  NodeSchedule *schedule = &editor->schedule;
+  NodeComponent *component = &schedule->components[component_index];
+  NodeWorklist *worklist = &editor->worklist;
+  schedule->active_component = component_index;
+  it(i, component->count){
+    EditorNode *node = schedule->order[component->first + i];
+    node->is_queued = 1;
+    worklist->nodes[(worklist->head + worklist->count) % worklist->capacity] = node;
+    worklist->count++;
+  }
+
+  uint64_t budget = (uint64_t)component->count * (uint64_t)Max(editor->loopIterationLimit, 1);
+  uint64_t evaluations = 0;
+  while(worklist->count > 0){
+    if(evaluations == budget){
+      component->is_oscillating = true;
+      schedule->oscillating_count++;
+      while(worklist->count > 0) DequeueNode(editor);
+      break;
+    }
+    SimulateNode(DequeueNode(editor), editor);
+    evaluations++;
+  }
+  schedule->active_component = UINT32_MAX;
+}
+
+void RunNodeSchedule(Editor *editor){
+  NodeSchedule *schedule = &editor->schedule;
+  schedule->oscillating_count = 0;
+  it(c, schedule->components.count){
+    NodeComponent *component = &schedule->components[c];
+    component->is_oscillating = false;
+    if(component->is_cyclic){
+      SimulateCyclicComponent(c, editor);
+    } else {
+      EditorNode *node = schedule->order[component->first];
+      if(!node->is_queued) continue;
+      node->is_queued = 0;
+      SimulateNode(node, editor);
+    }
+  }
+}
@@ -0,0 +1,534 @@
+//NOTE(Torin) Regression checks, run with --self-check
+//Every check builds a small design in an Editor of its own and computes the same result
+//two independent ways, the event driven simulator against the netlist, a journal replayed
+//after undo against the design it recorded and so on. A failing check prints the condition
+//that failed, RunSelfChecks returns the number of failed checks
+
+#include <pthread.h>
+
+#define SELF_CHECK(condition) if(!(condition)){ \
+  printf("  %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+  return false; \
+}
+
+static uint64_t SelfCheckRandom(uint64_t *state){
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static void InitSelfCheckEditor(Editor *editor){
+  *editor = {};
+  editor->gateInputCount = 2;
+  editor->registerWidth = 4;
+  editor->clockHalfPeriod = 1;
+  editor->loopIterationLimit = 32;
+  editor->busWidth = 8;
+  editor->portWidth = 1;
+  editor->memoryAddressWidth = 12;
+  editor->memoryDataWidth = 16;
+}
+
+static void *ProfileSelfCheckThread(void *){
+  PROFILE_SCOPE("ProfileSelfCheckThread");
+  return nullptr;
+}
+
+static bool CheckProfilerThreadReuse(){
+  bool wasEnabled = g_profiler.enabled;
+  g_profiler.enabled = true;
+  uint32_t threadCount = g_profiler.thread_count.load();
+  it(i, PROFILER_MAX_THREADS * 2){
+    pthread_t thread;
+    pthread_create(&thread, nullptr, ProfileSelfCheckThread, nullptr);
+    pthread_join(thread, nullptr);
+  }
+  g_profiler.enabled = wasEnabled;
+  SELF_CHECK(g_profiler.thread_count.load() <= threadCount + 1);
+  return true;
+}
+
+static const uint32_t SELF_CHECK_GATES[] = {
+  NodeType_AND, NodeType_OR, NodeType_XOR, NodeType_NOT,
+  NodeType_NAND, NodeType_NOR, NodeType_XNOR, NodeType_BUF,
+};
+
+//NOTE(Torin) Gates with 1 to 4 inputs driven by earlier nodes, an input is left unconnected
+//now and then so NONE is propagated too. The last output_count gates drive the OUTPUTs
+static void BuildRandomSelfCheckDesign(Editor *editor, uint64_t seed, uint32_t input_count, uint32_t gate_count, uint32_t output_count){
+  uint64_t random = seed;
+  DynamicArray<EditorNode *> sources = {};
+  it(i, input_count) ArrayAdd(CreateNode(NodeType_INPUT, editor), sources);
+  it(i, gate_count){
+    editor->gateInputCount = 2 + SelfCheckRandom(&random) % 3;
+    uint32_t type = SELF_CHECK_GATES[SelfCheckRandom(&random) % (sizeof(SELF_CHECK_GATES) / sizeof(SELF_CHECK_GATES[0]))];
+    EditorNode *gate = CreateNode(type, editor);
+    it(n, gate->input_count){
+      if(SelfCheckRandom(&random) % 32 == 0) continue;
+      ConnectNodes(sources[SelfCheckRandom(&random) % sources.count], 0, gate, n, editor);
+    }
+    ArrayAdd(gate, sources);
+  }
+  it(i, output_count){
+    EditorNode *output = CreateNode(NodeType_OUTPUT, editor);
+    ConnectNodes(sources[sources.count - 1 - i], 0, output, 0, editor);
+  }
+  editor->gateInputCount = 2;
+  ArrayDestroy(sources);
+}
+
+static void SetSelfCheckInputs(Editor *editor, uint64_t inputs){
+  it(i, editor->inputs.count) editor->inputs[i]->signal_state = ((inputs >> i) & 1) ? NodeState_HIGH : NodeState_LOW;
+}
+
+//NOTE(Torin) Runs both editors on the same inputs and compares every OUTPUT, bus outputs
+//by their value
+static bool AreOutputsEqual(Editor *event, Editor *netlist){
+  SimulationStep(event);
+  SimulationStep(netlist);
+  if(event->nodes.count != netlist->nodes.count) return false;
+  it(i, event->nodes.count){
+    const EditorNode *a = event->nodes[i], *b = netlist->nodes[i];
+    if(a->type != NodeType_OUTPUT) continue;
+    if(a->signal_state != b->signal_state) return false;
+    if(GetPortWidth(a, true, 0) > 1 && a->signal_state == NodeState_HIGH && a->input_value[0] != b->input_value[0]) return false;
+  }
+  return true;
+}
+
+static bool CheckNetlistMatchesEventMode(){
+  it(seed, 8){
+    Editor event, netlist;
+    InitSelfCheckEditor(&event);
+    InitSelfCheckEditor(&netlist);
+    event.simulationMode = SimulationMode_EVENT;
+    netlist.simulationMode = SimulationMode_NETLIST;
+    netlist.optimizeNetlist = seed % 2 == 0;
+    BuildRandomSelfCheckDesign(&event, seed + 1, 8, 64, 8);
+    BuildRandomSelfCheckDesign(&netlist, seed + 1, 8, 64, 8);
+    it(vector, 256){
+      SetSelfCheckInputs(&event, vector);
+      SetSelfCheckInputs(&netlist, vector);
+      SELF_CHECK(AreOutputsEqual(&event, &netlist));
+    }
+  }
+  return true;
+}
+
+//NOTE(Torin) Two 8 bit buses and two single bits through every kind of word node, including
+//a bus of width 1 that is driven by a gate and by a 1 bit INPUT
+static void BuildWordSelfCheckDesign(Editor *editor){
+  editor->portWidth = 8;
+  EditorNode *a = CreateNode(NodeType_INPUT, editor);
+  EditorNode *b = CreateNode(NodeType_INPUT, editor);
+  editor->portWidth = 1;
+  EditorNode *c = CreateNode(NodeType_INPUT, editor);
+  EditorNode *d = CreateNode(NodeType_INPUT, editor);
+
+  EditorNode *sum = CreateNode(NodeType_WORD_ADD, editor);
+  EditorNode *mixed = CreateNode(NodeType_WORD_XOR, editor);
+  EditorNode *compare = CreateNode(NodeType_WORD_COMPARE, editor);
+  EditorNode *mux = CreateNode(NodeType_WORD_MUX, editor);
+  EditorNode *split = CreateNode(NodeType_WORD_SPLIT, editor);
+  EditorNode *merge = CreateNode(NodeType_WORD_MERGE, editor);
+  ConnectNodes(a, 0, sum, 0, editor);
+  ConnectNodes(b, 0, sum, 1, editor);
+  ConnectNodes(sum, 0, mixed, 0, editor);
+  ConnectNodes(a, 0, mixed, 1, editor);
+  ConnectNodes(mixed, 0, compare, 0, editor);
+  ConnectNodes(b, 0, compare, 1, editor);
+  ConnectNodes(c, 0, mux, 0, editor);
+  ConnectNodes(mixed, 0, mux, 1, editor);
+  ConnectNodes(sum, 0, mux, 2, editor);
+  ConnectNodes(mux, 0, split, 0, editor);
+  it(i, 8) ConnectNodes(split, 7 - i, merge, i, editor);
+
+  EditorNode *gate = CreateNode(NodeType_XOR, editor);
+  ConnectNodes(c, 0, gate, 0, editor);
+  ConnectNodes(split, 0, gate, 1, editor);
+  editor->busWidth = 1;
+  EditorNode *narrow = CreateNode(NodeType_WORD_XOR, editor);
+  editor->busWidth = 8;
+  ConnectNodes(gate, 0, narrow, 0, editor);
+  ConnectNodes(d, 0, narrow, 1, editor);
+
+  EditorNode *outputs[4];
+  it(i, 4) outputs[i] = CreateNode(NodeType_OUTPUT, editor);
+  outputs[0]->parameter = 8;
+  ConnectNodes(merge, 0, outputs[0], 0, editor);
+  ConnectNodes(compare, 0, outputs[1], 0, editor);
+  ConnectNodes(compare, 1, outputs[2], 0, editor);
+  ConnectNodes(narrow, 0, outputs[3], 0, editor);
+}
+
+static bool CheckWordNodesMatchEventMode(){
+  Editor event, netlist;
+  InitSelfCheckEditor(&event);
+  InitSelfCheckEditor(&netlist);
+  event.simulationMode = SimulationMode_EVENT;
+  netlist.simulationMode = SimulationMode_NETLIST;
+  BuildWordSelfCheckDesign(&event);
+  BuildWordSelfCheckDesign(&netlist);
+  uint64_t random = 0x2545F4914F6CDD1DULL;
+  it(vector, 512){
+    uint64_t value = SelfCheckRandom(&random);
+    Editor *editors[2] = { &event, &netlist };
+    it(e, 2){
+      it(i, 2){
+        EditorNode *bus = editors[e]->inputs[i];
+        bus->bus_value = (value >> (i * 8)) & 0xFF;
+        bus->signal_state = bus->bus_value ? NodeState_HIGH : NodeState_LOW;
+      }
+      it(i, 2) editors[e]->inputs[2 + i]->signal_state = ((value >> (16 + i)) & 1) ? NodeState_HIGH : NodeState_LOW;
+    }
+    SELF_CHECK(AreOutputsEqual(&event, &netlist));
+  }
+  return true;
+}
+
+static void ExpectXorOutput(uint64_t inputs, uint64_t *expected, uint64_t *care, void *){
+  *expected = (inputs ^ (inputs >> 1)) & 1;
+  *care = 1;
+}
+
+static void ExpectAndOutput(uint64_t inputs, uint64_t *expected, uint64_t *care, void *){
+  *expected = (inputs & (inputs >> 1)) & 1;
+  *care = 1;
+}
+
+static bool CheckVectorRunner(){
+  Editor editor;
+  InitSelfCheckEditor(&editor);
+  BuildRandomSelfCheckDesign(&editor, 7, 8, 64, 8);
+  VectorRunner *runner = CreateVectorRunner(&editor);
+  runner->source = VectorSource_EXHAUSTIVE;
+  runner->check = VectorCheck_REFERENCE;
+  SELF_CHECK(RunVectors(runner, &editor));
+  SELF_CHECK(runner->is_bit_parallel && runner->vector_count == 256 && runner->mismatch_count == 0);
+  DestroyVectorRunner(runner);
+  free(runner);
+
+  Editor gate;
+  InitSelfCheckEditor(&gate);
+  EditorNode *a = CreateNode(NodeType_INPUT, &gate);
+  EditorNode *b = CreateNode(NodeType_INPUT, &gate);
+  EditorNode *x = CreateNode(NodeType_XOR, &gate);
+  EditorNode *output = CreateNode(NodeType_OUTPUT, &gate);
+  ConnectNodes(a, 0, x, 0, &gate);
+  ConnectNodes(b, 0, x, 1, &gate);
+  ConnectNodes(x, 0, output, 0, &gate);
+  runner = CreateVectorRunner(&gate);
+  runner->source = VectorSource_EXHAUSTIVE;
+  runner->check = VectorCheck_REFERENCE;
+  runner->reference = ExpectXorOutput;
+  SELF_CHECK(RunVectors(runner, &gate) && runner->vector_count == 4 && runner->mismatch_count == 0);
+  runner->reference = ExpectAndOutput;
+  SELF_CHECK(RunVectors(runner, &gate) && runner->mismatch_count == 3);
+  SELF_CHECK(runner->mismatches.count == 3 && runner->mismatches[0].inputs == 1 && runner->mismatches[0].actual == 1);
+  DestroyVectorRunner(runner);
+  free(runner);
+  return true;
+}
+
+//NOTE(Torin) The fault list does not depend on how it is split over the threads
+static bool CheckFaultSimulation(){
+  Editor editor;
+  InitSelfCheckEditor(&editor);
+  BuildRandomSelfCheckDesign(&editor, 11, 8, 64, 8);
+  VectorRunner *runner = CreateVectorRunner(&editor);
+  runner->source = VectorSource_EXHAUSTIVE;
+  FaultSimulation single = {}, parallel = {};
+  single.thread_count = 1;
+  parallel.thread_count = 4;
+  SELF_CHECK(RunFaultSimulation(&single, runner, &editor));
+  SELF_CHECK(RunFaultSimulation(&parallel, runner, &editor));
+  SELF_CHECK(single.faults.count > 0 && single.faults.count == parallel.faults.count);
+  SELF_CHECK(single.detected_count > 0 && single.detected_count == parallel.detected_count);
+  it(i, single.faults.count){
+    SELF_CHECK(single.faults[i].net == parallel.faults[i].net && single.faults[i].stuck_value == parallel.faults[i].stuck_value);
+    SELF_CHECK(single.faults[i].detected_vector == parallel.faults[i].detected_vector);
+  }
+  DestroyFaultSimulation(&single);
+  DestroyFaultSimulation(&parallel);
+  DestroyVectorRunner(runner);
+  free(runner);
+
+  //NOTE(Torin) Every fault of an AND gate is found by the four vectors, the OR gate drives
+  //nothing so neither of its faults can be
+  Editor gate;
+  InitSelfCheckEditor(&gate);
+  EditorNode *a = CreateNode(NodeType_INPUT, &gate);
+  EditorNode *b = CreateNode(NodeType_INPUT, &gate);
+  EditorNode *both = CreateNode(NodeType_AND, &gate);
+  EditorNode *either = CreateNode(NodeType_OR, &gate);
+  EditorNode *output = CreateNode(NodeType_OUTPUT, &gate);
+  ConnectNodes(a, 0, both, 0, &gate);
+  ConnectNodes(b, 0, both, 1, &gate);
+  ConnectNodes(a, 0, either, 0, &gate);
+  ConnectNodes(b, 0, either, 1, &gate);
+  ConnectNodes(both, 0, output, 0, &gate);
+  runner = CreateVectorRunner(&gate);
+  runner->source = VectorSource_EXHAUSTIVE;
+  FaultSimulation simulation = {};
+  SELF_CHECK(RunFaultSimulation(&simulation, runner, &gate));
+  uint32_t undetected = 0;
+  it(i, simulation.faults.count){
+    const Fault *fault = &simulation.faults[i];
+    if(fault->detected_vector != FAULT_UNDETECTED) continue;
+    SELF_CHECK(fault->net_type == NetType_OR);
+    undetected++;
+  }
+  SELF_CHECK(simulation.faults.count == 8 && undetected == 2 && simulation.detected_count == 6);
+  DestroyFaultSimulation(&simulation);
+  DestroyVectorRunner(runner);
+  free(runner);
+  return true;
+}
+
+//NOTE(Torin) Packs every node of the editor into one IC, returns its definition
+static ICDefinition *CreateSelfCheckIC(Editor *editor){
+  DynamicArray<NodeIndex> indices = {};
+  it(i, editor->nodes.count){
+    NodeIndex index = {};
+    index.node_index = editor->nodes[i]->id;
+    index.node_ptr = editor->nodes[i];
+    ArrayAdd(index, indices);
+  }
+  EditorNode *node = CreateICFromNodes(indices.data, indices.count, editor);
+  ArrayDestroy(indices);
+  return editor->icdefs[node->type - (NodeType_COUNT + 1)];
+}
+
+//NOTE(Torin) Reduces the nodes pairwise with gates of type until one is left
+static EditorNode *ReduceSelfCheckNodes(DynamicArray<EditorNode *> *nodes, uint32_t type, Editor *editor){
+  size_t first = 0;
+  while(nodes->count - first > 1){
+    EditorNode *gate = CreateNode(type, editor);
+    ConnectNodes((*nodes)[first], 0, gate, 0, editor);
+    ConnectNodes((*nodes)[first + 1], 0, gate, 1, editor);
+    ArrayAdd(gate, *nodes);
+    first += 2;
+  }
+  return (*nodes)[first];
+}
+
+//NOTE(Torin) 24 inputs are past the exhaustive limit so both results come from the SAT
+//solver. a0 a1 + a2 a3 + ... against its De Morgan form, then a 24 input AND against one
+//that is 0 for every input, which only differs when every input is 1
+static bool CheckEquivalenceMethods(){
+  const uint32_t inputCount = 24;
+  Editor editors[4];
+  ICDefinition *icdefs[4];
+  it(variant, 4){
+    Editor& editor = editors[variant];
+    InitSelfCheckEditor(&editor);
+    DynamicArray<EditorNode *> inputs = {}, terms = {};
+    it(i, inputCount) ArrayAdd(CreateNode(NodeType_INPUT, &editor), inputs);
+    EditorNode *output = CreateNode(NodeType_OUTPUT, &editor);
+    EditorNode *result = nullptr;
+    if(variant < 2){
+      for(uint32_t i = 0; i < inputCount; i += 2){
+        EditorNode *term = CreateNode(variant == 0 ? NodeType_AND : NodeType_NAND, &editor);
+        ConnectNodes(inputs[i], 0, term, 0, &editor);
+        ConnectNodes(inputs[i + 1], 0, term, 1, &editor);
+        ArrayAdd(term, terms);
+      }
+      result = ReduceSelfCheckNodes(&terms, variant == 0 ? NodeType_OR : NodeType_AND, &editor);
+      if(variant == 1){
+        EditorNode *inverted = CreateNode(NodeType_NOT, &editor);
+        ConnectNodes(result, 0, inverted, 0, &editor);
+        result = inverted;
+      }
+    } else {
+      it(i, inputCount) ArrayAdd(inputs[i], terms);
+      if(variant == 3){
+        EditorNode *zero = CreateNode(NodeType_XOR, &editor);
+        ConnectNodes(inputs[0], 0, zero, 0, &editor);
+        ConnectNodes(inputs[0], 0, zero, 1, &editor);
+        terms[0] = zero;
+      }
+      result = ReduceSelfCheckNodes(&terms, NodeType_AND, &editor);
+    }
+    ConnectNodes(result, 0, output, 0, &editor);
+    ArrayDestroy(inputs);
+    ArrayDestroy(terms);
+    icdefs[variant] = CreateSelfCheckIC(&editor);
+  }
+
+  EquivalenceCheck check = {};
+  SELF_CHECK(CheckEquivalence(&check, icdefs[0], icdefs[1]));
+  SELF_CHECK(check.status == EquivalenceStatus_EQUIVALENT && check.method == EquivalenceMethod_SAT);
+  SELF_CHECK(CheckEquivalence(&check, icdefs[2], icdefs[3]));
+  SELF_CHECK(check.status == EquivalenceStatus_DIFFERENT && check.method == EquivalenceMethod_SAT);
+  it(i, inputCount) SELF_CHECK(check.counterexample[i] == 1);
+  SELF_CHECK(CheckEquivalence(&check, icdefs[0], icdefs[2]));
+  SELF_CHECK(check.status == EquivalenceStatus_DIFFERENT && check.method == EquivalenceMethod_RANDOM);
+  ArrayDestroy(check.counterexample);
+  return true;
+}
+
+//NOTE(Torin) Nodes ordered by id with the connections of each node after it and with
+//is_memory_included the serialized RAM and ROM contents
+static void DescribeSelfCheckDesign(Editor *editor, bool is_memory_included, DynamicArray<uint8_t> *design){
+  design->count = 0;
+  it(id, editor->nodeTable.count){
+    EditorNode *node = editor->nodeTable[id];
+    if(node == nullptr) continue;
+    NodeDescription description = DescribeNode(node);
+    size_t offset = design->count;
+    bool hasMemory = is_memory_included && node->memory != nullptr;
+    size_t memorySize = hasMemory ? GetMemoryContentsSize(node->memory) : 0;
+    size_t size = sizeof(NodeDescription) + node->input_count * sizeof(ConnectionDescription) + memorySize;
+    ArrayReserve(offset + size, *design);
+    design->count = offset + size;
+    memcpy(design->data + offset, &description, sizeof(description));
+    ConnectionDescription *connection = (ConnectionDescription *)(design->data + offset + sizeof(description));
+    it(n, node->input_count){
+      const NodeConnection *input = &node->inputConnections[n];
+      connection[n] = {};
+      if(IsValid(input->node_index)) connection[n] = { input->node_index.node_ptr->id, input->io_index, node->id, (uint32_t)n };
+    }
+    if(hasMemory) SerializeMemoryContents(node->memory, (uint8_t *)(connection + node->input_count));
+  }
+}
+
+static bool IsSelfCheckDesign(Editor *editor, bool is_memory_included, const DynamicArray<uint8_t>& expected){
+  DynamicArray<uint8_t> design = {};
+  DescribeSelfCheckDesign(editor, is_memory_included, &design);
+  bool result = design.count == expected.count && memcmp(design.data, expected.data, design.count) == 0;
+  ArrayDestroy(design);
+  return result;
+}
+
+static NodeIndex GetSelfCheckIndex(EditorNode *node){
+  NodeIndex result = {};
+  result.node_index = node->id;
+  result.node_ptr = node;
+  return result;
+}
+
+static void GetSelfCheckIndices(Editor *editor, DynamicArray<NodeIndex> *indices){
+  indices->count = 0;
+  it(i, editor->nodes.count) ArrayAdd(GetSelfCheckIndex(editor->nodes[i]), *indices);
+}
+
+//NOTE(Torin) Every step of a random edit session is undone back to the empty design and
+//redone, the design after each step has to come back exactly. Undoing the delete of a RAM
+//brings back the words the simulation wrote into it, redoing its creation does not since
+//those writes are not commands
+static bool CheckUndoRedo(){
+  Editor editor;
+  InitSelfCheckEditor(&editor);
+  uint64_t random = 0x9E3779B97F4A7C15ULL;
+  DynamicArray<DynamicArray<uint8_t>> designs[2] = {};
+  it(m, 2){
+    ArrayAdd(DynamicArray<uint8_t>(), designs[m]);
+    DescribeSelfCheckDesign(&editor, m == 1, &designs[m][0]);
+  }
+  it(step, 200){
+    uint64_t action = SelfCheckRandom(&random) % 8;
+    if(action < 3 || editor.nodes.count < 4){
+      uint32_t type = action == 0 ? (uint32_t)NodeType_RAM : SELF_CHECK_GATES[SelfCheckRandom(&random) % 3];
+      if(editor.nodes.count < 4) type = NodeType_INPUT;
+      EditorNode *node = CommandCreateNode(type, ImVec2(step * 10.0f, action * 10.0f), &editor);
+      if(node->memory != nullptr){
+        it(i, 4) WriteMemoryWord(node->memory, SelfCheckRandom(&random), SelfCheckRandom(&random));
+      }
+    } else if(action < 6){
+      EditorNode *source = editor.nodes[SelfCheckRandom(&random) % editor.nodes.count];
+      EditorNode *dest = editor.nodes[SelfCheckRandom(&random) % editor.nodes.count];
+      if(source->output_count == 0 || dest->input_count == 0) continue;
+      uint32_t output = SelfCheckRandom(&random) % source->output_count;
+      uint32_t input = SelfCheckRandom(&random) % dest->input_count;
+      if(GetPortWidth(source, false, output) != GetPortWidth(dest, true, input)) continue;
+      CommandConnect(source, output, dest, input, &editor);
+    } else if(action == 6){
+      EditorNode *node = editor.nodes[SelfCheckRandom(&random) % editor.nodes.count];
+      CommandSetNodeParameter(node, NodeParameter_DELAY, node->delay + 1 + SelfCheckRandom(&random) % 7, &editor);
+    } else {
+      NodeIndex indices[2];
+      it(i, 2) indices[i] = GetSelfCheckIndex(editor.nodes[SelfCheckRandom(&random) % editor.nodes.count]);
+      CommandDeleteNodes(indices, indices[0].node_ptr == indices[1].node_ptr ? 1 : 2, &editor);
+    }
+    it(m, 2){
+      ArrayAdd(DynamicArray<uint8_t>(), designs[m]);
+      DescribeSelfCheckDesign(&editor, m == 1, &designs[m][designs[m].count - 1]);
+    }
+  }
+
+  size_t stepCount = designs[0].count;
+  for(size_t i = stepCount - 1; i > 0; i--){
+    SELF_CHECK(UndoCommand(&editor));
+    SELF_CHECK(IsSelfCheckDesign(&editor, true, designs[1][i - 1]));
+  }
+  SELF_CHECK(!UndoCommand(&editor) && editor.nodes.count == 0);
+  for(size_t i = 1; i < stepCount; i++){
+    SELF_CHECK(RedoCommand(&editor));
+    SELF_CHECK(IsSelfCheckDesign(&editor, false, designs[0][i]));
+  }
+  SELF_CHECK(!RedoCommand(&editor));
+  it(m, 2){
+    it(i, designs[m].count) ArrayDestroy(designs[m][i]);
+    ArrayDestroy(designs[m]);
+  }
+  return true;
+}
+
+//NOTE(Torin) A copy pasted into an empty editor at the same place serializes to the same
+//buffer, which covers the connections, the ICs and the memory contents
+static bool CheckPaste(){
+  Editor editor;
+  InitSelfCheckEditor(&editor);
+  BuildRandomSelfCheckDesign(&editor, 5, 4, 16, 2);
+  DynamicArray<NodeIndex> indices = {};
+  GetSelfCheckIndices(&editor, &indices);
+  CreateICFromNodes(indices.data, indices.count, &editor);
+  EditorNode *ram = CreateNode(NodeType_RAM, &editor);
+  EditorNode *address = CreateNode(NodeType_INPUT, &editor);
+  address->parameter = ram->memory->address_width;
+  ConnectNodes(address, 0, ram, 0, &editor);
+  WriteMemoryWord(ram->memory, 3, 0x1234);
+  WriteMemoryWord(ram->memory, 4000, 0x5678);
+  GetSelfCheckIndices(&editor, &indices);
+  DynamicArray<uint8_t> copy = {};
+  SerializeNodes(indices.data, indices.count, &editor, &copy);
+
+  Editor pasted;
+  InitSelfCheckEditor(&pasted);
+  const ClipboardHeader *header = (const ClipboardHeader *)copy.data;
+  ImVec2 origin = ImVec2(header->origin_x, header->origin_y);
+  SELF_CHECK(CommandPaste(copy.data, copy.count, origin, &pasted));
+  SELF_CHECK(pasted.nodes.count == editor.nodes.count && pasted.icdefs.count == 1);
+  DynamicArray<uint8_t> recopy = {};
+  SerializeNodes(pasted.selectedNodes.data, pasted.selectedNodes.count, &pasted, &recopy);
+  SELF_CHECK(recopy.count == copy.count && memcmp(recopy.data, copy.data, copy.count) == 0);
+  SELF_CHECK(UndoCommand(&pasted) && pasted.nodes.count == 0);
+  SELF_CHECK(RedoCommand(&pasted) && pasted.nodes.count == editor.nodes.count);
+  GetSelfCheckIndices(&pasted, &indices);
+  SerializeNodes(indices.data, indices.count, &pasted, &recopy);
+  SELF_CHECK(recopy.count == copy.count && memcmp(recopy.data, copy.data, copy.count) == 0);
+  ArrayDestroy(indices);
+  ArrayDestroy(copy);
+  ArrayDestroy(recopy);
+  return true;
+}
+
+static bool RunSelfCheck(const char *name, bool (*check)()){
+  bool result = check();
+  printf("%-40s %s\n", name, result ? "ok" : "FAILED");
+  return result;
+}
+
+int RunSelfChecks(){
+  int failed = 0;
+  failed += !RunSelfCheck("profiler thread reuse", CheckProfilerThreadReuse);
+  failed += !RunSelfCheck("netlist matches event mode", CheckNetlistMatchesEventMode);
+  failed += !RunSelfCheck("word nodes match event mode", CheckWordNodesMatchEventMode);
+  failed += !RunSelfCheck("vector runner", CheckVectorRunner);
+  failed += !RunSelfCheck("fault simulation", CheckFaultSimulation);
+  failed += !RunSelfCheck("equivalence", CheckEquivalenceMethods);
+  failed += !RunSelfCheck("undo and redo", CheckUndoRedo);
+  failed += !RunSelfCheck("paste", CheckPaste);
+  return failed;
+}
@@ -0,0 +1,72 @@
+//NOTE(Torin) Sequential nodes
+//DFF and REGISTER nodes sample their D inputs on a rising edge of their clock input,
+//RAM nodes write the data input to the address when write enable is HIGH on that edge,
+//CLOCK nodes toggle every half period of Editor::clockTick. A step first settles the
+//combinational logic with the current register outputs and then latches, so register
+//outputs only change between steps and feedback through a register never oscillates
+
+static inline
+void LatchSequentialNode(EditorNode *node){
+  if(node->type == NodeType_CLOCK) return;
+  if(node->type == NodeType_RAM){
+    NodeState clock = node->input_state[3];
+    bool isWrite = node->clock_state == NodeState_LOW && clock == NodeState_HIGH && node->input_state[2] == NodeState_HIGH;
+    if(isWrite && node->input_state[0] != NodeState_NONE && node->input_state[1] != NodeState_NONE)
+      WriteMemoryWord(node->memory, node->input_value[0], node->input_value[1]);
+    node->clock_state = clock;
+    return;
+  }
+
+  size_t clockIndex = node->input_count - 1;
+  NodeState clock = node->input_state[clockIndex];
+  if(node->clock_state == NodeState_LOW && clock == NodeState_HIGH){
+    for(size_t i = 0; i < node->output_count; i++){
+      if(node->input_state[i] == NodeState_NONE) continue;
+      node->output_state[i] = node->input_state[i];
+      node->output_value[i] = node->input_value[i];
+    }
+  }
+  node->clock_state = clock;
+}
+
+void LatchSequentialNodes(Editor *editor){
+  it(i, editor->sequentialNodes.count){
+    LatchSequentialNode(editor->sequentialNodes[i]);
+  }
+}
+
+//NOTE(Torin) Ticks of one period of the slowest CLOCK node in the design, so every clock
+//completes at least one whole period per cycle. 0 when the design has no CLOCK node
+static uint64_t GetClockCycleTicks(const Editor *editor){
+  uint64_t result = 0;
+  it(i, editor->sequentialNodes.count){
+    const EditorNode *node = editor->sequentialNodes.data[i];
+    if(node->type == NodeType_CLOCK) result = Max(result, 2 * (uint64_t)Max(node->parameter, 1));
+  }
+  return result;
+}
+
+//NOTE(Torin) Runs cycle_count clock cycles (see GetClockCycleTicks) as fast as possible on
+//the levelized netlist, designs with a combinational loop fall back to one event driven
+//settle per tick. Returns false without running when the design has no CLOCK node
+bool RunClockCycles(Editor *editor, uint64_t cycle_count){
+  PROFILE_SCOPE("RunClockCycles");
+  uint64_t cycleTicks = GetClockCycleTicks(editor);
+  if(cycleTicks == 0) return false;
+  editor->timing.is_valid = false;
+  uint64_t beginTicks = ProfilerTimestamp();
+  uint64_t tickCount = cycle_count * cycleTicks;
+  if(UpdateNetlist(editor)){
+    RunNetlistCycles(editor->netlist, editor->clockTick, tickCount);
+    editor->clockTick += tickCount;
+  } else {
+    for(uint64_t i = 0; i < tickCount; i++){
+      SimulateEventDriven(editor);
+      LatchSequentialNodes(editor);
+      editor->clockTick++;
+    }
+  }
+  editor->lastRunCycles = cycle_count;
+  editor->lastRunMilliseconds = ProfilerTicksToMilliseconds(ProfilerTimestamp() - beginTicks);
+  return true;
+}
@@ -0,0 +1,172 @@
+//NOTE(Torin) Simulation work counters
+//Per step: node evaluations, redundant re-evaluations (a node evaluated more than once
+//in the same step by the recursive propagation), IC evaluations, settled net toggles and
+//in timing mode every transition, a net with more transitions than toggles glitched
+//Per net: toggle counts stored in EditorNode::output_activity
+//Per ICDefinition: instance evaluations, internal node evaluations and rdtsc time
+
+static inline
+void BeginSimulationStats(SimulationStats *stats){
+  stats->evaluations = 0;
+  stats->redundant_evaluations = 0;
+  stats->ic_evaluations = 0;
+  stats->toggles = 0;
+  stats->transitions = 0;
+}
+
+//NOTE(Torin) A toggle is counted when a net settles to a different value than it
+//had at the end of the previous step, intermediate values produced by the propagation
+//order inside a single step are not counted
+void EndSimulationStats(Editor *editor){
+  SimulationStats *stats = &editor->stats;
+  it(i, editor->nodes.count){
+    EditorNode *node = editor->nodes[i];
+    it(n, node->output_count){
+      NetActivity *activity = &node->output_activity[n];
+      NodeState state = node->output_state[n];
+      if(state == NodeState_NONE) continue;
+      uint64_t value = GetPortWidth(node, false, n) > 1 ? node->output_value[n] : (uint64_t)state;
+      if(activity->settled_state != state || activity->settled_value != value){
+        activity->toggle_count++;
+        activity->settled_state = state;
+        activity->settled_value = value;
+        stats->toggles++;
+      }
+    }
+  }
+
+  size_t historyIndex = stats->step_count % SIMULATION_STATS_HISTORY;
+  stats->evaluation_history[historyIndex] = (float)stats->evaluations;
+  stats->redundant_history[historyIndex] = (float)stats->redundant_evaluations;
+  stats->toggle_history[historyIndex] = (float)stats->toggles;
+
+  stats->total_evaluations += stats->evaluations;
+  stats->total_redundant_evaluations += stats->redundant_evaluations;
+  stats->total_ic_evaluations += stats->ic_evaluations;
+  stats->total_toggles += stats->toggles;
+  stats->total_transitions += stats->transitions;
+  stats->step_count++;
+}
+
+const SimulationStats *GetSimulationStats(const Editor *editor){
+  return &editor->stats;
+}
+
+void ResetSimulationStats(Editor *editor){
+  memset(&editor->stats, 0, sizeof(SimulationStats));
+  it(i, editor->nodes.count){
+    EditorNode *node = editor->nodes[i];
+    node->total_evaluations = 0;
+    it(n, node->output_count){
+      node->output_activity[n].toggle_count = 0;
+      node->output_activity[n].transition_count = 0;
+    }
+  }
+
+  it(i, editor->icdefs.count){
+    ICDefinition *icdef = editor->icdefs[i];
+    icdef->eval_count = 0;
+    icdef->eval_ticks = 0;
+    icdef->node_evaluations = 0;
+  }
+}
+
+static inline
+const char *GetNodeTypeName(uint32_t type){
+  if(type < NodeType_COUNT) return NodeName[type];
+  return "IC";
+}
+
+bool DumpSimulationStatsCSV(const Editor *editor, const char *filename){
+  FILE *file = fopen(filename, "wb");
+  if(file == nullptr) return false;
+
+  const SimulationStats *stats = &editor->stats;
+  fprintf(file, "kind,id,type,output,evaluations,toggles,time_ms\n");
+  fprintf(file, "summary,steps,,,%llu,%llu,\n", (unsigned long long)stats->step_count, (unsigned long long)stats->total_toggles);
+  fprintf(file, "summary,redundant,,,%llu,,\n", (unsigned long long)stats->total_redundant_evaluations);
+  fprintf(file, "summary,ic,,,%llu,,\n", (unsigned long long)stats->total_ic_evaluations);
+
+  for(size_t i = 0; i < editor->nodes.count; i++){
+    EditorNode *node = editor->nodes.data[i];
+    for(size_t n = 0; n < node->output_count; n++){
+      fprintf(file, "net,%zu,%s,%zu,%llu,%llu,\n", i, GetNodeTypeName(node->type), n,
+        (unsigned long long)node->total_evaluations, (unsigned long long)node->output_activity[n].toggle_count);
+    }
+  }
+
+  for(size_t i = 0; i < editor->icdefs.count; i++){
+    const ICDefinition *icdef = editor->icdefs.data[i];
+    fprintf(file, "ic,%zu,IC,,%llu,,%.6f\n", i, (unsigned long long)icdef->eval_count,
+      ProfilerTicksToMilliseconds(icdef->eval_ticks));
+  }
+
+  fclose(file);
+  return true;
+}
+
+void DrawSimulationStatsWindow(Editor *editor){
+  static const size_t TOP_NET_COUNT = 16;
+  SimulationStats *stats = &editor->stats;
+
+  ImGui::Begin("SimulationStats");
+  if(ImGui::Button("Reset")) ResetSimulationStats(editor);
+  ImGui::SameLine();
+  if(ImGui::Button("Dump CSV")) DumpSimulationStatsCSV(editor, "simulation_stats.csv");
+
+  int historyOffset = (int)(stats->step_count % SIMULATION_STATS_HISTORY);
+  ImGui::Text("steps: %llu", (unsigned long long)stats->step_count);
+  ImGui::PlotLines("evaluations", stats->evaluation_history, SIMULATION_STATS_HISTORY, historyOffset, 0, 0.0f, FLT_MAX, ImVec2(0, 40));
+  ImGui::PlotLines("redundant", stats->redundant_history, SIMULATION_STATS_HISTORY, historyOffset, 0, 0.0f, FLT_MAX, ImVec2(0, 40));
+  ImGui::PlotLines("toggles", stats->toggle_history, SIMULATION_STATS_HISTORY, historyOffset, 0, 0.0f, FLT_MAX, ImVec2(0, 40));
+  ImGui::Text("total evaluations: %llu", (unsigned long long)stats->total_evaluations);
+  ImGui::Text("total redundant evaluations: %llu", (unsigned long long)stats->total_redundant_evaluations);
+  ImGui::Text("total IC evaluations: %llu", (unsigned long long)stats->total_ic_evaluations);
+  ImGui::Text("total toggles: %llu", (unsigned long long)stats->total_toggles);
+  if(stats->total_transitions > 0)
+    ImGui::Text("total transitions: %llu", (unsigned long long)stats->total_transitions);
+
+  if(ImGui::CollapsingHeader("Most active nets")){
+    //NOTE(Torin) Partial insertion sort into a fixed size table, the node count
+    //can be large but only the top entries are displayed
+    EditorNode *topNodes[TOP_NET_COUNT];
+    size_t topOutputs[TOP_NET_COUNT];
+    uint64_t topToggles[TOP_NET_COUNT];
+    size_t topCount = 0;
+    it(i, editor->nodes.count){
+      EditorNode *node = editor->nodes[i];
+      it(n, node->output_count){
+        uint64_t toggles = node->output_activity[n].toggle_count;
+        if(toggles == 0) continue;
+        if(topCount == TOP_NET_COUNT && toggles <= topToggles[topCount - 1]) continue;
+        size_t insert = topCount < TOP_NET_COUNT ? topCount++ : TOP_NET_COUNT - 1;
+        while(insert > 0 && topToggles[insert - 1] < toggles){
+          topNodes[insert] = topNodes[insert - 1];
+          topOutputs[insert] = topOutputs[insert - 1];
+          topToggles[insert] = topToggles[insert - 1];
+          insert--;
+        }
+        topNodes[insert] = node;
+        topOutputs[insert] = n;
+        topToggles[insert] = toggles;
+      }
+    }
+
+    it(i, topCount){
+      ImGui::Text("%zu. %s output %zu: %llu toggles", i + 1, GetNodeTypeName(topNodes[i]->type),
+        topOutputs[i], (unsigned long long)topToggles[i]);
+    }
+  }
+
+  if(ImGui::CollapsingHeader("IC definitions")){
+    it(i, editor->icdefs.count){
+      ICDefinition *icdef = editor->icdefs[i];
+      double totalMs = ProfilerTicksToMilliseconds(icdef->eval_ticks);
+      double averageUs = icdef->eval_count ? (totalMs * 1000.0) / (double)icdef->eval_count : 0.0;
+      ImGui::Text("%s: %llu evals, %llu node evals, %.3f ms total, %.3f us avg", GetICName(i, editor),
+        (unsigned long long)icdef->eval_count, (unsigned long long)icdef->node_evaluations, totalMs, averageUs);
+    }
+  }
+
+  ImGui::End();
+}
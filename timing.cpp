@@ -0,0 +1,404 @@
+//NOTE(Torin) Gate delay timing simulation
+//Every node output change is an event that becomes visible after the propagation delay
+//of the node, so hazards and glitches show up as short pulses instead of being settled
+//away like in the zero delay simulators. A SimulationStep advances time by one clock tick
+//of Editor::timingTickLength time units, events further in the future carry over into
+//the next step which is how a path longer than the clock period shows up.
+//Pending events live in a hierarchical timing wheel: level L holds events that share the
+//current block of 64^(L+1) time units with TimingWheel::now, one slot per 64^L units,
+//anything further away goes to an overflow list. Insertion and removal are O(1) on
+//intrusive doubly linked slot lists, the next occupied slot is found with the occupancy
+//bitmap of each level and a higher level slot is only cascaded down once time reaches it.
+//Transport delay keeps every pulse, inertial delay cancels the pending event of an output
+//when it is evaluated again so pulses shorter than the delay are swallowed
+
+static inline
+uint32_t GetNodeDelay(const EditorNode *node){
+  if(node->delay != 0) return node->delay;
+  if(IsLogicGateType(node->type)) return GetGateInfo(node->type)->delay;
+  switch(node->type){
+    case NodeType_DFF:
+    case NodeType_REGISTER: return 3;
+    case NodeType_RAM:
+    case NodeType_ROM: return 10;
+  }
+  if(IsWordNodeType(node->type)) return 8;
+  return 5; //IC
+}
+
+static inline
+uint32_t GetTimingWheelList(const TimingWheel *wheel, uint64_t time){
+  assert(time >= wheel->now);
+  for(uint32_t level = 0; level < TIMING_WHEEL_LEVELS; level++){
+    uint32_t shift = TIMING_WHEEL_BITS * (level + 1);
+    if((time >> shift) == (wheel->now >> shift))
+      return level * TIMING_WHEEL_SLOTS + ((time >> (TIMING_WHEEL_BITS * level)) & (TIMING_WHEEL_SLOTS - 1));
+  }
+  return TIMING_WHEEL_OVERFLOW;
+}
+
+static inline
+void LinkTimingEvent(TimingWheel *wheel, uint32_t index){
+  TimingEvent *event = &wheel->events.data[index];
+  uint32_t list = GetTimingWheelList(wheel, event->time);
+  event->list = list;
+  event->prev = TIMING_EVENT_NONE;
+  event->next = wheel->heads[list];
+  if(event->next != TIMING_EVENT_NONE) wheel->events.data[event->next].prev = index;
+  wheel->heads[list] = index;
+  if(list < TIMING_WHEEL_OVERFLOW)
+    wheel->occupied[list / TIMING_WHEEL_SLOTS] |= 1ULL << (list % TIMING_WHEEL_SLOTS);
+}
+
+static inline
+void UnlinkTimingEvent(TimingWheel *wheel, uint32_t index){
+  TimingEvent *event = &wheel->events.data[index];
+  if(event->prev != TIMING_EVENT_NONE) wheel->events.data[event->prev].next = event->next;
+  else wheel->heads[event->list] = event->next;
+  if(event->next != TIMING_EVENT_NONE) wheel->events.data[event->next].prev = event->prev;
+  if(wheel->heads[event->list] == TIMING_EVENT_NONE && event->list < TIMING_WHEEL_OVERFLOW)
+    wheel->occupied[event->list / TIMING_WHEEL_SLOTS] &= ~(1ULL << (event->list % TIMING_WHEEL_SLOTS));
+}
+
+void ResetTimingWheel(TimingWheel *wheel, uint64_t now){
+  wheel->now = now;
+  wheel->events.count = 0;
+  wheel->free_list = TIMING_EVENT_NONE;
+  wheel->event_count = 0;
+  memset(wheel->occupied, 0, sizeof(wheel->occupied));
+  it(i, TIMING_WHEEL_OVERFLOW + 1) wheel->heads[i] = TIMING_EVENT_NONE;
+}
+
+uint32_t InsertTimingEvent(TimingWheel *wheel, const TimingEvent *event){
+  uint32_t index = wheel->free_list;
+  if(index != TIMING_EVENT_NONE){
+    wheel->free_list = wheel->events.data[index].next;
+    wheel->events.data[index] = *event;
+  } else {
+    index = wheel->events.count;
+    ArrayAdd(*event, wheel->events);
+  }
+  LinkTimingEvent(wheel, index);
+  wheel->event_count++;
+  return index;
+}
+
+static inline
+void FreeTimingEvent(TimingWheel *wheel, uint32_t index){
+  wheel->events.data[index].next = wheel->free_list;
+  wheel->events.data[index].node = nullptr;
+  wheel->free_list = index;
+  wheel->event_count--;
+}
+
+void RemoveTimingEvent(TimingWheel *wheel, uint32_t index){
+  UnlinkTimingEvent(wheel, index);
+  FreeTimingEvent(wheel, index);
+}
+
+//NOTE(Torin) Relinks every event of a list relative to the current time, used when time
+//enters the block of a higher level slot or the overflow list
+static void CascadeTimingList(TimingWheel *wheel, uint32_t list){
+  uint32_t index = wheel->heads[list];
+  wheel->heads[list] = TIMING_EVENT_NONE;
+  if(list < TIMING_WHEEL_OVERFLOW)
+    wheel->occupied[list / TIMING_WHEEL_SLOTS] &= ~(1ULL << (list % TIMING_WHEEL_SLOTS));
+  while(index != TIMING_EVENT_NONE){
+    uint32_t next = wheel->events.data[index].next;
+    LinkTimingEvent(wheel, index);
+    index = next;
+  }
+}
+
+//NOTE(Torin) Advances TimingWheel::now to the earliest pending event if it is not later
+//than limit and returns its level 0 list, every event of that list has time == now
+bool NextTimingSlot(TimingWheel *wheel, uint64_t limit, uint32_t *list){
+  static const uint64_t SLOT_MASK = TIMING_WHEEL_SLOTS - 1;
+  for(;;){
+    uint64_t pending = wheel->occupied[0] & (~0ULL << (wheel->now & SLOT_MASK));
+    if(pending != 0){
+      uint64_t time = (wheel->now & ~SLOT_MASK) | __builtin_ctzll(pending);
+      if(time > limit) return false;
+      wheel->now = time;
+      *list = (uint32_t)(time & SLOT_MASK);
+      return true;
+    }
+
+    bool cascaded = false;
+    for(uint32_t level = 1; level < TIMING_WHEEL_LEVELS && !cascaded; level++){
+      uint32_t shift = TIMING_WHEEL_BITS * level;
+      uint64_t current = (wheel->now >> shift) & SLOT_MASK;
+      uint64_t later = (current == SLOT_MASK) ? 0 : (wheel->occupied[level] & (~0ULL << (current + 1)));
+      if(later == 0) continue;
+      uint64_t slot = __builtin_ctzll(later);
+      uint64_t blockStart = ((wheel->now >> (shift + TIMING_WHEEL_BITS)) << (shift + TIMING_WHEEL_BITS)) | (slot << shift);
+      if(blockStart > limit) return false;
+      wheel->now = blockStart;
+      CascadeTimingList(wheel, level * TIMING_WHEEL_SLOTS + (uint32_t)slot);
+      cascaded = true;
+    }
+    if(cascaded) continue;
+
+    //NOTE(Torin) Every level is empty, jump straight to the earliest overflow event
+    uint32_t index = wheel->heads[TIMING_WHEEL_OVERFLOW];
+    if(index == TIMING_EVENT_NONE) return false;
+    uint64_t earliest = UINT64_MAX;
+    for(; index != TIMING_EVENT_NONE; index = wheel->events.data[index].next){
+      if(wheel->events.data[index].time < earliest) earliest = wheel->events.data[index].time;
+    }
+    if(earliest > limit) return false;
+    wheel->now = earliest;
+    CascadeTimingList(wheel, TIMING_WHEEL_OVERFLOW);
+  }
+}
+
+//NOTE(Torin) Schedules output_index of node to change at time, events matching the
+//value the output is already heading to are dropped
+static void ScheduleTimingOutput(EditorNode *node, uint32_t output_index, NodeState state, uint64_t value, uint64_t time, Editor *editor){
+  TimingSimulation *timing = &editor->timing;
+  uint32_t slot = timing->output_base[node->timing_index] + output_index;
+  if(timing->projected_state[slot] == state && timing->projected_value[slot] == value) return;
+  if(editor->timingInertial && timing->pending_event[slot] != TIMING_EVENT_NONE){
+    RemoveTimingEvent(&timing->wheel, timing->pending_event[slot]);
+    timing->pending_event[slot] = TIMING_EVENT_NONE;
+    timing->projected_state[slot] = node->output_state[output_index];
+    timing->projected_value[slot] = node->output_value[output_index];
+    if(timing->projected_state[slot] == state && timing->projected_value[slot] == value) return;
+  }
+
+  TimingEvent event = {};
+  event.time = time;
+  event.value = value;
+  event.node = node;
+  event.output_index = output_index;
+  event.state = state;
+  timing->pending_event[slot] = InsertTimingEvent(&timing->wheel, &event);
+  timing->projected_state[slot] = state;
+  timing->projected_value[slot] = value;
+}
+
+static inline
+void MarkTimingNodeDirty(EditorNode *node, TimingSimulation *timing){
+  if(timing->is_dirty[node->timing_index]) return;
+  timing->is_dirty[node->timing_index] = 1;
+  ArrayAdd(node, timing->dirty);
+}
+
+static void ApplyTimingEvent(uint32_t index, Editor *editor){
+  TimingSimulation *timing = &editor->timing;
+  const TimingEvent *event = &timing->wheel.events.data[index];
+  EditorNode *node = event->node;
+  uint32_t output_index = event->output_index;
+  uint32_t slot = timing->output_base[node->timing_index] + output_index;
+  if(timing->pending_event[slot] == index) timing->pending_event[slot] = TIMING_EVENT_NONE;
+
+  NodeState state = event->state;
+  uint64_t value = event->value;
+  NodeState previous = node->output_state[output_index];
+  if(previous == state && node->output_value[output_index] == value) return;
+  node->output_state[output_index] = state;
+  node->output_value[output_index] = value;
+  if(state != NodeState_NONE) node->signal_state = state;
+  if(state != NodeState_NONE && previous != NodeState_NONE){
+    node->output_activity[output_index].transition_count++;
+    editor->stats.transitions++;
+  }
+
+  DynamicArray<NodeConnection> &connections = node->output_connections[output_index];
+  it(i, connections.count){
+    NodeConnection *connection = &connections[i];
+    EditorNode *dest = connection->node_index.node_ptr;
+    dest->input_state[connection->io_index] = state;
+    dest->input_value[connection->io_index] = value;
+    MarkTimingNodeDirty(dest, timing);
+  }
+}
+
+//NOTE(Torin) Evaluates a node whose inputs changed at time and schedules its outputs
+static void EvaluateTimedNode(EditorNode *node, uint64_t time, Editor *editor){
+  editor->stats.evaluations++;
+  node->total_evaluations++;
+  uint64_t outputTime = time + Max(GetNodeDelay(node), 1);
+
+  if(IsLogicGateType(node->type)){
+    NodeState state = EvaluateGate(GetGateInfo(node->type)->truth, node->input_state, node->input_count);
+    ScheduleTimingOutput(node, 0, state, state == NodeState_HIGH, outputTime, editor);
+    return;
+  }
+
+  switch(node->type){
+    case NodeType_INPUT:
+    case NodeType_CLOCK: break;
+
+    case NodeType_OUTPUT:{
+      node->signal_state = (node->input_state[0] == NodeState_NONE) ? NodeState_LOW : node->input_state[0];
+    }break;
+
+    case NodeType_DFF:
+    case NodeType_REGISTER:{
+      size_t clockIndex = node->input_count - 1;
+      NodeState clock = node->input_state[clockIndex];
+      if(node->clock_state == NodeState_LOW && clock == NodeState_HIGH){
+        it(i, node->output_count){
+          NodeState data = node->input_state[i];
+          if(data != NodeState_NONE) ScheduleTimingOutput(node, i, data, node->input_value[i], outputTime, editor);
+        }
+      }
+      node->clock_state = clock;
+    }break;
+
+    case NodeType_RAM:
+    case NodeType_ROM:{
+      if(node->type == NodeType_RAM) LatchSequentialNode(node);
+      if(node->input_state[0] == NodeState_NONE){
+        ScheduleTimingOutput(node, 0, NodeState_NONE, 0, outputTime, editor);
+      } else {
+        uint64_t value = ReadMemoryWord(node->memory, node->input_value[0]);
+        ScheduleTimingOutput(node, 0, value ? NodeState_HIGH : NodeState_LOW, value, outputTime, editor);
+      }
+    }break;
+
+    default:{
+      bool hasNone = false;
+      it(i, node->input_count) hasNone |= node->input_state[i] == NodeState_NONE;
+      if(hasNone){
+        it(i, node->output_count) ScheduleTimingOutput(node, i, NodeState_NONE, 0, outputTime, editor);
+      } else if(IsWordNodeType(node->type)){
+        it(i, node->output_count){
+          uint32_t parameter = 0;
+          WordOp op = GetWordOutputOp(node->type, i, node->parameter, &parameter);
+          uint64_t value = EvaluateWordOp(op, parameter, node->input_value, node->input_count);
+          ScheduleTimingOutput(node, i, value ? NodeState_HIGH : NodeState_LOW, value, outputTime, editor);
+        }
+      } else {
+        assert(node->type > NodeType_COUNT);
+        ICDefinition *icdef = editor->icdefs[node->type - (NodeType_COUNT + 1)];
+        NodeState outputs[node->output_count];
+        editor->stats.ic_evaluations++;
+        if(editor->useCompiledICs && icdef->program != nullptr){
+          SimulateCompiledIC(icdef, node->input_state, outputs);
+        } else {
+          it(n, icdef->node_count){
+            ICNode *icnode = &icdef->nodes[n];
+            it(k, icnode->input_count) icnode->input_state[k] = NodeState_NONE;
+          }
+          SimulateIC(icdef, node->input_state, outputs, Max(editor->loopIterationLimit, 1));
+        }
+        it(i, node->output_count) ScheduleTimingOutput(node, i, outputs[i], outputs[i] == NodeState_HIGH, outputTime, editor);
+      }
+    }break;
+  }
+}
+
+//NOTE(Torin) Every net starts out NONE, register contents are kept and replayed as events
+static void BuildTimingSimulation(Editor *editor){
+  PROFILE_SCOPE("BuildTimingSimulation");
+  TimingSimulation *timing = &editor->timing;
+  timing->topology_version = editor->topologyVersion;
+  timing->is_valid = true;
+  ResetTimingWheel(&timing->wheel, timing->time);
+
+  timing->output_base.count = 0;
+  timing->dirty.count = 0;
+  uint32_t outputCount = 0;
+  it(i, editor->nodes.count){
+    EditorNode *node = editor->nodes[i];
+    node->timing_index = i;
+    ArrayAdd(outputCount, timing->output_base);
+    outputCount += node->output_count;
+  }
+  ArrayReserve(editor->nodes.count, timing->is_dirty);
+  timing->is_dirty.count = editor->nodes.count;
+  memset(timing->is_dirty.data, 0, editor->nodes.count);
+  ArrayReserve(outputCount, timing->pending_event);
+  ArrayReserve(outputCount, timing->projected_state);
+  ArrayReserve(outputCount, timing->projected_value);
+  timing->pending_event.count = timing->projected_state.count = timing->projected_value.count = outputCount;
+  it(i, outputCount){
+    timing->pending_event[i] = TIMING_EVENT_NONE;
+    timing->projected_state[i] = NodeState_NONE;
+    timing->projected_value[i] = 0;
+  }
+
+  it(i, editor->nodes.count){
+    EditorNode *node = editor->nodes[i];
+    memset(node->input_state, NodeState_NONE, node->input_count * sizeof(NodeState));
+    memset(node->input_value, 0, node->input_count * sizeof(uint64_t));
+    bool isRegister = node->type == NodeType_DFF || node->type == NodeType_REGISTER;
+    it(n, node->output_count){
+      NodeState state = node->output_state[n];
+      uint64_t value = GetOutputWord(node, n);
+      node->output_state[n] = NodeState_NONE;
+      node->output_value[n] = 0;
+      if(isRegister && state != NodeState_NONE)
+        ScheduleTimingOutput(node, n, state, value, timing->time, editor);
+    }
+    MarkTimingNodeDirty(node, timing);
+  }
+}
+
+//NOTE(Torin) Runs one step of Editor::timingTickLength time units, the inputs and
+//clocks of the step change at its start
+void SimulateTiming(Editor *editor){
+  PROFILE_SCOPE("SimulateTiming");
+  uint64_t beginTicks = ProfilerTimestamp();
+  TimingSimulation *timing = &editor->timing;
+  if(!timing->is_valid || timing->topology_version != editor->topologyVersion)
+    BuildTimingSimulation(editor);
+
+  uint64_t stepBegin = timing->time;
+  uint64_t stepEnd = stepBegin + Max(editor->timingTickLength, 1);
+  it(i, editor->nodes.count){
+    EditorNode *node = editor->nodes[i];
+    if(node->type == NodeType_INPUT){
+      uint64_t value = GetPortWidth(node, false, 0) > 1 ? node->bus_value : (node->signal_state == NodeState_HIGH);
+      ScheduleTimingOutput(node, 0, node->signal_state, value, stepBegin, editor);
+    } else if(node->type == NodeType_CLOCK){
+      NodeState state = GetClockState(node->parameter, editor->clockTick);
+      ScheduleTimingOutput(node, 0, state, state == NodeState_HIGH, stepBegin, editor);
+    }
+  }
+
+  //NOTE(Torin) Nodes marked by a rebuild are evaluated before the first events
+  TimingWheel *wheel = &timing->wheel;
+  uint64_t processed = 0;
+  uint64_t evaluationTime = stepBegin;
+  for(;;){
+    it(i, timing->dirty.count){
+      EditorNode *node = timing->dirty[i];
+      timing->is_dirty[node->timing_index] = 0;
+      EvaluateTimedNode(node, evaluationTime, editor);
+    }
+    timing->dirty.count = 0;
+
+    uint32_t list;
+    if(!NextTimingSlot(wheel, stepEnd - 1, &list)) break;
+    evaluationTime = wheel->now;
+    uint32_t index = wheel->heads[list];
+    wheel->heads[list] = TIMING_EVENT_NONE;
+    wheel->occupied[0] &= ~(1ULL << list);
+    while(index != TIMING_EVENT_NONE){
+      uint32_t next = wheel->events.data[index].next;
+      ApplyTimingEvent(index, editor);
+      FreeTimingEvent(wheel, index);
+      processed++;
+      index = next;
+    }
+  }
+
+  timing->time = stepEnd;
+  timing->events_processed += processed;
+  timing->last_step_events = processed;
+  timing->last_step_milliseconds = ProfilerTicksToMilliseconds(ProfilerTimestamp() - beginTicks);
+}
+
+void DestroyTimingSimulation(TimingSimulation *timing){
+  ArrayDestroy(timing->wheel.events);
+  ArrayDestroy(timing->output_base);
+  ArrayDestroy(timing->is_dirty);
+  ArrayDestroy(timing->dirty);
+  ArrayDestroy(timing->pending_event);
+  ArrayDestroy(timing->projected_state);
+  ArrayDestroy(timing->projected_value);
+  timing->is_valid = false;
+}
@@ -0,0 +1,353 @@
+//NOTE(Torin) Static timing analysis
+//Arrival times are propagated once through the node graph in topological order (Kahn's
+//algorithm over the same edges the event schedule uses) so the analysis is linear in
+//nodes + connections. Sources are INPUT and CLOCK nodes at time 0 and DFF / REGISTER
+//outputs at their clock to output delay, every other node adds its GetNodeDelay() to
+//the latest of its inputs and remembers which input that was so a critical path is
+//traced back from its endpoint. Endpoints are OUTPUT nodes and the sampled inputs of
+//DFF, REGISTER and RAM nodes. ICs use a per definition input to output delay matrix.
+//Nodes inside a combinational loop and everything they drive have no arrival time
+
+#define TIMING_PATH_START UINT32_MAX  //EditorNode::path_input of the node a path starts at
+
+static inline
+uint32_t GetICNodeDelay(uint32_t type){
+  if(IsLogicGateType(type)) return GetGateInfo(type)->delay;
+  return 0;
+}
+
+//NOTE(Torin) Longest delay and gate depth from every input of the IC to every output,
+//TIMING_ARRIVAL_NONE where an output does not depend on an input. Returns false when the
+//definition contains a loop
+static bool AnalyzeICDefinition(const ICDefinition *icdef, uint32_t *delay, uint32_t *depth){
+  uint32_t node_count = icdef->node_count;
+  uint32_t *connectionBase = (uint32_t *)malloc(sizeof(uint32_t) * (node_count + 1));
+  uint32_t *pending = (uint32_t *)calloc(node_count + 1, sizeof(uint32_t));
+  uint32_t *order = (uint32_t *)malloc(sizeof(uint32_t) * (node_count + 1));
+  uint32_t *arrival = (uint32_t *)malloc(sizeof(uint32_t) * (node_count + 1));
+  uint32_t *levels = (uint32_t *)malloc(sizeof(uint32_t) * (node_count + 1));
+
+  uint32_t connectionCount = 0;
+  it(i, node_count){
+    const ICNode *node = &icdef->nodes[i];
+    connectionBase[i] = connectionCount;
+    it(o, node->output_count) connectionCount += node->connection_count_per_output[o];
+  }
+  connectionBase[node_count] = connectionCount;
+  it(i, node_count){
+    const ICNode *node = &icdef->nodes[i];
+    uint32_t count = connectionBase[i + 1] - connectionBase[i];
+    it(c, count) pending[node->output_connections[c].node_index]++;
+  }
+
+  uint32_t orderCount = 0;
+  it(i, node_count) if(pending[i] == 0) order[orderCount++] = i;
+  for(uint32_t head = 0; head < orderCount; head++){
+    const ICNode *node = &icdef->nodes[order[head]];
+    uint32_t count = connectionBase[order[head] + 1] - connectionBase[order[head]];
+    it(c, count){
+      uint32_t dest = node->output_connections[c].node_index;
+      if(--pending[dest] == 0) order[orderCount++] = dest;
+    }
+  }
+
+  bool result = orderCount == node_count;
+  if(result){
+    //NOTE(Torin) One pass per input, ICs are small and the matrix is computed per
+    //definition rather than per instance
+    const ICNode *outputs = icdef->nodes + icdef->input_count;
+    it(input, icdef->input_count){
+      it(i, node_count) arrival[i] = TIMING_ARRIVAL_NONE;
+      arrival[input] = 0;
+      levels[input] = 0;
+      it(n, node_count){
+        uint32_t index = order[n];
+        if(arrival[index] == TIMING_ARRIVAL_NONE) continue;
+        const ICNode *node = &icdef->nodes[index];
+        uint32_t nodeDelay = GetICNodeDelay(node->type);
+        uint32_t outArrival = arrival[index] + nodeDelay;
+        uint32_t outLevel = levels[index] + (nodeDelay != 0);
+        uint32_t count = connectionBase[index + 1] - connectionBase[index];
+        it(c, count){
+          uint32_t dest = node->output_connections[c].node_index;
+          if(arrival[dest] == TIMING_ARRIVAL_NONE || outArrival > arrival[dest]){
+            arrival[dest] = outArrival;
+            levels[dest] = outLevel;
+          }
+        }
+      }
+      it(o, icdef->output_count){
+        uint32_t index = (uint32_t)(&outputs[o] - icdef->nodes);
+        delay[input * icdef->output_count + o] = arrival[index];
+        depth[input * icdef->output_count + o] = levels[index];
+      }
+    }
+  }
+
+  free(connectionBase);
+  free(pending);
+  free(order);
+  free(arrival);
+  free(levels);
+  return result;
+}
+
+static inline
+bool IsTimingEndpoint(const EditorNode *node, uint32_t input_index){
+  switch(node->type){
+    case NodeType_OUTPUT: return true;
+    case NodeType_DFF:
+    case NodeType_REGISTER: return input_index + 1 < node->input_count;
+    case NodeType_RAM: return input_index < 3;
+  }
+  return false;
+}
+
+//NOTE(Torin) Arrival and depth at an input, false when it is undriven or untimed
+static inline
+bool GetInputArrival(const TimingAnalysis *analysis, const EditorNode *node, uint32_t input_index,
+  uint32_t *arrival, uint32_t *depth){
+  const NodeConnection *connection = &node->inputConnections[input_index];
+  const EditorNode *driver = connection->node_index.node_ptr;
+  if(driver == nullptr) return false;
+  uint32_t slot = analysis->output_base.data[driver->analysis_index] + connection->io_index;
+  if(analysis->arrival.data[slot] == TIMING_ARRIVAL_NONE) return false;
+  *arrival = analysis->arrival.data[slot];
+  *depth = analysis->depth.data[slot];
+  return true;
+}
+
+//NOTE(Torin) Computes the outputs of a node whose drivers all have been visited, returns
+//false if the node is untimed
+static bool PropagateNodeArrival(TimingAnalysis *analysis, EditorNode *node, Editor *editor){
+  uint32_t base = analysis->output_base[node->analysis_index];
+  uint32_t nodeDelay = GetNodeDelay(node);
+
+  switch(node->type){
+    case NodeType_OUTPUT: return true;
+    case NodeType_INPUT:
+    case NodeType_CLOCK:{
+      it(o, node->output_count){
+        analysis->arrival[base + o] = 0;
+        analysis->depth[base + o] = 0;
+        analysis->critical_input[base + o] = TIMING_ARRIVAL_NONE;
+      }
+      return true;
+    }
+    case NodeType_DFF:
+    case NodeType_REGISTER:{
+      it(o, node->output_count){
+        analysis->arrival[base + o] = nodeDelay;
+        analysis->depth[base + o] = 0;
+        analysis->critical_input[base + o] = TIMING_ARRIVAL_NONE;
+      }
+      return true;
+    }
+  }
+
+  if(node->type > NodeType_COUNT){
+    uint32_t ic_index = node->type - (NodeType_COUNT + 1);
+    uint32_t offset = analysis->ic_offset[ic_index];
+    if(offset == TIMING_ARRIVAL_NONE) return false;
+    ICDefinition *icdef = editor->icdefs[ic_index];
+    it(o, node->output_count){
+      uint32_t worst = TIMING_ARRIVAL_NONE, worstDepth = 0, critical = TIMING_ARRIVAL_NONE;
+      it(i, node->input_count){
+        uint32_t entry = offset + i * icdef->output_count + o;
+        if(analysis->ic_delay[entry] == TIMING_ARRIVAL_NONE) continue;
+        uint32_t arrival = 0, depth = 0;
+        if(node->inputConnections[i].node_index.node_ptr != nullptr &&
+          !GetInputArrival(analysis, node, i, &arrival, &depth)) return false;
+        arrival += analysis->ic_delay[entry];
+        if(worst == TIMING_ARRIVAL_NONE || arrival > worst){
+          worst = arrival;
+          worstDepth = depth + analysis->ic_depth[entry];
+          critical = node->inputConnections[i].node_index.node_ptr != nullptr ? i : TIMING_ARRIVAL_NONE;
+        }
+      }
+      analysis->arrival[base + o] = worst == TIMING_ARRIVAL_NONE ? 0 : worst;
+      analysis->depth[base + o] = worstDepth;
+      analysis->critical_input[base + o] = critical;
+    }
+    return true;
+  }
+
+  //NOTE(Torin) Gates, word nodes and memories, a RAM / ROM read only depends on the address
+  uint32_t inputCount = IsMemoryNodeType(node->type) ? 1 : node->input_count;
+  uint32_t worst = 0, worstDepth = 0, critical = TIMING_ARRIVAL_NONE;
+  it(i, inputCount){
+    if(node->inputConnections[i].node_index.node_ptr == nullptr) continue;
+    uint32_t arrival = 0, depth = 0;
+    if(!GetInputArrival(analysis, node, i, &arrival, &depth)) return false;
+    if(critical == TIMING_ARRIVAL_NONE || arrival > worst){
+      worst = arrival;
+      worstDepth = depth;
+      critical = i;
+    }
+  }
+  it(o, node->output_count){
+    analysis->arrival[base + o] = worst + nodeDelay;
+    analysis->depth[base + o] = worstDepth + 1;
+    analysis->critical_input[base + o] = critical;
+  }
+  return true;
+}
+
+static void TraceTimingPath(TimingAnalysis *analysis, TimingPath *path, EditorNode *endpoint, uint32_t input_index){
+  path->first = analysis->path_nodes.count;
+  TimingPathNode entry = { endpoint, input_index, TIMING_ARRIVAL_NONE, path->arrival };
+  ArrayAdd(entry, analysis->path_nodes);
+  EditorNode *node = endpoint;
+  uint32_t input = input_index;
+  while(input != TIMING_ARRIVAL_NONE){
+    const NodeConnection *connection = &node->inputConnections[input];
+    node = connection->node_index.node_ptr;
+    uint32_t slot = analysis->output_base[node->analysis_index] + connection->io_index;
+    input = analysis->critical_input[slot];
+    entry = { node, input, connection->io_index, analysis->arrival[slot] };
+    ArrayAdd(entry, analysis->path_nodes);
+  }
+  path->count = analysis->path_nodes.count - path->first;
+
+  //NOTE(Torin) Traced from the endpoint, stored from the start point
+  TimingPathNode *nodes = &analysis->path_nodes[path->first];
+  it(i, path->count / 2){
+    TimingPathNode temp = nodes[i];
+    nodes[i] = nodes[path->count - 1 - i];
+    nodes[path->count - 1 - i] = temp;
+  }
+}
+
+void AnalyzeTiming(Editor *editor, uint32_t path_count){
+  PROFILE_SCOPE("AnalyzeTiming");
+  TimingAnalysis *analysis = &editor->timingAnalysis;
+  uint32_t node_count = editor->nodes.count;
+  analysis->topology_version = editor->topologyVersion;
+  analysis->delay_version = editor->delayVersion;
+  analysis->paths.count = 0;
+  analysis->path_nodes.count = 0;
+  analysis->endpoint_count = 0;
+  analysis->untimed_count = 0;
+
+  ArrayReserve(editor->icdefs.count, analysis->ic_offset);
+  analysis->ic_offset.count = editor->icdefs.count;
+  analysis->ic_delay.count = 0;
+  analysis->ic_depth.count = 0;
+  it(i, editor->icdefs.count){
+    ICDefinition *icdef = editor->icdefs[i];
+    uint32_t offset = analysis->ic_delay.count;
+    uint32_t entryCount = icdef->input_count * icdef->output_count;
+    ArrayReserve(offset + entryCount, analysis->ic_delay);
+    ArrayReserve(offset + entryCount, analysis->ic_depth);
+    bool isTimed = AnalyzeICDefinition(icdef, analysis->ic_delay.data + offset, analysis->ic_depth.data + offset);
+    analysis->ic_offset[i] = isTimed ? offset : TIMING_ARRIVAL_NONE;
+    if(isTimed){
+      analysis->ic_delay.count += entryCount;
+      analysis->ic_depth.count += entryCount;
+    }
+  }
+
+  ArrayReserve(node_count, analysis->output_base);
+  analysis->output_base.count = node_count;
+  uint32_t outputCount = 0;
+  it(i, node_count){
+    EditorNode *node = editor->nodes[i];
+    node->analysis_index = i;
+    node->path_input = 0;
+    analysis->output_base[i] = outputCount;
+    outputCount += node->output_count;
+  }
+  ArrayReserve(outputCount, analysis->arrival);
+  ArrayReserve(outputCount, analysis->depth);
+  ArrayReserve(outputCount, analysis->critical_input);
+  analysis->arrival.count = analysis->depth.count = analysis->critical_input.count = outputCount;
+  it(i, outputCount) analysis->arrival[i] = TIMING_ARRIVAL_NONE;
+
+  //NOTE(Torin) Kahn's algorithm, pending counts the scheduled inputs not yet visited
+  uint32_t *pending = (uint32_t *)calloc(node_count + 1, sizeof(uint32_t));
+  uint32_t *queue = (uint32_t *)malloc(sizeof(uint32_t) * (node_count + 1));
+  it(i, node_count){
+    EditorNode *node = editor->nodes[i];
+    it(n, node->input_count){
+      if(node->inputConnections[n].node_index.node_ptr != nullptr && IsScheduleEdge(node, n)) pending[i]++;
+    }
+  }
+  uint32_t queueCount = 0;
+  it(i, node_count) if(pending[i] == 0) queue[queueCount++] = i;
+  for(uint32_t head = 0; head < queueCount; head++){
+    EditorNode *node = editor->nodes[queue[head]];
+    if(!PropagateNodeArrival(analysis, node, editor)){
+      uint32_t base = analysis->output_base[node->analysis_index];
+      it(o, node->output_count) analysis->arrival[base + o] = TIMING_ARRIVAL_NONE;
+      analysis->untimed_count++;
+    }
+    it(o, node->output_count){
+      DynamicArray<NodeConnection> &connections = node->output_connections[o];
+      it(c, connections.count){
+        EditorNode *dest = connections[c].node_index.node_ptr;
+        if(!IsScheduleEdge(dest, connections[c].io_index)) continue;
+        if(--pending[dest->analysis_index] == 0) queue[queueCount++] = dest->analysis_index;
+      }
+    }
+  }
+  analysis->untimed_count += node_count - queueCount;
+  free(pending);
+  free(queue);
+
+  //NOTE(Torin) The path_count latest endpoints are kept sorted by insertion
+  ArrayReserve(path_count, analysis->paths);
+  DynamicArray<TimingPathNode> endpoints = {};
+  ArrayReserve(path_count, endpoints);
+  it(i, node_count){
+    EditorNode *node = editor->nodes[i];
+    it(n, node->input_count){
+      if(!IsTimingEndpoint(node, n)) continue;
+      uint32_t arrival = 0, depth = 0;
+      if(!GetInputArrival(analysis, node, n, &arrival, &depth)) continue;
+      analysis->endpoint_count++;
+      if(path_count == 0) continue;
+      if(analysis->paths.count == path_count && arrival <= analysis->paths[path_count - 1].arrival) continue;
+      size_t position = analysis->paths.count < path_count ? analysis->paths.count : path_count - 1;
+      if(analysis->paths.count < path_count){
+        analysis->paths.count++;
+        endpoints.count++;
+      }
+      while(position > 0 && analysis->paths[position - 1].arrival < arrival){
+        analysis->paths[position] = analysis->paths[position - 1];
+        endpoints[position] = endpoints[position - 1];
+        position--;
+      }
+      analysis->paths[position] = { arrival, depth, 0, 0 };
+      endpoints[position] = { node, (uint32_t)n, TIMING_ARRIVAL_NONE, arrival };
+    }
+  }
+  it(i, analysis->paths.count) TraceTimingPath(analysis, &analysis->paths[i], endpoints[i].node, endpoints[i].input_index);
+  ArrayDestroy(endpoints);
+
+  analysis->is_valid = true;
+}
+
+//NOTE(Torin) Marks the nodes of path_index for DrawEditor, -1 clears the highlight
+void SelectTimingPath(Editor *editor, int path_index){
+  TimingAnalysis *analysis = &editor->timingAnalysis;
+  it(i, editor->nodes.count) editor->nodes[i]->path_input = 0;
+  editor->selectedTimingPath = -1;
+  if(!analysis->is_valid || path_index < 0 || path_index >= (int)analysis->paths.count) return;
+  editor->selectedTimingPath = path_index;
+  const TimingPath *path = &analysis->paths[path_index];
+  it(i, path->count){
+    const TimingPathNode *entry = &analysis->path_nodes[path->first + i];
+    entry->node->path_input = entry->input_index == TIMING_ARRIVAL_NONE ? TIMING_PATH_START : entry->input_index + 1;
+  }
+}
+
+//NOTE(Torin) Paths hold node pointers, a valid analysis is redone when the graph or a
+//delay changes
+static inline
+void UpdateTimingAnalysis(Editor *editor){
+  TimingAnalysis *analysis = &editor->timingAnalysis;
+  if(!analysis->is_valid) return;
+  if(analysis->topology_version == editor->topologyVersion && analysis->delay_version == editor->delayVersion) return;
+  AnalyzeTiming(editor, (uint32_t)Max(editor->timingPathCount, 0));
+  SelectTimingPath(editor, editor->selectedTimingPath);
+}
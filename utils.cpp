@@ -54,6 +54,14 @@ void ArrayAdd(const T& t, DynamicArray<T>& array){
   array.count += 1;
 }
 
+template<typename T>
+void ArrayReserve(size_t capacity, DynamicArray<T>& array){
+  if(array.capacity >= capacity) return;
+  array.capacity = capacity;
+  if(array.data != 0) array.data = (T*)realloc(array.data, sizeof(T) * array.capacity);
+  else array.data = (T *)malloc(sizeof(T) * array.capacity);
+}
+
 template<typename T>
 void ArrayRemoveAtIndexUnordered(const size_t index, DynamicArray<T>& array){
   assert(index < array.count);
@@ -110,4 +118,11 @@ int Max(int a, int b){
 int Min(int a, int b){
   int result = a < b ? a : b;
   return result;
+}
+
+//NOTE(Torin) Mask of the low width bits, width may be 64
+static inline
+uint64_t WordMask(uint32_t width){
+  uint64_t result = (width >= 64) ? ~0ULL : ((1ULL << width) - 1);
+  return result;
 }
\ No newline at end of file
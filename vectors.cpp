@@ -0,0 +1,494 @@
+//NOTE(Torin) Test vector runner
+//Applies a set of input vectors to the INPUT nodes of the design and checks the OUTPUT
+//nodes against expected values from a stimulus file or a reference model. Vectors are
+//either every combination of the inputs, pseudo random or read from a file.
+//The runner evaluates its own copy of the netlist (built without folding inputs since they
+//change every vector). When the levelized netlist only contains single bit gates, 64
+//vectors are evaluated at once with one bit lane per vector, every net holds a value mask
+//and a known mask so NONE is propagated exactly like EvaluateNetlistGate. Word and memory
+//gates fall back to EvaluateNetlist one vector at a time. Register and clock outputs
+//keep their current value for every vector.
+//Input vector bit i is Editor::inputs[i], output bit o is the o-th OUTPUT node in
+//Editor::nodes order.
+//Stimulus files have one vector per line, the input bits with input 0 first and
+//optionally the expected output bits in the same order, x is a don't care, # a comment:
+//  0110 1x
+
+#define VECTOR_MAX_PORTS 64
+#define VECTOR_MAX_EXHAUSTIVE_INPUTS 32
+#define VECTOR_MAX_MISMATCHES 16
+#define VECTOR_LANES 64
+
+enum VectorSource {
+  VectorSource_EXHAUSTIVE,
+  VectorSource_RANDOM,
+  VectorSource_FILE,
+};
+
+enum VectorCheck {
+  VectorCheck_NONE,
+  VectorCheck_FILE,       //expected outputs of the stimulus file
+  VectorCheck_REFERENCE,  //VectorRunner::reference
+};
+
+//NOTE(Torin) Expected output bits of a vector, only bits set in care are checked
+typedef void VectorReference(uint64_t inputs, uint64_t *expected, uint64_t *care, void *user);
+
+struct VectorMismatch {
+  uint64_t vector;
+  uint64_t inputs;
+  uint64_t expected;
+  uint64_t care;
+  uint64_t actual;
+  uint64_t unknown;  //outputs that were NONE
+};
+
+struct VectorFile {
+  uint32_t input_count;
+  uint32_t output_count;  //0 when the file has no expected outputs
+  DynamicArray<uint64_t> inputs;
+  DynamicArray<uint64_t> expected;
+  DynamicArray<uint64_t> care;
+};
+
+struct VectorRunner {
+  Netlist netlist;
+  uint64_t *lane_values;
+  uint64_t *lane_known;
+  size_t lane_capacity;
+  DynamicArray<uint32_t> output_nets;
+
+  VectorFile file;
+  VectorReference *reference;
+  void *reference_user;
+
+  //NOTE(Torin) Settings of the Simulation window
+  int source;
+  int check;
+  int random_count;
+  uint64_t seed;
+  char path[256];
+
+  uint32_t input_count;
+  uint32_t output_count;
+  uint64_t vector_count;
+  uint64_t mismatch_count;
+  DynamicArray<VectorMismatch> mismatches;  //first VECTOR_MAX_MISMATCHES
+  bool is_bit_parallel;
+  double milliseconds;
+  const char *error;
+};
+
+//NOTE(Torin) Lane patterns of the low 6 input bits when lane l is vector base + l
+static const uint64_t EXHAUSTIVE_LANE_PATTERN[6] = {
+  0xAAAAAAAAAAAAAAAAULL,
+  0xCCCCCCCCCCCCCCCCULL,
+  0xF0F0F0F0F0F0F0F0ULL,
+  0xFF00FF00FF00FF00ULL,
+  0xFFFF0000FFFF0000ULL,
+  0xFFFFFFFF00000000ULL,
+};
+
+static inline
+uint64_t NextVectorRandom(uint64_t *state){
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+//NOTE(Torin) Returns false if a line is malformed or the vectors disagree on their size
+bool LoadVectorFile(VectorFile *file, const char *filename){
+  file->inputs.count = 0;
+  file->expected.count = 0;
+  file->care.count = 0;
+  file->input_count = 0;
+  file->output_count = 0;
+  FILE *stream = fopen(filename, "r");
+  if(stream == nullptr) return false;
+
+  bool result = true;
+  bool isFirst = true;
+  char line[512];
+  while(result && fgets(line, sizeof(line), stream)){
+    const char *c = line;
+    while(*c == ' ' || *c == '\t') c++;
+    if(*c == '#' || *c == '\n' || *c == '\r' || *c == 0) continue;
+
+    uint64_t fields[3] = {};
+    uint32_t counts[2] = {};
+    for(uint32_t field = 0; field < 2; field++){
+      while(*c == ' ' || *c == '\t') c++;
+      for(; *c == '0' || *c == '1' || *c == 'x' || *c == 'X'; c++){
+        if(counts[field] == VECTOR_MAX_PORTS || (field == 0 && (*c == 'x' || *c == 'X'))){
+          result = false;
+          break;
+        }
+        uint64_t bit = 1ULL << counts[field]++;
+        if(*c == '1') fields[field] |= bit;
+        if(field == 1 && *c != 'x' && *c != 'X') fields[2] |= bit;
+      }
+    }
+    while(*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n') c++;
+    if(*c != 0 && *c != '#') result = false;
+    if(isFirst){
+      file->input_count = counts[0];
+      file->output_count = counts[1];
+      isFirst = false;
+    }
+    if(counts[0] != file->input_count || counts[1] != file->output_count) result = false;
+
+    ArrayAdd(fields[0], file->inputs);
+    ArrayAdd(fields[1], file->expected);
+    ArrayAdd(fields[2], file->care);
+  }
+  fclose(stream);
+  return result && !isFirst;
+}
+
+//NOTE(Torin) Only single bit gates have a lane evaluation
+static bool IsNetlistBitParallel(const Netlist *netlist){
+  it(i, netlist->order.count){
+    NetType type = netlist->gates.data[netlist->order.data[i]].type;
+    if(type == NetType_WORD || type == NetType_MEMORY) return false;
+  }
+  return true;
+}
+
+static inline
+void EvaluateLaneGate(const NetlistGate *gate, const uint32_t *fanins, const uint64_t *values, const uint64_t *known,
+  uint64_t *result_value, uint64_t *result_known){
+  uint64_t isKnown = ~0ULL;
+  it(n, gate->fanin_count) isKnown &= known[fanins[n]];
+
+  uint64_t value = values[fanins[0]];
+  switch(gate->type){
+    case NetType_BUF:
+    case NetType_PORT: break;
+    case NetType_AND:
+    case NetType_NAND: for(uint32_t n = 1; n < gate->fanin_count; n++) value &= values[fanins[n]]; break;
+    case NetType_OR:
+    case NetType_NOR:  for(uint32_t n = 1; n < gate->fanin_count; n++) value |= values[fanins[n]]; break;
+    case NetType_XOR:
+    case NetType_XNOR: for(uint32_t n = 1; n < gate->fanin_count; n++) value ^= values[fanins[n]]; break;
+    case NetType_NOT: break;
+    default: assert(false);
+  }
+  if(gate->type == NetType_NOT || gate->type == NetType_NAND || gate->type == NetType_NOR || gate->type == NetType_XNOR)
+    value = ~value;
+  *result_value = value;
+  *result_known = isKnown;
+}
+
+static void EvaluateNetlistLanes(const Netlist *netlist, uint64_t *values, uint64_t *known){
+  const uint32_t *fanins = netlist->fanins.data;
+  it(i, netlist->order.count){
+    uint32_t g = netlist->order.data[i];
+    const NetlistGate *gate = &netlist->gates.data[g];
+    EvaluateLaneGate(gate, fanins + gate->fanin_offset, values, known, &values[g], &known[g]);
+  }
+}
+
+static inline
+void SetLaneState(uint64_t *values, uint64_t *known, uint32_t net, NodeState state){
+  values[net] = state == NodeState_HIGH ? ~0ULL : 0;
+  known[net] = state == NodeState_NONE ? 0 : ~0ULL;
+}
+
+static bool PrepareVectorRunner(VectorRunner *runner, Editor *editor){
+  //NOTE(Torin) A vector holds one bit per INPUT and OUTPUT node
+  it(i, editor->nodes.count){
+    const EditorNode *node = editor->nodes[i];
+    bool isPort = node->type == NodeType_INPUT || node->type == NodeType_OUTPUT;
+    if(isPort && GetPortWidth(node, node->type == NodeType_OUTPUT, 0) > 1){
+      runner->error = "bus inputs and outputs are not supported";
+      return false;
+    }
+  }
+  Netlist *netlist = &runner->netlist;
+  BuildNetlist(netlist, editor);
+  if(!LevelizeNetlist(netlist)){
+    runner->error = "the design contains a combinational loop";
+    return false;
+  }
+  if(editor->optimizeNetlist){
+    NetlistOptimizerSettings settings = {};
+    OptimizeNetlist(netlist, &settings);
+  }
+
+  runner->output_nets.count = 0;
+  it(i, netlist->taps.count){
+    const NetlistTap *tap = &netlist->taps.data[i];
+    if(tap->output_index == NETLIST_TAP_OUTPUT_NODE) ArrayAdd(tap->net, runner->output_nets);
+  }
+  runner->input_count = netlist->inputs.count;
+  runner->output_count = runner->output_nets.count;
+
+  uint32_t gate_count = netlist->gates.count;
+  if(runner->lane_capacity < gate_count){
+    free(runner->lane_values);
+    free(runner->lane_known);
+    runner->lane_values = (uint64_t *)malloc(sizeof(uint64_t) * gate_count);
+    runner->lane_known = (uint64_t *)malloc(sizeof(uint64_t) * gate_count);
+    runner->lane_capacity = gate_count;
+  }
+  runner->is_bit_parallel = IsNetlistBitParallel(netlist);
+  return true;
+}
+
+static inline
+uint64_t GetVectorInputs(VectorRunner *runner, uint64_t vector, uint64_t *random_state){
+  switch(runner->source){
+    case VectorSource_EXHAUSTIVE: return vector;
+    case VectorSource_RANDOM: return NextVectorRandom(random_state) & WordMask(runner->input_count);
+    case VectorSource_FILE: return runner->file.inputs.data[vector];
+  }
+  assert(false);
+  return 0;
+}
+
+//NOTE(Torin) Checks the outputs of up to VECTOR_LANES vectors, lane l of the masks is
+//vector first + l
+static void CheckVectorLanes(VectorRunner *runner, uint64_t first, uint32_t lane_count,
+  const uint64_t *inputs, const uint64_t *actual, const uint64_t *unknown){
+  it(l, lane_count){
+    uint64_t expected = 0, care = 0;
+    if(runner->check == VectorCheck_FILE){
+      expected = runner->file.expected.data[first + l];
+      care = runner->file.care.data[first + l];
+    } else if(runner->check == VectorCheck_REFERENCE){
+      runner->reference(inputs[l], &expected, &care, runner->reference_user);
+    }
+    if((((actual[l] ^ expected) | unknown[l]) & care) == 0) continue;
+    runner->mismatch_count++;
+    if(runner->mismatches.count < VECTOR_MAX_MISMATCHES){
+      VectorMismatch mismatch = { first + l, inputs[l], expected, care, actual[l], unknown[l] };
+      ArrayAdd(mismatch, runner->mismatches);
+    }
+  }
+}
+
+//NOTE(Torin) Constants, clocks and registers are the same in every lane and every block
+static void SetVectorLaneSources(const VectorRunner *runner, const Editor *editor, uint64_t *values, uint64_t *known){
+  const Netlist *netlist = &runner->netlist;
+  SetLaneState(values, known, NET_UNDRIVEN, NodeState_NONE);
+  SetLaneState(values, known, NET_CONST0, NodeState_LOW);
+  SetLaneState(values, known, NET_CONST1, NodeState_HIGH);
+  it(i, netlist->clocks.count){
+    const NetlistClock *clock = &netlist->clocks.data[i];
+    SetLaneState(values, known, clock->net, GetClockState(clock->half_period, editor->clockTick));
+  }
+  it(i, netlist->registers.count){
+    const NetlistRegister *reg = &netlist->registers.data[i];
+    if(reg->net == NET_INVALID) continue;
+    SetLaneState(values, known, reg->net, reg->node->output_state[reg->bit]);
+  }
+}
+
+//NOTE(Torin) Input lanes of the block starting at vector first, random vectors have to be
+//generated block after block from the seed
+static void SetVectorLaneInputs(const VectorRunner *runner, uint64_t first, uint32_t lane_count,
+  uint64_t *values, uint64_t *known, uint64_t *random_state){
+  const Netlist *netlist = &runner->netlist;
+  it(i, runner->input_count){
+    uint32_t net = netlist->inputs.data[i];
+    known[net] = ~0ULL;
+    if(runner->source == VectorSource_EXHAUSTIVE){
+      values[net] = i < 6 ? EXHAUSTIVE_LANE_PATTERN[i] : (((first >> i) & 1) ? ~0ULL : 0);
+    } else if(runner->source == VectorSource_RANDOM){
+      values[net] = NextVectorRandom(random_state);
+    }
+  }
+  if(runner->source == VectorSource_FILE){
+    it(i, runner->input_count) values[netlist->inputs.data[i]] = 0;
+    it(l, lane_count){
+      uint64_t word = runner->file.inputs.data[first + l];
+      it(i, runner->input_count) values[netlist->inputs.data[i]] |= ((word >> i) & 1) << l;
+    }
+  }
+}
+
+static inline
+uint32_t GetVectorLaneCount(const VectorRunner *runner, uint64_t first){
+  uint64_t remaining = runner->vector_count - first;
+  uint32_t result = remaining < VECTOR_LANES ? (uint32_t)remaining : VECTOR_LANES;
+  return result;
+}
+
+static void RunVectorLanes(VectorRunner *runner, Editor *editor){
+  Netlist *netlist = &runner->netlist;
+  uint64_t *values = runner->lane_values;
+  uint64_t *known = runner->lane_known;
+  SetVectorLaneSources(runner, editor, values, known);
+
+  uint64_t randomState = runner->seed | 1;
+  uint64_t inputs[VECTOR_LANES], actual[VECTOR_LANES], unknown[VECTOR_LANES];
+  for(uint64_t first = 0; first < runner->vector_count; first += VECTOR_LANES){
+    uint32_t laneCount = GetVectorLaneCount(runner, first);
+    SetVectorLaneInputs(runner, first, laneCount, values, known, &randomState);
+    EvaluateNetlistLanes(netlist, values, known);
+
+    //NOTE(Torin) Transposes the lanes back into one word per vector
+    memset(inputs, 0, sizeof(inputs));
+    memset(actual, 0, sizeof(actual));
+    memset(unknown, 0, sizeof(unknown));
+    it(i, runner->input_count){
+      uint64_t lanes = values[netlist->inputs.data[i]];
+      it(l, laneCount) inputs[l] |= ((lanes >> l) & 1) << i;
+    }
+    it(o, runner->output_count){
+      uint32_t net = runner->output_nets.data[o];
+      uint64_t lanes = net == NET_INVALID ? 0 : values[net];
+      uint64_t isUnknown = net == NET_INVALID ? ~0ULL : ~known[net];
+      it(l, laneCount){
+        actual[l] |= ((lanes >> l) & 1) << o;
+        unknown[l] |= ((isUnknown >> l) & 1) << o;
+      }
+    }
+    CheckVectorLanes(runner, first, laneCount, inputs, actual, unknown);
+  }
+}
+
+//NOTE(Torin) One EvaluateNetlist per vector, the INPUT nodes are set to every vector
+static void RunVectorsScalar(VectorRunner *runner, Editor *editor){
+  Netlist *netlist = &runner->netlist;
+  LoadNetlistRegisters(netlist);
+  uint64_t randomState = runner->seed | 1;
+  uint64_t inputs[VECTOR_LANES], actual[VECTOR_LANES], unknown[VECTOR_LANES];
+  for(uint64_t first = 0; first < runner->vector_count; first += VECTOR_LANES){
+    uint32_t laneCount = GetVectorLaneCount(runner, first);
+    it(l, laneCount){
+      inputs[l] = GetVectorInputs(runner, first + l, &randomState);
+      it(i, runner->input_count)
+        netlist->input_nodes.data[i]->signal_state = ((inputs[l] >> i) & 1) ? NodeState_HIGH : NodeState_LOW;
+      EvaluateNetlist(netlist, editor->clockTick);
+      actual[l] = unknown[l] = 0;
+      it(o, runner->output_count){
+        uint32_t net = runner->output_nets.data[o];
+        NodeState state = net == NET_INVALID ? NodeState_NONE : netlist->values[net];
+        actual[l] |= (uint64_t)(state == NodeState_HIGH) << o;
+        unknown[l] |= (uint64_t)(state == NodeState_NONE) << o;
+      }
+    }
+    CheckVectorLanes(runner, first, laneCount, inputs, actual, unknown);
+  }
+}
+
+//NOTE(Torin) Builds the netlist and counts the vectors of the selected source
+static bool PrepareVectors(VectorRunner *runner, Editor *editor){
+  runner->error = nullptr;
+  runner->vector_count = 0;
+  runner->mismatch_count = 0;
+  runner->mismatches.count = 0;
+  if(!PrepareVectorRunner(runner, editor)) return false;
+
+  switch(runner->source){
+    case VectorSource_EXHAUSTIVE:{
+      if(runner->input_count > VECTOR_MAX_EXHAUSTIVE_INPUTS){
+        runner->error = "too many inputs for exhaustive vectors";
+        return false;
+      }
+      runner->vector_count = 1ULL << runner->input_count;
+    }break;
+    case VectorSource_RANDOM:{
+      runner->vector_count = (uint64_t)Max(runner->random_count, 0);
+    }break;
+    case VectorSource_FILE:{
+      if(runner->file.input_count != runner->input_count){
+        runner->error = "the stimulus file does not match the number of inputs";
+        return false;
+      }
+      runner->vector_count = runner->file.inputs.count;
+    }break;
+  }
+  return true;
+}
+
+//NOTE(Torin) Returns false and sets VectorRunner::error if the vectors could not be run,
+//mismatches are not an error
+bool RunVectors(VectorRunner *runner, Editor *editor){
+  PROFILE_SCOPE("RunVectors");
+  uint64_t beginTicks = ProfilerTimestamp();
+  if(!PrepareVectors(runner, editor)) return false;
+  if(runner->input_count > VECTOR_MAX_PORTS || runner->output_count > VECTOR_MAX_PORTS){
+    runner->error = "more than 64 inputs or outputs";
+    return false;
+  }
+  if(runner->check == VectorCheck_FILE && (runner->source != VectorSource_FILE || runner->file.output_count != runner->output_count)){
+    runner->error = "the stimulus file has no expected value for every output";
+    return false;
+  }
+  if(runner->check == VectorCheck_REFERENCE && runner->reference == nullptr){
+    runner->error = "no reference model";
+    return false;
+  }
+
+  //NOTE(Torin) The scalar path and an event driven reference drive the INPUT nodes
+  NodeState *savedInputs = (NodeState *)malloc(sizeof(NodeState) * (editor->inputs.count + 1));
+  it(i, editor->inputs.count) savedInputs[i] = editor->inputs[i]->signal_state;
+  if(runner->is_bit_parallel){
+    RunVectorLanes(runner, editor);
+  } else {
+    RunVectorsScalar(runner, editor);
+  }
+  it(i, editor->inputs.count) editor->inputs[i]->signal_state = savedInputs[i];
+  free(savedInputs);
+
+  runner->milliseconds = ProfilerTicksToMilliseconds(ProfilerTimestamp() - beginTicks);
+  return true;
+}
+
+//NOTE(Torin) Reference model that settles the design with the event driven simulator,
+//it is independent of the netlist and catches differences between the two engines.
+//user is the Editor
+void EventDrivenVectorReference(uint64_t inputs, uint64_t *expected, uint64_t *care, void *user){
+  Editor *editor = (Editor *)user;
+  it(i, editor->inputs.count)
+    editor->inputs[i]->signal_state = ((inputs >> i) & 1) ? NodeState_HIGH : NodeState_LOW;
+  SimulateEventDriven(editor);
+  *expected = 0;
+  *care = 0;
+  uint32_t outputIndex = 0;
+  it(i, editor->nodes.count){
+    const EditorNode *node = editor->nodes[i];
+    if(node->type != NodeType_OUTPUT) continue;
+    if(node->input_state[0] != NodeState_NONE) *care |= 1ULL << outputIndex;
+    *expected |= (uint64_t)(node->input_state[0] == NodeState_HIGH) << outputIndex;
+    outputIndex++;
+  }
+}
+
+VectorRunner *CreateVectorRunner(Editor *editor){
+  VectorRunner *runner = (VectorRunner *)calloc(1, sizeof(VectorRunner));
+  runner->random_count = 65536;
+  runner->seed = 0x9E3779B97F4A7C15ULL;
+  runner->reference = EventDrivenVectorReference;
+  runner->reference_user = editor;
+  return runner;
+}
+
+//NOTE(Torin) Bit 0 first like the stimulus file, unknown bits are written as x and
+//bits outside of care as -
+static inline
+void FormatVectorBits(char *buffer, uint64_t value, uint64_t unknown, uint64_t care, uint32_t count){
+  it(i, count){
+    uint64_t bit = 1ULL << i;
+    buffer[i] = !(care & bit) ? '-' : (unknown & bit) ? 'x' : (value & bit) ? '1' : '0';
+  }
+  buffer[count] = 0;
+}
+
+void DestroyVectorRunner(VectorRunner *runner){
+  DestroyNetlist(&runner->netlist);
+  free(runner->lane_values);
+  free(runner->lane_known);
+  runner->lane_values = runner->lane_known = 0;
+  runner->lane_capacity = 0;
+  ArrayDestroy(runner->output_nets);
+  ArrayDestroy(runner->file.inputs);
+  ArrayDestroy(runner->file.expected);
+  ArrayDestroy(runner->file.care);
+  ArrayDestroy(runner->mismatches);
+}
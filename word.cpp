@@ -0,0 +1,124 @@
+//NOTE(Torin) Word level nodes
+//Ports of these nodes carry a bus of up to 64 bits in EditorNode::input_value /
+//output_value which is evaluated with a single native integer operation. NodeState still
+//marks a port as NONE, for a bus it is HIGH when any bit is set which is what wires display.
+//SPLIT and MERGE convert between a bus and single bit wires, slicing and concatenation
+//are a SPLIT feeding a MERGE. INPUT and OUTPUT nodes with a parameter above 1 are bus
+//ports of that width and a REGISTER with one output and a parameter above 1 stores a
+//whole bus, see GetPortWidth
+
+#define BUS_MAX_WIDTH 64
+
+enum WordOp : uint8_t {
+  WordOp_AND,
+  WordOp_OR,
+  WordOp_XOR,
+  WordOp_ADD,
+  WordOp_SUB,
+  WordOp_EQUAL,
+  WordOp_LESS,
+  WordOp_SHIFT_LEFT,
+  WordOp_SHIFT_RIGHT,
+  WordOp_MUX,    //select, a, b
+  WordOp_BIT,    //parameter is the bit index
+  WordOp_MERGE,  //one input per bit, lsb first
+};
+
+static inline
+bool IsWordNodeType(uint32_t type){
+  bool result = type >= NodeType_WORD_AND && type <= NodeType_WORD_MERGE;
+  return result;
+}
+
+static inline
+void GetWordNodeIOCount(uint32_t type, uint32_t width, uint32_t *input_count, uint32_t *output_count){
+  *input_count = 2;
+  *output_count = 1;
+  switch(type){
+    case NodeType_WORD_COMPARE: *output_count = 2; break;
+    case NodeType_WORD_MUX:     *input_count = 3; break;
+    case NodeType_WORD_SPLIT:   *input_count = 1; *output_count = width; break;
+    case NodeType_WORD_MERGE:   *input_count = width; break;
+  }
+}
+
+//NOTE(Torin) A REGISTER either has a D input for every bit or a single bus D input,
+//the bit form always has its bit count as parameter
+static inline
+bool IsBusRegister(const EditorNode *node){
+  bool result = node->type == NodeType_REGISTER && node->output_count == 1 && node->parameter > 1;
+  return result;
+}
+
+//NOTE(Torin) Connections are only allowed between ports of the same width
+static inline
+uint32_t GetPortWidth(const EditorNode *node, bool is_input, size_t index){
+  if(IsMemoryNodeType(node->type)) return GetMemoryPortWidth(node, is_input, index);
+  //NOTE(Torin) Ports created before bus widths have a parameter of 0
+  if(node->type == NodeType_INPUT || node->type == NodeType_OUTPUT) return node->parameter > 1 ? node->parameter : 1;
+  if(IsBusRegister(node)) return (is_input && index == 1) ? 1 : node->parameter;
+  if(!IsWordNodeType(node->type)) return 1;
+  uint32_t width = node->parameter;
+  switch(node->type){
+    case NodeType_WORD_COMPARE: return is_input ? width : 1;
+    case NodeType_WORD_MUX:     return (is_input && index == 0) ? 1 : width;
+    case NodeType_WORD_SPLIT:   return is_input ? width : 1;
+    case NodeType_WORD_MERGE:   return is_input ? 1 : width;
+  }
+  return width;
+}
+
+//NOTE(Torin) Bus value of an output, single bit outputs only keep their NodeState current
+static inline
+uint64_t GetOutputWord(const EditorNode *node, size_t index){
+  uint64_t result = GetPortWidth(node, false, index) > 1 ? node->output_value[index] : (node->output_state[index] == NodeState_HIGH);
+  return result;
+}
+
+//NOTE(Torin) Operation producing output output_index, parameter is the bus width or
+//the bit index for WordOp_BIT
+static inline
+WordOp GetWordOutputOp(uint32_t type, size_t output_index, uint32_t width, uint32_t *parameter){
+  *parameter = width;
+  switch(type){
+    case NodeType_WORD_AND:     return WordOp_AND;
+    case NodeType_WORD_OR:      return WordOp_OR;
+    case NodeType_WORD_XOR:     return WordOp_XOR;
+    case NodeType_WORD_ADD:     return WordOp_ADD;
+    case NodeType_WORD_SUB:     return WordOp_SUB;
+    case NodeType_WORD_COMPARE: return output_index == 0 ? WordOp_EQUAL : WordOp_LESS;
+    case NodeType_WORD_SHL:     return WordOp_SHIFT_LEFT;
+    case NodeType_WORD_SHR:     return WordOp_SHIFT_RIGHT;
+    case NodeType_WORD_MUX:     return WordOp_MUX;
+    case NodeType_WORD_SPLIT:   *parameter = output_index; return WordOp_BIT;
+    case NodeType_WORD_MERGE:   return WordOp_MERGE;
+  }
+  assert(false);
+  return WordOp_AND;
+}
+
+static inline
+uint64_t EvaluateWordOp(WordOp op, uint32_t parameter, const uint64_t *inputs, uint32_t input_count){
+  uint64_t a = inputs[0];
+  uint64_t b = input_count > 1 ? inputs[1] : 0;
+  switch(op){
+    case WordOp_AND: return a & b;
+    case WordOp_OR:  return a | b;
+    case WordOp_XOR: return a ^ b;
+    case WordOp_ADD: return (a + b) & WordMask(parameter);
+    case WordOp_SUB: return (a - b) & WordMask(parameter);
+    case WordOp_EQUAL: return a == b;
+    case WordOp_LESS:  return a < b;
+    case WordOp_SHIFT_LEFT:  return (b >= parameter) ? 0 : (a << b) & WordMask(parameter);
+    case WordOp_SHIFT_RIGHT: return (b >= parameter) ? 0 : a >> b;
+    case WordOp_MUX: return a ? inputs[2] : b;
+    case WordOp_BIT: return (a >> parameter) & 1;
+    case WordOp_MERGE: {
+      uint64_t result = 0;
+      for(uint32_t i = 0; i < input_count; i++) result |= (inputs[i] & 1) << i;
+      return result;
+    }
+  }
+  assert(false);
+  return 0;
+}